@@ -69,4 +69,22 @@
     #define AWS_IOT_SECURE_SOCKETS_METRICS_ENABLED    ( 0 )
 #endif
 
+/**
+ * @brief Host name lookup of SOCKETS_GetHostByName.
+ *
+ * xLookUp is the lookup of the port, a uint32_t ( * )( const char * ) that
+ * returns the address or 0. A board may put e.g. a cache in front of it, by
+ * default the port calls it directly.
+ */
+#ifndef socketsconfigGET_HOST_BY_NAME_HOOK
+    #define socketsconfigGET_HOST_BY_NAME_HOOK( pcHostName, xLookUp )    ( xLookUp( pcHostName ) )
+#endif
+
+/**
+ * @brief Called by the port after every successful TLS send, nothing by default.
+ */
+#ifndef socketsconfigTLS_SEND_HOOK
+    #define socketsconfigTLS_SEND_HOOK()
+#endif
+
 #endif /* AWS_INC_SECURE_SOCKETS_CONFIG_DEFAULTS_H_ */
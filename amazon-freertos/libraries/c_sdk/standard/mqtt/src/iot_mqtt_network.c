@@ -630,6 +630,8 @@ static IotMqttError_t _deserializeIncomingPacket( _mqttConnection_t * pMqttConne
                                  pMqttConnection );
 
                     pMqttConnection->keepAliveFailure = false;
+
+                    IotMqtt_PingrespHook();
                 }
 
                 IotMutex_Unlock( &( pMqttConnection->referencesMutex ) );
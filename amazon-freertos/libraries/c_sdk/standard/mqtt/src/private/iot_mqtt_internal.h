@@ -192,6 +192,14 @@
 #ifndef IOT_MQTT_RETRY_MS_CEILING
     #define IOT_MQTT_RETRY_MS_CEILING               ( 60000 )
 #endif
+
+/**
+ * @brief Called on every expected PINGRESP, lets the application track the
+ * liveness of the connection. Does nothing by default.
+ */
+#ifndef IotMqtt_PingrespHook
+    #define IotMqtt_PingrespHook()
+#endif
 /** @endcond */
 
 /**
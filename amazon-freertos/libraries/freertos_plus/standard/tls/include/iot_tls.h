@@ -46,6 +46,18 @@
 
 /**@} */
 
+/**
+ * @brief Offer the session of the last full handshake on the next connect
+ * to the same server.
+ *
+ * A resumed handshake skips the certificate exchange and the signature with
+ * the device key. Connects are expected from one task at a time. Off unless
+ * the board configuration enables it.
+ */
+#ifndef tlsSESSION_RESUMPTION
+    #define tlsSESSION_RESUMPTION    ( 0 )
+#endif
+
 /**
  * @brief Defines callback type for receiving bytes from the network.
  *
@@ -153,4 +165,10 @@ BaseType_t TLS_Send( void * pvContext,
  */
 void TLS_Cleanup( void * pvContext );
 
+/**
+ * @brief Drops the session kept for resumption, the next TLS_Connect does a
+ * full handshake.
+ */
+void TLS_ForgetSession( void );
+
 #endif /* ifndef __AWS__TLS__H__ */
@@ -102,6 +102,23 @@ typedef struct TLSContext
 
 #define TLS_PRINT( X )    vLoggingPrintf X
 
+#if ( tlsSESSION_RESUMPTION == 1 )
+
+/**
+ * @brief Longest server name a session is kept for.
+ */
+    #define tlsSESSION_DESTINATION_MAX    ( 96 )
+
+/**
+ * @brief Session of the last successful handshake and the server it belongs to.
+ *
+ * A deep copy, it outlives the TLS context it was taken from.
+ */
+    static mbedtls_ssl_session xSavedSession;
+    static char cSavedDestination[ tlsSESSION_DESTINATION_MAX ];
+    static BaseType_t xSessionSaved = pdFALSE;
+#endif /* if ( tlsSESSION_RESUMPTION == 1 ) */
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -135,6 +152,62 @@ static void prvFreeContext( TLSContext_t * pxCtx )
 
 /*-----------------------------------------------------------*/
 
+#if ( tlsSESSION_RESUMPTION == 1 )
+
+/**
+ * @brief Keeps the session of a finished handshake for the next connect.
+ *
+ * @param[in] pxCtx Context the handshake succeeded on.
+ */
+    static void prvSaveSession( TLSContext_t * pxCtx )
+    {
+        TLS_ForgetSession();
+
+        if( ( NULL != pxCtx->pcDestination ) &&
+            ( strlen( pxCtx->pcDestination ) < sizeof( cSavedDestination ) ) )
+        {
+            mbedtls_ssl_session_init( &xSavedSession );
+
+            if( 0 == mbedtls_ssl_get_session( &pxCtx->xMbedSslCtx, &xSavedSession ) )
+            {
+                strcpy( cSavedDestination, pxCtx->pcDestination );
+                xSessionSaved = pdTRUE;
+            }
+            else
+            {
+                mbedtls_ssl_session_free( &xSavedSession );
+            }
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Offers the saved session if it was made with the same server.
+ *
+ * A session that fails to resume is kept, the caller decides with
+ * TLS_ForgetSession() when to stop offering it.
+ *
+ * @param[in] pxCtx Context before the handshake.
+ */
+    static void prvOfferSession( TLSContext_t * pxCtx )
+    {
+        if( ( pdTRUE == xSessionSaved ) &&
+            ( NULL != pxCtx->pcDestination ) &&
+            ( 0 == strcmp( cSavedDestination, pxCtx->pcDestination ) ) )
+        {
+            /* The server falls back to a full handshake by itself if it
+             * does not know the session any more. */
+            if( 0 != mbedtls_ssl_set_session( &pxCtx->xMbedSslCtx, &xSavedSession ) )
+            {
+                TLS_ForgetSession();
+            }
+        }
+    }
+#endif /* if ( tlsSESSION_RESUMPTION == 1 ) */
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Network send callback shim.
  *
@@ -844,6 +917,14 @@ BaseType_t TLS_Connect( void * pvContext )
         xResult = mbedtls_ssl_set_hostname( &pxCtx->xMbedSslCtx, pxCtx->pcDestination );
     }
 
+    #if ( tlsSESSION_RESUMPTION == 1 )
+        /* Try to resume the session of the last connect. */
+        if( 0 == xResult )
+        {
+            prvOfferSession( pxCtx );
+        }
+    #endif
+
     /* Set the socket callbacks. */
     if( 0 == xResult )
     {
@@ -873,6 +954,10 @@ BaseType_t TLS_Connect( void * pvContext )
     if( 0 == xResult )
     {
         pxCtx->xTLSHandshakeSuccessful = pdTRUE;
+
+        #if ( tlsSESSION_RESUMPTION == 1 )
+            prvSaveSession( pxCtx );
+        #endif
     }
     else if( xResult > 0 )
     {
@@ -1006,3 +1091,20 @@ void TLS_Cleanup( void * pvContext )
         vPortFree( pxCtx );
     }
 }
+
+/*-----------------------------------------------------------*/
+
+void TLS_ForgetSession( void )
+{
+    #if ( tlsSESSION_RESUMPTION == 1 )
+        if( pdTRUE == xSessionSaved )
+        {
+            /* Ensure that the FreeRTOS heap is used. */
+            CRYPTO_ConfigureHeap();
+
+            mbedtls_ssl_session_free( &xSavedSession );
+            cSavedDestination[ 0 ] = '\0';
+            xSessionSaved = pdFALSE;
+        }
+    #endif
+}
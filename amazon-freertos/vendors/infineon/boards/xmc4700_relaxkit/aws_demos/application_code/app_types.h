@@ -27,7 +27,12 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "correlation.h"
+#include "classifier.h"
+#include "spectrum_codec.h"
+#include "message_schema.h"
 #include "sensors.h"
+#include "latency.h"
 
 
 #define	BUF_LEN( x )		( (sizeof( x )) / (sizeof( x[0] )) )
@@ -45,63 +50,72 @@ typedef struct {
 
 typedef struct { uint16_t data[128]; } FFTData_t; 	//! Spectra characteristics
 
+/* Structure containing Hall switch edge parameters */
+typedef struct {
+    float fFrequency; 					//! < Switching frequency, Hz
+    float fDutyCycle; 					//! < Share of the window with field present
+    uint32_t ulPulseCount; 				//! < Field-on edges in the window
+    float fDwellOn; 					//! < Mean field-on dwell time, ms
+    float fDwellOff; 					//! < Mean field-off dwell time, ms
+} EdgeData_t;
+
+/* Structure containing values derived from a DPS368 differential pressure pair */
+typedef struct {
+    float fDiffPressure; 				//! < Upstream minus downstream pressure, Pa
+    float fFlow; 						//! < Temperature compensated volume flow, m^3/h
+    float fCloggingIndex; 				//! < Fitted differential pressure growth, %/h
+} DerivedData_t;
+
+
+/* Parts of a window the encoders write, less detail for weaker links */
+typedef enum {
+	MSG_DETAIL_FULL = 0,						//! < Everything
+	MSG_DETAIL_FEATURES,						//! < No spectra
+	MSG_DETAIL_STATS							//! < Statistic of the parameters and the derived values only
+
+} MsgDetail_t;
 
-/* Data type to push the message to the cloud */
+/* Data type to push the message to the cloud, one entry per row of message_schema.h */
 typedef struct {
-	bool bDPS368On_1;							//! < Boolean availability dps368
-	bool bDPS368On_2;							//! < Boolean availability dps368
-	bool bDPS368On_3;							//! < Boolean availability dps368
-	bool bDPS368On_4;							//! < Boolean availability dps368
-	bool bDPS368On_5;							//! < Boolean availability dps368
-	bool bTLI4971On_1; 							//! < Boolean availability tli4971
-	bool bTLI4971On_2; 							//! < Boolean availability tli4971
-	bool bTLI4971On_3; 							//! < Boolean availability tli4971
-	bool bTLE4997On_1; 							//! < Boolean availability tle4997
-	bool bTLE4964On_1; 						    //! < Boolean availability tle4964
-	bool bTLE49613KOn_1; 						//! < Boolean availability tle4961-3k
-	bool bTLE4913On_1; 							//! < Boolean availability tle4913
-	bool bTLE49611KOn_1; 						//! < Boolean availability tle4961-1k
-	bool bTLI4966gOn_1; 						//! < Boolean availability tli4966g
-	bool bIM69dOn_1;							//! < Boolean availability im69d130
-	bool bTLI493dOn_1; 							//! < Boolean availability tli493d-a2b6
-    StatData_t fDPS368Temperature_1; 			//! < Temperature statistic dps368
-    StatData_t fDPS368Temperature_2; 			//! < Temperature statistic dps368
-    StatData_t fDPS368Temperature_3; 			//! < Temperature statistic dps368
-    StatData_t fDPS368Temperature_4; 			//! < Temperature statistic dps368
-    StatData_t fDPS368Temperature_5; 			//! < Temperature statistic dps368
-    StatData_t fDPS368Pressure_1; 				//! < Air pressure statistic dps368
-    StatData_t fDPS368Pressure_2; 				//! < Air pressure statistic dps368
-    StatData_t fDPS368Pressure_3; 				//! < Air pressure statistic dps368
-    StatData_t fDPS368Pressure_4; 				//! < Air pressure statistic dps368
-    StatData_t fDPS368Pressure_5; 				//! < Air pressure statistic dps368
-    StatData_t fTLI4971Current_1; 				//! < Current consumption statistic tli4971
-    StatData_t fTLI4971Current_2; 				//! < Current consumption statistic tli4971
-    StatData_t fTLI4971Current_3; 				//! < Current consumption statistic tli4971
-    StatData_t fTLE4997LinearHall_1; 			//! < Linear Hall statistic tle4997
-    StatData_t fTLE4964Hall_1; 				    //! < Hall statistic tle4964
-    StatData_t fTLE49613kHall_1; 				//! < Hall statistic tle4961-3k
-	StatData_t fTLE4913Hall_1; 					//! < Hall statistic tle4913
-	StatData_t fTLE49611kHall_1; 					//! < Hall statistic tle4961-1k
-    StatData_t fTLI4966gDoubleHall_Speed_1; 	//! < Double Hall Speed statistic tli4966g
-    StatData_t fTLI4966gDoubleHall_Dir_1; 		//! < Double Hall Direction statistic tli4966g
-    StatData_t fIM69dMic_1;						//! < Microphone statistics im69d130
-    StatData_t fTLI493dMagnetic_X_1; 			//! < 3D magnetic statistic tli493d-a2b6
-    StatData_t fTLI493dMagnetic_Y_1; 			//! < 3D magnetic statistic tli493d-a2b6
-    StatData_t fTLI493dMagnetic_Z_1; 			//! < 3D magnetic statistic tli493d-a2b6
-    FFTData_t fIM69dMicSpectra_1; 				//! < Spectra characteristics of the data gathered from the microphone
-    FFTData_t fTLE4997HallSpectra_1; 			//! < Spectra characteristics of the data gathered from the hall sensor
+	bool bOn[MSG_SENSOR_MAX];					//! < Boolean availability of the sensor
+	bool bReady[MSG_SENSOR_MAX];				//! < Boolean statistic window of the sensor closed
+    StatData_t xStat[MSG_PARAMETER_MAX]; 		//! < Statistic of the parameter
+	bool bSuppressed[MSG_PARAMETER_MAX];		//! < Boolean parameter within its deadband, left out of the payload
+    FFTData_t xFft[MSG_SPECTRUM_MAX]; 			//! < Spectra characteristics of the microphone and the linear hall sensor
+    EdgeData_t xEdge[MSG_EDGE_MAX]; 			//! < Edge timing of the hall switches
+	bool bPairOn[MSG_PAIR_MAX];					//! < Boolean availability dps368 pair
+	bool bPairReady[MSG_PAIR_MAX];				//! < Boolean derived values calculated dps368 pair
+    DerivedData_t xPair[MSG_PAIR_MAX]; 			//! < Differential pressure, flow and clogging dps368 pair
+	bool bCorrelationOn;						//! < Boolean availability of the correlation
+	bool bCorrelationReady;						//! < Boolean correlation calculated in the window
+    CorrelationData_t xCorrelation; 			//! < Covariance and correlation of the configured parameters
+	bool bClassifierOn;							//! < Boolean availability of the classifier model
+	bool bClassifierReady;						//! < Boolean classifier run in the window
+    ClassifierData_t xClassifier; 				//! < Class probabilities of the window
+    uint32_t ulTimestamp; 						//! < Tick of the window close, ms
+	bool bAlarm;								//! < Boolean window goes through the high lane, ahead of the routine windows
+	MsgDetail_t xDetail;						//! < Parts of the window in the payload, set by the MQTT task before encoding
+	LatencyTrace_t xTrace;						//! < Time of the window at each stage on the way to the broker
 
 } InfineonSensorsMessage_t;
 
 /* Structure containing fields for sensor data */
 typedef struct {
     bool bOn;
+    bool bReady;
     bool bInited;
     uint32_t ucErrorCount;
     char *pcName;
+    uint8_t ucId;						//! < JsonSensorsStatistic_t, the integer key of binary payloads
     void *pvCxt;
     StatData_t *pxStat;
     FFTData_t *pxFft;
+    SpecCodec_t *pxSpecCodec;			//! < Window to window state, the spectrum goes compressed with it
+    uint8_t ucPrecision;				//! < Digits after the point of the statistic in JSON
+    EdgeData_t *pxEdge;
+    DerivedData_t *pxDerived;
+    CorrelationData_t *pxCorr;
+    ClassifierData_t *pxClass;
 
 } SensorContext_t;
 
@@ -0,0 +1,491 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+
+#include "hall_capture.h"
+
+#include "DAVE.h"
+#include "xmc_posif.h"
+
+
+/*
+ * The Hall switch outputs of this board are not wired to CCU4 input pins, so
+ * every edge is detected in hardware and timestamped in its interrupt from a
+ * free-running 32-bit CCU4 timebase (latency < 1us):
+ * - P0.11 and P3.1 only reach ERU0, which has no route to the CCU4 event
+ *   inputs. They use ERU0 both-edge interrupts.
+ * - P14.6 and P14.7 have no ERU input, but they are the POSIF0 Hall inputs 1
+ *   and 0. POSIF0 runs in Hall sensor mode for its input edge detection only,
+ *   the handler reads both pins and logs the one that changed.
+ */
+#define HALL_CAPTURE_TIMEBASE_MODULE        CCU43
+#define HALL_CAPTURE_TIMEBASE_LOW           CCU43_CC40
+#define HALL_CAPTURE_TIMEBASE_HIGH          CCU43_CC41
+
+#define HALL_CAPTURE_TLE4913_IRQHandler     IRQ_Hdlr_4      /* ERU0 OGU3 */
+#define HALL_CAPTURE_TLE49611K_IRQHandler   IRQ_Hdlr_1      /* ERU0 OGU0 */
+#define HALL_CAPTURE_POSIF_IRQHandler       POSIF0_0_IRQHandler     /* POSIF0 SR0 */
+
+#define HALL_CAPTURE_POSIF                  POSIF0
+#define HALL_CAPTURE_POSIF_IRQn             POSIF0_0_IRQn
+
+#define HALL_CAPTURE_RING_MASK              ( HALL_CAPTURE_RING_LEN - 1U )
+
+
+typedef struct {
+	/* Edge ring, written by the ERU or POSIF interrupt, read by the sensors task */
+	HallCaptureEdge_t xRing[HALL_CAPTURE_RING_LEN];
+	volatile uint32_t ulHead;
+	volatile uint32_t ulTail;
+	volatile uint32_t ulOverrun;
+
+	bool bInited;
+	uint8_t ucLevel;            /* Level after the last consumed edge */
+	uint8_t ucEdgeLevel;        /* Level of the last logged edge, POSIF channels */
+
+	/* Window accumulators, in timebase ticks */
+	uint32_t ulWindowRef;       /* Start of the open duty interval */
+	uint32_t ulLastEdge;
+	uint32_t ulLastRise;
+	bool bLastEdgeValid;
+	bool bLastRiseValid;
+	uint32_t ulOnTicks;
+	uint32_t ulOffTicks;
+	uint32_t ulDwellOnSum;
+	uint32_t ulDwellOnCount;
+	uint32_t ulDwellOffSum;
+	uint32_t ulDwellOffCount;
+	uint32_t ulPeriodSum;
+	uint32_t ulPeriodCount;
+	uint32_t ulPulseCount;
+	uint32_t ulOverrunSeen;
+
+} HallCaptureChannelCxt_t;
+
+
+static HallCaptureChannelCxt_t xChannels[HALL_CAPTURE_CHANNEL_MAX];
+static bool bTimebaseStarted = false;
+/* Channels on the POSIF0 Hall inputs, bit per HallCaptureChannel_t */
+static volatile uint8_t ucPosifChannels = 0U;
+
+
+static void prvTimebaseStart( void )
+{
+	const XMC_CCU4_SLICE_COMPARE_CONFIG_t xLowConfig = {
+		.timer_mode = XMC_CCU4_SLICE_TIMER_COUNT_MODE_EA,
+		.monoshot = XMC_CCU4_SLICE_TIMER_REPEAT_MODE_REPEAT,
+		.prescaler_mode = XMC_CCU4_SLICE_PRESCALER_MODE_NORMAL,
+		.prescaler_initval = XMC_CCU4_SLICE_PRESCALER_16,
+		.timer_concatenation = false
+	};
+	const XMC_CCU4_SLICE_COMPARE_CONFIG_t xHighConfig = {
+		.timer_mode = XMC_CCU4_SLICE_TIMER_COUNT_MODE_EA,
+		.monoshot = XMC_CCU4_SLICE_TIMER_REPEAT_MODE_REPEAT,
+		.prescaler_mode = XMC_CCU4_SLICE_PRESCALER_MODE_NORMAL,
+		.prescaler_initval = XMC_CCU4_SLICE_PRESCALER_16,
+		.timer_concatenation = true
+	};
+
+	if( bTimebaseStarted )
+	{
+		return;
+	}
+
+	/* CCU43 module and its prescaler are started by GLOBAL_CCU4_0 in DAVE_Init() */
+	XMC_CCU4_EnableClock( HALL_CAPTURE_TIMEBASE_MODULE, 0U );
+	XMC_CCU4_EnableClock( HALL_CAPTURE_TIMEBASE_MODULE, 1U );
+
+	XMC_CCU4_SLICE_CompareInit( HALL_CAPTURE_TIMEBASE_LOW, &xLowConfig );
+	XMC_CCU4_SLICE_CompareInit( HALL_CAPTURE_TIMEBASE_HIGH, &xHighConfig );
+
+	XMC_CCU4_SLICE_SetTimerPeriodMatch( HALL_CAPTURE_TIMEBASE_LOW, 0xFFFFU );
+	XMC_CCU4_SLICE_SetTimerPeriodMatch( HALL_CAPTURE_TIMEBASE_HIGH, 0xFFFFU );
+	XMC_CCU4_EnableShadowTransfer( HALL_CAPTURE_TIMEBASE_MODULE,
+			XMC_CCU4_SHADOW_TRANSFER_SLICE_0 | XMC_CCU4_SHADOW_TRANSFER_SLICE_1 );
+
+	XMC_CCU4_SLICE_StartTimer( HALL_CAPTURE_TIMEBASE_HIGH );
+	XMC_CCU4_SLICE_StartTimer( HALL_CAPTURE_TIMEBASE_LOW );
+
+	bTimebaseStarted = true;
+}
+
+
+static void prvEruInit( HallCaptureChannel_t xChannel )
+{
+	XMC_ERU_ETL_CONFIG_t xEtlConfig = {
+		.enable_output_trigger = 1U,
+		.status_flag_mode = XMC_ERU_ETL_STATUS_FLAG_MODE_SWCTRL,
+		.edge_detection = XMC_ERU_ETL_EDGE_DETECTION_BOTH
+	};
+	XMC_ERU_OGU_CONFIG_t xOguConfig = {
+		.enable_pattern_detection = XMC_ERU_OGU_PATTERN_DETECTION_DISABLED,
+		.service_request = XMC_ERU_OGU_SERVICE_REQUEST_ON_TRIGGER
+	};
+	uint8_t ucEtl;
+	IRQn_Type xIrq;
+
+	if( xChannel == HALL_CAPTURE_CHANNEL_TLE4913 )
+	{
+		ucEtl = 3U;
+		xIrq = ERU0_3_IRQn;
+		xEtlConfig.input_a = ERU0_ETL3_INPUTA_P0_11;
+		xEtlConfig.source = XMC_ERU_ETL_SOURCE_A;
+		xEtlConfig.output_trigger_channel = XMC_ERU_ETL_OUTPUT_TRIGGER_CHANNEL3;
+	}
+	else
+	{
+		ucEtl = 0U;
+		xIrq = ERU0_0_IRQn;
+		xEtlConfig.input_b = ERU0_ETL0_INPUTB_P3_1;
+		xEtlConfig.source = XMC_ERU_ETL_SOURCE_B;
+		xEtlConfig.output_trigger_channel = XMC_ERU_ETL_OUTPUT_TRIGGER_CHANNEL0;
+	}
+
+	XMC_ERU_ETL_Init( XMC_ERU0, ucEtl, &xEtlConfig );
+	XMC_ERU_OGU_Init( XMC_ERU0, ucEtl, &xOguConfig );
+
+	NVIC_SetPriority( xIrq, NVIC_EncodePriority( NVIC_GetPriorityGrouping(), HALL_CAPTURE_IRQ_PRIORITY, 0U ) );
+	NVIC_ClearPendingIRQ( xIrq );
+	NVIC_EnableIRQ( xIrq );
+}
+
+
+static void prvEruDeInit( HallCaptureChannel_t xChannel )
+{
+	if( xChannel == HALL_CAPTURE_CHANNEL_TLE4913 )
+	{
+		NVIC_DisableIRQ( ERU0_3_IRQn );
+	}
+	else
+	{
+		NVIC_DisableIRQ( ERU0_0_IRQn );
+	}
+}
+
+
+/* The first channel starts POSIF0, the handler serves both */
+static void prvPosifInit( HallCaptureChannel_t xChannel )
+{
+	const XMC_POSIF_CONFIG_t xPosifConfig = {
+		.mode = XMC_POSIF_MODE_HALL_SENSOR,
+		.input0 = XMC_POSIF_INPUT_PORT_B,       /* P14.7 */
+		.input1 = XMC_POSIF_INPUT_PORT_B,       /* P14.6 */
+		.input2 = XMC_POSIF_INPUT_PORT_D,       /* ERU1 PDOUT2, not used and static */
+		.filter = XMC_POSIF_FILTER_16_CLOCK_CYCLE
+	};
+
+	NVIC_DisableIRQ( HALL_CAPTURE_POSIF_IRQn );
+
+	if( ucPosifChannels == 0U )
+	{
+		XMC_POSIF_Init( HALL_CAPTURE_POSIF, &xPosifConfig );
+		XMC_POSIF_SetInterruptNode( HALL_CAPTURE_POSIF, XMC_POSIF_IRQ_EVENT_HALL_INPUT, XMC_POSIF_SR_ID_0 );
+		XMC_POSIF_ClearEvent( HALL_CAPTURE_POSIF, XMC_POSIF_IRQ_EVENT_HALL_INPUT );
+		XMC_POSIF_EnableEvent( HALL_CAPTURE_POSIF, XMC_POSIF_IRQ_EVENT_HALL_INPUT );
+		XMC_POSIF_Start( HALL_CAPTURE_POSIF );
+		NVIC_SetPriority( HALL_CAPTURE_POSIF_IRQn, NVIC_EncodePriority( NVIC_GetPriorityGrouping(), HALL_CAPTURE_IRQ_PRIORITY, 0U ) );
+		NVIC_ClearPendingIRQ( HALL_CAPTURE_POSIF_IRQn );
+	}
+	ucPosifChannels |= ( uint8_t )( 1U << xChannel );
+
+	NVIC_EnableIRQ( HALL_CAPTURE_POSIF_IRQn );
+}
+
+
+static void prvPosifDeInit( HallCaptureChannel_t xChannel )
+{
+	NVIC_DisableIRQ( HALL_CAPTURE_POSIF_IRQn );
+
+	ucPosifChannels &= ( uint8_t )~( 1U << xChannel );
+	if( ucPosifChannels == 0U )
+	{
+		XMC_POSIF_Stop( HALL_CAPTURE_POSIF );
+		XMC_POSIF_DisableEvent( HALL_CAPTURE_POSIF, XMC_POSIF_IRQ_EVENT_HALL_INPUT );
+	}
+	else
+	{
+		NVIC_EnableIRQ( HALL_CAPTURE_POSIF_IRQn );
+	}
+}
+
+
+/* Single producer: the ERU or POSIF interrupt of the channel */
+static inline void prvEdgePush( HallCaptureChannelCxt_t *pxCh, uint32_t ulTimestamp, uint8_t ucLevel )
+{
+	uint32_t ulHead = pxCh->ulHead;
+
+	if( ( ulHead - pxCh->ulTail ) >= HALL_CAPTURE_RING_LEN )
+	{
+		pxCh->ulOverrun++;
+		return;
+	}
+
+	pxCh->xRing[ulHead & HALL_CAPTURE_RING_MASK].ulTimestamp = ulTimestamp;
+	pxCh->xRing[ulHead & HALL_CAPTURE_RING_MASK].ucLevel = ucLevel;
+	__DMB();
+	pxCh->ulHead = ulHead + 1U;
+}
+
+
+void HALL_CAPTURE_TLE4913_IRQHandler( void )
+{
+	uint32_t ulTimestamp = HALL_CAPTURE_ulTimestamp();
+
+	XMC_ERU_ETL_ClearStatusFlag( XMC_ERU0, 3U );
+	prvEdgePush( &xChannels[HALL_CAPTURE_CHANNEL_TLE4913], ulTimestamp,
+			( DIGITAL_IO_GetInput( &TLE4913_DATA_1 ) == 0U ) ? 1U : 0U );
+}
+
+
+void HALL_CAPTURE_TLE49611K_IRQHandler( void )
+{
+	uint32_t ulTimestamp = HALL_CAPTURE_ulTimestamp();
+
+	XMC_ERU_ETL_ClearStatusFlag( XMC_ERU0, 0U );
+	prvEdgePush( &xChannels[HALL_CAPTURE_CHANNEL_TLE49611K], ulTimestamp,
+			( DIGITAL_IO_GetInput( &TLE49611K_DATA_1 ) == 0U ) ? 1U : 0U );
+}
+
+
+/* POSIF0 flags an edge of any Hall input, only a channel whose level changed gets it */
+static inline void prvPosifLevel( HallCaptureChannel_t xChannel, uint32_t ulTimestamp, uint8_t ucLevel )
+{
+	HallCaptureChannelCxt_t *pxCh = &xChannels[xChannel];
+
+	if( ( ( ucPosifChannels & ( 1U << xChannel ) ) != 0U ) && ( ucLevel != pxCh->ucEdgeLevel ) )
+	{
+		pxCh->ucEdgeLevel = ucLevel;
+		prvEdgePush( pxCh, ulTimestamp, ucLevel );
+	}
+}
+
+
+void HALL_CAPTURE_POSIF_IRQHandler( void )
+{
+	uint32_t ulTimestamp = HALL_CAPTURE_ulTimestamp();
+
+	XMC_POSIF_ClearEvent( HALL_CAPTURE_POSIF, XMC_POSIF_IRQ_EVENT_HALL_INPUT );
+	prvPosifLevel( HALL_CAPTURE_CHANNEL_TLE4964, ulTimestamp,
+			( DIGITAL_IO_GetInput( &TLE4964_DATA_1 ) == 0U ) ? 1U : 0U );
+	prvPosifLevel( HALL_CAPTURE_CHANNEL_TLE49613K, ulTimestamp,
+			( DIGITAL_IO_GetInput( &TLE49613K_DATA_1 ) == 0U ) ? 1U : 0U );
+}
+
+
+/* 32-bit read of the concatenated timer, retried if the high half rolled over in between */
+uint32_t HALL_CAPTURE_ulTimestamp( void )
+{
+	uint16_t usHigh;
+	uint16_t usLow;
+
+	do
+	{
+		usHigh = XMC_CCU4_SLICE_GetTimerValue( HALL_CAPTURE_TIMEBASE_HIGH );
+		usLow = XMC_CCU4_SLICE_GetTimerValue( HALL_CAPTURE_TIMEBASE_LOW );
+	} while( usHigh != XMC_CCU4_SLICE_GetTimerValue( HALL_CAPTURE_TIMEBASE_HIGH ) );
+
+	return ( (uint32_t)usHigh << 16 ) | usLow;
+}
+
+
+int32_t HALL_CAPTURE_lChannelInit( HallCaptureChannel_t xChannel, uint8_t ucLevel )
+{
+	if( xChannel >= HALL_CAPTURE_CHANNEL_MAX )
+	{
+		return -1;
+	}
+
+	prvTimebaseStart();
+
+	HallCaptureChannelCxt_t *pxCh = &xChannels[xChannel];
+	if( pxCh->bInited )
+	{
+		HALL_CAPTURE_vChannelDeInit( xChannel );
+	}
+
+	memset( pxCh, 0, sizeof( HallCaptureChannelCxt_t ) );
+	pxCh->ucLevel = ucLevel;
+	pxCh->ucEdgeLevel = ucLevel;
+	pxCh->ulWindowRef = HALL_CAPTURE_ulTimestamp();
+	pxCh->bInited = true;
+
+	if( ( xChannel == HALL_CAPTURE_CHANNEL_TLE4913 ) || ( xChannel == HALL_CAPTURE_CHANNEL_TLE49611K ) )
+	{
+		prvEruInit( xChannel );
+	}
+	else
+	{
+		prvPosifInit( xChannel );
+	}
+
+	return 0;
+}
+
+
+void HALL_CAPTURE_vChannelDeInit( HallCaptureChannel_t xChannel )
+{
+	if( ( xChannel >= HALL_CAPTURE_CHANNEL_MAX ) || ( !xChannels[xChannel].bInited ) )
+	{
+		return;
+	}
+
+	if( ( xChannel == HALL_CAPTURE_CHANNEL_TLE4913 ) || ( xChannel == HALL_CAPTURE_CHANNEL_TLE49611K ) )
+	{
+		prvEruDeInit( xChannel );
+	}
+	else
+	{
+		prvPosifDeInit( xChannel );
+	}
+	xChannels[xChannel].bInited = false;
+}
+
+
+void HALL_CAPTURE_vUpdate( HallCaptureChannel_t xChannel )
+{
+	if( xChannel >= HALL_CAPTURE_CHANNEL_MAX )
+	{
+		return;
+	}
+
+	HallCaptureChannelCxt_t *pxCh = &xChannels[xChannel];
+	if( !pxCh->bInited )
+	{
+		return;
+	}
+
+	uint32_t ulHead = pxCh->ulHead;
+	__DMB();
+
+	while( pxCh->ulTail != ulHead )
+	{
+		HallCaptureEdge_t xEdge = pxCh->xRing[pxCh->ulTail & HALL_CAPTURE_RING_MASK];
+		pxCh->ulTail++;
+
+		/* Two edges of the same level mean the opposite one was lost or bounced */
+		if( xEdge.ucLevel == pxCh->ucLevel )
+		{
+			continue;
+		}
+
+		/* Duty time of the interval closed by this edge */
+		if( pxCh->ucLevel )
+		{
+			pxCh->ulOnTicks += xEdge.ulTimestamp - pxCh->ulWindowRef;
+		}
+		else
+		{
+			pxCh->ulOffTicks += xEdge.ulTimestamp - pxCh->ulWindowRef;
+		}
+		pxCh->ulWindowRef = xEdge.ulTimestamp;
+
+		/* Dwell is counted only between two real edges */
+		if( pxCh->bLastEdgeValid )
+		{
+			if( pxCh->ucLevel )
+			{
+				pxCh->ulDwellOnSum += xEdge.ulTimestamp - pxCh->ulLastEdge;
+				pxCh->ulDwellOnCount++;
+			}
+			else
+			{
+				pxCh->ulDwellOffSum += xEdge.ulTimestamp - pxCh->ulLastEdge;
+				pxCh->ulDwellOffCount++;
+			}
+		}
+		pxCh->ulLastEdge = xEdge.ulTimestamp;
+		pxCh->bLastEdgeValid = true;
+
+		if( xEdge.ucLevel )
+		{
+			pxCh->ulPulseCount++;
+			if( pxCh->bLastRiseValid )
+			{
+				pxCh->ulPeriodSum += xEdge.ulTimestamp - pxCh->ulLastRise;
+				pxCh->ulPeriodCount++;
+			}
+			pxCh->ulLastRise = xEdge.ulTimestamp;
+			pxCh->bLastRiseValid = true;
+		}
+
+		pxCh->ucLevel = xEdge.ucLevel;
+	}
+}
+
+
+int32_t HALL_CAPTURE_lGetStat( HallCaptureChannel_t xChannel, HallCaptureStat_t *pxStat )
+{
+	const float fTicksToMs = 1000.0F / (float)HALL_CAPTURE_TIMEBASE_HZ;
+
+	if( ( xChannel >= HALL_CAPTURE_CHANNEL_MAX ) || ( !pxStat ) || ( !xChannels[xChannel].bInited ) )
+	{
+		return -1;
+	}
+
+	HallCaptureChannelCxt_t *pxCh = &xChannels[xChannel];
+
+	HALL_CAPTURE_vUpdate( xChannel );
+
+	/* Account the open interval up to now and restart the window from here */
+	uint32_t ulNow = HALL_CAPTURE_ulTimestamp();
+	if( pxCh->ucLevel )
+	{
+		pxCh->ulOnTicks += ulNow - pxCh->ulWindowRef;
+	}
+	else
+	{
+		pxCh->ulOffTicks += ulNow - pxCh->ulWindowRef;
+	}
+	pxCh->ulWindowRef = ulNow;
+
+	uint32_t ulWindow = pxCh->ulOnTicks + pxCh->ulOffTicks;
+
+	pxStat->ulPulseCount = pxCh->ulPulseCount;
+	pxStat->fDutyCycle = ( ulWindow > 0U ) ? ( (float)pxCh->ulOnTicks / (float)ulWindow ) : (float)pxCh->ucLevel;
+	pxStat->fFrequency = ( pxCh->ulPeriodCount > 0U ) ?
+			( (float)HALL_CAPTURE_TIMEBASE_HZ * (float)pxCh->ulPeriodCount / (float)pxCh->ulPeriodSum ) : 0.0F;
+	pxStat->fDwellOn = ( pxCh->ulDwellOnCount > 0U ) ?
+			( (float)pxCh->ulDwellOnSum * fTicksToMs / (float)pxCh->ulDwellOnCount ) : 0.0F;
+	pxStat->fDwellOff = ( pxCh->ulDwellOffCount > 0U ) ?
+			( (float)pxCh->ulDwellOffSum * fTicksToMs / (float)pxCh->ulDwellOffCount ) : 0.0F;
+
+	uint32_t ulOverrun = pxCh->ulOverrun;
+	pxStat->ulOverrun = ulOverrun - pxCh->ulOverrunSeen;
+	pxCh->ulOverrunSeen = ulOverrun;
+
+	pxCh->ulOnTicks = 0U;
+	pxCh->ulOffTicks = 0U;
+	pxCh->ulDwellOnSum = 0U;
+	pxCh->ulDwellOnCount = 0U;
+	pxCh->ulDwellOffSum = 0U;
+	pxCh->ulDwellOffCount = 0U;
+	pxCh->ulPeriodSum = 0U;
+	pxCh->ulPeriodCount = 0U;
+	pxCh->ulPulseCount = 0U;
+
+	return 0;
+}
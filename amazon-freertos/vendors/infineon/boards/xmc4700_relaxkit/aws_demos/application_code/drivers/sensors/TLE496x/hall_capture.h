@@ -0,0 +1,79 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#ifndef HALL_CAPTURE_H
+#define HALL_CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/* Free-running edge timebase: CCU43 slices 0 and 1 concatenated, fccu4 / 16 */
+#define HALL_CAPTURE_TIMEBASE_HZ        ( 9000000UL )
+/* Edges kept between two updates, the sensors task drains the ring on every read tick (power of two) */
+#define HALL_CAPTURE_RING_LEN           ( 64U )
+/* Priority of the ERU and POSIF edge interrupts, the handlers do not use the FreeRTOS API */
+#define HALL_CAPTURE_IRQ_PRIORITY       ( 62U )
+
+
+typedef enum {
+	HALL_CAPTURE_CHANNEL_TLE4964 = 0,   /* P14.6, POSIF0 IN1B -> Hall input edge -> IRQ, both edges */
+	HALL_CAPTURE_CHANNEL_TLE49613K,     /* P14.7, POSIF0 IN0B -> Hall input edge -> IRQ, both edges */
+	HALL_CAPTURE_CHANNEL_TLE4913,       /* P0.11, ERU0 ETL3 -> OGU3 -> IRQ, both edges */
+	HALL_CAPTURE_CHANNEL_TLE49611K,     /* P3.1,  ERU0 ETL0 -> OGU0 -> IRQ, both edges */
+
+	HALL_CAPTURE_CHANNEL_MAX
+
+} HallCaptureChannel_t;
+
+
+/* One logged edge. ucLevel is the field state after the edge: 1 - field present (Q low) */
+typedef struct {
+	uint32_t ulTimestamp;
+	uint8_t ucLevel;
+
+} HallCaptureEdge_t;
+
+
+/* Edge statistic over one measurement window */
+typedef struct {
+	float fFrequency;          /* Hz, from the mean period between field-on edges */
+	float fDutyCycle;          /* Fraction of the window with field present, 0..1 */
+	uint32_t ulPulseCount;     /* Field-on edges in the window */
+	float fDwellOn;            /* Mean field-on dwell time, ms */
+	float fDwellOff;           /* Mean field-off dwell time, ms */
+	uint32_t ulOverrun;        /* Edges lost because the ring was full */
+
+} HallCaptureStat_t;
+
+
+int32_t HALL_CAPTURE_lChannelInit( HallCaptureChannel_t xChannel, uint8_t ucLevel );
+void HALL_CAPTURE_vChannelDeInit( HallCaptureChannel_t xChannel );
+/* Drain the edge ring into the window accumulators */
+void HALL_CAPTURE_vUpdate( HallCaptureChannel_t xChannel );
+/* Close the window, return its statistic and start a new one */
+int32_t HALL_CAPTURE_lGetStat( HallCaptureChannel_t xChannel, HallCaptureStat_t *pxStat );
+uint32_t HALL_CAPTURE_ulTimestamp( void );
+
+
+#endif /* HALL_CAPTURE_H */
@@ -29,6 +29,7 @@
 #include "TLx4966/corelib/TLx4966.h"
 #include "TLE4964/corelib/hall_switch.h"
 #include "TLx4966/pal/TLx4966_pal_xmc.h"
+#include "hall_capture.h"
 
 #include "DAVE.h"
 
@@ -36,6 +37,16 @@
 static TLE496x_t xTLE496x[TLE496x_API_SENSOR_ID_MAX];
 
 
+/* Hall switch IDs ONE..FOUR map one-to-one onto the edge capture channels */
+static int32_t prvCaptureInit( HallSwitch_t *pxHall, TLE496xSensorNumber_t xSensorNumber )
+{
+	HALL_SWITCH_xBFieldUpdate( pxHall );
+	uint8_t ucLevel = ( HALL_SWITCH_xBFieldGet( pxHall ) == HALL_RESULT_B_FIELD_ON ) ? 1U : 0U;
+
+	return HALL_CAPTURE_lChannelInit( (HallCaptureChannel_t)xSensorNumber, ucLevel );
+}
+
+
 int32_t TLE496x_lInit( void **ppvHandle, TLE496xSensorNumber_t xSensorNumber )
 {
     int32_t lRetCode = 0;
@@ -80,6 +91,10 @@ int32_t TLE496x_lInit( void **ppvHandle, TLE496xSensorNumber_t xSensorNumber )
                 {
                 	lRetCode = -1;
                 }
+                else if( prvCaptureInit( pxHall, xSensorNumber ) < 0 )
+                {
+                	lRetCode = -1;
+                }
                 break;
             }
             case TLE496x_API_SENSOR_ID_TWO:
@@ -108,6 +123,10 @@ int32_t TLE496x_lInit( void **ppvHandle, TLE496xSensorNumber_t xSensorNumber )
                 {
                 	lRetCode = -1;
                 }
+                else if( prvCaptureInit( pxHall, xSensorNumber ) < 0 )
+                {
+                	lRetCode = -1;
+                }
                 break;
             }
             case TLE496x_API_SENSOR_ID_THREE:
@@ -136,6 +155,10 @@ int32_t TLE496x_lInit( void **ppvHandle, TLE496xSensorNumber_t xSensorNumber )
                 {
                 	lRetCode = -1;
                 }
+                else if( prvCaptureInit( pxHall, xSensorNumber ) < 0 )
+                {
+                	lRetCode = -1;
+                }
                 break;
             }
             case TLE496x_API_SENSOR_ID_FOUR:
@@ -164,6 +187,10 @@ int32_t TLE496x_lInit( void **ppvHandle, TLE496xSensorNumber_t xSensorNumber )
                 {
                 	lRetCode = -1;
                 }
+                else if( prvCaptureInit( pxHall, xSensorNumber ) < 0 )
+                {
+                	lRetCode = -1;
+                }
                 break;
             }
             case TLE496x_API_SENSOR_ID_FIVE:
@@ -201,6 +228,7 @@ int32_t TLE496x_lInit( void **ppvHandle, TLE496xSensorNumber_t xSensorNumber )
     if( lRetCode < 0)
     {
         vPortFree(*ppvHandle);
+        *ppvHandle = NULL;
     }
 
     return lRetCode;
@@ -235,8 +263,41 @@ int32_t TLE496x_lGetData( void *pvHandle, TLE496xData_t *pxSensorData )
 }
 
 
+/* Every read tick of the sensors task, also outside the statistic window: drains the edge ring of the switch */
+void TLE496x_vEdgePoll( void *pvHandle )
+{
+    TLE496x_t *pxTle = pvHandle;
+
+    if( ( !pxTle ) || ( pxTle->xSensorNumber > TLE496x_API_SENSOR_ID_FOUR ) )
+    {
+    	return;
+    }
+
+    HALL_CAPTURE_vUpdate( (HallCaptureChannel_t)pxTle->xSensorNumber );
+}
+
+
+int32_t TLE496x_lGetEdgeData( void *pvHandle, HallCaptureStat_t *pxEdgeData )
+{
+    TLE496x_t *pxTle = pvHandle;
+
+    if( ( !pxTle ) || ( pxTle->xSensorNumber > TLE496x_API_SENSOR_ID_FOUR ) )
+    {
+    	return -1;
+    }
+
+    return HALL_CAPTURE_lGetStat( (HallCaptureChannel_t)pxTle->xSensorNumber, pxEdgeData );
+}
+
+
 void TLE496x_vDeInit( void **ppvHandle )
 {
+    TLE496x_t *pxTle = *ppvHandle;
+
+    if( pxTle && ( pxTle->xSensorNumber <= TLE496x_API_SENSOR_ID_FOUR ) )
+    {
+    	HALL_CAPTURE_vChannelDeInit( (HallCaptureChannel_t)pxTle->xSensorNumber );
+    }
 	vPortFree( *ppvHandle );
 }
 
@@ -28,6 +28,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "hall_capture.h"
+
 typedef enum {
     TLE496x_API_SENSOR_ID_ONE = 0,      /* TLE4964    High precision Unipolar Hall Effect Latch */
     TLE496x_API_SENSOR_ID_TWO,          /* TLE4961-3K High precision Bipolar Hall Effect Latch */
@@ -58,6 +60,10 @@ typedef struct {
 
 int32_t TLE496x_lInit( void **ppvHandle, TLE496xSensorNumber_t xSensorNumber );
 int32_t TLE496x_lGetData( void *pvHandle, TLE496xData_t *pxSensorData );
+/* Edge ring drain of a Hall switch, on every read tick */
+void TLE496x_vEdgePoll( void *pvHandle );
+/* Edge statistic of the window since the previous call, Hall switches ID_ONE..ID_FOUR only */
+int32_t TLE496x_lGetEdgeData( void *pvHandle, HallCaptureStat_t *pxEdgeData );
 void TLE496x_vDeInit( void **ppvHandle );
 void TLE496x_vReset( void *pvHandle );
 
@@ -35,7 +35,10 @@
 #include "TLE4997/tle4997_api.h"
 
 #include "statistic.h"
+#include "diff_pressure.h"
+#include "classifier.h"
 #include "aws_nbiot.h"
+#include "dbg.h"
 
 /* Parameter HEADERS for printing to log */
 static const char * pcFeatures[PARAMETERS_NUMBER] = {
@@ -133,10 +136,204 @@ static const char * pcFeatures[PARAMETERS_NUMBER] = {
 
 static SensorContext_t xSensor[SENSORS_NUMBER];
 
+/* Sampling and reporting of each sensor, see sensors_config.h, the shadow settings change them at runtime */
+static SensorRate_t xSensorRate[SENSORS_NUMBER] = {
+
+/* Temperature and Pressure sensors */
+
+#if( SENSOR_DPS368_1_ENABLE > 0 )
+	{ SENSOR_DPS368_SAMPLE_MS, SENSOR_DPS368_WINDOW, SENSOR_DPS368_SEND_MS },
+#endif
+
+#if( SENSOR_DPS368_2_ENABLE > 0 )
+	{ SENSOR_DPS368_SAMPLE_MS, SENSOR_DPS368_WINDOW, SENSOR_DPS368_SEND_MS },
+#endif
+
+#if( SENSOR_DPS368_3_ENABLE > 0 )
+	{ SENSOR_DPS368_SAMPLE_MS, SENSOR_DPS368_WINDOW, SENSOR_DPS368_SEND_MS },
+#endif
+
+#if( SENSOR_DPS368_4_ENABLE > 0 )
+	{ SENSOR_DPS368_SAMPLE_MS, SENSOR_DPS368_WINDOW, SENSOR_DPS368_SEND_MS },
+#endif
+
+#if( SENSOR_DPS368_5_ENABLE > 0 )
+	{ SENSOR_DPS368_SAMPLE_MS, SENSOR_DPS368_WINDOW, SENSOR_DPS368_SEND_MS },
+#endif
+
+/* Magnetic Current sensors */
+
+#if( SENSOR_TLI4971_1_ENABLE > 0 )
+	{ SENSOR_TLI4971_SAMPLE_MS, SENSOR_TLI4971_WINDOW, SENSOR_TLI4971_SEND_MS },
+#endif
+
+#if( SENSOR_TLI4971_2_ENABLE > 0 )
+	{ SENSOR_TLI4971_SAMPLE_MS, SENSOR_TLI4971_WINDOW, SENSOR_TLI4971_SEND_MS },
+#endif
+
+#if( SENSOR_TLI4971_3_ENABLE > 0 )
+	{ SENSOR_TLI4971_SAMPLE_MS, SENSOR_TLI4971_WINDOW, SENSOR_TLI4971_SEND_MS },
+#endif
+
+/* Linear Hall sensors */
+
+#if( SENSOR_TLE4997_1_ENABLE > 0 )
+	{ SENSOR_TLE4997_SAMPLE_MS, SENSOR_TLE4997_WINDOW, SENSOR_TLE4997_SEND_MS },
+#endif
+
+#if( SENSOR_TLE4997_2_ENABLE > 0 )
+	{ SENSOR_TLE4997_SAMPLE_MS, SENSOR_TLE4997_WINDOW, SENSOR_TLE4997_SEND_MS },
+#endif
+
+/* Hall sensors */
+
+#if( SENSOR_TLE4964_1_ENABLE > 0 )
+	{ SENSOR_TLE496X_SAMPLE_MS, SENSOR_TLE496X_WINDOW, SENSOR_TLE496X_SEND_MS },
+#endif
+
+#if( SENSOR_TLE4961_3K_1_ENABLE > 0 )
+	{ SENSOR_TLE496X_SAMPLE_MS, SENSOR_TLE496X_WINDOW, SENSOR_TLE496X_SEND_MS },
+#endif
+
+#if( SENSOR_TLE4913_1_ENABLE > 0 )
+	{ SENSOR_TLE496X_SAMPLE_MS, SENSOR_TLE496X_WINDOW, SENSOR_TLE496X_SEND_MS },
+#endif
+
+#if( SENSOR_TLE4961_1K_1_ENABLE > 0 )
+	{ SENSOR_TLE496X_SAMPLE_MS, SENSOR_TLE496X_WINDOW, SENSOR_TLE496X_SEND_MS },
+#endif
+
+#if( SENSOR_TLI4966_1_ENABLE > 0 )
+	{ SENSOR_TLI4966_SAMPLE_MS, SENSOR_TLI4966_WINDOW, SENSOR_TLI4966_SEND_MS },
+#endif
+
+/* Microphone */
+
+#if( SENSOR_IM69D130_ENABLE > 0 )
+	{ 0, SENSOR_IM69D130_WINDOW, SENSOR_IM69D130_SEND_MS },
+#endif
+
+/* 3D Magnetic sensors */
+
+#if( SENSOR_TLI493D_1_ENABLE > 0 )
+	{ SENSOR_TLI493D_SAMPLE_MS, SENSOR_TLI493D_WINDOW, SENSOR_TLI493D_SEND_MS },
+#endif
+
+};
+
+STATIC_ASSERT( SENSOR_DPS368_WINDOW <= SENSORS_VECTOR_LEN, dps368_window_exceeds_vector );
+STATIC_ASSERT( SENSOR_TLI4971_WINDOW <= SENSORS_VECTOR_LEN, tli4971_window_exceeds_vector );
+STATIC_ASSERT( SENSOR_TLE4997_WINDOW <= SENSORS_VECTOR_LEN, tle4997_window_exceeds_vector );
+STATIC_ASSERT( SENSOR_TLE496X_WINDOW <= SENSORS_VECTOR_LEN, tle496x_window_exceeds_vector );
+STATIC_ASSERT( SENSOR_TLI4966_WINDOW <= SENSORS_VECTOR_LEN, tli4966_window_exceeds_vector );
+STATIC_ASSERT( SENSOR_IM69D130_WINDOW <= SENSORS_VECTOR_LEN, im69d130_window_exceeds_vector );
+STATIC_ASSERT( SENSOR_TLI493D_WINDOW <= SENSORS_VECTOR_LEN, tli493d_window_exceeds_vector );
+STATIC_ASSERT( SETTINGS_WINDOW_MAX <= SENSORS_VECTOR_LEN, settings_window_exceeds_vector );
+
+/* Rows of message_schema.h built in, they take the positions of SENSORS_POSITION_IN_VECTOR in order */
+#define SENSORS_ROW_BUILT( sensor )		( SENSOR_##sensor##_ENABLE > 0 ),
+
+static const bool pbSensorBuilt[MSG_SENSOR_MAX] = { MSG_SENSORS( SENSORS_ROW_BUILT ) };
+
+/* Linked rows are bits of a word in the settings */
+STATIC_ASSERT( MSG_SENSOR_MAX <= 32, msg_sensors_exceed_link_bits );
+
+/* Sensor row of each parameter row, parameters of a sensor built in take the positions of SENSORS_VECTOR in order */
+#define SENSORS_PARAMETER_ROW( id, name, sensor, ... )		MSG_SENSOR_##sensor,
+
+static const uint8_t pucParameterSensor[MSG_PARAMETER_MAX] = { MSG_PARAMETERS( SENSORS_PARAMETER_ROW ) };
+
+/* Current statistic window of each sensor */
+typedef struct {
+	uint32_t ulStart;			/* Tick the window was opened */
+	uint32_t ulLastSample;		/* Tick of the last read */
+	uint32_t ulSamples;			/* Samples stored in the vector */
+	bool bClosed;				/* Send period passed, waiting for statistic and restart */
+} SensorWindow_t;
+
+static SensorWindow_t xWindow[SENSORS_NUMBER];
+static bool bWindowsStarted = false;
+
+/* Sensor of the captured parameter, read at its sample period in and out of its window */
+static uint8_t ucCaptureSensor = SENSORS_NUMBER;
+static uint32_t ulCaptureLast = 0;			/* Tick of the last read */
+static uint32_t ulCapturePos = 0;			/* Vector position of the last read */
+static uint8_t ucCaptureErrors = 0;			/* Error count before the read */
+static bool bCaptureRead = false;			/* Read in this vSensorsRead */
+static bool bCaptureSpare = false;			/* That read is past the window */
+static bool bCaptureNew = false;			/* Good read not taken yet */
+
+#if( ( SENSOR_DPS368_PAIR_1_ENABLE > 0 ) || ( SENSOR_DPS368_PAIR_2_ENABLE > 0 ) )
+
+/* Differential pressure pair, see sensors_config.h */
+typedef struct {
+	uint8_t ucUpstream;			/* DPS368 number 1..5 */
+	uint8_t ucDownstream;		/* DPS368 number 1..5 */
+	float fFlowK;				/* Discharge coefficient * flow area, m^2 */
+} SensorPair_t;
+
+static const SensorPair_t xSensorPair[SENSORS_PAIR_NUMBER] = {
+
+#if( SENSOR_DPS368_PAIR_1_ENABLE > 0 )
+	{ SENSOR_DPS368_PAIR_1_UPSTREAM, SENSOR_DPS368_PAIR_1_DOWNSTREAM, SENSOR_DPS368_PAIR_1_FLOW_K },
+#endif
+
+#if( SENSOR_DPS368_PAIR_2_ENABLE > 0 )
+	{ SENSOR_DPS368_PAIR_2_UPSTREAM, SENSOR_DPS368_PAIR_2_DOWNSTREAM, SENSOR_DPS368_PAIR_2_FLOW_K },
+#endif
+
+};
+
+STATIC_ASSERT( SENSOR_DPS368_TREND_POINTS <= DIFFP_TREND_POINTS_MAX, dps368_trend_points_exceed_max );
+
+static DiffPressureTrend_t xPairTrend[SENSORS_PAIR_NUMBER];
+static float fPairDecimationSum[SENSORS_PAIR_NUMBER];
+static uint32_t ulPairDecimationCount[SENSORS_PAIR_NUMBER];
+static uint32_t ulPairSendMs[SENSORS_PAIR_NUMBER];		/* Window length the trend points were taken with */
+static bool bPairTrendInited = false;
+
+#endif
+
+#if( SENSORS_CORRELATION_ENABLE > 0 )
+
+/* Parameter in the correlation matrix, see sensors_config.h */
+typedef struct {
+	uint8_t ucSensor;
+	uint8_t ucParameter;
+} CorrelationChannel_t;
+
+static const CorrelationChannel_t xCorrChannel[] = SENSORS_CORRELATION_CHANNELS;
+static const uint8_t ucCorrLagPair[][2] = SENSORS_CORRELATION_LAG_PAIRS;
+
+#define CORR_CHANNELS_NUMBER		( sizeof( xCorrChannel ) / sizeof( xCorrChannel[0] ) )
+#define CORR_LAG_PAIRS_NUMBER		( sizeof( ucCorrLagPair ) / sizeof( ucCorrLagPair[0] ) )
+
+STATIC_ASSERT( CORR_CHANNELS_NUMBER <= CORR_CHANNELS_MAX, correlation_channels_exceed_max );
+STATIC_ASSERT( CORR_LAG_PAIRS_NUMBER <= CORR_LAG_PAIRS_MAX, correlation_lag_pairs_exceed_max );
+STATIC_ASSERT( SENSORS_VECTOR_LEN <= CORR_VECTOR_LEN_MAX, correlation_vector_exceeds_max );
+
+#endif
+
+#if( SENSORS_CLASSIFIER_ENABLE > 0 )
+
+#define CLASSIFIER_FEATURES_NUMBER	( 2 * PARAMETERS_NUMBER + SENSORS_CLASSIFIER_SPECTRAL_BANDS )
+#define CLASSIFIER_BAND_BINS		( ( SENSORS_VECTOR_LEN / 2 ) / SENSORS_CLASSIFIER_SPECTRAL_BANDS )
+
+STATIC_ASSERT( CLASSIFIER_FEATURES_NUMBER <= CLASSIFIER_INPUTS_MAX, classifier_features_exceed_max );
+STATIC_ASSERT( ( SENSORS_VECTOR_LEN / 2 ) % SENSORS_CLASSIFIER_SPECTRAL_BANDS == 0, classifier_bands_not_aligned );
+
+static float pfClassifierFeatures[CLASSIFIER_FEATURES_NUMBER];
+static bool bClassifierInited = false;
+static bool bClassifierMismatchShown = false;
+
+#endif
+
 /* Global error number of initialize or read sensors operations in sensors.c file
  * When power turned on, is equal to the number of sensors ( NOT NUMBER OF SENSORS PARAMETERS! )
  */
 static uint8_t ucErrorNumber;
+/* Failed reads since the start, for the metrics */
+static volatile uint32_t ulReadErrors = 0;
 
 void vBoardOn( void )
 {
@@ -527,20 +724,146 @@ void vSensorsInit( void )
 
 
 /* Read non-background sensors, using tick count */
+/* True if the sensor has to be read now, returns its position in the window vector */
+static bool prvSensorSampleDue( uint8_t ucSensor, uint32_t ulTicks, uint32_t *pulPos )
+{
+	SensorWindow_t *pxWindow = &xWindow[ucSensor];
+
+	if( !bWindowsStarted )
+	{
+		return false;
+	}
+
+	if( pxWindow->bClosed || ( pxWindow->ulSamples >= xSensorRate[ucSensor].ulWindowLen ) )
+	{
+		/* The captured sensor is read on, the read goes to the spare position and not in the statistic */
+		if( ( ucSensor != ucCaptureSensor ) || ( ( ulTicks - ulCaptureLast ) < pdMS_TO_TICKS( xSensorRate[ucSensor].ulSampleMs ) ) )
+		{
+			return false;
+		}
+		*pulPos = SENSORS_VECTOR_SPARE;
+	}
+	else
+	{
+		if( ( pxWindow->ulSamples > 0 ) && ( ( ulTicks - pxWindow->ulLastSample ) < pdMS_TO_TICKS( xSensorRate[ucSensor].ulSampleMs ) ) )
+		{
+			return false;
+		}
+
+		pxWindow->ulLastSample = ulTicks;
+		*pulPos = pxWindow->ulSamples++;
+	}
+
+	if( ucSensor == ucCaptureSensor )
+	{
+		ulCaptureLast = ulTicks;
+		ulCapturePos = *pulPos;
+		ucCaptureErrors = xSensor[ucSensor].ucErrorCount;
+		bCaptureSpare = ( *pulPos == SENSORS_VECTOR_SPARE );
+		bCaptureRead = true;
+	}
+
+	return true;
+}
+
+
+/* A failed read of the captured sensor gives no sample, past the window it doesn't count against the sensor either */
+static void prvCaptureReadCheck( void )
+{
+	if( !bCaptureRead )
+	{
+		return;
+	}
+	bCaptureRead = false;
+
+	if( xSensor[ucCaptureSensor].ucErrorCount == ucCaptureErrors )
+	{
+		bCaptureNew = true;
+	}
+	else if( bCaptureSpare )
+	{
+		xSensor[ucCaptureSensor].ucErrorCount = ucCaptureErrors;
+	}
+}
+
+
+/* Statistic of the sensor is calculated and sent only when its window is closed */
+static bool prvSensorWindowReady( uint8_t ucSensor )
+{
+	return xSensor[ucSensor].bOn && xWindow[ucSensor].bClosed && ( xWindow[ucSensor].ulSamples > 0 );
+}
+
+
+bool bSensorsWindowClose( uint32_t ulTicks )
+{
+	bool bRet = false;
+
+	/* The first call opens all windows */
+	if( !bWindowsStarted )
+	{
+		for( uint8_t i = 0; i < SENSORS_NUMBER; i++ )
+		{
+			memset( &xWindow[i], 0, sizeof( SensorWindow_t ) );
+			xWindow[i].ulStart = ulTicks;
+		}
+		bWindowsStarted = true;
+
+		return false;
+	}
+
+	for( uint8_t i = 0; i < SENSORS_NUMBER; i++ )
+	{
+		if( ( !xWindow[i].bClosed ) && ( ( ulTicks - xWindow[i].ulStart ) >= pdMS_TO_TICKS( xSensorRate[i].ulSendMs ) ) )
+		{
+			xWindow[i].bClosed = true;
+			bRet = true;
+		}
+	}
+
+	return bRet;
+}
+
+
+void vSensorsWindowRestart( uint32_t ulTicks )
+{
+	for( uint8_t i = 0; i < SENSORS_NUMBER; i++ )
+	{
+		if( xWindow[i].bClosed )
+		{
+			memset( &xWindow[i], 0, sizeof( SensorWindow_t ) );
+			xWindow[i].ulStart = ulTicks;
+		}
+	}
+}
+
+
+#if( ( SENSOR_TLE4964_1_ENABLE > 0 ) || ( SENSOR_TLE4961_3K_1_ENABLE > 0 ) || ( SENSOR_TLE4913_1_ENABLE > 0 ) || ( SENSOR_TLE4961_1K_1_ENABLE > 0 ) )
+/* Edges of a Hall switch over the whole send period, not only while its statistic window fills */
+static void prvSensorsEdgePoll( uint8_t ucSensor )
+{
+    if( xSensor[ucSensor].bInited && xSensor[ucSensor].bOn )
+    {
+    	TLE496x_vEdgePoll( xSensor[ucSensor].pvCxt );
+    }
+}
+#endif
+
+
 void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
 {
+	uint32_t ulPos = 0;
 
 /* Read DPS368 Temperature and Pressure */
 
 #if( SENSOR_DPS368_1_ENABLE > 0 )
 
-    if( xSensor[DPS368_1].bInited && xSensor[DPS368_1].bOn )
+    if( xSensor[DPS368_1].bInited && xSensor[DPS368_1].bOn && prvSensorSampleDue( DPS368_1, ulTicks, &ulPos ) )
     {
     	DPS368Data_t xData;
         if( DPS368_lGetData( xSensor[DPS368_1].pvCxt, &xData ) == 0 )
         {
-			pxSensorsData->fSensorsVector.vector[DPS368_TEMP_1][ulTicks] = xData.fTemperature;
-			pxSensorsData->fSensorsVector.vector[DPS368_PRESS_1][ulTicks] = xData.fPressure;
+			pxSensorsData->fSensorsVector.vector[DPS368_TEMP_1][ulPos] = xData.fTemperature;
+			pxSensorsData->fSensorsVector.vector[DPS368_PRESS_1][ulPos] = xData.fPressure;
 #if( SENSOR_DPS368_1_ENABLE > 1 )
 			configPRINTF( ("DPS368-1 Temp: %.2f, Press: %.2f\r\n", xData.fTemperature, xData.fPressure) );
 #endif
@@ -556,13 +879,13 @@ void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
 
 #if( SENSOR_DPS368_2_ENABLE > 0 )
 
-    if( xSensor[DPS368_2].bInited && xSensor[DPS368_2].bOn )
+    if( xSensor[DPS368_2].bInited && xSensor[DPS368_2].bOn && prvSensorSampleDue( DPS368_2, ulTicks, &ulPos ) )
     {
     	DPS368Data_t xData;
         if( DPS368_lGetData( xSensor[DPS368_2].pvCxt, &xData ) == 0 )
         {
-        	pxSensorsData->fSensorsVector.vector[DPS368_TEMP_2][ulTicks] = xData.fTemperature;
-        	pxSensorsData->fSensorsVector.vector[DPS368_PRESS_2][ulTicks] = xData.fPressure;
+        	pxSensorsData->fSensorsVector.vector[DPS368_TEMP_2][ulPos] = xData.fTemperature;
+        	pxSensorsData->fSensorsVector.vector[DPS368_PRESS_2][ulPos] = xData.fPressure;
 #if( SENSOR_DPS368_2_ENABLE > 1 )
         	configPRINTF( ("DPS368-2 Temp: %.2f, Press: %.2f\r\n", xData.fTemperature, xData.fPressure) );
 #endif
@@ -578,13 +901,13 @@ void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
 
 #if( SENSOR_DPS368_3_ENABLE > 0 )
 
-    if( xSensor[DPS368_3].bInited && xSensor[DPS368_3].bOn )
+    if( xSensor[DPS368_3].bInited && xSensor[DPS368_3].bOn && prvSensorSampleDue( DPS368_3, ulTicks, &ulPos ) )
     {
     	DPS368Data_t xData;
         if( DPS368_lGetData( xSensor[DPS368_3].pvCxt, &xData ) == 0 )
         {
-        	pxSensorsData->fSensorsVector.vector[DPS368_TEMP_3][ulTicks] = xData.fTemperature;
-        	pxSensorsData->fSensorsVector.vector[DPS368_PRESS_3][ulTicks] = xData.fPressure;
+        	pxSensorsData->fSensorsVector.vector[DPS368_TEMP_3][ulPos] = xData.fTemperature;
+        	pxSensorsData->fSensorsVector.vector[DPS368_PRESS_3][ulPos] = xData.fPressure;
 #if( SENSOR_DPS368_3_ENABLE > 1 )
         	configPRINTF( ("DPS368-3 Temp: %.2f, Press: %.2f\r\n", xData.fTemperature, xData.fPressure) );
 #endif
@@ -600,13 +923,13 @@ void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
 
 #if( SENSOR_DPS368_4_ENABLE > 0 )
 
-    if( xSensor[DPS368_4].bInited && xSensor[DPS368_4].bOn )
+    if( xSensor[DPS368_4].bInited && xSensor[DPS368_4].bOn && prvSensorSampleDue( DPS368_4, ulTicks, &ulPos ) )
     {
     	DPS368Data_t xData;
         if( DPS368_lGetData( xSensor[DPS368_4].pvCxt, &xData ) == 0 )
         {
-            pxSensorsData->fSensorsVector.vector[DPS368_TEMP_4][ulTicks] = xData.fTemperature;
-            pxSensorsData->fSensorsVector.vector[DPS368_PRESS_4][ulTicks] = xData.fPressure;
+            pxSensorsData->fSensorsVector.vector[DPS368_TEMP_4][ulPos] = xData.fTemperature;
+            pxSensorsData->fSensorsVector.vector[DPS368_PRESS_4][ulPos] = xData.fPressure;
 #if( SENSOR_DPS368_4_ENABLE > 1 )
             configPRINTF( ("DPS368-4 Temp: %.2f, Press: %.2f\r\n", xData.fTemperature, xData.fPressure) );
 #endif
@@ -622,13 +945,13 @@ void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
 
 #if( SENSOR_DPS368_5_ENABLE > 0 )
 
-    if( xSensor[DPS368_5].bInited && xSensor[DPS368_5].bOn )
+    if( xSensor[DPS368_5].bInited && xSensor[DPS368_5].bOn && prvSensorSampleDue( DPS368_5, ulTicks, &ulPos ) )
     {
         DPS368Data_t xData;
         if( DPS368_lGetData( xSensor[DPS368_5].pvCxt, &xData ) == 0 )
         {
-            pxSensorsData->fSensorsVector.vector[DPS368_TEMP_5][ulTicks] = xData.fTemperature;
-            pxSensorsData->fSensorsVector.vector[DPS368_PRESS_5][ulTicks] = xData.fPressure;
+            pxSensorsData->fSensorsVector.vector[DPS368_TEMP_5][ulPos] = xData.fTemperature;
+            pxSensorsData->fSensorsVector.vector[DPS368_PRESS_5][ulPos] = xData.fPressure;
 #if( SENSOR_DPS368_5_ENABLE > 1 )
             configPRINTF( ("DPS368-5 Temp: %.2f, Press: %.2f\r\n", xData.fTemperature, xData.fPressure) );
 #endif
@@ -646,12 +969,12 @@ void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
 
 #if( SENSOR_TLI4971_1_ENABLE > 0 )
 
-	if( xSensor[TLI4971_1].bInited && xSensor[TLI4971_1].bOn )
+	if( xSensor[TLI4971_1].bInited && xSensor[TLI4971_1].bOn && prvSensorSampleDue( TLI4971_1, ulTicks, &ulPos ) )
 	{
 		TLI4971Data_t xData;
 		if( TLI4971_lGetData( xSensor[TLI4971_1].pvCxt, &xData ) == 0 )
 		{
-			pxSensorsData->fSensorsVector.vector[TLI4971_CURRENT_1][ulTicks] = xData.fCurrent;
+			pxSensorsData->fSensorsVector.vector[TLI4971_CURRENT_1][ulPos] = xData.fCurrent;
 #if( SENSOR_TLI4971_1_ENABLE > 1 )
 			configPRINTF( ("TLI4971-1: %.4f\r\n", xData.fCurrent) );
 #endif
@@ -666,12 +989,12 @@ void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
 
 #if( SENSOR_TLI4971_2_ENABLE > 0 )
 
-	if( xSensor[TLI4971_2].bInited && xSensor[TLI4971_2].bOn )
+	if( xSensor[TLI4971_2].bInited && xSensor[TLI4971_2].bOn && prvSensorSampleDue( TLI4971_2, ulTicks, &ulPos ) )
 	{
 		TLI4971Data_t xData;
 		if( TLI4971_lGetData( xSensor[TLI4971_2].pvCxt, &xData ) == 0 )
 		{
-			pxSensorsData->fSensorsVector.vector[TLI4971_CURRENT_2][ulTicks] = xData.fCurrent;
+			pxSensorsData->fSensorsVector.vector[TLI4971_CURRENT_2][ulPos] = xData.fCurrent;
 #if( SENSOR_TLI4971_2_ENABLE > 1 )
 			configPRINTF( ("TLI4971-2: %.4f\r\n", xData.fCurrent) );
 #endif
@@ -686,12 +1009,12 @@ void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
 
 #if( SENSOR_TLI4971_3_ENABLE > 0 )
 
-	if( xSensor[TLI4971_3].bInited && xSensor[TLI4971_3].bOn )
+	if( xSensor[TLI4971_3].bInited && xSensor[TLI4971_3].bOn && prvSensorSampleDue( TLI4971_3, ulTicks, &ulPos ) )
 	{
 		TLI4971Data_t xData;
 		if( TLI4971_lGetData( xSensor[TLI4971_3].pvCxt, &xData ) == 0 )
 		{
-			pxSensorsData->fSensorsVector.vector[TLI4971_CURRENT_3][ulTicks] = xData.fCurrent;
+			pxSensorsData->fSensorsVector.vector[TLI4971_CURRENT_3][ulPos] = xData.fCurrent;
 #if( SENSOR_TLI4971_3_ENABLE > 1 )
 			configPRINTF( ("TLI4971-3: %.4f\r\n", xData.fCurrent) );
 #endif
@@ -708,12 +1031,12 @@ void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
 
 #if( SENSOR_TLE4997_1_ENABLE > 0 )
 
-	if( xSensor[TLE4997_1].bInited && xSensor[TLE4997_1].bOn )
+	if( xSensor[TLE4997_1].bInited && xSensor[TLE4997_1].bOn && prvSensorSampleDue( TLE4997_1, ulTicks, &ulPos ) )
 	{
 		TLE4997Data_t xData;
 		if( TLE4997_lGetData( xSensor[TLE4997_1].pvCxt, &xData ) == 0 )
 		{
-			pxSensorsData->fSensorsVector.vector[TLE4997_LINEAR_HALL_1][ulTicks] = xData.fHallRatiometry;
+			pxSensorsData->fSensorsVector.vector[TLE4997_LINEAR_HALL_1][ulPos] = xData.fHallRatiometry;
 #if( SENSOR_TLE4997_1_ENABLE > 1 )
 			configPRINTF( ("TLE4997-1: %.2f\r\n", xData.fHallRatiometry) );
 #endif
@@ -728,12 +1051,12 @@ void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
 
 #if( SENSOR_TLE4997_2_ENABLE > 0 )
 
-	if( xSensor[TLE4997_2].bInited && xSensor[TLE4997_2].bOn )
+	if( xSensor[TLE4997_2].bInited && xSensor[TLE4997_2].bOn && prvSensorSampleDue( TLE4997_2, ulTicks, &ulPos ) )
 	{
 		TLE4997Data_t xData;
 		if( TLE4997_lGetData( xSensor[TLE4997_2].pvCxt, &xData ) == 0 )
 		{
-			pxSensorsData->fSensorsVector.vector[TLE4997_LINEAR_HALL_2][ulTicks] = xData.fHallRatiometry;
+			pxSensorsData->fSensorsVector.vector[TLE4997_LINEAR_HALL_2][ulPos] = xData.fHallRatiometry;
 #if( SENSOR_TLE4997_2_ENABLE > 1 )
 			configPRINTF( ("TLE4997-2: %.2f\r\n", xData.fHallRatiometry) );
 #endif
@@ -749,13 +1072,26 @@ void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
 /* Read TLx49xx Hall */
 
 #if( SENSOR_TLE4964_1_ENABLE > 0 )
+    prvSensorsEdgePoll( TLE4964_1 );
+#endif
+#if( SENSOR_TLE4961_3K_1_ENABLE > 0 )
+    prvSensorsEdgePoll( TLE49613K_1 );
+#endif
+#if( SENSOR_TLE4913_1_ENABLE > 0 )
+    prvSensorsEdgePoll( TLE4913_1 );
+#endif
+#if( SENSOR_TLE4961_1K_1_ENABLE > 0 )
+    prvSensorsEdgePoll( TLE49611K_1 );
+#endif
 
-    if( xSensor[TLE4964_1].bInited && xSensor[TLE4964_1].bOn )
+#if( SENSOR_TLE4964_1_ENABLE > 0 )
+
+    if( xSensor[TLE4964_1].bInited && xSensor[TLE4964_1].bOn && prvSensorSampleDue( TLE4964_1, ulTicks, &ulPos ) )
     {
     	TLE496xData_t xData;
         if( TLE496x_lGetData( xSensor[TLE4964_1].pvCxt, &xData ) == 0 )
         {
-            pxSensorsData->fSensorsVector.vector[TLE4964_HALL_SWITCH_1][ulTicks] = (float)xData.lMagneticFieldValue;
+            pxSensorsData->fSensorsVector.vector[TLE4964_HALL_SWITCH_1][ulPos] = (float)xData.lMagneticFieldValue;
 #if( SENSOR_TLE4964_1_ENABLE > 1 )
             configPRINTF( ("TLE4964-1: %.0f\r\n", (float)xData.lMagneticFieldValue) );
 #endif
@@ -770,12 +1106,12 @@ void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
 
 #if( SENSOR_TLE4961_3K_1_ENABLE > 0 )
 
-    if( xSensor[TLE49613K_1].bInited && xSensor[TLE49613K_1].bOn )
+    if( xSensor[TLE49613K_1].bInited && xSensor[TLE49613K_1].bOn && prvSensorSampleDue( TLE49613K_1, ulTicks, &ulPos ) )
     {
     	TLE496xData_t xData;
         if( TLE496x_lGetData( xSensor[TLE49613K_1].pvCxt, &xData ) == 0 )
         {
-            pxSensorsData->fSensorsVector.vector[TLE49613K_HALL_LATCH_1][ulTicks] = (float)xData.lMagneticFieldValue;
+            pxSensorsData->fSensorsVector.vector[TLE49613K_HALL_LATCH_1][ulPos] = (float)xData.lMagneticFieldValue;
 #if( SENSOR_TLE4961_3K_1_ENABLE > 1 )
             configPRINTF( ("TLE4961-3K-1: %.0f\r\n", (float)xData.lMagneticFieldValue) );
 #endif
@@ -790,12 +1126,12 @@ void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
 
 #if( SENSOR_TLE4913_1_ENABLE > 0 )
 
-    if( xSensor[TLE4913_1].bInited && xSensor[TLE4913_1].bOn )
+    if( xSensor[TLE4913_1].bInited && xSensor[TLE4913_1].bOn && prvSensorSampleDue( TLE4913_1, ulTicks, &ulPos ) )
     {
     	TLE496xData_t xData;
         if( TLE496x_lGetData( xSensor[TLE4913_1].pvCxt, &xData ) == 0 )
         {
-            pxSensorsData->fSensorsVector.vector[TLE4913_HALL_SWITCH_1][ulTicks] = (float)xData.lMagneticFieldValue;
+            pxSensorsData->fSensorsVector.vector[TLE4913_HALL_SWITCH_1][ulPos] = (float)xData.lMagneticFieldValue;
 #if( SENSOR_TLE4913_1_ENABLE > 1 )
             configPRINTF( ("TLE4913-1: %.0f\r\n", (float)xData.lMagneticFieldValue) );
 #endif
@@ -810,12 +1146,12 @@ void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
 
 #if( SENSOR_TLE4961_1K_1_ENABLE > 0 )
 
-    if( xSensor[TLE49611K_1].bInited && xSensor[TLE49611K_1].bOn )
+    if( xSensor[TLE49611K_1].bInited && xSensor[TLE49611K_1].bOn && prvSensorSampleDue( TLE49611K_1, ulTicks, &ulPos ) )
     {
     	TLE496xData_t xData;
         if( TLE496x_lGetData( xSensor[TLE49611K_1].pvCxt, &xData ) == 0 )
         {
-            pxSensorsData->fSensorsVector.vector[TLE49611K_HALL_LATCH_1][ulTicks] = (float)xData.lMagneticFieldValue;
+            pxSensorsData->fSensorsVector.vector[TLE49611K_HALL_LATCH_1][ulPos] = (float)xData.lMagneticFieldValue;
 #if( SENSOR_TLE4961_1K_1_ENABLE > 1 )
             configPRINTF( ("TLE49611K-1: %.0f\r\n", (float)xData.lMagneticFieldValue) );
 #endif
@@ -830,32 +1166,20 @@ void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
 
 #if( SENSOR_TLI4966_1_ENABLE > 0 )
 
-    if( xSensor[TLI4966G_1].bInited && xSensor[TLI4966G_1].bOn )
+    if( xSensor[TLI4966G_1].bInited && xSensor[TLI4966G_1].bOn && prvSensorSampleDue( TLI4966G_1, ulTicks, &ulPos ) )
     {
-        static TLE496xData_t xData;
-        static int32_t lRet = -1;
-
-        /* update values once in ~1second */
-        if( ulTicks == 0 || lRet != 0 )
+        TLE496xData_t xData;
+        if( TLE496x_lGetData( xSensor[TLI4966G_1].pvCxt, &xData ) == 0 )
         {
-        	lRet = TLE496x_lGetData( xSensor[TLI4966G_1].pvCxt, &xData );
-            if( lRet == 0 )
-            {
-                pxSensorsData->fSensorsVector.vector[TLI4966G_DOUBLE_HALL_SPEED_1][ulTicks] = (float)xData.fSpeed;
-                pxSensorsData->fSensorsVector.vector[TLI4966G_DOUBLE_HALL_DIR_1][ulTicks] = (float)xData.lDirection;
+            pxSensorsData->fSensorsVector.vector[TLI4966G_DOUBLE_HALL_SPEED_1][ulPos] = (float)xData.fSpeed;
+            pxSensorsData->fSensorsVector.vector[TLI4966G_DOUBLE_HALL_DIR_1][ulPos] = (float)xData.lDirection;
 #if( SENSOR_TLI4966_1_ENABLE > 1 )
-                configPRINTF( ("TLI4966G-1: Speed %.0f, Dir %.0f\r\n", (float)xData.fSpeed, (float)xData.lDirection) );
+            configPRINTF( ("TLI4966G-1: Speed %.0f, Dir %.0f\r\n", (float)xData.fSpeed, (float)xData.lDirection) );
 #endif
-            }
-            else
-            {
-                xSensor[TLI4966G_1].ucErrorCount++;
-            }
         }
         else
         {
-            pxSensorsData->fSensorsVector.vector[TLI4966G_DOUBLE_HALL_SPEED_1][ulTicks] = (float)xData.fSpeed;
-            pxSensorsData->fSensorsVector.vector[TLI4966G_DOUBLE_HALL_DIR_1][ulTicks] = (float)xData.lDirection;
+            xSensor[TLI4966G_1].ucErrorCount++;
         }
     }
 
@@ -865,14 +1189,14 @@ void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
 
 #if( SENSOR_TLI493D_1_ENABLE > 0 )
 
-    if( xSensor[TLI493D_1].bInited && xSensor[TLI493D_1].bOn )
+    if( xSensor[TLI493D_1].bInited && xSensor[TLI493D_1].bOn && prvSensorSampleDue( TLI493D_1, ulTicks, &ulPos ) )
     {
     	TLI493DData_t xData;
         if( TLI493D_lGetData( xSensor[TLI493D_1].pvCxt, &xData ) == 0 )
         {
-            pxSensorsData->fSensorsVector.vector[TLI493D_MAGNETIC_X_1][ulTicks] = xData.fMagneticFieldIntensityX;
-            pxSensorsData->fSensorsVector.vector[TLI493D_MAGNETIC_Y_1][ulTicks] = xData.fMagneticFieldIntensityY;
-            pxSensorsData->fSensorsVector.vector[TLI493D_MAGNETIC_Z_1][ulTicks] = xData.fMagneticFieldIntensityZ;
+            pxSensorsData->fSensorsVector.vector[TLI493D_MAGNETIC_X_1][ulPos] = xData.fMagneticFieldIntensityX;
+            pxSensorsData->fSensorsVector.vector[TLI493D_MAGNETIC_Y_1][ulPos] = xData.fMagneticFieldIntensityY;
+            pxSensorsData->fSensorsVector.vector[TLI493D_MAGNETIC_Z_1][ulPos] = xData.fMagneticFieldIntensityZ;
 #if( SENSOR_TLI493D_1_ENABLE > 1 )
             configPRINTF( ("TLI493D-1 x: %.4f, y: %.4f, z: %.4f\r\n", xData.fMagneticFieldIntensityX, xData.fMagneticFieldIntensityY, xData.fMagneticFieldIntensityZ) );
 #endif
@@ -885,25 +1209,78 @@ void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
 
 #endif
 
+    prvCaptureReadCheck();
+
 } /* vSensorsRead */
 
 
+#if( ( SENSOR_TLE4964_1_ENABLE > 0 ) || ( SENSOR_TLE4961_3K_1_ENABLE > 0 ) || ( SENSOR_TLE4913_1_ENABLE > 0 ) || ( SENSOR_TLE4961_1K_1_ENABLE > 0 ) )
+/* Store edge statistic of the closed window for one Hall switch */
+static void prvSensorsEdgeRead( InfineonSensorsData_t *pxSensorsData, uint8_t ucSensor, uint8_t ucEdge )
+{
+    HallCaptureStat_t xEdge;
+
+    if( !( xSensor[ucSensor].bInited && xSensor[ucSensor].bOn && xWindow[ucSensor].bClosed ) )
+    {
+    	return;
+    }
+
+    if( TLE496x_lGetEdgeData( xSensor[ucSensor].pvCxt, &xEdge ) == 0 )
+    {
+        pxSensorsData->Frequency.edge_buf[ucEdge] = xEdge.fFrequency;
+        pxSensorsData->DutyCycle.edge_buf[ucEdge] = xEdge.fDutyCycle;
+        pxSensorsData->PulseCount.count_buf[ucEdge] = xEdge.ulPulseCount;
+        pxSensorsData->DwellOn.edge_buf[ucEdge] = xEdge.fDwellOn;
+        pxSensorsData->DwellOff.edge_buf[ucEdge] = xEdge.fDwellOff;
+        if( xEdge.ulOverrun > 0 )
+        {
+        	configPRINTF( ("Hall edge #%u: %u edges lost\r\n", ucEdge, xEdge.ulOverrun) );
+        }
+    }
+    else
+    {
+        xSensor[ucSensor].ucErrorCount++;
+    }
+}
+#endif
+
+
 /* Read sensors, using background mode */
 void vNonTickSensorsRead( InfineonSensorsData_t *pxSensorsData )
 {
 
+/* Close the edge capture window of Hall switches */
+
+#if( SENSOR_TLE4964_1_ENABLE > 0 )
+    prvSensorsEdgeRead( pxSensorsData, TLE4964_1, TLE4964_EDGE_1 );
+#endif
+
+#if( SENSOR_TLE4961_3K_1_ENABLE > 0 )
+    prvSensorsEdgeRead( pxSensorsData, TLE49613K_1, TLE49613K_EDGE_1 );
+#endif
+
+#if( SENSOR_TLE4913_1_ENABLE > 0 )
+    prvSensorsEdgeRead( pxSensorsData, TLE4913_1, TLE4913_EDGE_1 );
+#endif
+
+#if( SENSOR_TLE4961_1K_1_ENABLE > 0 )
+    prvSensorsEdgeRead( pxSensorsData, TLE49611K_1, TLE49611K_EDGE_1 );
+#endif
+
 /* Get data from I2S Microphone */
 
 #if( SENSOR_IM69D130_ENABLE > 0 )
 
-    if( xSensor[IM69D_1].bInited && xSensor[IM69D_1].bOn )
+    /* Microphone is sampled by DMA, the last window of samples is taken when the send period is over */
+    if( xSensor[IM69D_1].bInited && xSensor[IM69D_1].bOn && xWindow[IM69D_1].bClosed )
     {
-        if( IM69D_lGetData( pxSensorsData, IM69D_MIC_1, SENSORS_VECTOR_LEN ) == 0 )
+        if( IM69D_lGetData( pxSensorsData, IM69D_MIC_1, xSensorRate[IM69D_1].ulWindowLen ) == 0 )
         {
+        	xWindow[IM69D_1].ulSamples = xSensorRate[IM69D_1].ulWindowLen;
 #if( SENSOR_IM69D130_ENABLE > 1 )
         	configPRINTF( ("IM69D-1\r\n") );
 #warning "'loggingDONT_BLOCK' should be set to non-zero value (about 15ms) because a big amount of data will be sent over the serial port"
-        	IM69D_vPrintData( pxSensorsData, IM69D_MIC_1, SENSORS_VECTOR_LEN );
+        	IM69D_vPrintData( pxSensorsData, IM69D_MIC_1, xSensorRate[IM69D_1].ulWindowLen );
 #endif
         }
         else
@@ -917,27 +1294,29 @@ void vNonTickSensorsRead( InfineonSensorsData_t *pxSensorsData )
 } /* vNonTickSensorsRead */
 
 
-int32_t lSensorsReadErrorCheck( uint32_t ulTicks )
+int32_t lSensorsReadErrorCheck( void )
 {
 	int32_t lRet = 0;
 
 	uint32_t ulRefErrorNumber;
 
-	/* Reference number of sensor errors is taken as half the vector length, but not less than one */
-	if( ulTicks > ATTEMPTS_LIMIT_EXCEEDED )
-	{
-		ulRefErrorNumber = ulTicks / 3;
-	}
-	else
-	{
-		ulRefErrorNumber = ONE_ATTEMPT;
-	}
-
-    /* check for errors */
+    /* check for errors of the sensors whose window is over */
     for( uint8_t i = 0; i < SENSORS_NUMBER; i++ )
     {
-        if( xSensor[i].bInited && xSensor[i].bOn )
+        if( xSensor[i].bInited && xSensor[i].bOn && xWindow[i].bClosed )
         {
+        	ulReadErrors += xSensor[i].ucErrorCount;
+
+        	/* Reference number of sensor errors is taken as a third of the window samples, but not less than one */
+        	if( xWindow[i].ulSamples > ATTEMPTS_LIMIT_EXCEEDED )
+        	{
+        		ulRefErrorNumber = xWindow[i].ulSamples / 3;
+        	}
+        	else
+        	{
+        		ulRefErrorNumber = ONE_ATTEMPT;
+        	}
+
             /* Resetting non-working sensors */
             if( xSensor[i].ucErrorCount >= ulRefErrorNumber )
             {
@@ -1135,7 +1514,7 @@ void vSensorsDeInit( void )
 } /* vSensorsDeInit */
 
 
-void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks )
+void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData )
 {
 
 /** Delay vTaskDelay( 20 ) is used as time needed for logTask to receive and print log message
@@ -1145,15 +1524,15 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 #if( SENSOR_DPS368_1_ENABLE > 0 )
 
-    if( xSensor[DPS368_1].bOn )
+    if( prvSensorWindowReady( DPS368_1 ) )
     {
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[DPS368_TEMP_1]) ); }
-        STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_TEMP_1][0]), ulTicks, &(pxSensorsData->Max.stat_buf[DPS368_TEMP_1]), &(pxSensorsData->Min.stat_buf[DPS368_TEMP_1]), &(pxSensorsData->Mean.stat_buf[DPS368_TEMP_1]), &(pxSensorsData->Rms.stat_buf[DPS368_TEMP_1]), &(pxSensorsData->StdDev.stat_buf[DPS368_TEMP_1]), &(pxSensorsData->Variance.stat_buf[DPS368_TEMP_1]) );
+        STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_TEMP_1][0]), xWindow[DPS368_1].ulSamples, &(pxSensorsData->Max.stat_buf[DPS368_TEMP_1]), &(pxSensorsData->Min.stat_buf[DPS368_TEMP_1]), &(pxSensorsData->Mean.stat_buf[DPS368_TEMP_1]), &(pxSensorsData->Rms.stat_buf[DPS368_TEMP_1]), &(pxSensorsData->StdDev.stat_buf[DPS368_TEMP_1]), &(pxSensorsData->Variance.stat_buf[DPS368_TEMP_1]) );
 
         vTaskDelay( 20 );
 
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[DPS368_PRESS_1]) ); }
-	    STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_PRESS_1][0]), ulTicks, &(pxSensorsData->Max.stat_buf[DPS368_PRESS_1]), &(pxSensorsData->Min.stat_buf[DPS368_PRESS_1]), &(pxSensorsData->Mean.stat_buf[DPS368_PRESS_1]), &(pxSensorsData->Rms.stat_buf[DPS368_PRESS_1]), &(pxSensorsData->StdDev.stat_buf[DPS368_PRESS_1]), &(pxSensorsData->Variance.stat_buf[DPS368_PRESS_1]) );
+	    STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_PRESS_1][0]), xWindow[DPS368_1].ulSamples, &(pxSensorsData->Max.stat_buf[DPS368_PRESS_1]), &(pxSensorsData->Min.stat_buf[DPS368_PRESS_1]), &(pxSensorsData->Mean.stat_buf[DPS368_PRESS_1]), &(pxSensorsData->Rms.stat_buf[DPS368_PRESS_1]), &(pxSensorsData->StdDev.stat_buf[DPS368_PRESS_1]), &(pxSensorsData->Variance.stat_buf[DPS368_PRESS_1]) );
 
 	    vTaskDelay( 20 );
 	}
@@ -1162,15 +1541,15 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 #if( SENSOR_DPS368_2_ENABLE > 0 )
 
-    if( xSensor[DPS368_2].bOn )
+    if( prvSensorWindowReady( DPS368_2 ) )
     {
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[DPS368_TEMP_2]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_TEMP_2][0]), ulTicks, &(pxSensorsData->Max.stat_buf[DPS368_TEMP_2]), &(pxSensorsData->Min.stat_buf[DPS368_TEMP_2]), &(pxSensorsData->Mean.stat_buf[DPS368_TEMP_2]), &(pxSensorsData->Rms.stat_buf[DPS368_TEMP_2]), &(pxSensorsData->StdDev.stat_buf[DPS368_TEMP_2]), &(pxSensorsData->Variance.stat_buf[DPS368_TEMP_2]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_TEMP_2][0]), xWindow[DPS368_2].ulSamples, &(pxSensorsData->Max.stat_buf[DPS368_TEMP_2]), &(pxSensorsData->Min.stat_buf[DPS368_TEMP_2]), &(pxSensorsData->Mean.stat_buf[DPS368_TEMP_2]), &(pxSensorsData->Rms.stat_buf[DPS368_TEMP_2]), &(pxSensorsData->StdDev.stat_buf[DPS368_TEMP_2]), &(pxSensorsData->Variance.stat_buf[DPS368_TEMP_2]) );
 
     	vTaskDelay( 20 );
 
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[DPS368_PRESS_2]) ); }
-		STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_PRESS_2][0]), ulTicks, &(pxSensorsData->Max.stat_buf[DPS368_PRESS_2]), &(pxSensorsData->Min.stat_buf[DPS368_PRESS_2]), &(pxSensorsData->Mean.stat_buf[DPS368_PRESS_2]), &(pxSensorsData->Rms.stat_buf[DPS368_PRESS_2]), &(pxSensorsData->StdDev.stat_buf[DPS368_PRESS_2]), &(pxSensorsData->Variance.stat_buf[DPS368_PRESS_2]) );
+		STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_PRESS_2][0]), xWindow[DPS368_2].ulSamples, &(pxSensorsData->Max.stat_buf[DPS368_PRESS_2]), &(pxSensorsData->Min.stat_buf[DPS368_PRESS_2]), &(pxSensorsData->Mean.stat_buf[DPS368_PRESS_2]), &(pxSensorsData->Rms.stat_buf[DPS368_PRESS_2]), &(pxSensorsData->StdDev.stat_buf[DPS368_PRESS_2]), &(pxSensorsData->Variance.stat_buf[DPS368_PRESS_2]) );
 
 		vTaskDelay( 20 );
 	}
@@ -1179,15 +1558,15 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 #if( SENSOR_DPS368_3_ENABLE > 0 )
 
-    if( xSensor[DPS368_3].bOn )
+    if( prvSensorWindowReady( DPS368_3 ) )
     {
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[DPS368_TEMP_3]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_TEMP_3][0]), ulTicks, &(pxSensorsData->Max.stat_buf[DPS368_TEMP_3]), &(pxSensorsData->Min.stat_buf[DPS368_TEMP_3]), &(pxSensorsData->Mean.stat_buf[DPS368_TEMP_3]), &(pxSensorsData->Rms.stat_buf[DPS368_TEMP_3]), &(pxSensorsData->StdDev.stat_buf[DPS368_TEMP_3]), &(pxSensorsData->Variance.stat_buf[DPS368_TEMP_3]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_TEMP_3][0]), xWindow[DPS368_3].ulSamples, &(pxSensorsData->Max.stat_buf[DPS368_TEMP_3]), &(pxSensorsData->Min.stat_buf[DPS368_TEMP_3]), &(pxSensorsData->Mean.stat_buf[DPS368_TEMP_3]), &(pxSensorsData->Rms.stat_buf[DPS368_TEMP_3]), &(pxSensorsData->StdDev.stat_buf[DPS368_TEMP_3]), &(pxSensorsData->Variance.stat_buf[DPS368_TEMP_3]) );
 
     	vTaskDelay( 20 );
 
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[DPS368_PRESS_3]) ); }
-		STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_PRESS_3][0]), ulTicks, &(pxSensorsData->Max.stat_buf[DPS368_PRESS_3]), &(pxSensorsData->Min.stat_buf[DPS368_PRESS_3]), &(pxSensorsData->Mean.stat_buf[DPS368_PRESS_3]), &(pxSensorsData->Rms.stat_buf[DPS368_PRESS_3]), &(pxSensorsData->StdDev.stat_buf[DPS368_PRESS_3]), &(pxSensorsData->Variance.stat_buf[DPS368_PRESS_3]) );
+		STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_PRESS_3][0]), xWindow[DPS368_3].ulSamples, &(pxSensorsData->Max.stat_buf[DPS368_PRESS_3]), &(pxSensorsData->Min.stat_buf[DPS368_PRESS_3]), &(pxSensorsData->Mean.stat_buf[DPS368_PRESS_3]), &(pxSensorsData->Rms.stat_buf[DPS368_PRESS_3]), &(pxSensorsData->StdDev.stat_buf[DPS368_PRESS_3]), &(pxSensorsData->Variance.stat_buf[DPS368_PRESS_3]) );
 
 		vTaskDelay( 20 );
 	}
@@ -1196,15 +1575,15 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 #if( SENSOR_DPS368_4_ENABLE > 0 )
 
-    if( xSensor[DPS368_4].bOn )
+    if( prvSensorWindowReady( DPS368_4 ) )
     {
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[DPS368_TEMP_4]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_TEMP_4][0]), ulTicks, &(pxSensorsData->Max.stat_buf[DPS368_TEMP_4]), &(pxSensorsData->Min.stat_buf[DPS368_TEMP_4]), &(pxSensorsData->Mean.stat_buf[DPS368_TEMP_4]), &(pxSensorsData->Rms.stat_buf[DPS368_TEMP_4]), &(pxSensorsData->StdDev.stat_buf[DPS368_TEMP_4]), &(pxSensorsData->Variance.stat_buf[DPS368_TEMP_4]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_TEMP_4][0]), xWindow[DPS368_4].ulSamples, &(pxSensorsData->Max.stat_buf[DPS368_TEMP_4]), &(pxSensorsData->Min.stat_buf[DPS368_TEMP_4]), &(pxSensorsData->Mean.stat_buf[DPS368_TEMP_4]), &(pxSensorsData->Rms.stat_buf[DPS368_TEMP_4]), &(pxSensorsData->StdDev.stat_buf[DPS368_TEMP_4]), &(pxSensorsData->Variance.stat_buf[DPS368_TEMP_4]) );
 
     	vTaskDelay( 20 );
 
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[DPS368_PRESS_4]) ); }
-		STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_PRESS_4][0]), ulTicks, &(pxSensorsData->Max.stat_buf[DPS368_PRESS_4]), &(pxSensorsData->Min.stat_buf[DPS368_PRESS_4]), &(pxSensorsData->Mean.stat_buf[DPS368_PRESS_4]), &(pxSensorsData->Rms.stat_buf[DPS368_PRESS_4]), &(pxSensorsData->StdDev.stat_buf[DPS368_PRESS_4]), &(pxSensorsData->Variance.stat_buf[DPS368_PRESS_4]) );
+		STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_PRESS_4][0]), xWindow[DPS368_4].ulSamples, &(pxSensorsData->Max.stat_buf[DPS368_PRESS_4]), &(pxSensorsData->Min.stat_buf[DPS368_PRESS_4]), &(pxSensorsData->Mean.stat_buf[DPS368_PRESS_4]), &(pxSensorsData->Rms.stat_buf[DPS368_PRESS_4]), &(pxSensorsData->StdDev.stat_buf[DPS368_PRESS_4]), &(pxSensorsData->Variance.stat_buf[DPS368_PRESS_4]) );
 
 		vTaskDelay( 20 );
 	}
@@ -1213,15 +1592,15 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 #if( SENSOR_DPS368_5_ENABLE > 0 )
 
-    if( xSensor[DPS368_5].bOn )
+    if( prvSensorWindowReady( DPS368_5 ) )
     {
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[DPS368_TEMP_5]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_TEMP_5][0]), ulTicks, &(pxSensorsData->Max.stat_buf[DPS368_TEMP_5]), &(pxSensorsData->Min.stat_buf[DPS368_TEMP_5]), &(pxSensorsData->Mean.stat_buf[DPS368_TEMP_5]), &(pxSensorsData->Rms.stat_buf[DPS368_TEMP_5]), &(pxSensorsData->StdDev.stat_buf[DPS368_TEMP_5]), &(pxSensorsData->Variance.stat_buf[DPS368_TEMP_5]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_TEMP_5][0]), xWindow[DPS368_5].ulSamples, &(pxSensorsData->Max.stat_buf[DPS368_TEMP_5]), &(pxSensorsData->Min.stat_buf[DPS368_TEMP_5]), &(pxSensorsData->Mean.stat_buf[DPS368_TEMP_5]), &(pxSensorsData->Rms.stat_buf[DPS368_TEMP_5]), &(pxSensorsData->StdDev.stat_buf[DPS368_TEMP_5]), &(pxSensorsData->Variance.stat_buf[DPS368_TEMP_5]) );
 
     	vTaskDelay( 20 );
 
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[DPS368_PRESS_5]) ); }
-		STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_PRESS_5][0]), ulTicks, &(pxSensorsData->Max.stat_buf[DPS368_PRESS_5]), &(pxSensorsData->Min.stat_buf[DPS368_PRESS_5]), &(pxSensorsData->Mean.stat_buf[DPS368_PRESS_5]), &(pxSensorsData->Rms.stat_buf[DPS368_PRESS_5]), &(pxSensorsData->StdDev.stat_buf[DPS368_PRESS_5]), &(pxSensorsData->Variance.stat_buf[DPS368_PRESS_5]) );
+		STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[DPS368_PRESS_5][0]), xWindow[DPS368_5].ulSamples, &(pxSensorsData->Max.stat_buf[DPS368_PRESS_5]), &(pxSensorsData->Min.stat_buf[DPS368_PRESS_5]), &(pxSensorsData->Mean.stat_buf[DPS368_PRESS_5]), &(pxSensorsData->Rms.stat_buf[DPS368_PRESS_5]), &(pxSensorsData->StdDev.stat_buf[DPS368_PRESS_5]), &(pxSensorsData->Variance.stat_buf[DPS368_PRESS_5]) );
 
 		vTaskDelay( 20 );
 	}
@@ -1232,10 +1611,10 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 #if( SENSOR_TLI4971_1_ENABLE > 0 )
 
-    if( xSensor[TLI4971_1].bOn )
+    if( prvSensorWindowReady( TLI4971_1 ) )
     {
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[TLI4971_CURRENT_1]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLI4971_CURRENT_1][0]), SENSORS_VECTOR_LEN, &(pxSensorsData->Max.stat_buf[TLI4971_CURRENT_1]), &(pxSensorsData->Min.stat_buf[TLI4971_CURRENT_1]), &(pxSensorsData->Mean.stat_buf[TLI4971_CURRENT_1]), &(pxSensorsData->Rms.stat_buf[TLI4971_CURRENT_1]), &(pxSensorsData->StdDev.stat_buf[TLI4971_CURRENT_1]), &(pxSensorsData->Variance.stat_buf[TLI4971_CURRENT_1]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLI4971_CURRENT_1][0]), xWindow[TLI4971_1].ulSamples, &(pxSensorsData->Max.stat_buf[TLI4971_CURRENT_1]), &(pxSensorsData->Min.stat_buf[TLI4971_CURRENT_1]), &(pxSensorsData->Mean.stat_buf[TLI4971_CURRENT_1]), &(pxSensorsData->Rms.stat_buf[TLI4971_CURRENT_1]), &(pxSensorsData->StdDev.stat_buf[TLI4971_CURRENT_1]), &(pxSensorsData->Variance.stat_buf[TLI4971_CURRENT_1]) );
 
     	vTaskDelay( 20 );
     }
@@ -1244,10 +1623,10 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 #if( SENSOR_TLI4971_2_ENABLE > 0 )
 
-    if( xSensor[TLI4971_2].bOn )
+    if( prvSensorWindowReady( TLI4971_2 ) )
     {
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[TLI4971_CURRENT_2]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLI4971_CURRENT_2][0]), SENSORS_VECTOR_LEN, &(pxSensorsData->Max.stat_buf[TLI4971_CURRENT_2]), &(pxSensorsData->Min.stat_buf[TLI4971_CURRENT_2]), &(pxSensorsData->Mean.stat_buf[TLI4971_CURRENT_2]), &(pxSensorsData->Rms.stat_buf[TLI4971_CURRENT_2]), &(pxSensorsData->StdDev.stat_buf[TLI4971_CURRENT_2]), &(pxSensorsData->Variance.stat_buf[TLI4971_CURRENT_2]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLI4971_CURRENT_2][0]), xWindow[TLI4971_2].ulSamples, &(pxSensorsData->Max.stat_buf[TLI4971_CURRENT_2]), &(pxSensorsData->Min.stat_buf[TLI4971_CURRENT_2]), &(pxSensorsData->Mean.stat_buf[TLI4971_CURRENT_2]), &(pxSensorsData->Rms.stat_buf[TLI4971_CURRENT_2]), &(pxSensorsData->StdDev.stat_buf[TLI4971_CURRENT_2]), &(pxSensorsData->Variance.stat_buf[TLI4971_CURRENT_2]) );
 
     	vTaskDelay( 20 );
     }
@@ -1256,10 +1635,10 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 #if( SENSOR_TLI4971_3_ENABLE > 0 )
 
-    if( xSensor[TLI4971_3].bOn )
+    if( prvSensorWindowReady( TLI4971_3 ) )
     {
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[TLI4971_CURRENT_3]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLI4971_CURRENT_3][0]), SENSORS_VECTOR_LEN, &(pxSensorsData->Max.stat_buf[TLI4971_CURRENT_3]), &(pxSensorsData->Min.stat_buf[TLI4971_CURRENT_3]), &(pxSensorsData->Mean.stat_buf[TLI4971_CURRENT_3]), &(pxSensorsData->Rms.stat_buf[TLI4971_CURRENT_3]), &(pxSensorsData->StdDev.stat_buf[TLI4971_CURRENT_3]), &(pxSensorsData->Variance.stat_buf[TLI4971_CURRENT_3]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLI4971_CURRENT_3][0]), xWindow[TLI4971_3].ulSamples, &(pxSensorsData->Max.stat_buf[TLI4971_CURRENT_3]), &(pxSensorsData->Min.stat_buf[TLI4971_CURRENT_3]), &(pxSensorsData->Mean.stat_buf[TLI4971_CURRENT_3]), &(pxSensorsData->Rms.stat_buf[TLI4971_CURRENT_3]), &(pxSensorsData->StdDev.stat_buf[TLI4971_CURRENT_3]), &(pxSensorsData->Variance.stat_buf[TLI4971_CURRENT_3]) );
 
     	vTaskDelay( 20 );
     }
@@ -1270,10 +1649,10 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 #if( SENSOR_TLE4997_1_ENABLE > 0 )
 
-    if( xSensor[TLE4997_1].bOn )
+    if( prvSensorWindowReady( TLE4997_1 ) )
     {
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[TLE4997_LINEAR_HALL_1]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLE4997_LINEAR_HALL_1][0]), SENSORS_VECTOR_LEN, &(pxSensorsData->Max.stat_buf[TLE4997_LINEAR_HALL_1]), &(pxSensorsData->Min.stat_buf[TLE4997_LINEAR_HALL_1]), &(pxSensorsData->Mean.stat_buf[TLE4997_LINEAR_HALL_1]), &(pxSensorsData->Rms.stat_buf[TLE4997_LINEAR_HALL_1]), &(pxSensorsData->StdDev.stat_buf[TLE4997_LINEAR_HALL_1]), &(pxSensorsData->Variance.stat_buf[TLE4997_LINEAR_HALL_1]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLE4997_LINEAR_HALL_1][0]), xWindow[TLE4997_1].ulSamples, &(pxSensorsData->Max.stat_buf[TLE4997_LINEAR_HALL_1]), &(pxSensorsData->Min.stat_buf[TLE4997_LINEAR_HALL_1]), &(pxSensorsData->Mean.stat_buf[TLE4997_LINEAR_HALL_1]), &(pxSensorsData->Rms.stat_buf[TLE4997_LINEAR_HALL_1]), &(pxSensorsData->StdDev.stat_buf[TLE4997_LINEAR_HALL_1]), &(pxSensorsData->Variance.stat_buf[TLE4997_LINEAR_HALL_1]) );
 
     	vTaskDelay( 20 );
     }
@@ -1282,10 +1661,10 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 #if( SENSOR_TLE4997_2_ENABLE > 0 )
 
-    if( xSensor[TLE4997_2].bOn )
+    if( prvSensorWindowReady( TLE4997_2 ) )
     {
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[TLE4997_LINEAR_HALL_2]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLE4997_LINEAR_HALL_2][0]), SENSORS_VECTOR_LEN, &(pxSensorsData->Max.stat_buf[TLE4997_LINEAR_HALL_2]), &(pxSensorsData->Min.stat_buf[TLE4997_LINEAR_HALL_2]), &(pxSensorsData->Mean.stat_buf[TLE4997_LINEAR_HALL_2]), &(pxSensorsData->Rms.stat_buf[TLE4997_LINEAR_HALL_2]), &(pxSensorsData->StdDev.stat_buf[TLE4997_LINEAR_HALL_2]), &(pxSensorsData->Variance.stat_buf[TLE4997_LINEAR_HALL_2]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLE4997_LINEAR_HALL_2][0]), xWindow[TLE4997_2].ulSamples, &(pxSensorsData->Max.stat_buf[TLE4997_LINEAR_HALL_2]), &(pxSensorsData->Min.stat_buf[TLE4997_LINEAR_HALL_2]), &(pxSensorsData->Mean.stat_buf[TLE4997_LINEAR_HALL_2]), &(pxSensorsData->Rms.stat_buf[TLE4997_LINEAR_HALL_2]), &(pxSensorsData->StdDev.stat_buf[TLE4997_LINEAR_HALL_2]), &(pxSensorsData->Variance.stat_buf[TLE4997_LINEAR_HALL_2]) );
 
     	vTaskDelay( 20 );
     }
@@ -1296,10 +1675,10 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 #if( SENSOR_TLE4964_1_ENABLE > 0 )
 
-    if( xSensor[TLE4964_1].bOn )
+    if( prvSensorWindowReady( TLE4964_1 ) )
     {
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[TLE4964_HALL_SWITCH_1]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLE4964_HALL_SWITCH_1][0]), ulTicks, &(pxSensorsData->Max.stat_buf[TLE4964_HALL_SWITCH_1]), &(pxSensorsData->Min.stat_buf[TLE4964_HALL_SWITCH_1]), &(pxSensorsData->Mean.stat_buf[TLE4964_HALL_SWITCH_1]), &(pxSensorsData->Rms.stat_buf[TLE4964_HALL_SWITCH_1]), &(pxSensorsData->StdDev.stat_buf[TLE4964_HALL_SWITCH_1]), &(pxSensorsData->Variance.stat_buf[TLE4964_HALL_SWITCH_1]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLE4964_HALL_SWITCH_1][0]), xWindow[TLE4964_1].ulSamples, &(pxSensorsData->Max.stat_buf[TLE4964_HALL_SWITCH_1]), &(pxSensorsData->Min.stat_buf[TLE4964_HALL_SWITCH_1]), &(pxSensorsData->Mean.stat_buf[TLE4964_HALL_SWITCH_1]), &(pxSensorsData->Rms.stat_buf[TLE4964_HALL_SWITCH_1]), &(pxSensorsData->StdDev.stat_buf[TLE4964_HALL_SWITCH_1]), &(pxSensorsData->Variance.stat_buf[TLE4964_HALL_SWITCH_1]) );
 
     	vTaskDelay( 20 );
     }
@@ -1308,10 +1687,10 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 #if( SENSOR_TLE4961_3K_1_ENABLE > 0 )
 
-    if( xSensor[TLE49613K_1].bOn )
+    if( prvSensorWindowReady( TLE49613K_1 ) )
     {
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[TLE49613K_HALL_LATCH_1]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLE49613K_HALL_LATCH_1][0]), ulTicks, &(pxSensorsData->Max.stat_buf[TLE49613K_HALL_LATCH_1]), &(pxSensorsData->Min.stat_buf[TLE49613K_HALL_LATCH_1]), &(pxSensorsData->Mean.stat_buf[TLE49613K_HALL_LATCH_1]), &(pxSensorsData->Rms.stat_buf[TLE49613K_HALL_LATCH_1]), &(pxSensorsData->StdDev.stat_buf[TLE49613K_HALL_LATCH_1]), &(pxSensorsData->Variance.stat_buf[TLE49613K_HALL_LATCH_1]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLE49613K_HALL_LATCH_1][0]), xWindow[TLE49613K_1].ulSamples, &(pxSensorsData->Max.stat_buf[TLE49613K_HALL_LATCH_1]), &(pxSensorsData->Min.stat_buf[TLE49613K_HALL_LATCH_1]), &(pxSensorsData->Mean.stat_buf[TLE49613K_HALL_LATCH_1]), &(pxSensorsData->Rms.stat_buf[TLE49613K_HALL_LATCH_1]), &(pxSensorsData->StdDev.stat_buf[TLE49613K_HALL_LATCH_1]), &(pxSensorsData->Variance.stat_buf[TLE49613K_HALL_LATCH_1]) );
 
     	vTaskDelay( 20 );
     }
@@ -1320,10 +1699,10 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 #if( SENSOR_TLE4913_1_ENABLE > 0 )
 
-    if( xSensor[TLE4913_1].bOn )
+    if( prvSensorWindowReady( TLE4913_1 ) )
     {
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[TLE4913_HALL_SWITCH_1]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLE4913_HALL_SWITCH_1][0]), ulTicks, &(pxSensorsData->Max.stat_buf[TLE4913_HALL_SWITCH_1]), &(pxSensorsData->Min.stat_buf[TLE4913_HALL_SWITCH_1]), &(pxSensorsData->Mean.stat_buf[TLE4913_HALL_SWITCH_1]), &(pxSensorsData->Rms.stat_buf[TLE4913_HALL_SWITCH_1]), &(pxSensorsData->StdDev.stat_buf[TLE4913_HALL_SWITCH_1]), &(pxSensorsData->Variance.stat_buf[TLE4913_HALL_SWITCH_1]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLE4913_HALL_SWITCH_1][0]), xWindow[TLE4913_1].ulSamples, &(pxSensorsData->Max.stat_buf[TLE4913_HALL_SWITCH_1]), &(pxSensorsData->Min.stat_buf[TLE4913_HALL_SWITCH_1]), &(pxSensorsData->Mean.stat_buf[TLE4913_HALL_SWITCH_1]), &(pxSensorsData->Rms.stat_buf[TLE4913_HALL_SWITCH_1]), &(pxSensorsData->StdDev.stat_buf[TLE4913_HALL_SWITCH_1]), &(pxSensorsData->Variance.stat_buf[TLE4913_HALL_SWITCH_1]) );
 
     	vTaskDelay( 20 );
     }
@@ -1332,10 +1711,10 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 #if( SENSOR_TLE4961_1K_1_ENABLE > 0 )
 
-    if( xSensor[TLE49611K_1].bOn )
+    if( prvSensorWindowReady( TLE49611K_1 ) )
     {
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[TLE49611K_HALL_LATCH_1]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLE49611K_HALL_LATCH_1][0]), ulTicks, &(pxSensorsData->Max.stat_buf[TLE49611K_HALL_LATCH_1]), &(pxSensorsData->Min.stat_buf[TLE49611K_HALL_LATCH_1]), &(pxSensorsData->Mean.stat_buf[TLE49611K_HALL_LATCH_1]), &(pxSensorsData->Rms.stat_buf[TLE49611K_HALL_LATCH_1]), &(pxSensorsData->StdDev.stat_buf[TLE49611K_HALL_LATCH_1]), &(pxSensorsData->Variance.stat_buf[TLE49611K_HALL_LATCH_1]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLE49611K_HALL_LATCH_1][0]), xWindow[TLE49611K_1].ulSamples, &(pxSensorsData->Max.stat_buf[TLE49611K_HALL_LATCH_1]), &(pxSensorsData->Min.stat_buf[TLE49611K_HALL_LATCH_1]), &(pxSensorsData->Mean.stat_buf[TLE49611K_HALL_LATCH_1]), &(pxSensorsData->Rms.stat_buf[TLE49611K_HALL_LATCH_1]), &(pxSensorsData->StdDev.stat_buf[TLE49611K_HALL_LATCH_1]), &(pxSensorsData->Variance.stat_buf[TLE49611K_HALL_LATCH_1]) );
 
     	vTaskDelay( 20 );
     }
@@ -1344,15 +1723,15 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 #if( SENSOR_TLI4966_1_ENABLE > 0 )
 
-    if( xSensor[TLI4966G_1].bOn )
+    if( prvSensorWindowReady( TLI4966G_1 ) )
     {
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[TLI4966G_DOUBLE_HALL_SPEED_1]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLI4966G_DOUBLE_HALL_SPEED_1][0]), ulTicks, &(pxSensorsData->Max.stat_buf[TLI4966G_DOUBLE_HALL_SPEED_1]), &(pxSensorsData->Min.stat_buf[TLI4966G_DOUBLE_HALL_SPEED_1]), &(pxSensorsData->Mean.stat_buf[TLI4966G_DOUBLE_HALL_SPEED_1]), &(pxSensorsData->Rms.stat_buf[TLI4966G_DOUBLE_HALL_SPEED_1]), &(pxSensorsData->StdDev.stat_buf[TLI4966G_DOUBLE_HALL_SPEED_1]), &(pxSensorsData->Variance.stat_buf[TLI4966G_DOUBLE_HALL_SPEED_1]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLI4966G_DOUBLE_HALL_SPEED_1][0]), xWindow[TLI4966G_1].ulSamples, &(pxSensorsData->Max.stat_buf[TLI4966G_DOUBLE_HALL_SPEED_1]), &(pxSensorsData->Min.stat_buf[TLI4966G_DOUBLE_HALL_SPEED_1]), &(pxSensorsData->Mean.stat_buf[TLI4966G_DOUBLE_HALL_SPEED_1]), &(pxSensorsData->Rms.stat_buf[TLI4966G_DOUBLE_HALL_SPEED_1]), &(pxSensorsData->StdDev.stat_buf[TLI4966G_DOUBLE_HALL_SPEED_1]), &(pxSensorsData->Variance.stat_buf[TLI4966G_DOUBLE_HALL_SPEED_1]) );
 
     	vTaskDelay( 20 );
 
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[TLI4966G_DOUBLE_HALL_DIR_1]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLI4966G_DOUBLE_HALL_DIR_1][0]), ulTicks, &(pxSensorsData->Max.stat_buf[TLI4966G_DOUBLE_HALL_DIR_1]), &(pxSensorsData->Min.stat_buf[TLI4966G_DOUBLE_HALL_DIR_1]), &(pxSensorsData->Mean.stat_buf[TLI4966G_DOUBLE_HALL_DIR_1]), &(pxSensorsData->Rms.stat_buf[TLI4966G_DOUBLE_HALL_DIR_1]), &(pxSensorsData->StdDev.stat_buf[TLI4966G_DOUBLE_HALL_DIR_1]), &(pxSensorsData->Variance.stat_buf[TLI4966G_DOUBLE_HALL_DIR_1]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLI4966G_DOUBLE_HALL_DIR_1][0]), xWindow[TLI4966G_1].ulSamples, &(pxSensorsData->Max.stat_buf[TLI4966G_DOUBLE_HALL_DIR_1]), &(pxSensorsData->Min.stat_buf[TLI4966G_DOUBLE_HALL_DIR_1]), &(pxSensorsData->Mean.stat_buf[TLI4966G_DOUBLE_HALL_DIR_1]), &(pxSensorsData->Rms.stat_buf[TLI4966G_DOUBLE_HALL_DIR_1]), &(pxSensorsData->StdDev.stat_buf[TLI4966G_DOUBLE_HALL_DIR_1]), &(pxSensorsData->Variance.stat_buf[TLI4966G_DOUBLE_HALL_DIR_1]) );
 
     	vTaskDelay( 20 );
     }
@@ -1363,10 +1742,10 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 #if( SENSOR_IM69D130_ENABLE > 0 )
 
-    if( xSensor[IM69D_1].bOn )
+    if( prvSensorWindowReady( IM69D_1 ) )
     {
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[IM69D_MIC_1]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[IM69D_MIC_1][0]), SENSORS_VECTOR_LEN, &(pxSensorsData->Max.stat_buf[IM69D_MIC_1]), &(pxSensorsData->Min.stat_buf[IM69D_MIC_1]), &(pxSensorsData->Mean.stat_buf[IM69D_MIC_1]), &(pxSensorsData->Rms.stat_buf[IM69D_MIC_1]), &(pxSensorsData->StdDev.stat_buf[IM69D_MIC_1]), &(pxSensorsData->Variance.stat_buf[IM69D_MIC_1]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[IM69D_MIC_1][0]), xWindow[IM69D_1].ulSamples, &(pxSensorsData->Max.stat_buf[IM69D_MIC_1]), &(pxSensorsData->Min.stat_buf[IM69D_MIC_1]), &(pxSensorsData->Mean.stat_buf[IM69D_MIC_1]), &(pxSensorsData->Rms.stat_buf[IM69D_MIC_1]), &(pxSensorsData->StdDev.stat_buf[IM69D_MIC_1]), &(pxSensorsData->Variance.stat_buf[IM69D_MIC_1]) );
 
     	vTaskDelay( 20 );
     }
@@ -1377,20 +1756,20 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 #if( SENSOR_TLI493D_1_ENABLE > 0 )
 
-    if( xSensor[TLI493D_1].bOn )
+    if( prvSensorWindowReady( TLI493D_1 ) )
     {
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[TLI493D_MAGNETIC_X_1]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLI493D_MAGNETIC_X_1][0]), ulTicks, &(pxSensorsData->Max.stat_buf[TLI493D_MAGNETIC_X_1]), &(pxSensorsData->Min.stat_buf[TLI493D_MAGNETIC_X_1]), &(pxSensorsData->Mean.stat_buf[TLI493D_MAGNETIC_X_1]), &(pxSensorsData->Rms.stat_buf[TLI493D_MAGNETIC_X_1]), &(pxSensorsData->StdDev.stat_buf[TLI493D_MAGNETIC_X_1]), &(pxSensorsData->Variance.stat_buf[TLI493D_MAGNETIC_X_1]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLI493D_MAGNETIC_X_1][0]), xWindow[TLI493D_1].ulSamples, &(pxSensorsData->Max.stat_buf[TLI493D_MAGNETIC_X_1]), &(pxSensorsData->Min.stat_buf[TLI493D_MAGNETIC_X_1]), &(pxSensorsData->Mean.stat_buf[TLI493D_MAGNETIC_X_1]), &(pxSensorsData->Rms.stat_buf[TLI493D_MAGNETIC_X_1]), &(pxSensorsData->StdDev.stat_buf[TLI493D_MAGNETIC_X_1]), &(pxSensorsData->Variance.stat_buf[TLI493D_MAGNETIC_X_1]) );
 
     	vTaskDelay( 20 );
 
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[TLI493D_MAGNETIC_Y_1]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLI493D_MAGNETIC_Y_1][0]), ulTicks, &(pxSensorsData->Max.stat_buf[TLI493D_MAGNETIC_Y_1]), &(pxSensorsData->Min.stat_buf[TLI493D_MAGNETIC_Y_1]), &(pxSensorsData->Mean.stat_buf[TLI493D_MAGNETIC_Y_1]), &(pxSensorsData->Rms.stat_buf[TLI493D_MAGNETIC_Y_1]), &(pxSensorsData->StdDev.stat_buf[TLI493D_MAGNETIC_Y_1]), &(pxSensorsData->Variance.stat_buf[TLI493D_MAGNETIC_Y_1]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLI493D_MAGNETIC_Y_1][0]), xWindow[TLI493D_1].ulSamples, &(pxSensorsData->Max.stat_buf[TLI493D_MAGNETIC_Y_1]), &(pxSensorsData->Min.stat_buf[TLI493D_MAGNETIC_Y_1]), &(pxSensorsData->Mean.stat_buf[TLI493D_MAGNETIC_Y_1]), &(pxSensorsData->Rms.stat_buf[TLI493D_MAGNETIC_Y_1]), &(pxSensorsData->StdDev.stat_buf[TLI493D_MAGNETIC_Y_1]), &(pxSensorsData->Variance.stat_buf[TLI493D_MAGNETIC_Y_1]) );
 
     	vTaskDelay( 20 );
 
     	if( SHOW_SENSOR_OUTPUT ) { configPRINTF( ("\r\n%s: ", pcFeatures[TLI493D_MAGNETIC_Z_1]) ); }
-    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLI493D_MAGNETIC_Z_1][0]), ulTicks, &(pxSensorsData->Max.stat_buf[TLI493D_MAGNETIC_Z_1]), &(pxSensorsData->Min.stat_buf[TLI493D_MAGNETIC_Z_1]), &(pxSensorsData->Mean.stat_buf[TLI493D_MAGNETIC_Z_1]), &(pxSensorsData->Rms.stat_buf[TLI493D_MAGNETIC_Z_1]), &(pxSensorsData->StdDev.stat_buf[TLI493D_MAGNETIC_Z_1]), &(pxSensorsData->Variance.stat_buf[TLI493D_MAGNETIC_Z_1]) );
+    	STAT_vCalcAndPrint( &(pxSensorsData->fSensorsVector.vector[TLI493D_MAGNETIC_Z_1][0]), xWindow[TLI493D_1].ulSamples, &(pxSensorsData->Max.stat_buf[TLI493D_MAGNETIC_Z_1]), &(pxSensorsData->Min.stat_buf[TLI493D_MAGNETIC_Z_1]), &(pxSensorsData->Mean.stat_buf[TLI493D_MAGNETIC_Z_1]), &(pxSensorsData->Rms.stat_buf[TLI493D_MAGNETIC_Z_1]), &(pxSensorsData->StdDev.stat_buf[TLI493D_MAGNETIC_Z_1]), &(pxSensorsData->Variance.stat_buf[TLI493D_MAGNETIC_Z_1]) );
 
     	vTaskDelay( 20 );
     }
@@ -1399,6 +1778,269 @@ void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulT
 
 } /* vSensorsStatCalculation */
 
+#if( ( SENSOR_DPS368_PAIR_1_ENABLE > 0 ) || ( SENSOR_DPS368_PAIR_2_ENABLE > 0 ) )
+/* DPS368 number to positions of the sensor and its parameters, false if the sensor is disabled */
+static bool prvDps368Position( uint8_t ucNumber, uint8_t *pucSensor, uint8_t *pucTemp, uint8_t *pucPress )
+{
+	switch( ucNumber )
+	{
+#if( SENSOR_DPS368_1_ENABLE > 0 )
+	case 1: *pucSensor = DPS368_1; *pucTemp = DPS368_TEMP_1; *pucPress = DPS368_PRESS_1; return true;
+#endif
+#if( SENSOR_DPS368_2_ENABLE > 0 )
+	case 2: *pucSensor = DPS368_2; *pucTemp = DPS368_TEMP_2; *pucPress = DPS368_PRESS_2; return true;
+#endif
+#if( SENSOR_DPS368_3_ENABLE > 0 )
+	case 3: *pucSensor = DPS368_3; *pucTemp = DPS368_TEMP_3; *pucPress = DPS368_PRESS_3; return true;
+#endif
+#if( SENSOR_DPS368_4_ENABLE > 0 )
+	case 4: *pucSensor = DPS368_4; *pucTemp = DPS368_TEMP_4; *pucPress = DPS368_PRESS_4; return true;
+#endif
+#if( SENSOR_DPS368_5_ENABLE > 0 )
+	case 5: *pucSensor = DPS368_5; *pucTemp = DPS368_TEMP_5; *pucPress = DPS368_PRESS_5; return true;
+#endif
+	default: return false;
+	}
+}
+#endif
+
+
+#if( SENSORS_CORRELATION_ENABLE > 0 )
+/* Correlation matrix and lagged cross-correlation peaks when the windows of all channels are closed */
+static void prvCorrelationCalculation( InfineonSensorsData_t *pxSensorsData )
+{
+	const float *ppfVect[CORR_CHANNELS_MAX];
+	uint32_t ulLen = SENSORS_VECTOR_LEN;
+	uint8_t ucSensor;
+
+	pxSensorsData->bCorrelationReady = false;
+	pxSensorsData->bCorrelationOn = true;
+
+	for( uint8_t i = 0; i < CORR_CHANNELS_NUMBER; i++ )
+	{
+		ucSensor = xCorrChannel[i].ucSensor;
+		if( !xSensor[ucSensor].bOn )
+		{
+			pxSensorsData->bCorrelationOn = false;
+			return;
+		}
+		if( !prvSensorWindowReady( ucSensor ) )
+		{
+			return;
+		}
+		if( xWindow[ucSensor].ulSamples < ulLen )
+		{
+			ulLen = xWindow[ucSensor].ulSamples;
+		}
+		ppfVect[i] = &pxSensorsData->fSensorsVector.vector[xCorrChannel[i].ucParameter][0];
+	}
+
+	if( !CORR_bMatrix( ppfVect, CORR_CHANNELS_NUMBER, ulLen, &pxSensorsData->xCorrelation ) )
+	{
+		return;
+	}
+
+	pxSensorsData->xCorrelation.ucLagPairs = CORR_LAG_PAIRS_NUMBER;
+	for( uint8_t i = 0; i < CORR_LAG_PAIRS_NUMBER; i++ )
+	{
+		CORR_bLagPeak( ppfVect[ucCorrLagPair[i][0]], ppfVect[ucCorrLagPair[i][1]], ulLen, SENSORS_CORRELATION_MAX_LAG,
+				&pxSensorsData->xCorrelation.psLag[i], &pxSensorsData->xCorrelation.pfLagPeak[i] );
+	}
+
+	pxSensorsData->bCorrelationReady = true;
+
+#if( SENSORS_CORRELATION_ENABLE > 1 )
+	for( uint8_t i = 0; i < CORR_CHANNELS_NUMBER; i++ )
+	{
+		configPRINTF( ("\r\nCorrelation %s:", pcFeatures[xCorrChannel[i].ucParameter]) );
+		for( uint8_t j = i; j < CORR_CHANNELS_NUMBER; j++ )
+		{
+			configPRINTF( (" %.3f", pxSensorsData->xCorrelation.pfCorrelation[CORR_ulTriangleIndex( CORR_CHANNELS_NUMBER, i, j )]) );
+		}
+		vTaskDelay( 20 );
+	}
+	for( uint8_t i = 0; i < CORR_LAG_PAIRS_NUMBER; i++ )
+	{
+		configPRINTF( ("\r\nLag %u-%u: %d, %.3f", ucCorrLagPair[i][0], ucCorrLagPair[i][1],
+				pxSensorsData->xCorrelation.psLag[i], pxSensorsData->xCorrelation.pfLagPeak[i]) );
+	}
+#endif
+}
+#endif
+
+#if( SENSORS_CLASSIFIER_ENABLE > 0 )
+/* Features of the latest windows to the int8 classifier, once at least one window is closed */
+static void prvClassifierCalculation( InfineonSensorsData_t *pxSensorsData )
+{
+	bool bClosed = false;
+	float fSum;
+	uint32_t ulBin;
+
+	pxSensorsData->bClassifierReady = false;
+
+	if( !bClassifierInited )
+	{
+		bClassifierInited = true;
+		if( !CLASSIFIER_bLoaded() && ( CLASSIFIER_lLoadDefault() != 0 ) )
+		{
+			configPRINTF( ("\r\nClassifier: default model not loaded") );
+		}
+	}
+
+	/* Model may be replaced at runtime, inputs are checked every window */
+	if( !CLASSIFIER_bLoaded() || ( CLASSIFIER_usInputs() != CLASSIFIER_FEATURES_NUMBER ) )
+	{
+		if( !bClassifierMismatchShown && CLASSIFIER_bLoaded() )
+		{
+			configPRINTF( ("\r\nClassifier: model needs %u features, %u available", CLASSIFIER_usInputs(), CLASSIFIER_FEATURES_NUMBER) );
+			bClassifierMismatchShown = true;
+		}
+		pxSensorsData->bClassifierOn = false;
+		return;
+	}
+	bClassifierMismatchShown = false;
+	pxSensorsData->bClassifierOn = true;
+
+	for( uint8_t i = 0; i < SENSORS_NUMBER; i++ )
+	{
+		bClosed |= prvSensorWindowReady( i );
+	}
+	if( !bClosed )
+	{
+		return;
+	}
+
+	for( uint8_t i = 0; i < PARAMETERS_NUMBER; i++ )
+	{
+		pfClassifierFeatures[2 * i] = pxSensorsData->Mean.stat_buf[i];
+		pfClassifierFeatures[2 * i + 1] = pxSensorsData->StdDev.stat_buf[i];
+	}
+
+	ulBin = 0;
+	for( uint8_t i = 0; i < SENSORS_CLASSIFIER_SPECTRAL_BANDS; i++ )
+	{
+		fSum = 0.0f;
+		for( uint32_t j = 0; j < CLASSIFIER_BAND_BINS; j++ )
+		{
+			fSum += (float)pxSensorsData->fMicBuffer.mic_fft_buf[ulBin++];
+		}
+		pfClassifierFeatures[2 * PARAMETERS_NUMBER + i] = fSum / (float)CLASSIFIER_BAND_BINS;
+	}
+
+	if( CLASSIFIER_lRun( pfClassifierFeatures, CLASSIFIER_FEATURES_NUMBER, &pxSensorsData->xClassifier ) != 0 )
+	{
+		return;
+	}
+
+	pxSensorsData->bClassifierReady = true;
+
+#if( SENSORS_CLASSIFIER_ENABLE > 1 )
+	configPRINTF( ("\r\nClassifier: class %u", pxSensorsData->xClassifier.ucLabel) );
+	for( uint8_t i = 0; i < pxSensorsData->xClassifier.ucClasses; i++ )
+	{
+		configPRINTF( (" %.3f", pxSensorsData->xClassifier.pfProb[i]) );
+	}
+#endif
+}
+#endif
+
+
+void vSensorsDerivedCalculation( InfineonSensorsData_t *pxSensorsData )
+{
+#if( ( SENSOR_DPS368_PAIR_1_ENABLE > 0 ) || ( SENSOR_DPS368_PAIR_2_ENABLE > 0 ) )
+
+	uint8_t ucUp, ucUpTemp, ucUpPress;
+	uint8_t ucDown, ucDownTemp, ucDownPress;
+	float fDiff, fPress, fTemp, fSlope, fLast;
+
+	if( !bPairTrendInited )
+	{
+		for( uint8_t i = 0; i < SENSORS_PAIR_NUMBER; i++ )
+		{
+			DIFFP_vTrendInit( &xPairTrend[i], SENSOR_DPS368_TREND_POINTS );
+			fPairDecimationSum[i] = 0.0f;
+			ulPairDecimationCount[i] = 0;
+			ulPairSendMs[i] = SENSOR_DPS368_SEND_MS;
+		}
+		bPairTrendInited = true;
+	}
+
+	for( uint8_t i = 0; i < SENSORS_PAIR_NUMBER; i++ )
+	{
+		pxSensorsData->bPairsReady.pair_on_buf[i] = false;
+		pxSensorsData->bPairsOn.pair_on_buf[i] = prvDps368Position( xSensorPair[i].ucUpstream, &ucUp, &ucUpTemp, &ucUpPress ) &&
+												 prvDps368Position( xSensorPair[i].ucDownstream, &ucDown, &ucDownTemp, &ucDownPress ) &&
+												 xSensor[ucUp].bOn && xSensor[ucDown].bOn;
+
+		/* Both sensors have the same window, the pair is calculated when it is closed */
+		if( ( !pxSensorsData->bPairsOn.pair_on_buf[i] ) || ( !prvSensorWindowReady( ucUp ) ) || ( !prvSensorWindowReady( ucDown ) ) )
+		{
+			continue;
+		}
+
+		/* Points of another window length don't make one slope, the trend starts again with the settings */
+		if( xSensorRate[ucUp].ulSendMs != ulPairSendMs[i] )
+		{
+			DIFFP_vTrendInit( &xPairTrend[i], SENSOR_DPS368_TREND_POINTS );
+			fPairDecimationSum[i] = 0.0f;
+			ulPairDecimationCount[i] = 0;
+			ulPairSendMs[i] = xSensorRate[ucUp].ulSendMs;
+		}
+
+		fDiff = DIFFP_fDiffPressure( pxSensorsData->Mean.stat_buf[ucUpPress], pxSensorsData->Mean.stat_buf[ucDownPress] );
+		fPress = 0.5f * ( pxSensorsData->Mean.stat_buf[ucUpPress] + pxSensorsData->Mean.stat_buf[ucDownPress] );
+		fTemp = 0.5f * ( pxSensorsData->Mean.stat_buf[ucUpTemp] + pxSensorsData->Mean.stat_buf[ucDownTemp] );
+
+		pxSensorsData->DiffPressure.pair_buf[i] = fDiff;
+		pxSensorsData->Flow.pair_buf[i] = DIFFP_fFlow( fDiff, fPress, fTemp, xSensorPair[i].fFlowK );
+
+		/* Trend point is the mean differential pressure over several windows */
+		fPairDecimationSum[i] += fDiff;
+		if( ++ulPairDecimationCount[i] >= SENSOR_DPS368_TREND_DECIMATION )
+		{
+			DIFFP_vTrendAdd( &xPairTrend[i], fPairDecimationSum[i] / (float)ulPairDecimationCount[i] );
+			fPairDecimationSum[i] = 0.0f;
+			ulPairDecimationCount[i] = 0;
+		}
+
+		if( DIFFP_bTrendFit( &xPairTrend[i], &fSlope, &fLast ) )
+		{
+			const float fPointsPerHour = 3600000.0f / ( (float)ulPairSendMs[i] * SENSOR_DPS368_TREND_DECIMATION );
+			pxSensorsData->CloggingIndex.pair_buf[i] = DIFFP_fCloggingIndex( fSlope, fLast, fPointsPerHour );
+		}
+		else
+		{
+			pxSensorsData->CloggingIndex.pair_buf[i] = 0.0f;
+		}
+
+		pxSensorsData->bPairsReady.pair_on_buf[i] = true;
+
+		if( SHOW_SENSOR_OUTPUT )
+		{
+			configPRINTF( ("\r\nDPS368 Pair #%u: dP=%.2f Pa, flow=%.3f m3/h, clogging=%.3f %%/h", i + 1,
+					pxSensorsData->DiffPressure.pair_buf[i], pxSensorsData->Flow.pair_buf[i], pxSensorsData->CloggingIndex.pair_buf[i]) );
+			vTaskDelay( 20 );
+		}
+	}
+
+#endif
+
+#if( SENSORS_CORRELATION_ENABLE > 0 )
+	prvCorrelationCalculation( pxSensorsData );
+#endif
+
+#if( SENSORS_CLASSIFIER_ENABLE > 0 )
+	prvClassifierCalculation( pxSensorsData );
+#endif
+} /* vSensorsDerivedCalculation */
+
+
+uint32_t ulSensorsReadErrors( void )
+{
+	return ulReadErrors;
+}
+
+
 /* Сheck the availability of the sensors to be included in the package */
 void vSensorsAvailability( InfineonSensorsData_t *pxSensorsData )
 {
@@ -1406,9 +2048,150 @@ void vSensorsAvailability( InfineonSensorsData_t *pxSensorsData )
 	for( uint8_t i = 0; i < SENSORS_NUMBER; i++ )
 	{
 		pxSensorsData->bSensorsOn.on_buf[i] = xSensor[i].bOn;
+		pxSensorsData->bSensorsReady.on_buf[i] = xWindow[i].bClosed;
+	}
+}
+
+void vSensorsSettingsGet( Settings_t *pxSettings )
+{
+	uint8_t ucPos = 0;
+
+	for( uint32_t i = 0; i < MSG_SENSOR_MAX; i++ )
+	{
+		SettingsSensor_t *pxSensor = &pxSettings->xSensor[i];
+
+		memset( pxSensor, 0, sizeof( SettingsSensor_t ) );
+		if( pbSensorBuilt[i] )
+		{
+			pxSensor->bOn = xSensor[ucPos].bOn;
+			pxSensor->ulSampleMs = xSensorRate[ucPos].ulSampleMs;
+			pxSensor->ulWindow = xSensorRate[ucPos].ulWindowLen;
+			pxSensor->ulSendMs = xSensorRate[ucPos].ulSendMs;
+			ucPos++;
+		}
+	}
+}
+
+
+/* Called by the sensors task between two reads, a window already open takes the new rates at once */
+void vSensorsSettingsSet( Settings_t *pxSettings )
+{
+	uint8_t ucPos = 0;
+
+	for( uint32_t i = 0; i < MSG_SENSOR_MAX; i++ )
+	{
+		if( !pbSensorBuilt[i] )
+		{
+			continue;
+		}
+
+		const SettingsSensor_t *pxSensor = &pxSettings->xSensor[i];
+
+		/* A sensor failed at the start stays off, it isn't initialized */
+		xSensor[ucPos].bOn = pxSensor->bOn && xSensor[ucPos].bInited;
+		xSensorRate[ucPos].ulSendMs = pxSensor->ulSendMs;
+
+		/* The microphone window is its DMA transfer and FFT size */
+		if( xSensorRate[ucPos].ulSampleMs != 0 )
+		{
+			xSensorRate[ucPos].ulSampleMs = pxSensor->ulSampleMs;
+			xSensorRate[ucPos].ulWindowLen = pxSensor->ulWindow;
+		}
+
+		ucPos++;
 	}
+
+	/* What the sensors run with, to be reported */
+	vSensorsSettingsGet( pxSettings );
 }
 
+
+/* Bit of the message_schema.h row of a sensor position */
+static uint32_t prvSensorRowBit( uint8_t ucSensor )
+{
+	uint8_t ucPos = 0;
+
+	for( uint32_t i = 0; i < MSG_SENSOR_MAX; i++ )
+	{
+		if( pbSensorBuilt[i] && ( ucPos++ == ucSensor ) )
+		{
+			return 1UL << i;
+		}
+	}
+
+	return 0;
+}
+
+
+void vSensorsSettingsLink( void )
+{
+#if( ( SENSOR_DPS368_PAIR_1_ENABLE > 0 ) || ( SENSOR_DPS368_PAIR_2_ENABLE > 0 ) )
+	uint8_t ucUp, ucDown, ucTemp, ucPress;
+
+	for( uint8_t i = 0; i < SENSORS_PAIR_NUMBER; i++ )
+	{
+		if( prvDps368Position( xSensorPair[i].ucUpstream, &ucUp, &ucTemp, &ucPress ) &&
+			prvDps368Position( xSensorPair[i].ucDownstream, &ucDown, &ucTemp, &ucPress ) )
+		{
+			( void )SETTINGS_bLink( prvSensorRowBit( ucUp ) | prvSensorRowBit( ucDown ) );
+		}
+	}
+#endif
+
+#if( SENSORS_CORRELATION_ENABLE > 0 )
+	uint32_t ulRows = 0;
+
+	for( uint8_t i = 0; i < CORR_CHANNELS_NUMBER; i++ )
+	{
+		ulRows |= prvSensorRowBit( xCorrChannel[i].ucSensor );
+	}
+	( void )SETTINGS_bLink( ulRows );
+#endif
+}
+
+
+/* Latest read of the parameter in its window, one per read of the sensor */
+bool bSensorsSampleNew( uint8_t ucParameter, const InfineonSensorsData_t *pxSensorsData, uint32_t *pulTick, float *pfValue )
+{
+	uint8_t ucSensor = 0;
+	uint8_t ucVector = 0;
+
+	if( ( ucParameter >= MSG_PARAMETER_MAX ) || !pbSensorBuilt[pucParameterSensor[ucParameter]] )
+	{
+		ucCaptureSensor = SENSORS_NUMBER;
+		return false;
+	}
+
+	for( uint8_t i = 0; i < pucParameterSensor[ucParameter]; i++ )
+	{
+		ucSensor += pbSensorBuilt[i];
+	}
+	for( uint8_t i = 0; i < ucParameter; i++ )
+	{
+		ucVector += pbSensorBuilt[pucParameterSensor[i]];
+	}
+
+	/* Reads of the sensor are taken from the next one on */
+	if( ucSensor != ucCaptureSensor )
+	{
+		ucCaptureSensor = ucSensor;
+		bCaptureNew = false;
+		return false;
+	}
+
+	if( ( xSensorRate[ucSensor].ulSampleMs == 0 ) || !xSensor[ucSensor].bOn || !bCaptureNew )
+	{
+		return false;
+	}
+
+	bCaptureNew = false;
+	*pulTick = ulCaptureLast;
+	*pfValue = pxSensorsData->fSensorsVector.vector[ucVector][ulCapturePos];
+
+	return true;
+}
+
+
 /* Reset secure element Optiga TrustM */
 void vOptigaReset( void )
 {
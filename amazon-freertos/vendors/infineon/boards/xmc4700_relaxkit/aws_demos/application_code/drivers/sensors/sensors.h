@@ -28,6 +28,7 @@
 #include "app_types.h"
 
 #include "sensors_config.h"
+#include "settings.h"
 
 
 #define SENSORS_VECTOR_LEN				( 256 )
@@ -233,6 +234,46 @@ enum SENSORS_SPECTRA_POSITION_IN_VECTOR {
 	SENSORS_SPECTRA_NUMBER
 };
 
+enum SENSORS_EDGE_POSITION_IN_VECTOR {
+
+/* Hall switches with edge capture */
+
+#if( SENSOR_TLE4964_1_ENABLE > 0 )
+	TLE4964_EDGE_1,
+#endif
+
+#if( SENSOR_TLE4961_3K_1_ENABLE > 0 )
+	TLE49613K_EDGE_1,
+#endif
+
+#if( SENSOR_TLE4913_1_ENABLE > 0 )
+	TLE4913_EDGE_1,
+#endif
+
+#if( SENSOR_TLE4961_1K_1_ENABLE > 0 )
+	TLE49611K_EDGE_1,
+#endif
+
+/* Max edge capture sensors number of user configure */
+	SENSORS_EDGE_NUMBER
+};
+
+enum SENSORS_PAIR_POSITION_IN_VECTOR {
+
+/* Differential pressure pairs of DPS368 sensors */
+
+#if( SENSOR_DPS368_PAIR_1_ENABLE > 0 )
+	DPS368_PAIR_1,
+#endif
+
+#if( SENSOR_DPS368_PAIR_2_ENABLE > 0 )
+	DPS368_PAIR_2,
+#endif
+
+/* Max differential pressure pairs number of user configure */
+	SENSORS_PAIR_NUMBER
+};
+
 
 enum SENSORS_NUMBER_ATTEMP_RESTORE {
     NONE_ATTEMPT = 0,
@@ -241,23 +282,52 @@ enum SENSORS_NUMBER_ATTEMP_RESTORE {
 };
 
 
-/* Ticks count maybe more than 256 SENSORS_VECTOR_LEN */
-typedef struct { float vector[PARAMETERS_NUMBER][SENSORS_VECTOR_LEN]; } 		SensorsVector_t;	/* Temp Sensors Vector */
+/* Sampling and reporting of one sensor, see sensors_config.h */
+typedef struct {
+	uint32_t ulSampleMs;		/* Time between two reads */
+	uint32_t ulWindowLen;		/* Max samples in the window */
+	uint32_t ulSendMs;			/* Window length in time */
+} SensorRate_t;
+
+/* Ticks count maybe more than 256 SENSORS_VECTOR_LEN, the position after the window takes the reads of the captured sensor past it */
+#define SENSORS_VECTOR_SPARE			( SENSORS_VECTOR_LEN )
+typedef struct { float vector[PARAMETERS_NUMBER][SENSORS_VECTOR_LEN + 1]; } 	SensorsVector_t;	/* Temp Sensors Vector */
 typedef struct { float adc_raw_buf[SENSORS_VECTOR_LEN]; } 						ADCRawBuf_t; 		/* Raw Data from ADC sensors */
 typedef struct { int16_t mic_fft_buf[SENSORS_VECTOR_LEN / 2]; } 				MICFftBuf_t; 		/* FFT Data from Microphone */
 typedef struct { float stat_buf[PARAMETERS_NUMBER]; } 							StatBuf_t;			/* Temp Statistic */
 typedef struct { bool on_buf[SENSORS_NUMBER]; } 								OnBuf_t;			/* Temp Statistic */
+typedef struct { float edge_buf[SENSORS_EDGE_NUMBER]; } 						EdgeBuf_t;			/* Hall switch edge statistic */
+typedef struct { uint32_t count_buf[SENSORS_EDGE_NUMBER]; } 					CountBuf_t;			/* Hall switch pulse count */
+typedef struct { float pair_buf[SENSORS_PAIR_NUMBER]; } 						PairBuf_t;			/* DPS368 pair derived value */
+typedef struct { bool pair_on_buf[SENSORS_PAIR_NUMBER]; } 						PairOnBuf_t;		/* DPS368 pair availability */
 
 
 /* Data type to collect data from sensors */
 typedef struct {
 	OnBuf_t bSensorsOn;
+	OnBuf_t bSensorsReady;
 	StatBuf_t Min;
 	StatBuf_t Max;
 	StatBuf_t Mean;
 	StatBuf_t Rms;
 	StatBuf_t StdDev;
 	StatBuf_t Variance;
+	EdgeBuf_t Frequency;
+	EdgeBuf_t DutyCycle;
+	CountBuf_t PulseCount;
+	EdgeBuf_t DwellOn;
+	EdgeBuf_t DwellOff;
+	PairOnBuf_t bPairsOn;
+	PairOnBuf_t bPairsReady;
+	PairBuf_t DiffPressure;
+	PairBuf_t Flow;
+	PairBuf_t CloggingIndex;
+	bool bCorrelationOn;
+	bool bCorrelationReady;
+	CorrelationData_t xCorrelation;
+	bool bClassifierOn;
+	bool bClassifierReady;
+	ClassifierData_t xClassifier;
 	ADCRawBuf_t fCurrentBuffer1;
 	ADCRawBuf_t fCurrentBuffer2;
 	ADCRawBuf_t fCurrentBuffer3;
@@ -274,11 +344,29 @@ void vSensorsOff( void );
 void vSensorsPreInit( void );
 void vSensorsInit( void );
 void vSensorsDeInit( void );
+/** read the sensors whose sample time has come, ulTicks is the current RTOS tick */
 void vSensorsRead( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks );
+/** close the windows whose send period has passed, true if at least one closed */
+bool bSensorsWindowClose( uint32_t ulTicks );
+/** start new windows for the closed ones */
+void vSensorsWindowRestart( uint32_t ulTicks );
 void vNonTickSensorsRead( InfineonSensorsData_t *pxSensorsData );
-int32_t lSensorsReadErrorCheck( uint32_t ulTicks );
-void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData, uint32_t ulTicks );
+int32_t lSensorsReadErrorCheck( void );
+/** failed reads of the windows checked since the start */
+uint32_t ulSensorsReadErrors( void );
+void vSensorsStatCalculation( InfineonSensorsData_t *pxSensorsData );
+/** DPS368 pairs, correlation of parameters and classifier, after the statistic */
+void vSensorsDerivedCalculation( InfineonSensorsData_t *pxSensorsData );
 void vSensorsAvailability( InfineonSensorsData_t *pxSensorsData );
+/** rates and on state of the sensors by message_schema.h row, sensors not built in have ulSendMs 0 */
+void vSensorsSettingsGet( Settings_t *pxSettings );
+/** takes the settings the sensors can run with, pxSettings is updated to what they run with */
+void vSensorsSettingsSet( Settings_t *pxSettings );
+/** links the sensors whose samples are combined, DPS368 pairs and correlation channels, in the settings */
+void vSensorsSettingsLink( void );
+/** sample of the parameter read since the last call, false if none or for the microphone, whose samples come by DMA;
+ *  from the next read on its sensor is read at its sample period also while its window is full or closed */
+bool bSensorsSampleNew( uint8_t ucParameter, const InfineonSensorsData_t *pxSensorsData, uint32_t *pulTick, float *pfValue );
 
 /** turn off sensors and reset system */
 void vFullReset( AppError_t xErrorReason );
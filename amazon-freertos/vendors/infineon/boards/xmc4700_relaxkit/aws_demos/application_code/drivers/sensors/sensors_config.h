@@ -67,4 +67,95 @@
 #define SENSOR_TLI493D_1_ENABLE     ( 1 )
 
 
+/**
+ *  Sampling and reporting per sensor type
+ *  _SAMPLE_MS - time between two reads, ms (not used by the microphone, it is sampled by I2S)
+ *  _WINDOW    - max samples in one statistic window, not more than SENSORS_VECTOR_LEN
+ *  _SEND_MS   - window length in time, the sensor is reported when its window closes
+ */
+
+/* Pressure and Temperature sensors, slow process */
+#define SENSOR_DPS368_SAMPLE_MS     ( 100 )
+#define SENSOR_DPS368_WINDOW        ( 50 )
+#define SENSOR_DPS368_SEND_MS       ( 5000 )
+
+/* Magnetic Current sensors */
+#define SENSOR_TLI4971_SAMPLE_MS    ( 1 )
+#define SENSOR_TLI4971_WINDOW       ( 256 )
+#define SENSOR_TLI4971_SEND_MS      ( 1000 )
+
+/* Linear Hall sensor */
+#define SENSOR_TLE4997_SAMPLE_MS    ( 1 )
+#define SENSOR_TLE4997_WINDOW       ( 256 )
+#define SENSOR_TLE4997_SEND_MS      ( 1000 )
+
+/* Hall switches, edges are timestamped separately */
+#define SENSOR_TLE496X_SAMPLE_MS    ( 1 )
+#define SENSOR_TLE496X_WINDOW       ( 256 )
+#define SENSOR_TLE496X_SEND_MS      ( 1000 )
+
+/* Double Hall speed, the driver updates speed once in ~1 second */
+#define SENSOR_TLI4966_SAMPLE_MS    ( 1000 )
+#define SENSOR_TLI4966_WINDOW       ( 1 )
+#define SENSOR_TLI4966_SEND_MS      ( 1000 )
+
+/* Microphone */
+#define SENSOR_IM69D130_WINDOW      ( 256 )
+#define SENSOR_IM69D130_SEND_MS     ( 1000 )
+
+/* 3D Magnetic sensors */
+#define SENSOR_TLI493D_SAMPLE_MS    ( 10 )
+#define SENSOR_TLI493D_WINDOW       ( 100 )
+#define SENSOR_TLI493D_SEND_MS      ( 1000 )
+
+
+/**
+ *  Differential pressure pairs of DPS368 sensors
+ *  _ENABLE     - 0 disabled, 1 enabled, 2 derived values printf
+ *  _UPSTREAM   - DPS368 number ( 1..5 ) before the filter or duct
+ *  _DOWNSTREAM - DPS368 number ( 1..5 ) after the filter or duct
+ *  _FLOW_K     - discharge coefficient * flow area, m^2
+ *  Both sensors of a pair should be enabled, the pair is reported with the DPS368 window
+ */
+#define SENSOR_DPS368_PAIR_1_ENABLE       ( 1 )
+#define SENSOR_DPS368_PAIR_1_UPSTREAM     ( 1 )
+#define SENSOR_DPS368_PAIR_1_DOWNSTREAM   ( 2 )
+#define SENSOR_DPS368_PAIR_1_FLOW_K       ( 0.01f )
+
+#define SENSOR_DPS368_PAIR_2_ENABLE       ( 1 )
+#define SENSOR_DPS368_PAIR_2_UPSTREAM     ( 3 )
+#define SENSOR_DPS368_PAIR_2_DOWNSTREAM   ( 4 )
+#define SENSOR_DPS368_PAIR_2_FLOW_K       ( 0.01f )
+
+/* Clogging trend: one regression point per _DECIMATION DPS368 windows, _POINTS points in the sliding window */
+#define SENSOR_DPS368_TREND_DECIMATION    ( 12 )
+#define SENSOR_DPS368_TREND_POINTS        ( 120 )
+
+
+/**
+ *  Correlation of parameters over one window
+ *  _ENABLE     - 0 disabled, 1 enabled, 2 matrix printf
+ *  _CHANNELS   - { sensor, parameter } from sensors.h, not more than 8, all sensors should be enabled
+ *                and sampled with the same period, the shortest window of them is used
+ *  _LAG_PAIRS  - { channel, channel } indexes in _CHANNELS for lagged cross-correlation, not more than 4
+ *  _MAX_LAG    - lags searched for the peak, samples
+ */
+#define SENSORS_CORRELATION_ENABLE        ( 1 )
+#define SENSORS_CORRELATION_CHANNELS      { { TLI4971_1, TLI4971_CURRENT_1 }, { TLI4971_2, TLI4971_CURRENT_2 }, \
+                                            { TLI4971_3, TLI4971_CURRENT_3 }, { TLE4997_1, TLE4997_LINEAR_HALL_1 } }
+#define SENSORS_CORRELATION_LAG_PAIRS     { { 0, 3 }, { 1, 3 }, { 2, 3 } }
+#define SENSORS_CORRELATION_MAX_LAG       ( 32 )
+
+
+/**
+ *  int8 classifier of the window, model from flash or loaded with CLASSIFIER_lLoad
+ *  _ENABLE          - 0 disabled, 1 enabled, 2 result printf
+ *  _SPECTRAL_BANDS  - microphone spectrum bands in the features
+ *  Features: Mean and StdDev of every parameter in sensors.h order, then the mean magnitude
+ *  of each microphone spectrum band, the model inputs should match the count
+ */
+#define SENSORS_CLASSIFIER_ENABLE         ( 1 )
+#define SENSORS_CLASSIFIER_SPECTRAL_BANDS ( 8 )
+
+
 #endif /* SENSORS_CONFIG_H */
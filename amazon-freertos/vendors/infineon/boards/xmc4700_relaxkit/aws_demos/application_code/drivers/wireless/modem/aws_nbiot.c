@@ -88,6 +88,7 @@ static int prvModemAttach( void );
 static int prvModemDeattach( void );
 static int prvModemAttachStatus( void );
 static int prvModemSignalQuality( void );
+static int prvModemServingSignal( void );
 static int prvModemNetworkRegistrationStatus( void );
 static int prvModemCurrentOperator( void );
 static int prvModemPutOnline( void );
@@ -101,6 +102,7 @@ static int prvModemInit( int lMode );
 static int prvModemConnect( int lContextID, char *pcApn, char *pcUserName, char *pcPass, int lProtocolType, int lAuthMethod );
 static void prvModemPrintStatus( void );
 static void prvModemClearStatus( void );
+static void prvUrcCheck( const char *pcLine, int lLength );
 
 static bool  prvCompareTimeval( TickType_t xTime, int lThresholdTick );
 
@@ -119,6 +121,9 @@ typedef struct
 
 ModemStatus_t xModemStatus;
 
+/* Set by the URCs of a connection the network closed, read and cleared by NBIOT_bLinkClosed() */
+static volatile bool bLinkClosed = false;
+
 
 /**
   * @brief  5V power on for mBUS
@@ -544,6 +549,7 @@ static uint32_t prvLookForUnsolicited( char * pcLine, int lLength )
 	{
 		if( strncmp((char*)&pcLine[lStart], "OK", strlen("OK")) != 0 )
 		{
+			prvUrcCheck( &pcLine[lStart], lLen );
 			memcpy( &xModemStatus.pucValue[xModemStatus.lCount][0], &pcLine[lStart], lLen );
 			xModemStatus.lCount++;
 			ulRet = 1;
@@ -554,6 +560,26 @@ static uint32_t prvLookForUnsolicited( char * pcLine, int lLength )
 	return ulRet;
 }
 
+/**
+  * @brief  Function notes the URCs of a socket closed or a PDP context deactivated by the network
+  * @param  pcLine pointer to the line, not terminated
+  * @param  lLength length of the line
+  * @retval none
+  */
+static void prvUrcCheck( const char *pcLine, int lLength )
+{
+	const char * ppcLost[] = { "+QIURC: \"closed\"", "+QSSLURC: \"closed\"", "+QIURC: \"pdpdeact\"" };
+
+	for( int i = 0; i < sizeof( ppcLost ) / sizeof( ppcLost[ 0 ] ); i++ )
+	{
+		int lLen = strlen( ppcLost[ i ] );
+		if( ( lLength >= lLen ) && ( strncmp( pcLine, ppcLost[ i ], lLen ) == 0 ) )
+		{
+			bLinkClosed = true;
+		}
+	}
+}
+
 /**
   * @brief  Function compares time for two rtime values against threshold in ticks
   * @param  xTime start time
@@ -951,6 +977,19 @@ static int prvModemSignalQuality( void )
 }
 
 
+/**
+  * @brief  Function read the signal of the serving cell, BG96 extension
+  * @param  none
+  * @retval zero or positive in case of parsable responses and negative in case of error
+  */
+static int prvModemServingSignal( void )
+{
+	const char * ppcResponces[] = {"OK", "+CME ERROR:", "ERROR"};
+
+	return prvPperformCommand( "AT+QCSQ", ppcResponces, sizeof(ppcResponces)/sizeof(ppcResponces[0]), NBIOT_TIMING_SEC_1 );
+}
+
+
 /**
   * @brief  Function enable modem network registration
   * @param  none
@@ -1784,6 +1823,8 @@ static int prvNbiot_SslNextRecvSocket( int lSocket, int lMaxLength, TickType_t x
         return -1;
     }
 
+    prvUrcCheck( pcBuffer, lRecvBytes );
+
     if( memcmp( pcBuffer, ppcResp[ 1 ], strlen( ppcResp[ 1 ] ) ) == 0 ) /* We have got URC that data has been received so we just ignore it */
     {
         vTaskDelay( 3 );
@@ -1805,6 +1846,7 @@ static int prvNbiot_SslNextRecvSocket( int lSocket, int lMaxLength, TickType_t x
     {
         if( memcmp( pcBuffer, "+QSSLURC: closed", strlen("+QSSLURC: closed") ) == 0 )
         {
+            bLinkClosed = true;
             configPRINTF( ( "ERROR: nbiot_tcp_recv_socket_next, cannot extract the amount of data r\n" ) );
             return NBIOT_ERROR_NO_CONNECTION;
         }
@@ -2125,6 +2167,8 @@ static int nbiot_tcp_recv_socket_next( uint8_t usSocket,
         return -1;
     }
 
+    prvUrcCheck( (char*)pcBuffer, lRecvBytes );
+
     if( memcmp( pcBuffer, pcResp[ 1 ], strlen( pcResp[ 1 ] ) ) == 0 ) /* We have got URC that data has been received so we just ignore it */
     {
         vTaskDelay( 3 );
@@ -2456,6 +2500,71 @@ status_t NBIOT_xGetRssi( int16_t *psRSSIdBm )
     return lRet;
 }
 
+/**
+ * Returns the reference signal received power of the serving LTE cell in dBm
+ * @param pointer to psRSRPdBm for value return. Value 0 - if there is no eMTC or NB-IoT service.
+ * @return status_t kStatus_Success in case of successful and value >0 in the case of error
+ */
+status_t NBIOT_xGetRsrp( int16_t *psRSRPdBm )
+{
+	/* +QCSQ: "NBIoT",<rssi>,<rsrp>,<sinr>,<rsrq>, the same for "eMTC" */
+	const char * pcFormat = "+QCSQ: \"%7[^\"]\",%d,%d";
+    int lRet = 0;
+    char pcMode[8] = { 0 };
+    int lRssi = 0;
+    int lRsrp = 0;
+
+    if( psRSRPdBm == NULL) return eStatus_InvalidArgument;
+    *psRSRPdBm = 0;
+
+	if( xSemaphoreTake( xModemSemaphore, NBIOT_TIMING_SEC_150 ) != pdTRUE )
+	{
+		return eStatus_Fail;
+	}
+
+    lRet = prvModemServingSignal();
+	if( lRet == 0 )
+	{
+		lRet = eStatus_Timeout;
+		for( int i=0; i< xModemStatus.lCount; i++ )
+		{
+			if( strncmp( (const char*)&xModemStatus.pucValue[i][0], "+QCSQ:", strlen("+QCSQ:") ) != 0 )
+			{
+				continue;
+			}
+			/* "NOSERVICE" and "GSM" have no RSRP */
+			if( ( sscanf((const char*)&xModemStatus.pucValue[i][0], pcFormat, pcMode, &lRssi, &lRsrp) == 3 ) &&
+				( ( strcmp( pcMode, "NBIoT" ) == 0 ) || ( strcmp( pcMode, "eMTC" ) == 0 ) ) )
+			{
+				*psRSRPdBm = ( int16_t )lRsrp;
+			}
+			lRet = eStatus_Success;
+			break;
+		}
+	}
+	else
+	{
+		lRet = eStatus_Fail;
+	}
+    xSemaphoreGive( xModemSemaphore );
+
+    return lRet;
+}
+
+/**
+ * Tells if the modem reported a connection closed by the network since the last call
+ * @return true after a "closed" or "pdpdeact" URC
+ */
+bool NBIOT_bLinkClosed( void )
+{
+	taskENTER_CRITICAL();
+	bool bClosed = bLinkClosed;
+	bLinkClosed = false;
+	taskEXIT_CRITICAL();
+
+	return bClosed;
+}
+
 /**
   * @brief  Function write file to the modem UFS
   * @param  pcName pointer to the name file.
@@ -154,6 +154,8 @@ bool NBIOT_bInit( void );
 bool NBIOT_bDisable( void );
 status_t NBIOT_xTcpPing( uint8_t ucContextID, uint8_t * pcAddress );
 status_t NBIOT_xGetRssi( int16_t * psRSSIdBm );
+status_t NBIOT_xGetRsrp( int16_t * psRSRPdBm );
+bool NBIOT_bLinkClosed( void );
 int NBIOT_lGetIpFromName( int lContextID, const char *pcName, char *pcIp );
 
 /* Work with configure SSL */
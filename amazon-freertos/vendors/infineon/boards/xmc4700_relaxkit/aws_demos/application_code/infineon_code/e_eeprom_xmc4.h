@@ -70,6 +70,11 @@
  * MACROS
  **********************************************************************************************************************/
 
+/* Bytes of the block in use, every caller of E_EEPROM_XMC4_Init passes the same: the PKCS #11 objects from 0 on,
+ * the shadow settings from E_EEPROM_XMC4_SETTINGS_OFFSET on */
+#define E_EEPROM_XMC4_DATA_LEN         (8176U)
+#define E_EEPROM_XMC4_SETTINGS_OFFSET  (7168U)
+
 /**********************************************************************************************************************
 * ENUMS
 **********************************************************************************************************************/
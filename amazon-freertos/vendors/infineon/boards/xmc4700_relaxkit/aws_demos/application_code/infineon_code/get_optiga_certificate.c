@@ -58,10 +58,20 @@
 
 /* mbedTLS includes. */
 #include "mbedtls/base64.h"
+#include "mbedtls/ssl.h"
+
+/* Size of the capture chunks of the MQTT task. */
+#include "mqtt_task.h"
+#include "dbg.h"
 
 /* Default FreeRTOS API for console logging. */
 #define GET_OPTIGA_CERTIFICATE_PRINT( X )    vLoggingPrintf X
 
+#if( mqtttaskCAPTURE_ENABLE > 0 )
+/* A capture chunk with its MQTT header, topic of up to 200 bytes included, goes out in one TLS record */
+STATIC_ASSERT( ( mqtttaskCAPTURE_CHUNK_SIZE + 256 ) <= MBEDTLS_SSL_MAX_CONTENT_LEN, capture_chunk_exceeds_tls_record );
+#endif
+
 
 
 
@@ -105,6 +105,16 @@
 #include "dps368_test/dps368_test.h"
 #include "tli493d_test/tli493d_test.h"
 #include "tlx4966_test/tlx4966_test.h"
+#include "diff_pressure_test/diff_pressure_test.h"
+#include "cbor_sensor_test/cbor_sensor_test.h"
+#include "msg_pool_test/msg_pool_test.h"
+#include "report_test/report_test.h"
+#include "batch_test/batch_test.h"
+#include "adapt_test/adapt_test.h"
+#include "dns_cache_test/dns_cache_test.h"
+#include "latency_test/latency_test.h"
+#include "capture_test/capture_test.h"
+#include "metrics_test/metrics_test.h"
 #endif
 
 /* Logging Task Defines */
@@ -280,6 +290,27 @@ void vApplicationDaemonTaskStartupHook( void )
 	/* testing JSON */
  	JSON_bSensorsShortTest();
  	JSON_bSensorsFullTest();
+ 	JSON_bSensorsFlushTest();
+ 	/* testing CBOR */
+ 	CBOR_bTest();
+ 	/* testing differential pressure analytics */
+ 	DIFFP_bTest();
+ 	/* testing message buffers handoff */
+ 	MSG_POOL_bTest();
+ 	/* testing deadband filter */
+ 	REPORT_bTest();
+ 	/* testing multi-window payloads */
+ 	BATCH_bTest();
+ 	/* testing link quality controller */
+ 	ADAPT_bTest();
+ 	/* testing broker address cache */
+ 	DNS_CACHE_bTest();
+ 	/* testing stage latency histograms */
+ 	LATENCY_bTest();
+ 	/* testing raw sample capture */
+ 	CAPTURE_bTest();
+ 	/* testing Device Defender metrics */
+ 	METRICS_bTest();
  	/* Switch on sensors power supply */
  	vSensorsOn();
  	/* testing Sensors */
@@ -0,0 +1,132 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#ifndef MESSAGE_SCHEMA_H
+#define MESSAGE_SCHEMA_H
+
+
+/**
+ * Rows of the message, each table is expanded with a macro X taking the row's columns.
+ * Adding a sensor is one MSG_SENSORS row and one MSG_PARAMETERS row per parameter;
+ * the message struct, the copy from InfineonSensorsData_t, the payload keys and every
+ * encoder follow. Rows are in the order of the sensors.h position enums, converting.c
+ * checks the counts.
+ */
+
+/**
+ * X( sensor ) - SENSOR_<sensor>_ENABLE of sensors_config.h, availability flags of its parameters
+ */
+#define MSG_SENSORS( X ) \
+	X( DPS368_1 ) \
+	X( DPS368_2 ) \
+	X( DPS368_3 ) \
+	X( DPS368_4 ) \
+	X( DPS368_5 ) \
+	X( TLI4971_1 ) \
+	X( TLI4971_2 ) \
+	X( TLI4971_3 ) \
+	X( TLE4997_1 ) \
+	X( TLE4964_1 ) \
+	X( TLE4961_3K_1 ) \
+	X( TLE4913_1 ) \
+	X( TLE4961_1K_1 ) \
+	X( TLI4966_1 ) \
+	X( IM69D130 ) \
+	X( TLI493D_1 )
+
+/**
+ * X( id, name, sensor, precision, unit, deadband, relative ) - statistic of one parameter, in the payload order
+ *   id        - JSON_STATISTIC_SENSOR_<id>, also the integer key of binary payloads
+ *   name      - JSON key
+ *   sensor    - MSG_SENSORS row
+ *   precision - digits after the point in JSON
+ *   unit      - of the values, for the reader of the payload, not sent
+ *   deadband  - mean or standard deviation change in unit below which the parameter is not reported, report.h
+ *   relative  - the same in % of the last reported value, the larger band of the two applies
+ */
+#define MSG_PARAMETERS( X ) \
+	X( DPS368_TEMP_1,					DPS368Temperature_1,		DPS368_1,		2,	"degC",			0.1f,	0 ) \
+	X( DPS368_PRESS_1,					DPS368Pressure_1,			DPS368_1,		2,	"Pa",			2.0f,	0 ) \
+	X( DPS368_TEMP_2,					DPS368Temperature_2,		DPS368_2,		2,	"degC",			0.1f,	0 ) \
+	X( DPS368_PRESS_2,					DPS368Pressure_2,			DPS368_2,		2,	"Pa",			2.0f,	0 ) \
+	X( DPS368_TEMP_3,					DPS368Temperature_3,		DPS368_3,		2,	"degC",			0.1f,	0 ) \
+	X( DPS368_PRESS_3,					DPS368Pressure_3,			DPS368_3,		2,	"Pa",			2.0f,	0 ) \
+	X( DPS368_TEMP_4,					DPS368Temperature_4,		DPS368_4,		2,	"degC",			0.1f,	0 ) \
+	X( DPS368_PRESS_4,					DPS368Pressure_4,			DPS368_4,		2,	"Pa",			2.0f,	0 ) \
+	X( DPS368_TEMP_5,					DPS368Temperature_5,		DPS368_5,		2,	"degC",			0.1f,	0 ) \
+	X( DPS368_PRESS_5,					DPS368Pressure_5,			DPS368_5,		2,	"Pa",			2.0f,	0 ) \
+	X( TLI4971_CURRENT_1,				TLI4971Current_1,			TLI4971_1,		4,	"A",			0.01f,	2 ) \
+	X( TLI4971_CURRENT_2,				TLI4971Current_2,			TLI4971_2,		4,	"A",			0.01f,	2 ) \
+	X( TLI4971_CURRENT_3,				TLI4971Current_3,			TLI4971_3,		4,	"A",			0.01f,	2 ) \
+	X( TLE4997_LINEAR_HALL_1,			TLE4997LinearHall_1,		TLE4997_1,		2,	"%",			0.5f,	0 ) \
+	X( TLE4964_HALL_SWITCH_1,			TLE4964Hall_1,				TLE4964_1,		3,	"state",		0.05f,	0 ) \
+	X( TLE49613K_HALL_LATCH_1,			TLE49613kHall_1,			TLE4961_3K_1,	3,	"state",		0.05f,	0 ) \
+	X( TLE4913_HALL_SWITCH_1,			TLE4913Hall_1,				TLE4913_1,		3,	"state",		0.05f,	0 ) \
+	X( TLE49611K_HALL_LATCH_1,			TLE49611kHall_1,			TLE4961_1K_1,	3,	"state",		0.05f,	0 ) \
+	X( TLI4966G_DOUBLE_HALL_SPEED_1,	TLI4966gDoubleHall_Speed_1,	TLI4966_1,		2,	"Hz",			0.5f,	2 ) \
+	X( TLI4966G_DOUBLE_HALL_DIR_1,		TLI4966gDoubleHall_Dir_1,	TLI4966_1,		3,	"direction",	0.5f,	0 ) \
+	X( IM69D_MIC_1,						IM69dMic_1,					IM69D130,		4,	"raw",			0.0f,	5 ) \
+	X( TLI493D_MAGNETIC_X_1,			TLI493dMagnetic_X_1,		TLI493D_1,		3,	"mT",			0.05f,	2 ) \
+	X( TLI493D_MAGNETIC_Y_1,			TLI493dMagnetic_Y_1,		TLI493D_1,		3,	"mT",			0.05f,	2 ) \
+	X( TLI493D_MAGNETIC_Z_1,			TLI493dMagnetic_Z_1,		TLI493D_1,		3,	"mT",			0.05f,	2 )
+
+/**
+ * X( id, source, coded ) - spectrum sent with the parameter id
+ *   source - InfineonSensorsData_t buffer, copied as it is
+ *   coded  - spectrum_codec.h frame in binary payloads; the TLE4997 buffer holds raw samples and stays lossless
+ */
+#define MSG_SPECTRA( X ) \
+	X( IM69D_MIC_1,						fMicBuffer,		1 ) \
+	X( TLE4997_LINEAR_HALL_1,			fHallBuffer,	0 )
+
+/**
+ * X( id, sensor ) - edge timing sent with the parameter id, in the order of SENSORS_EDGE_POSITION_IN_VECTOR
+ */
+#define MSG_EDGES( X ) \
+	X( TLE4964_HALL_SWITCH_1,			TLE4964_1 ) \
+	X( TLE49613K_HALL_LATCH_1,			TLE4961_3K_1 ) \
+	X( TLE4913_HALL_SWITCH_1,			TLE4913_1 ) \
+	X( TLE49611K_HALL_LATCH_1,			TLE4961_1K_1 )
+
+/**
+ * X( id, name, sensor ) - differential pressure pair, payload entries after the parameters
+ */
+#define MSG_PAIRS( X ) \
+	X( DPS368_PAIR_1,					DPS368Pair_1,				DPS368_PAIR_1 ) \
+	X( DPS368_PAIR_2,					DPS368Pair_2,				DPS368_PAIR_2 )
+
+
+#define MSG_SENSOR_ENUM( sensor )			MSG_SENSOR_##sensor,
+#define MSG_PARAMETER_ENUM( id, ... )		MSG_PARAMETER_##id,
+#define MSG_SPECTRUM_ENUM( id, ... )		MSG_SPECTRUM_##id,
+#define MSG_EDGE_ENUM( id, ... )			MSG_EDGE_##id,
+#define MSG_PAIR_ENUM( id, ... )			MSG_PAIR_##id,
+
+typedef enum { MSG_SENSORS( MSG_SENSOR_ENUM ) MSG_SENSOR_MAX } MsgSensor_t;
+typedef enum { MSG_PARAMETERS( MSG_PARAMETER_ENUM ) MSG_PARAMETER_MAX } MsgParameter_t;
+typedef enum { MSG_SPECTRA( MSG_SPECTRUM_ENUM ) MSG_SPECTRUM_MAX } MsgSpectrum_t;
+typedef enum { MSG_EDGES( MSG_EDGE_ENUM ) MSG_EDGE_MAX } MsgEdge_t;
+typedef enum { MSG_PAIRS( MSG_PAIR_ENUM ) MSG_PAIR_MAX } MsgPair_t;
+
+
+#endif /* MESSAGE_SCHEMA_H */
@@ -0,0 +1,202 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <string.h>
+
+#include "adapt.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+
+/* Policy before ADAPT_vInit, 0 windows a batch leaves the batch size to the MQTT task */
+static const AdaptPolicy_t xAdaptDefault = { 1, 0, MSG_DETAIL_FULL };
+
+static const AdaptConfig_t *pxAdaptConfig = NULL;
+static AdaptStat_t xAdaptStat;
+static bool bSignalKnown = false;
+static bool bLatencyKnown = false;
+/* Updates at a better level so far */
+static uint8_t ucAdaptBetter = 0;
+/* Routine windows since the last one published, sensors task only */
+static uint8_t ucAdaptWindows = 0;
+
+
+/* First sample as it is, then the running average */
+static int32_t prvAverage( bool *pbKnown, int32_t lAverage, int32_t lSample )
+{
+	if( !*pbKnown )
+	{
+		*pbKnown = true;
+		return lSample;
+	}
+
+	return lAverage + ( lSample - lAverage ) / ADAPT_AVERAGE_WEIGHT;
+}
+
+
+/* Level of a value that gets worse as it grows */
+static AdaptLink_t prvLevel( uint32_t ulValue, uint32_t ulFair, uint32_t ulPoor )
+{
+	if( ulValue >= ulPoor )
+	{
+		return ADAPT_LINK_POOR;
+	}
+	if( ulValue >= ulFair )
+	{
+		return ADAPT_LINK_FAIR;
+	}
+
+	return ADAPT_LINK_GOOD;
+}
+
+
+void ADAPT_vInit( const AdaptConfig_t *pxConfig )
+{
+	taskENTER_CRITICAL();
+	memset( &xAdaptStat, 0, sizeof( xAdaptStat ) );
+	bSignalKnown = false;
+	bLatencyKnown = false;
+	ucAdaptBetter = 0;
+	ucAdaptWindows = 0;
+	pxAdaptConfig = pxConfig;
+	taskEXIT_CRITICAL();
+}
+
+
+void ADAPT_vSignal( int16_t sDbm )
+{
+	if( sDbm == 0 )
+	{
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	xAdaptStat.sSignal = ( int16_t )prvAverage( &bSignalKnown, xAdaptStat.sSignal, sDbm );
+	taskEXIT_CRITICAL();
+}
+
+
+void ADAPT_vLatency( uint32_t ulMs )
+{
+	taskENTER_CRITICAL();
+	xAdaptStat.ulLatency = ( uint32_t )prvAverage( &bLatencyKnown, ( int32_t )xAdaptStat.ulLatency, ( int32_t )ulMs );
+	taskEXIT_CRITICAL();
+}
+
+
+bool ADAPT_bUpdate( uint32_t ulBacklog )
+{
+	const AdaptConfig_t *pxConfig = pxAdaptConfig;
+	AdaptLink_t xLevel = ADAPT_LINK_GOOD;
+	AdaptLink_t xLevelOf;
+	bool bChanged = false;
+
+	if( pxConfig == NULL )
+	{
+		return false;
+	}
+
+	taskENTER_CRITICAL();
+	xAdaptStat.ulBacklog = ulBacklog;
+	xAdaptStat.ulUpdates++;
+
+	if( bSignalKnown && ( xAdaptStat.sSignal < pxConfig->sSignalPoor ) )
+	{
+		xLevel = ADAPT_LINK_POOR;
+	}
+	else if( bSignalKnown && ( xAdaptStat.sSignal < pxConfig->sSignalFair ) )
+	{
+		xLevel = ADAPT_LINK_FAIR;
+	}
+	if( bLatencyKnown )
+	{
+		xLevelOf = prvLevel( xAdaptStat.ulLatency, pxConfig->ulLatencyFair, pxConfig->ulLatencyPoor );
+		xLevel = ( xLevelOf > xLevel ) ? xLevelOf : xLevel;
+	}
+	xLevelOf = prvLevel( ulBacklog, pxConfig->ulBacklogFair, pxConfig->ulBacklogPoor );
+	xLevel = ( xLevelOf > xLevel ) ? xLevelOf : xLevel;
+
+	/* Down at once so the device doesn't fall behind, up step by step so it doesn't flap */
+	if( xLevel > xAdaptStat.xLink )
+	{
+		xAdaptStat.xLink = xLevel;
+		ucAdaptBetter = 0;
+		bChanged = true;
+	}
+	else if( ( xLevel < xAdaptStat.xLink ) && ( ++ucAdaptBetter >= pxConfig->ucHold ) )
+	{
+		xAdaptStat.xLink--;
+		ucAdaptBetter = 0;
+		bChanged = true;
+	}
+	else if( xLevel == xAdaptStat.xLink )
+	{
+		ucAdaptBetter = 0;
+	}
+
+	if( bChanged )
+	{
+		xAdaptStat.ulChanges++;
+	}
+	taskEXIT_CRITICAL();
+
+	return bChanged;
+}
+
+
+void ADAPT_vPolicyGet( AdaptPolicy_t *pxPolicy )
+{
+	taskENTER_CRITICAL();
+	*pxPolicy = ( pxAdaptConfig != NULL ) ? pxAdaptConfig->xPolicy[xAdaptStat.xLink] : xAdaptDefault;
+	taskEXIT_CRITICAL();
+}
+
+
+bool ADAPT_bWindowDue( bool bAlarm )
+{
+	AdaptPolicy_t xPolicy;
+
+	ADAPT_vPolicyGet( &xPolicy );
+
+	/* The count starts again after every published window */
+	if( bAlarm || ( ++ucAdaptWindows >= xPolicy.ucInterval ) )
+	{
+		ucAdaptWindows = 0;
+		return true;
+	}
+
+	taskENTER_CRITICAL();
+	xAdaptStat.ulSkipped++;
+	taskEXIT_CRITICAL();
+
+	return false;
+}
+
+
+void ADAPT_vStatGet( AdaptStat_t *pxStat )
+{
+	taskENTER_CRITICAL();
+	*pxStat = xAdaptStat;
+	taskEXIT_CRITICAL();
+}
@@ -0,0 +1,101 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#ifndef ADAPT_H
+#define ADAPT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "app_types.h"
+
+
+/* Weight of a new sample in the averages, 1 / ADAPT_AVERAGE_WEIGHT */
+#define ADAPT_AVERAGE_WEIGHT		( 4 )
+
+
+typedef enum {
+	ADAPT_LINK_GOOD = 0,
+	ADAPT_LINK_FAIR,
+	ADAPT_LINK_POOR,
+	ADAPT_LINK_LEVELS
+
+} AdaptLink_t;
+
+
+/* What goes out at a link level */
+typedef struct {
+	uint8_t ucInterval;			/* One of this many routine windows is published, alarms always */
+	uint8_t ucBatch;			/* Windows collected into one publish where batching is built in */
+	MsgDetail_t xDetail;		/* Of the routine windows, alarms go in full */
+
+} AdaptPolicy_t;
+
+
+/* Thresholds of the inputs, the link level is the worst of the three */
+typedef struct {
+	int16_t sSignalFair;		/* dBm, Wi-Fi RSSI or LTE RSRP below it is fair at best */
+	int16_t sSignalPoor;
+	uint32_t ulLatencyFair;		/* ms from the publish to the acknowledge, from it on fair at best */
+	uint32_t ulLatencyPoor;
+	uint32_t ulBacklogFair;		/* Payloads waiting to go out, from it on fair at best */
+	uint32_t ulBacklogPoor;
+	uint8_t ucHold;				/* Updates in a row at a better level before it steps up one level, it steps down at once */
+	AdaptPolicy_t xPolicy[ADAPT_LINK_LEVELS];
+
+} AdaptConfig_t;
+
+
+typedef struct {
+	AdaptLink_t xLink;
+	int16_t sSignal;			/* Averages the level comes from, 0 while unknown */
+	uint32_t ulLatency;
+	uint32_t ulBacklog;
+	uint32_t ulUpdates;
+	uint32_t ulChanges;			/* Level changes */
+	uint32_t ulSkipped;			/* Routine windows left out by the interval */
+
+} AdaptStat_t;
+
+
+/**
+ * Link quality controller. The signal strength and the acknowledge latency are
+ * averaged, the backlog is taken as it is; the worst of them gives the level and
+ * the level the policy. Before ADAPT_vInit every window goes out in full.
+ */
+
+/** start at the good level, pxConfig is kept by pointer */
+void ADAPT_vInit( const AdaptConfig_t *pxConfig );
+/** signal strength sample, 0 for unknown is ignored */
+void ADAPT_vSignal( int16_t sDbm );
+/** time of a publish until its acknowledge, the caller counts a failed one as a long one */
+void ADAPT_vLatency( uint32_t ulMs );
+/** new level from the averages and the payloads waiting now, true if the level changed */
+bool ADAPT_bUpdate( uint32_t ulBacklog );
+void ADAPT_vPolicyGet( AdaptPolicy_t *pxPolicy );
+/** once per closed window, false for a routine window the interval leaves out */
+bool ADAPT_bWindowDue( bool bAlarm );
+void ADAPT_vStatGet( AdaptStat_t *pxStat );
+
+
+#endif /* ADAPT_H */
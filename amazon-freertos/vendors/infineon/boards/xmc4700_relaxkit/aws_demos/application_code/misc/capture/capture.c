@@ -0,0 +1,334 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#include <string.h>
+
+#include "capture.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "iot_json_utils.h"
+#include "settings.h"
+
+
+#define CAPTURE_PARAMETER_NAME( id, name, ... )				#name,
+#define CAPTURE_PARAMETER_SENSOR( id, name, sensor, ... )	MSG_SENSOR_##sensor,
+
+static const char *pcParameterName[MSG_PARAMETER_MAX] = { MSG_PARAMETERS( CAPTURE_PARAMETER_NAME ) };
+static const uint8_t pucParameterSensor[MSG_PARAMETER_MAX] = { MSG_PARAMETERS( CAPTURE_PARAMETER_SENSOR ) };
+
+
+/* Samples of the selected parameter, frozen during a transfer */
+static CaptureSample_t xRing[CAPTURE_RING_SAMPLES];
+static uint32_t ulHead = 0;					/* Next to be written */
+static uint32_t ulCount = 0;
+static uint8_t ucSelected = MSG_PARAMETER_MAX;
+
+/* Request waiting for its seconds to be recorded */
+static bool bRequested = false;
+static uint32_t ulDue = 0;
+static uint32_t ulSeconds = 0;
+
+/* Transfer on, the ring is frozen */
+static bool bTransfer = false;
+static uint16_t usTransfer = 0;
+static uint32_t ulFirst = 0;				/* Ring index of the oldest sample sent */
+static uint32_t ulSamples = 0;
+static uint32_t ulSpanMs = 0;
+static uint32_t ulPerChunk = 0;
+static uint16_t usChunks = 0;
+static uint16_t usNext = 0;					/* Chunk not acknowledged yet */
+
+static CaptureStat_t xStat;
+
+
+void CAPTURE_vInit( void )
+{
+	taskENTER_CRITICAL();
+	ulHead = 0;
+	ulCount = 0;
+	ucSelected = MSG_PARAMETER_MAX;
+	bRequested = false;
+	bTransfer = false;
+	memset( &xStat, 0, sizeof( xStat ) );
+	taskEXIT_CRITICAL();
+}
+
+
+uint8_t CAPTURE_ucParameter( void )
+{
+	return ucSelected;
+}
+
+
+void CAPTURE_vAdd( uint32_t ulTick, float fValue )
+{
+	taskENTER_CRITICAL();
+	if( !bTransfer )
+	{
+		xRing[ulHead].ulTick = ulTick;
+		xRing[ulHead].fValue = fValue;
+		ulHead = ( ulHead + 1 ) % CAPTURE_RING_SAMPLES;
+		if( ulCount < CAPTURE_RING_SAMPLES )
+		{
+			ulCount++;
+		}
+		else
+		{
+			xStat.ulOverwritten++;
+		}
+	}
+	taskEXIT_CRITICAL();
+}
+
+
+/* Value of the key in the command, the quote before the key keeps it from matching the tail of a longer one */
+static bool prvFind( const char *pcCmd, size_t xLen, const char *pcKey, const char **ppcValue, size_t *pxValueLen )
+{
+	char cKey[16];
+	size_t xKeyLen = strlen( pcKey ) + 1;
+
+	if( xKeyLen >= sizeof( cKey ) )
+	{
+		return false;
+	}
+	cKey[0] = '"';
+	memcpy( &cKey[1], pcKey, xKeyLen );
+
+	return IotJsonUtils_FindJsonValue( pcCmd, xLen, cKey, xKeyLen, ppcValue, pxValueLen );
+}
+
+
+bool CAPTURE_bCommand( const char *pcCmd, size_t xLen, uint32_t ulNow )
+{
+	const char *pcValue;
+	size_t xValueLen;
+	uint8_t ucParameter = MSG_PARAMETER_MAX;
+	uint32_t ulSec = 0;
+
+	if( !prvFind( pcCmd, xLen, "parameter", &pcValue, &xValueLen ) || ( xValueLen < 2 ) || ( pcValue[0] != '"' ) )
+	{
+		return false;
+	}
+
+	for( uint8_t i = 0; i < MSG_PARAMETER_MAX; i++ )
+	{
+		if( ( strlen( pcParameterName[i] ) == ( xValueLen - 2 ) ) && ( strncmp( pcParameterName[i], &pcValue[1], xValueLen - 2 ) == 0 ) )
+		{
+			ucParameter = i;
+			break;
+		}
+	}
+
+	if( !prvFind( pcCmd, xLen, "seconds", &pcValue, &xValueLen ) || ( xValueLen == 0 ) || ( xValueLen > 4 ) )
+	{
+		return false;
+	}
+
+	for( size_t i = 0; i < xValueLen; i++ )
+	{
+		if( ( pcValue[i] < '0' ) || ( pcValue[i] > '9' ) )
+		{
+			return false;
+		}
+		ulSec = ulSec * 10 + ( uint32_t )( pcValue[i] - '0' );
+	}
+
+	return CAPTURE_bRequest( ucParameter, ulSec, ulNow );
+}
+
+
+/* Whole seconds the ring holds at the sample period of the parameter, 0 for one not read by the sensors task */
+static uint32_t prvRingSeconds( uint8_t ucParameter )
+{
+	Settings_t xSettings;
+
+	SETTINGS_vGet( &xSettings );
+	const SettingsSensor_t *pxSensor = &xSettings.xSensor[pucParameterSensor[ucParameter]];
+	if( ( pxSensor->ulSendMs == 0 ) || ( pxSensor->ulSampleMs == 0 ) )
+	{
+		return 0;
+	}
+
+	return ( CAPTURE_RING_SAMPLES * pxSensor->ulSampleMs ) / 1000;
+}
+
+
+bool CAPTURE_bRequest( uint8_t ucParameter, uint32_t ulSec, uint32_t ulNow )
+{
+	bool bRet = false;
+
+	if( ( ucParameter >= MSG_PARAMETER_MAX ) || ( ulSec == 0 ) || ( ulSec > CAPTURE_SECONDS_MAX ) )
+	{
+		return false;
+	}
+
+	/* Seconds the ring can't hold would be waited for and then lost to the overwrite */
+	uint32_t ulRing = prvRingSeconds( ucParameter );
+	if( ulRing == 0 )
+	{
+		return false;
+	}
+	if( ulSec > ulRing )
+	{
+		ulSec = ulRing;
+	}
+
+	taskENTER_CRITICAL();
+	if( !bTransfer )
+	{
+		/* The ring holds another parameter, its seconds are recorded from now on */
+		if( ucParameter != ucSelected )
+		{
+			ucSelected = ucParameter;
+			ulHead = 0;
+			ulCount = 0;
+			ulDue = ulNow + ulSec * 1000;
+		}
+		else
+		{
+			ulDue = ulNow;
+		}
+		ulSeconds = ulSec;
+		bRequested = true;
+		xStat.ulRequests++;
+		bRet = true;
+	}
+	taskEXIT_CRITICAL();
+
+	return bRet;
+}
+
+
+bool CAPTURE_bStart( uint32_t ulNow, uint32_t ulChunkSize )
+{
+	bool bRet = false;
+
+	if( ulChunkSize < ( sizeof( CaptureChunkHeader_t ) + sizeof( CaptureSample_t ) ) )
+	{
+		return false;
+	}
+
+	taskENTER_CRITICAL();
+	if( bRequested && !bTransfer && ( ( int32_t )( ulNow - ulDue ) >= 0 ) )
+	{
+		uint32_t ulOldest = ( ulHead + CAPTURE_RING_SAMPLES - ulCount ) % CAPTURE_RING_SAMPLES;
+		uint32_t ulSkip = 0;
+
+		/* Samples older than the seconds asked for stay out */
+		while( ( ulSkip < ulCount ) && ( ( ulNow - xRing[( ulOldest + ulSkip ) % CAPTURE_RING_SAMPLES].ulTick ) > ( ulSeconds * 1000 ) ) )
+		{
+			ulSkip++;
+		}
+
+		ulFirst = ( ulOldest + ulSkip ) % CAPTURE_RING_SAMPLES;
+		ulSamples = ulCount - ulSkip;
+		ulSpanMs = ( ulSamples > 1 ) ? ( xRing[( ulFirst + ulSamples - 1 ) % CAPTURE_RING_SAMPLES].ulTick - xRing[ulFirst].ulTick ) : 0;
+		ulPerChunk = ( ulChunkSize - sizeof( CaptureChunkHeader_t ) ) / sizeof( CaptureSample_t );
+		usChunks = ( uint16_t )( ( ulSamples + ulPerChunk - 1 ) / ulPerChunk );
+		if( usChunks == 0 )
+		{
+			usChunks = 1;
+		}
+		usNext = 0;
+		usTransfer++;
+		bRequested = false;
+		bTransfer = true;
+		bRet = true;
+	}
+	taskEXIT_CRITICAL();
+
+	return bRet;
+}
+
+
+bool CAPTURE_bBusy( void )
+{
+	return bRequested || bTransfer;
+}
+
+
+/* The ring is frozen, the samples are read outside the critical section */
+uint32_t CAPTURE_ulChunk( uint8_t *pucBuf, uint32_t ulSize, CaptureChunkHeader_t *pxHeader )
+{
+	if( !bTransfer )
+	{
+		return 0;
+	}
+
+	uint32_t ulStart = ( uint32_t )usNext * ulPerChunk;
+	uint32_t ulIn = ( ulSamples > ulStart ) ? ( ulSamples - ulStart ) : 0;
+	if( ulIn > ulPerChunk )
+	{
+		ulIn = ulPerChunk;
+	}
+
+	uint32_t ulLen = sizeof( CaptureChunkHeader_t ) + ulIn * sizeof( CaptureSample_t );
+	if( ulLen > ulSize )
+	{
+		return 0;
+	}
+
+	pxHeader->usTransfer = usTransfer;
+	pxHeader->usSeq = usNext;
+	pxHeader->usChunks = usChunks;
+	pxHeader->usSamples = ( uint16_t )ulIn;
+	pxHeader->ucParameter = ucSelected;
+	pxHeader->ucVersion = CAPTURE_VERSION;
+	pxHeader->usSeconds = ( uint16_t )ulSeconds;
+	pxHeader->ulSpanMs = ulSpanMs;
+	memcpy( pucBuf, pxHeader, sizeof( CaptureChunkHeader_t ) );
+
+	for( uint32_t i = 0; i < ulIn; i++ )
+	{
+		memcpy( &pucBuf[sizeof( CaptureChunkHeader_t ) + i * sizeof( CaptureSample_t )],
+				&xRing[( ulFirst + ulStart + i ) % CAPTURE_RING_SAMPLES], sizeof( CaptureSample_t ) );
+	}
+
+	return ulLen;
+}
+
+
+void CAPTURE_vAcked( uint16_t usAckedTransfer, uint16_t usSeq )
+{
+	taskENTER_CRITICAL();
+	if( bTransfer && ( usAckedTransfer == usTransfer ) && ( usSeq == usNext ) )
+	{
+		usNext++;
+		xStat.ulChunks++;
+		if( usNext >= usChunks )
+		{
+			bTransfer = false;
+			xStat.ulTransfers++;
+		}
+	}
+	taskEXIT_CRITICAL();
+}
+
+
+void CAPTURE_vStatGet( CaptureStat_t *pxStat )
+{
+	taskENTER_CRITICAL();
+	*pxStat = xStat;
+	taskEXIT_CRITICAL();
+}
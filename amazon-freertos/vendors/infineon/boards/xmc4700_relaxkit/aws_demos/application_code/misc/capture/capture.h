@@ -0,0 +1,100 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "message_schema.h"
+
+
+/* Samples of the captured parameter kept in RAM, the oldest is overwritten */
+#define CAPTURE_RING_SAMPLES		( 2048 )
+/* Longest history a request may ask for, it is cut to what the ring holds at the sample period of the parameter */
+#define CAPTURE_SECONDS_MAX			( 600 )
+#define CAPTURE_VERSION				( 2 )
+
+
+typedef struct {
+	uint32_t ulTick;			/* ms, of the read */
+	float fValue;
+
+} CaptureSample_t;
+
+
+/* Head of every chunk, the samples follow; little endian as the MCU */
+typedef struct {
+	uint16_t usTransfer;		/* New on every request */
+	uint16_t usSeq;				/* Chunk of the transfer, from 0 on */
+	uint16_t usChunks;			/* Of the transfer, a transfer without samples has one empty chunk */
+	uint16_t usSamples;			/* In this chunk */
+	uint8_t ucParameter;		/* MSG_PARAMETERS row */
+	uint8_t ucVersion;			/* CAPTURE_VERSION */
+	uint16_t usSeconds;			/* Asked for, after the cut to the ring */
+	uint32_t ulSpanMs;			/* From the first to the last sample of the transfer, what the samples really cover */
+
+} CaptureChunkHeader_t;
+
+
+typedef struct {
+	uint32_t ulRequests;
+	uint32_t ulTransfers;		/* Completed */
+	uint32_t ulChunks;			/* Acknowledged */
+	uint32_t ulOverwritten;		/* Samples lost to the ring size, of the captured parameter */
+
+} CaptureStat_t;
+
+
+/**
+ * Raw samples of one parameter on request. The sensors task keeps the samples
+ * of the selected parameter in a ring; a request for the last seconds freezes
+ * the ring and the MQTT task sends it in chunks, each resent until it is
+ * acknowledged, so a transfer goes on where it stopped after a reconnect. The
+ * ring takes samples again once the last chunk is acknowledged. A request for
+ * another parameter selects it and is sent once its seconds are recorded.
+ * Only parameters the sensors task reads one by one can be captured, their
+ * sample period in the applied settings sets how many seconds the ring holds.
+ */
+
+void CAPTURE_vInit( void );
+/** parameter whose samples the ring takes, MSG_PARAMETER_MAX for none */
+uint8_t CAPTURE_ucParameter( void );
+/** every sample of the selected parameter, not only those of its statistic windows; ignored while a transfer is on */
+void CAPTURE_vAdd( uint32_t ulTick, float fValue );
+/** {"parameter":"<MSG_PARAMETERS name>","seconds":<n>}, false for a malformed command, a parameter without single reads or while a transfer is on */
+bool CAPTURE_bCommand( const char *pcCmd, size_t xLen, uint32_t ulNow );
+bool CAPTURE_bRequest( uint8_t ucParameter, uint32_t ulSeconds, uint32_t ulNow );
+/** starts the transfer of a request whose seconds are recorded, chunks of up to ulChunkSize bytes; true once per transfer */
+bool CAPTURE_bStart( uint32_t ulNow, uint32_t ulChunkSize );
+/** request waiting or transfer on */
+bool CAPTURE_bBusy( void );
+/** next chunk not acknowledged yet, 0 without a transfer or if ulSize is below the chunk size */
+uint32_t CAPTURE_ulChunk( uint8_t *pucBuf, uint32_t ulSize, CaptureChunkHeader_t *pxHeader );
+/** chunk acknowledged, the next one follows */
+void CAPTURE_vAcked( uint16_t usTransfer, uint16_t usSeq );
+void CAPTURE_vStatGet( CaptureStat_t *pxStat );
+
+
+#endif /* CAPTURE_H */
@@ -0,0 +1,294 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "cbor_sensor.h"
+
+
+#if( CBOR_SPECTRUM_CODED > 0 )
+/* Frame of one spectrum, the byte string needs it whole */
+static uint8_t pucSpecFrame[SPEC_FRAME_SIZE_MAX( SPEC_BINS_MAX )];
+#endif
+
+
+uint16_t CBOR_usFloatToHalf( float fVal )
+{
+	uint32_t ulBits, ulMant, ulRem, ulHalf, ulShift;
+	uint16_t usSign, usRet;
+	int32_t lExp;
+
+	memcpy( &ulBits, &fVal, sizeof( ulBits ) );
+	usSign = ( ulBits >> 16 ) & 0x8000;
+	lExp = (int32_t)( ( ulBits >> 23 ) & 0xFF ) - 127 + 15;
+	ulMant = ulBits & 0x7FFFFF;
+
+	if( ( ( ulBits >> 23 ) & 0xFF ) == 0xFF )
+	{
+		/* nan keeps a quiet bit */
+		return usSign | 0x7C00 | ( ulMant ? 0x200 : 0 );
+	}
+	if( lExp >= 31 )
+	{
+		return usSign | 0x7C00;
+	}
+	if( lExp <= 0 )
+	{
+		/* Half subnormal, the unit is 2^-24 */
+		if( lExp < -10 )
+		{
+			return usSign;
+		}
+		ulMant |= 0x800000;
+		ulShift = 14 - lExp;
+		usRet = ulMant >> ulShift;
+		ulRem = ulMant & ( ( 1UL << ulShift ) - 1 );
+		ulHalf = 1UL << ( ulShift - 1 );
+	}
+	else
+	{
+		usRet = ( lExp << 10 ) | ( ulMant >> 13 );
+		ulRem = ulMant & 0x1FFF;
+		ulHalf = 0x1000;
+	}
+
+	/* Carry goes into the exponent, up to inf */
+	if( ( ulRem > ulHalf ) || ( ( ulRem == ulHalf ) && ( usRet & 1 ) ) )
+	{
+		usRet++;
+	}
+
+	return usSign | usRet;
+}
+
+
+float CBOR_fHalfToFloat( uint16_t usHalf )
+{
+	uint32_t ulExp = ( usHalf >> 10 ) & 0x1F;
+	uint32_t ulMant = usHalf & 0x3FF;
+	float fRet;
+
+	if( ulExp == 0 )
+	{
+		fRet = ldexpf( (float)ulMant, -24 );
+	}
+	else if( ulExp == 31 )
+	{
+		fRet = ulMant ? NAN : INFINITY;
+	}
+	else
+	{
+		fRet = ldexpf( (float)( ulMant | 0x400 ), (int32_t)ulExp - 25 );
+	}
+
+	return ( usHalf & 0x8000 ) ? -fRet : fRet;
+}
+
+
+static CborError CBOR_prvFloatAdd( CborEncoder *pxEnc, float fVal )
+{
+#if( CBOR_FLOAT_MODE == CBOR_FLOAT_32 )
+	return cbor_encode_float( pxEnc, fVal );
+#else
+	uint16_t usHalf = CBOR_usFloatToHalf( fVal );
+
+#if( CBOR_FLOAT_MODE == CBOR_FLOAT_SHORTEST )
+	/* nan compares unequal, it goes as half */
+	if( ( CBOR_fHalfToFloat( usHalf ) != fVal ) && !isnan( fVal ) )
+	{
+		return cbor_encode_float( pxEnc, fVal );
+	}
+#endif
+	return cbor_encode_half_float( pxEnc, &usHalf );
+#endif
+}
+
+
+/* Float array, bSkipDiagonal leaves the always 1.0 diagonal out of the correlation triangle */
+static CborError CBOR_prvFloatArrayAdd( CborEncoder *pxMap, CborSensorKey_t xKey, const float *pfData, uint32_t ulCount, uint8_t ucChannels, bool bSkipDiagonal )
+{
+	CborEncoder xArray;
+	CborError xErr;
+	uint8_t ucRow = 0, ucCol = 0;
+	uint32_t ulLen = bSkipDiagonal ? ( ulCount - ucChannels ) : ulCount;
+
+	xErr = cbor_encode_uint( pxMap, xKey );
+	xErr |= cbor_encoder_create_array( pxMap, &xArray, ulLen );
+	for( uint32_t i = 0; ( i < ulCount ) && ( xErr == CborNoError ); i++ )
+	{
+		bool bDiagonal = ( ucRow == ucCol );
+		if( ++ucCol >= ucChannels )
+		{
+			ucRow++;
+			ucCol = ucRow;
+		}
+		if( bSkipDiagonal && bDiagonal )
+		{
+			continue;
+		}
+		xErr |= CBOR_prvFloatAdd( &xArray, pfData[i] );
+	}
+	if( xErr != CborNoError )
+	{
+		return xErr;
+	}
+
+	return cbor_encoder_close_container( pxMap, &xArray );
+}
+
+
+bool CBOR_bSensorAdd( CborEncoder *pxMessage, SensorContext_t *pxSensorCxt )
+{
+	CborEncoder xMap, xArray;
+	CborError xErr;
+	size_t xFields = 1;
+
+	if( !pxSensorCxt )
+	{
+		return false;
+	}
+
+	/* Statistic window of the sensor is still open, nothing to send this time */
+	if( !pxSensorCxt->bReady )
+	{
+		return true;
+	}
+
+	if( pxSensorCxt->bOn )
+	{
+		xFields += ( pxSensorCxt->pxStat != NULL ) + ( pxSensorCxt->pxFft != NULL ) + ( pxSensorCxt->pxEdge != NULL ) +
+				( pxSensorCxt->pxDerived != NULL ) + ( pxSensorCxt->pxCorr ? 2 : 0 ) +
+				( ( pxSensorCxt->pxCorr && pxSensorCxt->pxCorr->ucLagPairs ) ? 1 : 0 ) + ( pxSensorCxt->pxClass ? 2 : 0 );
+	}
+
+	xErr = cbor_encode_uint( pxMessage, CBOR_KEY_SENSOR_BASE + pxSensorCxt->ucId );
+	xErr |= cbor_encoder_create_map( pxMessage, &xMap, xFields );
+	xErr |= cbor_encode_uint( &xMap, CBOR_KEY_ON );
+	xErr |= cbor_encode_boolean( &xMap, pxSensorCxt->bOn );
+
+	while( pxSensorCxt->bOn && ( xErr == CborNoError ) )
+	{
+		if( pxSensorCxt->pxStat )
+		{
+			const float pfStat[] = { pxSensorCxt->pxStat->fMin, pxSensorCxt->pxStat->fMax, pxSensorCxt->pxStat->fMean,
+					pxSensorCxt->pxStat->fRMS, pxSensorCxt->pxStat->fStdDev, pxSensorCxt->pxStat->fVariance };
+
+			xErr |= CBOR_prvFloatArrayAdd( &xMap, CBOR_KEY_STAT, pfStat, BUF_LEN( pfStat ), BUF_LEN( pfStat ), false );
+		}
+
+		if( pxSensorCxt->pxEdge )
+		{
+			xErr |= cbor_encode_uint( &xMap, CBOR_KEY_EDGE );
+			xErr |= cbor_encoder_create_array( &xMap, &xArray, 5 );
+			xErr |= CBOR_prvFloatAdd( &xArray, pxSensorCxt->pxEdge->fFrequency );
+			xErr |= CBOR_prvFloatAdd( &xArray, pxSensorCxt->pxEdge->fDutyCycle );
+			xErr |= cbor_encode_uint( &xArray, pxSensorCxt->pxEdge->ulPulseCount );
+			xErr |= CBOR_prvFloatAdd( &xArray, pxSensorCxt->pxEdge->fDwellOn );
+			xErr |= CBOR_prvFloatAdd( &xArray, pxSensorCxt->pxEdge->fDwellOff );
+			if( xErr != CborNoError )
+			{
+				break;
+			}
+			xErr |= cbor_encoder_close_container( &xMap, &xArray );
+		}
+
+		if( pxSensorCxt->pxDerived )
+		{
+			const float pfDerived[] = { pxSensorCxt->pxDerived->fDiffPressure, pxSensorCxt->pxDerived->fFlow, pxSensorCxt->pxDerived->fCloggingIndex };
+
+			xErr |= CBOR_prvFloatArrayAdd( &xMap, CBOR_KEY_DERIVED, pfDerived, BUF_LEN( pfDerived ), BUF_LEN( pfDerived ), false );
+		}
+
+		if( pxSensorCxt->pxCorr )
+		{
+			CorrelationData_t *pxCorr = pxSensorCxt->pxCorr;
+			uint32_t ulCount = CORR_TRIANGLE_LEN( pxCorr->ucChannels );
+
+			xErr |= CBOR_prvFloatArrayAdd( &xMap, CBOR_KEY_COV, pxCorr->pfCovariance, ulCount, pxCorr->ucChannels, false );
+			xErr |= CBOR_prvFloatArrayAdd( &xMap, CBOR_KEY_CORR, pxCorr->pfCorrelation, ulCount, pxCorr->ucChannels, true );
+			if( ( pxCorr->ucLagPairs > 0 ) && ( xErr == CborNoError ) )
+			{
+				xErr |= cbor_encode_uint( &xMap, CBOR_KEY_LAG );
+				xErr |= cbor_encoder_create_array( &xMap, &xArray, 2 * pxCorr->ucLagPairs );
+				for( uint8_t i = 0; i < pxCorr->ucLagPairs; i++ )
+				{
+					xErr |= cbor_encode_int( &xArray, pxCorr->psLag[i] );
+					xErr |= CBOR_prvFloatAdd( &xArray, pxCorr->pfLagPeak[i] );
+				}
+				if( xErr != CborNoError )
+				{
+					break;
+				}
+				xErr |= cbor_encoder_close_container( &xMap, &xArray );
+			}
+		}
+
+		if( pxSensorCxt->pxClass )
+		{
+			xErr |= cbor_encode_uint( &xMap, CBOR_KEY_CLASS );
+			xErr |= cbor_encode_uint( &xMap, pxSensorCxt->pxClass->ucLabel );
+			xErr |= CBOR_prvFloatArrayAdd( &xMap, CBOR_KEY_PROB, pxSensorCxt->pxClass->pfProb, pxSensorCxt->pxClass->ucClasses,
+					pxSensorCxt->pxClass->ucClasses, false );
+		}
+
+#if( CBOR_SPECTRUM_CODED > 0 )
+		if( pxSensorCxt->pxFft && pxSensorCxt->pxSpecCodec && ( xErr == CborNoError ) )
+		{
+			uint32_t ulLen = SPEC_ulEncode( pxSensorCxt->pxSpecCodec, pxSensorCxt->pxFft->data, BUF_LEN( pxSensorCxt->pxFft->data ),
+					pucSpecFrame, sizeof( pucSpecFrame ) );
+			if( ulLen == 0 )
+			{
+				xErr = CborErrorInternalError;
+				break;
+			}
+			xErr |= cbor_encode_uint( &xMap, CBOR_KEY_FFT_SPEC );
+			xErr |= cbor_encode_byte_string( &xMap, pucSpecFrame, ulLen );
+		}
+		else
+#endif
+		/* Spectra stay integers */
+		if( pxSensorCxt->pxFft && ( xErr == CborNoError ) )
+		{
+			xErr |= cbor_encode_uint( &xMap, CBOR_KEY_FFT );
+			xErr |= cbor_encoder_create_array( &xMap, &xArray, BUF_LEN( pxSensorCxt->pxFft->data ) );
+			for( uint32_t i = 0; i < BUF_LEN( pxSensorCxt->pxFft->data ); i++ )
+			{
+				xErr |= cbor_encode_uint( &xArray, pxSensorCxt->pxFft->data[i] );
+			}
+			if( xErr != CborNoError )
+			{
+				break;
+			}
+			xErr |= cbor_encoder_close_container( &xMap, &xArray );
+		}
+		break;
+	}
+
+	if( xErr != CborNoError )
+	{
+		return false;
+	}
+
+	return cbor_encoder_close_container( pxMessage, &xMap ) == CborNoError;
+}
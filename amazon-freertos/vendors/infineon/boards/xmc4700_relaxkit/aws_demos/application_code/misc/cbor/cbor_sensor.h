@@ -0,0 +1,99 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#ifndef CBOR_SENSOR_H
+#define CBOR_SENSOR_H
+
+#include "cbor.h"
+#include "app_types.h"
+
+
+/**
+ * Binary payload, schema version CBOR_SCHEMA_VERSION:
+ *   map {
+ *     CBOR_KEY_VERSION: CBOR_SCHEMA_VERSION,
+ *     CBOR_KEY_SENSOR_BASE + JsonSensorsStatistic_t: map { CborSensorKey_t: value },
+ *     ...
+ *   }
+ * Sensor map values:
+ *   CBOR_KEY_ON      - bool
+ *   CBOR_KEY_STAT    - [min, max, mean, rms, stddev, variance]
+ *   CBOR_KEY_FFT     - unsigned integer per bin
+ *   CBOR_KEY_EDGE    - [frequency, duty cycle, pulse count, dwell on, dwell off]
+ *   CBOR_KEY_DERIVED - [dP, flow, clogging index]
+ *   CBOR_KEY_COV     - covariance upper triangle
+ *   CBOR_KEY_CORR    - correlation upper triangle without the diagonal
+ *   CBOR_KEY_LAG     - [lag, peak] pairs
+ *   CBOR_KEY_CLASS   - unsigned integer
+ *   CBOR_KEY_PROB    - class probabilities
+ *   CBOR_KEY_FFT_SPEC - spectrum_codec.h frame in a byte string, instead of CBOR_KEY_FFT
+ * Several windows in one payload, BATCH_bCreate:
+ *   map {
+ *     CBOR_KEY_VERSION: CBOR_SCHEMA_VERSION,
+ *     CBOR_KEY_WINDOWS: [ map { CBOR_KEY_TIMESTAMP: tick ms, sensors as above }, ... ],
+ *     CBOR_KEY_NOW: tick ms when the payload was closed, the receiver anchors the timestamps with it
+ *   }
+ * Keys are never reused, a new field gets a new key and a changed meaning a new version.
+ */
+#define CBOR_SCHEMA_VERSION				( 1 )
+
+#define CBOR_KEY_VERSION				( 0 )
+#define CBOR_KEY_TIMESTAMP				( 1 )
+#define CBOR_KEY_NOW					( 2 )
+#define CBOR_KEY_WINDOWS				( 3 )
+#define CBOR_KEY_SENSOR_BASE			( 16 )
+
+typedef enum {
+	CBOR_KEY_ON = 0,
+	CBOR_KEY_STAT,
+	CBOR_KEY_FFT,
+	CBOR_KEY_EDGE,
+	CBOR_KEY_DERIVED,
+	CBOR_KEY_COV,
+	CBOR_KEY_CORR,
+	CBOR_KEY_LAG,
+	CBOR_KEY_CLASS,
+	CBOR_KEY_PROB,
+	CBOR_KEY_FFT_SPEC,
+
+} CborSensorKey_t;
+
+/* Float values: 32 bit, half when it keeps the exact value, or half always */
+#define CBOR_FLOAT_32					( 0 )
+#define CBOR_FLOAT_SHORTEST				( 1 )
+#define CBOR_FLOAT_16					( 2 )
+
+#define CBOR_FLOAT_MODE					CBOR_FLOAT_SHORTEST
+
+/* Spectra with a codec state as dB codes, delta and varint coded */
+#define CBOR_SPECTRUM_CODED				( 1 )
+
+
+/** sensor map into the open message map, nothing if the window is not ready */
+bool CBOR_bSensorAdd( CborEncoder *pxMessage, SensorContext_t *pxSensorCxt );
+/** IEEE 754 half precision, round half to even */
+uint16_t CBOR_usFloatToHalf( float fVal );
+float CBOR_fHalfToFloat( uint16_t usHalf );
+
+
+#endif /* CBOR_SENSOR_H */
@@ -0,0 +1,305 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "FreeRTOS.h"
+
+#include "classifier.h"
+
+
+#define CLASSIFIER_ALIGN4( x )		( ( ( x ) + 3u ) & ~3u )
+
+
+typedef struct {
+	const ClassifierHeader_t *pxHeader;
+	const ClassifierInput_t *pxInput;
+	const ClassifierLayer_t *pxLayer[CLASSIFIER_LAYERS_MAX];
+	const int32_t *plBias[CLASSIFIER_LAYERS_MAX];
+	const int8_t *pcWeights[CLASSIFIER_LAYERS_MAX];
+} ClassifierModel_t;
+
+static ClassifierModel_t xModel;
+static bool bModelLoaded = false;
+
+/* Activations ping-pong between two buffers */
+static int8_t pcActivation[2][CLASSIFIER_INPUTS_MAX > CLASSIFIER_LAYER_OUTPUTS_MAX ? CLASSIFIER_INPUTS_MAX : CLASSIFIER_LAYER_OUTPUTS_MAX];
+
+
+static uint32_t prvCrc32( const uint8_t *pucData, uint32_t ulLen )
+{
+	uint32_t ulCrc = 0xFFFFFFFFUL;
+
+	while( ulLen-- )
+	{
+		ulCrc ^= *pucData++;
+		for( uint8_t i = 0; i < 8; i++ )
+		{
+			ulCrc = ( ulCrc >> 1 ) ^ ( 0xEDB88320UL & ( 0u - ( ulCrc & 1u ) ) );
+		}
+	}
+
+	return ~ulCrc;
+}
+
+
+/* Same as arm_nn_doubling_high_mult_no_sat() of CMSIS-NN, rounding half up whatever the sign */
+static int32_t prvDoublingHighMult( int32_t lA, int32_t lB )
+{
+	int64_t llMult = ( (int64_t)1 << 30 ) + (int64_t)lA * lB;
+
+	return (int32_t)( llMult >> 31 );
+}
+
+
+/* Same as arm_nn_divide_by_power_of_two() of CMSIS-NN, rounding half away from zero */
+static int32_t prvDivideByPowerOfTwo( int32_t lDividend, int32_t lExponent )
+{
+	const int32_t lMask = ( 1 << lExponent ) - 1;
+	int32_t lRemainder = lMask & lDividend;
+	int32_t lResult = lDividend >> lExponent;
+	int32_t lThreshold = lMask >> 1;
+
+	if( lResult < 0 )
+	{
+		lThreshold++;
+	}
+	if( lRemainder > lThreshold )
+	{
+		lResult++;
+	}
+
+	return lResult;
+}
+
+
+/* Same as arm_nn_requantize() of CMSIS-NN */
+static int32_t prvRequantize( int32_t lVal, int32_t lMultiplier, int32_t lShift )
+{
+	int32_t lLeft = ( lShift > 0 ) ? lShift : 0;
+	int32_t lRight = ( lShift > 0 ) ? 0 : -lShift;
+
+	return prvDivideByPowerOfTwo( prvDoublingHighMult( lVal * ( 1 << lLeft ), lMultiplier ), lRight );
+}
+
+
+/**
+ * int8 fully connected layer, the arithmetic of arm_fully_connected_s8():
+ * acc = bias + sum( w * ( x + input_offset ) ), requantized, + output_offset, clamped
+ */
+static void prvFullyConnected( const ClassifierLayer_t *pxLayer, const int32_t *plBias, const int8_t *pcWeights, const int8_t *pcIn, int8_t *pcOut )
+{
+	for( uint16_t o = 0; o < pxLayer->usOutputs; o++ )
+	{
+		const int8_t *pcRow = &pcWeights[(uint32_t)o * pxLayer->usInputs];
+		int32_t lAcc = plBias[o];
+
+		for( uint16_t i = 0; i < pxLayer->usInputs; i++ )
+		{
+			lAcc += (int32_t)pcRow[i] * ( (int32_t)pcIn[i] + pxLayer->lInputOffset );
+		}
+
+		lAcc = prvRequantize( lAcc, pxLayer->lMultiplier, pxLayer->lShift );
+		lAcc += pxLayer->lOutputOffset;
+		if( lAcc < pxLayer->lActMin )
+		{
+			lAcc = pxLayer->lActMin;
+		}
+		if( lAcc > pxLayer->lActMax )
+		{
+			lAcc = pxLayer->lActMax;
+		}
+
+		pcOut[o] = (int8_t)lAcc;
+	}
+}
+
+
+int32_t CLASSIFIER_lLoad( const uint8_t *pucBlob, uint32_t ulSize )
+{
+	ClassifierModel_t xNew;
+	const ClassifierHeader_t *pxHeader = (const ClassifierHeader_t *)pucBlob;
+	uint32_t ulPos;
+	uint16_t usPrevOutputs;
+
+	if( ( pucBlob == NULL ) || ( ( (uintptr_t)pucBlob & 3u ) != 0 ) || ( ulSize < sizeof( ClassifierHeader_t ) ) )
+	{
+		return -1;
+	}
+
+	if( ( pxHeader->ulMagic != CLASSIFIER_MAGIC ) || ( pxHeader->usVersion != CLASSIFIER_VERSION ) || ( pxHeader->ulSize != ulSize ) ||
+		( pxHeader->ucLayers == 0 ) || ( pxHeader->ucLayers > CLASSIFIER_LAYERS_MAX ) ||
+		( pxHeader->ucClasses == 0 ) || ( pxHeader->ucClasses > CLASSIFIER_CLASSES_MAX ) ||
+		( pxHeader->usInputs == 0 ) || ( pxHeader->usInputs > CLASSIFIER_INPUTS_MAX ) )
+	{
+		return -1;
+	}
+
+	if( prvCrc32( &pucBlob[sizeof( ClassifierHeader_t )], ulSize - sizeof( ClassifierHeader_t ) ) != pxHeader->ulCrc )
+	{
+		return -1;
+	}
+
+	memset( &xNew, 0, sizeof( xNew ) );
+	xNew.pxHeader = pxHeader;
+	ulPos = sizeof( ClassifierHeader_t );
+	xNew.pxInput = (const ClassifierInput_t *)&pucBlob[ulPos];
+	ulPos += pxHeader->usInputs * sizeof( ClassifierInput_t );
+
+	/* Walk the layers and check that they chain and fit in the blob */
+	usPrevOutputs = pxHeader->usInputs;
+	for( uint8_t l = 0; l < pxHeader->ucLayers; l++ )
+	{
+		if( ulPos + sizeof( ClassifierLayer_t ) > ulSize )
+		{
+			return -1;
+		}
+		xNew.pxLayer[l] = (const ClassifierLayer_t *)&pucBlob[ulPos];
+		ulPos += sizeof( ClassifierLayer_t );
+
+		if( ( xNew.pxLayer[l]->usInputs != usPrevOutputs ) || ( xNew.pxLayer[l]->usOutputs == 0 ) ||
+			( xNew.pxLayer[l]->usOutputs > CLASSIFIER_LAYER_OUTPUTS_MAX ) ||
+			( xNew.pxLayer[l]->lShift > 30 ) || ( xNew.pxLayer[l]->lShift < -30 ) )
+		{
+			return -1;
+		}
+		usPrevOutputs = xNew.pxLayer[l]->usOutputs;
+
+		xNew.plBias[l] = (const int32_t *)&pucBlob[ulPos];
+		ulPos += xNew.pxLayer[l]->usOutputs * sizeof( int32_t );
+
+		xNew.pcWeights[l] = (const int8_t *)&pucBlob[ulPos];
+		ulPos += CLASSIFIER_ALIGN4( (uint32_t)xNew.pxLayer[l]->usOutputs * xNew.pxLayer[l]->usInputs );
+
+		if( ulPos > ulSize )
+		{
+			return -1;
+		}
+	}
+
+	if( ( usPrevOutputs != pxHeader->ucClasses ) || ( ulPos != ulSize ) )
+	{
+		return -1;
+	}
+
+	/* Not switched while the sensors task runs the model, the task loads it itself */
+	xModel = xNew;
+	bModelLoaded = true;
+
+	return 0;
+}
+
+
+int32_t CLASSIFIER_lLoadDefault( void )
+{
+	return CLASSIFIER_lLoad( ucClassifierDefaultModel, ulClassifierDefaultModelSize );
+}
+
+
+bool CLASSIFIER_bLoaded( void )
+{
+	return bModelLoaded;
+}
+
+
+uint16_t CLASSIFIER_usInputs( void )
+{
+	return bModelLoaded ? xModel.pxHeader->usInputs : 0;
+}
+
+
+int32_t CLASSIFIER_lRunQ( const float *pfFeatures, uint16_t usFeatures, int8_t *pcLogits )
+{
+	uint8_t ucIn = 0;
+
+	if( ( !bModelLoaded ) || ( usFeatures != xModel.pxHeader->usInputs ) )
+	{
+		return -1;
+	}
+
+	/* Feature quantization */
+	for( uint16_t i = 0; i < usFeatures; i++ )
+	{
+		float fQ = roundf( pfFeatures[i] / xModel.pxInput[i].fScale ) + (float)xModel.pxInput[i].lZeroPoint;
+
+		if( !( fQ >= -128.0f ) )
+		{
+			fQ = -128.0f;
+		}
+		if( fQ > 127.0f )
+		{
+			fQ = 127.0f;
+		}
+		pcActivation[ucIn][i] = (int8_t)fQ;
+	}
+
+	for( uint8_t l = 0; l < xModel.pxHeader->ucLayers; l++ )
+	{
+		prvFullyConnected( xModel.pxLayer[l], xModel.plBias[l], xModel.pcWeights[l], pcActivation[ucIn], pcActivation[ucIn ^ 1] );
+		ucIn ^= 1;
+	}
+
+	memcpy( pcLogits, pcActivation[ucIn], xModel.pxHeader->ucClasses );
+
+	return 0;
+}
+
+
+int32_t CLASSIFIER_lRun( const float *pfFeatures, uint16_t usFeatures, ClassifierData_t *pxResult )
+{
+	int8_t pcLogits[CLASSIFIER_CLASSES_MAX];
+	float fMax, fSum = 0.0f;
+	uint8_t ucClasses;
+
+	if( CLASSIFIER_lRunQ( pfFeatures, usFeatures, pcLogits ) != 0 )
+	{
+		return -1;
+	}
+
+	ucClasses = xModel.pxHeader->ucClasses;
+	pxResult->ucClasses = ucClasses;
+	pxResult->ucLabel = 0;
+
+	/* Softmax of the dequantized logits, shifted by the max */
+	for( uint8_t c = 1; c < ucClasses; c++ )
+	{
+		if( pcLogits[c] > pcLogits[pxResult->ucLabel] )
+		{
+			pxResult->ucLabel = c;
+		}
+	}
+	fMax = (float)( pcLogits[pxResult->ucLabel] - xModel.pxHeader->lOutputZeroPoint ) * xModel.pxHeader->fOutputScale;
+
+	for( uint8_t c = 0; c < ucClasses; c++ )
+	{
+		pxResult->pfProb[c] = expf( (float)( pcLogits[c] - xModel.pxHeader->lOutputZeroPoint ) * xModel.pxHeader->fOutputScale - fMax );
+		fSum += pxResult->pfProb[c];
+	}
+	for( uint8_t c = 0; c < ucClasses; c++ )
+	{
+		pxResult->pfProb[c] /= fSum;
+	}
+
+	return 0;
+}
@@ -0,0 +1,105 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#ifndef CLASSIFIER_H
+#define CLASSIFIER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#define CLASSIFIER_MAGIC				( 0x31534C43UL )	/* "CLS1" */
+#define CLASSIFIER_VERSION				( 1 )
+
+#define CLASSIFIER_INPUTS_MAX			( 128 )
+#define CLASSIFIER_LAYER_OUTPUTS_MAX	( 64 )
+#define CLASSIFIER_LAYERS_MAX			( 4 )
+#define CLASSIFIER_CLASSES_MAX			( 8 )
+
+
+/**
+ * Model blob, little endian, every part 4-byte aligned:
+ *   ClassifierHeader_t
+ *   ClassifierInput_t x usInputs 			- feature quantization, q = round( x / fScale ) + lZeroPoint
+ *   per layer:
+ *     ClassifierLayer_t
+ *     int32_t bias x usOutputs
+ *     int8_t weights x usOutputs x usInputs, row per output, padded to 4 bytes
+ * ulCrc is CRC-32 ( IEEE 802.3 ) of everything after the header.
+ * Layers are int8 fully connected with the CMSIS-NN arm_fully_connected_s8 arithmetic,
+ * the last layer gives the class logits.
+ */
+typedef struct {
+	uint32_t ulMagic;
+	uint16_t usVersion;
+	uint8_t ucLayers;
+	uint8_t ucClasses;
+	uint16_t usInputs;
+	uint16_t usReserved;
+	uint32_t ulSize;				/* Whole blob, bytes */
+	uint32_t ulCrc;
+	float fOutputScale;				/* Logit = ( q - lOutputZeroPoint ) * fOutputScale */
+	int32_t lOutputZeroPoint;
+} ClassifierHeader_t;
+
+typedef struct {
+	float fScale;
+	int32_t lZeroPoint;
+} ClassifierInput_t;
+
+typedef struct {
+	uint16_t usInputs;
+	uint16_t usOutputs;
+	int32_t lInputOffset;			/* Added to the input, minus its zero point */
+	int32_t lOutputOffset;			/* Output zero point */
+	int32_t lMultiplier;			/* Requantization, Q31 */
+	int32_t lShift;					/* Requantization, left if positive, -30 to 30 */
+	int32_t lActMin;
+	int32_t lActMax;
+} ClassifierLayer_t;
+
+
+/* Structure containing the classifier result of one window */
+typedef struct {
+    uint8_t ucClasses; 							//! < Classes of the loaded model
+    uint8_t ucLabel; 							//! < Class with the max probability
+    float pfProb[CLASSIFIER_CLASSES_MAX]; 		//! < Class probabilities
+} ClassifierData_t;
+
+
+/** check the blob and use it as the model, the blob is not copied and should stay valid */
+int32_t CLASSIFIER_lLoad( const uint8_t *pucBlob, uint32_t ulSize );
+/** model compiled into flash */
+int32_t CLASSIFIER_lLoadDefault( void );
+bool CLASSIFIER_bLoaded( void );
+uint16_t CLASSIFIER_usInputs( void );
+/** quantize features and run the int8 layers, pcLogits gets ucClasses values */
+int32_t CLASSIFIER_lRunQ( const float *pfFeatures, uint16_t usFeatures, int8_t *pcLogits );
+/** CLASSIFIER_lRunQ and softmax */
+int32_t CLASSIFIER_lRun( const float *pfFeatures, uint16_t usFeatures, ClassifierData_t *pxResult );
+
+extern const uint8_t ucClassifierDefaultModel[];
+extern const uint32_t ulClassifierDefaultModelSize;
+
+
+#endif /* CLASSIFIER_H */
@@ -0,0 +1,168 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <stdint.h>
+
+#include "classifier.h"
+
+
+/**
+ * Default model in flash, used until a trained model is delivered with OTA.
+ * Layout is described in classifier.h: 56 inputs ( mean and std deviation of the
+ * 24 parameters of the default sensors_config.h, 8 microphone spectrum bands ),
+ * 16 hidden ReLU units, 3 classes. The weights are demo values without training.
+ */
+const uint8_t ucClassifierDefaultModel[] __attribute__( ( aligned( 4 ) ) ) = {
+	0x43, 0x4C, 0x53, 0x31, 0x01, 0x00, 0x02, 0x03, 0x38, 0x00, 0x00, 0x00,
+	0x10, 0x06, 0x00, 0x00, 0xB6, 0x6E, 0x8B, 0x78, 0x00, 0x00, 0x00, 0x3E,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x38, 0x00, 0x10, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x80, 0xFF, 0xFF, 0xFF, 0x9A, 0x79, 0x82, 0x5A,
+	0xFA, 0xFF, 0xFF, 0xFF, 0x80, 0xFF, 0xFF, 0xFF, 0x7F, 0x00, 0x00, 0x00,
+	0xE8, 0x01, 0x00, 0x00, 0x7D, 0xFE, 0xFF, 0xFF, 0xB5, 0x00, 0x00, 0x00,
+	0x34, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x8F, 0x00, 0x00, 0x00,
+	0x56, 0x00, 0x00, 0x00, 0xCD, 0xFE, 0xFF, 0xFF, 0xCA, 0xFF, 0xFF, 0xFF,
+	0x21, 0x00, 0x00, 0x00, 0x09, 0xFE, 0xFF, 0xFF, 0xC3, 0xFF, 0xFF, 0xFF,
+	0xC1, 0x00, 0x00, 0x00, 0x4E, 0xFF, 0xFF, 0xFF, 0x54, 0x00, 0x00, 0x00,
+	0x0D, 0x01, 0x00, 0x00, 0xD2, 0x07, 0x26, 0xE7, 0xD1, 0x02, 0x3D, 0xE3,
+	0xF8, 0x25, 0xFE, 0xFA, 0x33, 0x14, 0xC8, 0xC3, 0xE6, 0xF1, 0xDA, 0x30,
+	0x1E, 0xC1, 0x22, 0xE4, 0x08, 0x17, 0x37, 0x3D, 0x09, 0x24, 0xF5, 0x16,
+	0xE0, 0xDD, 0x28, 0xC9, 0x0F, 0x40, 0xF4, 0x2E, 0xE0, 0x33, 0x26, 0x30,
+	0x23, 0x07, 0x3E, 0x2F, 0x2C, 0x0B, 0x09, 0x08, 0xC5, 0xFD, 0x2A, 0x30,
+	0xDC, 0xC9, 0x1D, 0x15, 0x26, 0x18, 0xD3, 0x21, 0xFB, 0x0F, 0x05, 0x02,
+	0xF2, 0xD8, 0x10, 0xC5, 0xFD, 0x40, 0xF9, 0x3F, 0x1C, 0xFF, 0x19, 0x31,
+	0xE5, 0xF2, 0x13, 0xD3, 0xC8, 0xFB, 0xD7, 0x2A, 0xE9, 0x00, 0x39, 0xC9,
+	0xDF, 0xD3, 0xEF, 0xFA, 0x1A, 0xFD, 0xEB, 0xEB, 0x36, 0xC6, 0x2C, 0x20,
+	0x37, 0x07, 0xC5, 0x02, 0x36, 0x37, 0x21, 0xD2, 0xFA, 0x16, 0xEC, 0x0A,
+	0x36, 0xCE, 0x1F, 0xFD, 0x14, 0xCE, 0x14, 0xD5, 0x1F, 0x11, 0x2D, 0x2A,
+	0xE2, 0xD3, 0xED, 0x29, 0x38, 0xF6, 0xC9, 0xF6, 0xDF, 0xDA, 0x0E, 0x1E,
+	0xEC, 0xDB, 0x3B, 0x28, 0x2B, 0xDD, 0xC4, 0xEF, 0xD6, 0x14, 0xFC, 0x11,
+	0xF2, 0x05, 0x3C, 0xFC, 0xD4, 0x31, 0x0C, 0xDB, 0xF6, 0x0C, 0x11, 0xEF,
+	0xE0, 0x09, 0xD5, 0x3D, 0x16, 0xDA, 0x04, 0x04, 0x04, 0xCF, 0x30, 0x34,
+	0x2A, 0x3D, 0x30, 0xD6, 0xD0, 0x05, 0xCA, 0x40, 0xED, 0x40, 0xCE, 0x24,
+	0x38, 0xD1, 0xF6, 0xE7, 0x11, 0xE5, 0x07, 0x06, 0xF2, 0x1F, 0xF3, 0xC0,
+	0xFE, 0xD2, 0x34, 0x3C, 0xEF, 0x3B, 0xEC, 0x15, 0x02, 0xEA, 0xD4, 0xCD,
+	0xC8, 0xF5, 0xCE, 0xF2, 0x22, 0x02, 0x23, 0xF6, 0xDD, 0xF0, 0x16, 0xD2,
+	0xE4, 0x00, 0xF8, 0xF4, 0x40, 0xC5, 0xE6, 0xE3, 0x37, 0x1E, 0xF7, 0xCE,
+	0xF4, 0x09, 0x02, 0x03, 0x0D, 0x30, 0xC0, 0x10, 0xD8, 0xC4, 0x29, 0x09,
+	0xF4, 0x32, 0x02, 0x21, 0x36, 0x0B, 0x23, 0x37, 0x2C, 0xC3, 0x3E, 0xD0,
+	0xD6, 0x0C, 0xD8, 0x39, 0x34, 0x32, 0xC1, 0xC7, 0x34, 0xC7, 0x28, 0x13,
+	0xFE, 0xEE, 0x40, 0x40, 0x07, 0xE3, 0xC7, 0x17, 0x39, 0xDD, 0xED, 0x1B,
+	0xD6, 0xD1, 0x16, 0xCA, 0x0F, 0xC3, 0x0F, 0x06, 0xD0, 0xE9, 0x1D, 0xF9,
+	0xC6, 0x0B, 0x3F, 0xD6, 0x10, 0x1B, 0xFC, 0xF9, 0xFA, 0x0F, 0xEA, 0xC7,
+	0x17, 0x24, 0xFB, 0xE4, 0xFF, 0xE4, 0xCE, 0x2D, 0xC8, 0x27, 0xCF, 0x31,
+	0x35, 0x0B, 0x11, 0xCA, 0xF4, 0x06, 0xF5, 0x0B, 0x25, 0x00, 0x2B, 0xF5,
+	0xC9, 0xF6, 0xC9, 0x1A, 0x2A, 0x26, 0x20, 0x1F, 0xFF, 0x0A, 0xD1, 0xDC,
+	0xF6, 0xD8, 0xFC, 0x20, 0xEE, 0xCE, 0xEC, 0xDC, 0xF3, 0xC0, 0xEF, 0x0D,
+	0xEF, 0xD8, 0x30, 0x38, 0xFA, 0x05, 0x1C, 0xD1, 0xCE, 0x3B, 0x39, 0xEC,
+	0x12, 0x37, 0xCE, 0xCB, 0x00, 0xF7, 0xE1, 0xF4, 0xC2, 0xFF, 0xFC, 0x09,
+	0xE7, 0x34, 0xDC, 0x40, 0xC7, 0x0F, 0x1C, 0xDE, 0xC8, 0xDA, 0x0C, 0x26,
+	0xE3, 0xD5, 0x29, 0x24, 0x19, 0x20, 0xD0, 0xCD, 0xE9, 0x15, 0x03, 0xE4,
+	0xC2, 0xE8, 0xDF, 0xCB, 0x02, 0xEA, 0xFF, 0x02, 0x2E, 0xF1, 0xEC, 0xE5,
+	0xFF, 0xF6, 0xEE, 0xED, 0x24, 0xC2, 0x1A, 0xCC, 0xE2, 0x08, 0xF6, 0xF7,
+	0x3B, 0xE0, 0xE5, 0x1D, 0xFB, 0x1B, 0x19, 0xF2, 0x33, 0x04, 0x22, 0x32,
+	0xC2, 0x3F, 0xC1, 0xD1, 0xF5, 0x36, 0x26, 0xEE, 0x13, 0xD6, 0xC5, 0x2C,
+	0xE8, 0xC7, 0x3F, 0x25, 0x12, 0xE2, 0xEA, 0xD6, 0x0A, 0xFE, 0x32, 0x16,
+	0xE8, 0xEE, 0x3D, 0xCC, 0xEC, 0xFE, 0xDF, 0xF5, 0xD2, 0x2D, 0xC7, 0xE3,
+	0x04, 0xC4, 0x40, 0xF0, 0xE0, 0x1F, 0xEC, 0x1B, 0xE7, 0xE8, 0xC7, 0x1A,
+	0x1D, 0xE4, 0xC8, 0xEB, 0xF6, 0xC8, 0x10, 0xD0, 0x13, 0x2D, 0x1E, 0xFF,
+	0x1E, 0xE5, 0x36, 0x32, 0xDC, 0x12, 0x19, 0x0F, 0x14, 0xCB, 0x18, 0x2A,
+	0x38, 0xFE, 0x29, 0x17, 0x30, 0x32, 0xE2, 0xEE, 0xE5, 0xF8, 0xD8, 0x16,
+	0xFD, 0xEA, 0x16, 0xE5, 0xFC, 0xF6, 0xF0, 0xCC, 0x0F, 0x15, 0xCB, 0xFB,
+	0xD8, 0xDE, 0xF1, 0x2D, 0xE0, 0xED, 0xF9, 0x23, 0xE1, 0xCD, 0x0D, 0x14,
+	0x34, 0x3D, 0xCD, 0x0C, 0x33, 0x25, 0x2C, 0x13, 0x2B, 0x39, 0x1E, 0x2E,
+	0xE0, 0xD2, 0x3F, 0xD3, 0xE5, 0xC3, 0xEE, 0x37, 0xD1, 0x24, 0x0A, 0xC1,
+	0xDF, 0xD6, 0x30, 0x30, 0x2F, 0x3C, 0x37, 0x3E, 0x21, 0x37, 0xFD, 0xDE,
+	0xCF, 0xE0, 0xF4, 0xD9, 0xE0, 0x14, 0xDC, 0x36, 0xCC, 0x26, 0xC1, 0xDC,
+	0x16, 0x26, 0x00, 0xD9, 0xDD, 0x38, 0x27, 0xCA, 0x40, 0x32, 0x40, 0xCC,
+	0xFF, 0x1B, 0x27, 0xF6, 0x30, 0x17, 0xDE, 0xCA, 0x08, 0x16, 0x05, 0x0A,
+	0xD9, 0xD6, 0x29, 0xDB, 0x32, 0x3A, 0x31, 0x18, 0xFE, 0xEF, 0x38, 0xCE,
+	0x29, 0xFD, 0x12, 0x2F, 0xD8, 0xD5, 0x03, 0xE4, 0xFC, 0x10, 0xC2, 0xF6,
+	0x28, 0xD5, 0x2A, 0x1A, 0xF6, 0x20, 0xD8, 0xE0, 0xDA, 0x36, 0xC4, 0x15,
+	0x40, 0xFB, 0x27, 0x0B, 0x37, 0x2F, 0xE5, 0x07, 0xD9, 0x1E, 0x0E, 0xF0,
+	0xC7, 0x29, 0x00, 0x26, 0xF4, 0xC2, 0x05, 0xE7, 0x28, 0xD6, 0xF4, 0xCC,
+	0x3F, 0x0E, 0x2E, 0xD1, 0xF7, 0xC3, 0x01, 0xFD, 0xCE, 0xC0, 0x3C, 0x19,
+	0x20, 0x0E, 0x09, 0x33, 0x36, 0x3D, 0xC0, 0x23, 0x0B, 0xEE, 0x3E, 0xC8,
+	0xCE, 0x0B, 0x35, 0xE7, 0x1A, 0x3A, 0x3C, 0x15, 0xF0, 0xC2, 0xC6, 0x29,
+	0x00, 0x07, 0xD0, 0xC2, 0x13, 0x27, 0xFE, 0xF8, 0x3A, 0xEE, 0xE3, 0xC6,
+	0x1C, 0x34, 0x0D, 0x28, 0xCA, 0xD7, 0x20, 0x3E, 0xEE, 0xE7, 0x0C, 0xE8,
+	0xF3, 0x3D, 0x1E, 0xFC, 0x07, 0xDB, 0x39, 0x19, 0xEB, 0xE9, 0xE8, 0x33,
+	0xD0, 0x3D, 0x35, 0x39, 0xF4, 0xFD, 0xE1, 0xFB, 0x2C, 0x31, 0xEA, 0x04,
+	0x34, 0xCE, 0x0D, 0xE8, 0xDE, 0xD5, 0xC5, 0xD0, 0x3A, 0xC9, 0xF9, 0x13,
+	0xFE, 0xE6, 0x3B, 0x3B, 0x2D, 0x3B, 0xC0, 0x23, 0x3C, 0x37, 0xFB, 0x0F,
+	0xF2, 0x2B, 0x26, 0x32, 0x25, 0xE3, 0xC1, 0xDE, 0x04, 0x28, 0x08, 0xF6,
+	0xD3, 0xC0, 0xC2, 0xE1, 0x1F, 0x24, 0xEC, 0x3F, 0xCA, 0x37, 0x18, 0xF3,
+	0x2F, 0x12, 0xC8, 0x0F, 0xCD, 0x26, 0xDD, 0x16, 0x40, 0x13, 0x2B, 0xEF,
+	0xCF, 0xE7, 0x37, 0x3E, 0x1C, 0xE8, 0xF1, 0x0D, 0x3F, 0x2C, 0xEE, 0xD0,
+	0xF7, 0xFD, 0x32, 0x0F, 0x29, 0x26, 0x07, 0x26, 0xC4, 0xED, 0xF1, 0xFA,
+	0x32, 0xEB, 0xC7, 0xD4, 0x34, 0x3C, 0xE4, 0x2D, 0xF2, 0x33, 0xC5, 0x30,
+	0x32, 0x02, 0xD5, 0xE0, 0x3B, 0x0D, 0xEA, 0x37, 0xCC, 0xD8, 0x09, 0xDD,
+	0x1E, 0x04, 0xE2, 0x2A, 0xFF, 0x40, 0xD3, 0x3D, 0x2F, 0xCA, 0x2D, 0xCD,
+	0x19, 0xF4, 0x37, 0x34, 0x32, 0xC8, 0x1F, 0x16, 0xEC, 0x18, 0xC4, 0xF5,
+	0x10, 0x00, 0x03, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x9A, 0x79, 0x82, 0x5A, 0xF9, 0xFF, 0xFF, 0xFF, 0x80, 0xFF, 0xFF, 0xFF,
+	0x7F, 0x00, 0x00, 0x00, 0xEF, 0xFF, 0xFF, 0xFF, 0x0D, 0xFF, 0xFF, 0xFF,
+	0x9C, 0x00, 0x00, 0x00, 0xDF, 0x40, 0xFA, 0x0A, 0xEA, 0xD3, 0xC4, 0xFE,
+	0x0C, 0xFA, 0xDF, 0x2A, 0xD5, 0xE2, 0x22, 0x26, 0x1B, 0xFD, 0xFB, 0xD1,
+	0xC6, 0xC8, 0x0F, 0xD7, 0xE0, 0x13, 0x2B, 0xFA, 0xCB, 0xD0, 0xF1, 0xC5,
+	0x16, 0x39, 0xC0, 0x13, 0xD4, 0xD8, 0x18, 0x34, 0x01, 0xC7, 0xEC, 0xCD,
+	0xE1, 0x20, 0xF3, 0xC7,
+};
+
+const uint32_t ulClassifierDefaultModelSize = sizeof( ucClassifierDefaultModel );
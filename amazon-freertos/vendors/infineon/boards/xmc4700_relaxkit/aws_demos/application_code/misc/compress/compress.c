@@ -0,0 +1,332 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <string.h>
+
+#include "compress.h"
+#include "message_schema.h"
+#include "json/json_sensor.h"
+
+
+/* LZ4 block format limits */
+#define COMP_MIN_MATCH				( 4 )
+#define COMP_LAST_LITERALS			( 5 )		/* The block ends with at least this many literals */
+#define COMP_MATCH_LIMIT			( 12 )		/* No match starts closer to the end */
+#define COMP_OFFSET_MAX				( 0xFFFF )
+#define COMP_RUN_MASK				( 0x0F )
+
+#define COMP_HASH_SIZE				( 1U << COMP_HASH_BITS )
+
+/*
+ * Preset dictionary, the keys of every payload entry as JSON_bSensorAdd writes them.
+ * Matches reach back into it as if it preceded the payload, so even the first
+ * window of a batch costs a few bytes per key. A changed dictionary needs a new
+ * COMP_DICT_VERSION, the receiver keeps every version it has seen.
+ */
+#define COMP_DICT_PARAMETER( id, name, ... )	"\"" #name "\":{\"" JSON_SENSOR_ON_STRING "\":1,\"" JSON_SENSOR_STAT_STRING "\":["
+#define COMP_DICT_PAIR( id, name, ... )			"\"" #name "\":{\"" JSON_SENSOR_ON_STRING "\":1,\"" JSON_SENSOR_DERIVED_STRING "\":["
+
+static const char pcCompDict[] =
+	"\"Correlation\":{\"" JSON_SENSOR_ON_STRING "\":1,\"" JSON_SENSOR_COV_STRING "\":["
+	"],\"" JSON_SENSOR_CORR_STRING "\":[],\"" JSON_SENSOR_LAG_STRING "\":["
+	"\"Classifier\":{\"" JSON_SENSOR_ON_STRING "\":1,\"" JSON_SENSOR_CLASS_STRING "\":"
+	",\"" JSON_SENSOR_PROB_STRING "\":["
+	MSG_PAIRS( COMP_DICT_PAIR )
+	MSG_PARAMETERS( COMP_DICT_PARAMETER )
+	"],\"" JSON_SENSOR_FFT_STRING "\":["
+	"],\"" JSON_SENSOR_EDGE_STRING "\":["
+	"\":{\"" JSON_SENSOR_ON_STRING "\":0},"
+	"]},\"now\":";
+
+#define COMP_DICT_SIZE				( sizeof( pcCompDict ) - 1 )
+
+/* Positions in the dictionary followed by the input */
+static uint16_t pusCompHash[COMP_HASH_SIZE];
+
+
+static inline uint32_t prvRead32( const uint8_t *pucData )
+{
+	uint32_t ulVal;
+
+	memcpy( &ulVal, pucData, sizeof( ulVal ) );
+
+	return ulVal;
+}
+
+
+static inline uint32_t prvHash( uint32_t ulSeq )
+{
+	return ( ulSeq * 2654435761U ) >> ( 32 - COMP_HASH_BITS );
+}
+
+
+/* Length in the 4 bit field of the token plus 255 bytes, false if the output is full */
+static bool prvLengthWrite( uint8_t **ppucOut, const uint8_t *pucEnd, uint32_t ulLen )
+{
+	while( ulLen >= 255 )
+	{
+		if( *ppucOut >= pucEnd )
+		{
+			return false;
+		}
+		*( *ppucOut )++ = 255;
+		ulLen -= 255;
+	}
+	if( *ppucOut >= pucEnd )
+	{
+		return false;
+	}
+	*( *ppucOut )++ = ( uint8_t )ulLen;
+
+	return true;
+}
+
+
+/* Token, literals and, unless it is the last sequence, the match */
+static bool prvSequenceWrite( uint8_t **ppucOut, const uint8_t *pucEnd, const uint8_t *pucLiterals, uint32_t ulLiterals,
+							  uint32_t ulOffset, uint32_t ulMatch )
+{
+	uint8_t *pucToken = *ppucOut;
+	uint32_t ulMatchCode = ( ulMatch > 0 ) ? ulMatch - COMP_MIN_MATCH : 0;
+
+	if( pucToken >= pucEnd )
+	{
+		return false;
+	}
+	*pucToken = ( ( ( ulLiterals < COMP_RUN_MASK ) ? ulLiterals : COMP_RUN_MASK ) << 4 ) |
+				( ( ulMatchCode < COMP_RUN_MASK ) ? ulMatchCode : COMP_RUN_MASK );
+	( *ppucOut )++;
+
+	if( ( ulLiterals >= COMP_RUN_MASK ) && !prvLengthWrite( ppucOut, pucEnd, ulLiterals - COMP_RUN_MASK ) )
+	{
+		return false;
+	}
+	if( ( uint32_t )( pucEnd - *ppucOut ) < ulLiterals )
+	{
+		return false;
+	}
+	memcpy( *ppucOut, pucLiterals, ulLiterals );
+	*ppucOut += ulLiterals;
+
+	if( ulMatch == 0 )
+	{
+		return true;
+	}
+
+	if( pucEnd - *ppucOut < 2 )
+	{
+		return false;
+	}
+	*( *ppucOut )++ = ( uint8_t )ulOffset;
+	*( *ppucOut )++ = ( uint8_t )( ulOffset >> 8 );
+
+	if( ( ulMatchCode >= COMP_RUN_MASK ) && !prvLengthWrite( ppucOut, pucEnd, ulMatchCode - COMP_RUN_MASK ) )
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+uint32_t COMP_ulCompress( const uint8_t *pucIn, uint32_t ulLen, uint8_t *pucOut, uint32_t ulOutSize )
+{
+	const uint8_t *pucDict = ( const uint8_t * )pcCompDict;
+	const uint8_t *pucEnd = pucOut + ulOutSize;
+	uint8_t *pucPos = pucOut + COMP_HEADER_SIZE;
+	uint32_t ulAnchor = 0;
+	uint32_t i = 0;
+
+	/* Positions are 16 bit across the dictionary and the input */
+	if( ( ulOutSize < COMP_HEADER_SIZE ) || ( ulLen > COMP_OFFSET_MAX - COMP_DICT_SIZE ) )
+	{
+		return 0;
+	}
+
+	pucOut[0] = COMP_MAGIC;
+	pucOut[1] = COMP_DICT_VERSION;
+	pucOut[2] = ( uint8_t )ulLen;
+	pucOut[3] = ( uint8_t )( ulLen >> 8 );
+
+	memset( pusCompHash, 0, sizeof( pusCompHash ) );
+	for( uint32_t j = 0; j + COMP_MIN_MATCH <= COMP_DICT_SIZE; j++ )
+	{
+		pusCompHash[prvHash( prvRead32( &pucDict[j] ) )] = ( uint16_t )j;
+	}
+
+	while( i + COMP_MATCH_LIMIT <= ulLen )
+	{
+		uint32_t ulSeq = prvRead32( &pucIn[i] );
+		uint32_t ulHash = prvHash( ulSeq );
+		uint32_t ulCand = pusCompHash[ulHash];
+		uint32_t ulPos = COMP_DICT_SIZE + i;
+		const uint8_t *pucRef;
+		uint32_t ulRefMax;
+		uint32_t ulMatch;
+
+		pusCompHash[ulHash] = ( uint16_t )ulPos;
+
+		/* A match from the dictionary stops at its end, one from the input may overlap the current position */
+		if( ulCand < COMP_DICT_SIZE )
+		{
+			pucRef = &pucDict[ulCand];
+			ulRefMax = COMP_DICT_SIZE - ulCand;
+		}
+		else
+		{
+			pucRef = &pucIn[ulCand - COMP_DICT_SIZE];
+			ulRefMax = ulLen;
+		}
+
+		if( ( ulCand >= ulPos ) || ( ulRefMax < COMP_MIN_MATCH ) || ( prvRead32( pucRef ) != ulSeq ) )
+		{
+			i++;
+			continue;
+		}
+
+		ulMatch = COMP_MIN_MATCH;
+		while( ( ulMatch < ulRefMax ) && ( i + ulMatch < ulLen - COMP_LAST_LITERALS ) && ( pucRef[ulMatch] == pucIn[i + ulMatch] ) )
+		{
+			ulMatch++;
+		}
+
+		if( !prvSequenceWrite( &pucPos, pucEnd, &pucIn[ulAnchor], i - ulAnchor, ulPos - ulCand, ulMatch ) )
+		{
+			return 0;
+		}
+
+		i += ulMatch;
+		ulAnchor = i;
+
+		/* Position inside the match, helps the next repeated key */
+		if( i + COMP_MATCH_LIMIT <= ulLen )
+		{
+			pusCompHash[prvHash( prvRead32( &pucIn[i - 2] ) )] = ( uint16_t )( COMP_DICT_SIZE + i - 2 );
+		}
+	}
+
+	if( !prvSequenceWrite( &pucPos, pucEnd, &pucIn[ulAnchor], ulLen - ulAnchor, 0, 0 ) )
+	{
+		return 0;
+	}
+
+	return ( uint32_t )( pucPos - pucOut );
+}
+
+
+/* Length continued in 255 bytes, false past the end of the input */
+static bool prvLengthRead( const uint8_t **ppucIn, const uint8_t *pucEnd, uint32_t *pulLen )
+{
+	uint8_t ucByte;
+
+	do
+	{
+		if( *ppucIn >= pucEnd )
+		{
+			return false;
+		}
+		ucByte = *( *ppucIn )++;
+		*pulLen += ucByte;
+	} while( ucByte == 255 );
+
+	return true;
+}
+
+
+int32_t COMP_lDecompress( const uint8_t *pucIn, uint32_t ulLen, uint8_t *pucOut, uint32_t ulOutSize )
+{
+	const uint8_t *pucDict = ( const uint8_t * )pcCompDict;
+	const uint8_t *pucEnd = pucIn + ulLen;
+	uint32_t ulOrig, ulOut = 0;
+
+	if( ( ulLen < COMP_HEADER_SIZE + 1 ) || ( pucIn[0] != COMP_MAGIC ) || ( pucIn[1] != COMP_DICT_VERSION ) )
+	{
+		return -1;
+	}
+	ulOrig = pucIn[2] | ( ( uint32_t )pucIn[3] << 8 );
+	if( ulOrig > ulOutSize )
+	{
+		return -1;
+	}
+	pucIn += COMP_HEADER_SIZE;
+
+	while( pucIn < pucEnd )
+	{
+		uint8_t ucToken = *pucIn++;
+		uint32_t ulLiterals = ucToken >> 4;
+		uint32_t ulMatch = ucToken & COMP_RUN_MASK;
+		uint32_t ulOffset;
+
+		if( ( ulLiterals == COMP_RUN_MASK ) && !prvLengthRead( &pucIn, pucEnd, &ulLiterals ) )
+		{
+			return -1;
+		}
+		if( ( ( uint32_t )( pucEnd - pucIn ) < ulLiterals ) || ( ulOut + ulLiterals > ulOrig ) )
+		{
+			return -1;
+		}
+		memcpy( &pucOut[ulOut], pucIn, ulLiterals );
+		pucIn += ulLiterals;
+		ulOut += ulLiterals;
+
+		/* The last sequence has literals only */
+		if( pucIn == pucEnd )
+		{
+			break;
+		}
+
+		if( pucEnd - pucIn < 2 )
+		{
+			return -1;
+		}
+		ulOffset = pucIn[0] | ( ( uint32_t )pucIn[1] << 8 );
+		pucIn += 2;
+		if( ( ulMatch == COMP_RUN_MASK ) && !prvLengthRead( &pucIn, pucEnd, &ulMatch ) )
+		{
+			return -1;
+		}
+		ulMatch += COMP_MIN_MATCH;
+
+		if( ( ulOffset == 0 ) || ( ulOffset > ulOut + COMP_DICT_SIZE ) || ( ulOut + ulMatch > ulOrig ) )
+		{
+			return -1;
+		}
+
+		/* Byte by byte, the match may overlap the output and start in the dictionary */
+		for( uint32_t j = 0; j < ulMatch; j++, ulOut++ )
+		{
+			uint32_t ulRef = COMP_DICT_SIZE + ulOut - ulOffset;
+			pucOut[ulOut] = ( ulRef < COMP_DICT_SIZE ) ? pucDict[ulRef] : pucOut[ulRef - COMP_DICT_SIZE];
+		}
+	}
+
+	return ( ulOut == ulOrig ) ? ( int32_t )ulOut : -1;
+}
+
+
+const uint8_t *COMP_pucDict( uint32_t *pulSize )
+{
+	*pulSize = COMP_DICT_SIZE;
+
+	return ( const uint8_t * )pcCompDict;
+}
@@ -0,0 +1,61 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/**
+ * Payload frame:
+ *   COMP_MAGIC, COMP_DICT_VERSION, original length ( 16 bit, little endian ),
+ *   LZ4 block ( lz4_Block_format ) compressed with the preset dictionary of that version
+ * The first byte tells a frame from a JSON '{', a CBOR map or CSV digits. Any standard
+ * LZ4 block decoder with the dictionary as "external dictionary" reads the block.
+ */
+#define COMP_MAGIC					( 0xC4 )
+#define COMP_DICT_VERSION			( 1 )
+#define COMP_HEADER_SIZE			( 4 )
+
+/* Hash table entries, 2 bytes each of static RAM */
+#define COMP_HASH_BITS				( 10 )
+
+/* Worst case frame of incompressible data */
+#define COMP_BOUND( len )			( COMP_HEADER_SIZE + ( len ) + ( len ) / 255 + 16 )
+
+
+/**
+ * Frame of the ulLen bytes into pucOut, 0 if it doesn't fit ulOutSize or ulLen is over
+ * 0xFFFF - COMP_DICT_SIZE, the positions across the dictionary of COMP_pucDict() and the
+ * input are 16 bit; one caller at a time, the hash table is static
+ */
+uint32_t COMP_ulCompress( const uint8_t *pucIn, uint32_t ulLen, uint8_t *pucOut, uint32_t ulOutSize );
+/** original data of the frame, -1 if the frame is malformed or doesn't fit ulOutSize */
+int32_t COMP_lDecompress( const uint8_t *pucIn, uint32_t ulLen, uint8_t *pucOut, uint32_t ulOutSize );
+/** preset dictionary of COMP_DICT_VERSION, for a receiver built from the same sources */
+const uint8_t *COMP_pucDict( uint32_t *pulSize );
+
+
+#endif /* COMPRESS_H */
@@ -25,6 +25,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <math.h>
 
 #include "converting.h"
@@ -33,391 +34,490 @@
 #include "sensors.h"
 #include "app_error.h"
 #include "float_to_string.h"
+#include "cbor_sensor.h"
+#include "dbg.h"
+
+
+/* JSON_bSensorAdd or CBOR_bSensorAdd */
+typedef bool ( *SensorAdd_t )( void *pvEncoder, SensorContext_t *pxSensorCxt );
+
+/* Parameter row of message_schema.h */
+typedef struct {
+	uint8_t ucSensor;
+	uint8_t ucPrecision;
+} MsgParameterRow_t;
+
+#define MSG_SENSOR_ENABLED( sensor )								( SENSOR_##sensor##_ENABLE > 0 ),
+#define MSG_SENSOR_COUNT( sensor )									+ ( SENSOR_##sensor##_ENABLE > 0 )
+#define MSG_PARAMETER_ROW( id, name, sensor, precision, ... )		{ MSG_SENSOR_##sensor, precision },
+#define MSG_PARAMETER_COUNT( id, name, sensor, ... )				+ ( SENSOR_##sensor##_ENABLE > 0 )
+#define MSG_SPECTRUM_SOURCE( id, source, coded )					offsetof( InfineonSensorsData_t, source ),
+#define MSG_SPECTRUM_CODED( id, source, coded )						coded,
+#define MSG_SPECTRUM_OF( id, source, coded )						[MSG_PARAMETER_##id] = MSG_SPECTRUM_##id + 1,
+#define MSG_EDGE_SENSOR( id, sensor )								MSG_SENSOR_##sensor,
+#define MSG_EDGE_COUNT( id, sensor )								+ ( SENSOR_##sensor##_ENABLE > 0 )
+#define MSG_EDGE_OF( id, sensor )									[MSG_PARAMETER_##id] = MSG_EDGE_##id + 1,
+#define MSG_PAIR_ENABLED( id, name, sensor )						( SENSOR_##sensor##_ENABLE > 0 ),
+#define MSG_PAIR_COUNT( id, name, sensor )							+ ( SENSOR_##sensor##_ENABLE > 0 )
+
+/* InfineonSensorsData_t holds the enabled rows only, in the same order */
+STATIC_ASSERT( ( 0 MSG_SENSORS( MSG_SENSOR_COUNT ) ) == SENSORS_NUMBER, msg_sensors_mismatch );
+STATIC_ASSERT( ( 0 MSG_PARAMETERS( MSG_PARAMETER_COUNT ) ) == PARAMETERS_NUMBER, msg_parameters_mismatch );
+STATIC_ASSERT( ( 0 MSG_EDGES( MSG_EDGE_COUNT ) ) == SENSORS_EDGE_NUMBER, msg_edges_mismatch );
+STATIC_ASSERT( ( 0 MSG_PAIRS( MSG_PAIR_COUNT ) ) == SENSORS_PAIR_NUMBER, msg_pairs_mismatch );
+/* Parameters are the first payload entries, the id is the index */
+STATIC_ASSERT( JSON_STATISTIC_SENSOR_MAX == MSG_PARAMETER_MAX + MSG_PAIR_MAX + 2, msg_payload_entries_mismatch );
+
+static const bool pbSensorEnabled[] = { MSG_SENSORS( MSG_SENSOR_ENABLED ) };
+static const MsgParameterRow_t xParameterRow[] = { MSG_PARAMETERS( MSG_PARAMETER_ROW ) };
+static const uint32_t pulSpectrumSource[] = { MSG_SPECTRA( MSG_SPECTRUM_SOURCE ) };
+static const bool pbSpectrumCoded[] = { MSG_SPECTRA( MSG_SPECTRUM_CODED ) };
+static const uint8_t pucEdgeSensor[] = { MSG_EDGES( MSG_EDGE_SENSOR ) };
+static const bool pbPairEnabled[] = { MSG_PAIRS( MSG_PAIR_ENABLED ) };
+/* Spectrum and edge of each parameter plus one, 0 without */
+static const uint8_t pucSpectrumOf[MSG_PARAMETER_MAX] = { MSG_SPECTRA( MSG_SPECTRUM_OF ) };
+static const uint8_t pucEdgeOf[MSG_PARAMETER_MAX] = { MSG_EDGES( MSG_EDGE_OF ) };
+
+/* Spectra of the window before, the receiver keeps the same */
+static SpecCodec_t xSpecCodec[MSG_SPECTRUM_MAX];
+/* Codec state before the message being encoded, back to it when the message is not sent */
+static SpecCodec_t xSpecCodecSaved[MSG_SPECTRUM_MAX];
 
 
 void vSensorsDataToMessage( InfineonSensorsData_t *pxSensorsData, InfineonSensorsMessage_t *pxSensorsMessage )
 {
+	uint32_t ulPos = 0;
+
+	for( uint32_t i = 0; i < MSG_SENSOR_MAX; i++ )
+	{
+		pxSensorsMessage->bOn[i] = pbSensorEnabled[i] && pxSensorsData->bSensorsOn.on_buf[ulPos];
+		pxSensorsMessage->bReady[i] = pbSensorEnabled[i] && pxSensorsData->bSensorsReady.on_buf[ulPos];
+		ulPos += pbSensorEnabled[i];
+	}
+
+	ulPos = 0;
+	for( uint32_t i = 0; i < MSG_PARAMETER_MAX; i++ )
+	{
+		if( pbSensorEnabled[xParameterRow[i].ucSensor] )
+		{
+			pxSensorsMessage->xStat[i].fMin = pxSensorsData->Min.stat_buf[ulPos];
+			pxSensorsMessage->xStat[i].fMax = pxSensorsData->Max.stat_buf[ulPos];
+			pxSensorsMessage->xStat[i].fMean = pxSensorsData->Mean.stat_buf[ulPos];
+			pxSensorsMessage->xStat[i].fRMS = pxSensorsData->Rms.stat_buf[ulPos];
+			pxSensorsMessage->xStat[i].fStdDev = pxSensorsData->StdDev.stat_buf[ulPos];
+			pxSensorsMessage->xStat[i].fVariance = pxSensorsData->Variance.stat_buf[ulPos];
+			ulPos++;
+		}
+	}
 
-    StatData_t *pxSensorsStat[] = {
-#if( SENSOR_DPS368_1_ENABLE > 0 )
-    		&pxSensorsMessage->fDPS368Temperature_1,
-			&pxSensorsMessage->fDPS368Pressure_1,
-#endif
-
-#if( SENSOR_DPS368_2_ENABLE > 0 )
-			&pxSensorsMessage->fDPS368Temperature_2,
-			&pxSensorsMessage->fDPS368Pressure_2,
-#endif
-
-#if( SENSOR_DPS368_3_ENABLE > 0 )
-			&pxSensorsMessage->fDPS368Temperature_3,
-			&pxSensorsMessage->fDPS368Pressure_3,
-#endif
-
-#if( SENSOR_DPS368_4_ENABLE > 0 )
-			&pxSensorsMessage->fDPS368Temperature_4,
-			&pxSensorsMessage->fDPS368Pressure_4,
-#endif
-
-#if( SENSOR_DPS368_5_ENABLE > 0 )
-			&pxSensorsMessage->fDPS368Temperature_5,
-			&pxSensorsMessage->fDPS368Pressure_5,
-#endif
-
-#if( SENSOR_TLI4971_1_ENABLE > 0 )
-			&pxSensorsMessage->fTLI4971Current_1,
-#endif
-
-#if( SENSOR_TLI4971_2_ENABLE > 0 )
-			&pxSensorsMessage->fTLI4971Current_2,
-#endif
-
-#if( SENSOR_TLI4971_3_ENABLE > 0 )
-			&pxSensorsMessage->fTLI4971Current_3,
-#endif
-
-#if( SENSOR_TLE4997_1_ENABLE > 0 )
-			&pxSensorsMessage->fTLE4997LinearHall_1,
-#endif
-
-#if( SENSOR_TLE4964_1_ENABLE > 0 )
-			&pxSensorsMessage->fTLE4964Hall_1,
-#endif
-
-#if( SENSOR_TLE4961_3K_1_ENABLE > 0 )
-			&pxSensorsMessage->fTLE49613kHall_1,
-#endif
-
-#if( SENSOR_TLE4913_1_ENABLE > 0 )
-			&pxSensorsMessage->fTLE4913Hall_1,
-#endif
-
-#if( SENSOR_TLE4961_1K_1_ENABLE > 0 )
-			&pxSensorsMessage->fTLE49611kHall_1,
-#endif
+	/* Everything goes until REPORT_vFilter or the MQTT task says otherwise */
+	memset( pxSensorsMessage->bSuppressed, 0, sizeof( pxSensorsMessage->bSuppressed ) );
+	pxSensorsMessage->xDetail = MSG_DETAIL_FULL;
 
-#if( SENSOR_TLI4966_1_ENABLE > 0 )
-			&pxSensorsMessage->fTLI4966gDoubleHall_Speed_1,
-			&pxSensorsMessage->fTLI4966gDoubleHall_Dir_1,
-#endif
+	ulPos = 0;
+	for( uint32_t i = 0; i < MSG_EDGE_MAX; i++ )
+	{
+		if( pbSensorEnabled[pucEdgeSensor[i]] )
+		{
+			pxSensorsMessage->xEdge[i].fFrequency = pxSensorsData->Frequency.edge_buf[ulPos];
+			pxSensorsMessage->xEdge[i].fDutyCycle = pxSensorsData->DutyCycle.edge_buf[ulPos];
+			pxSensorsMessage->xEdge[i].ulPulseCount = pxSensorsData->PulseCount.count_buf[ulPos];
+			pxSensorsMessage->xEdge[i].fDwellOn = pxSensorsData->DwellOn.edge_buf[ulPos];
+			pxSensorsMessage->xEdge[i].fDwellOff = pxSensorsData->DwellOff.edge_buf[ulPos];
+			ulPos++;
+		}
+	}
+
+	ulPos = 0;
+	for( uint32_t i = 0; i < MSG_PAIR_MAX; i++ )
+	{
+		pxSensorsMessage->bPairOn[i] = pbPairEnabled[i] && pxSensorsData->bPairsOn.pair_on_buf[ulPos];
+		pxSensorsMessage->bPairReady[i] = pbPairEnabled[i] && pxSensorsData->bPairsReady.pair_on_buf[ulPos];
+		if( pbPairEnabled[i] )
+		{
+			pxSensorsMessage->xPair[i].fDiffPressure = pxSensorsData->DiffPressure.pair_buf[ulPos];
+			pxSensorsMessage->xPair[i].fFlow = pxSensorsData->Flow.pair_buf[ulPos];
+			pxSensorsMessage->xPair[i].fCloggingIndex = pxSensorsData->CloggingIndex.pair_buf[ulPos];
+			ulPos++;
+		}
+	}
 
-#if( SENSOR_IM69D130_ENABLE > 0 )
-			&pxSensorsMessage->fIM69dMic_1,
-#endif
+	for( uint32_t i = 0; i < MSG_SPECTRUM_MAX; i++ )
+	{
+		memcpy( pxSensorsMessage->xFft[i].data, (uint8_t *)pxSensorsData + pulSpectrumSource[i], sizeof( pxSensorsMessage->xFft[i].data ) );
+	}
 
-#if( SENSOR_TLI493D_1_ENABLE > 0 )
-			&pxSensorsMessage->fTLI493dMagnetic_X_1,
-			&pxSensorsMessage->fTLI493dMagnetic_Y_1,
-			&pxSensorsMessage->fTLI493dMagnetic_Z_1,
-#endif
+    pxSensorsMessage->bCorrelationOn = pxSensorsData->bCorrelationOn;
+    pxSensorsMessage->bCorrelationReady = pxSensorsData->bCorrelationReady;
+    memcpy( &pxSensorsMessage->xCorrelation, &pxSensorsData->xCorrelation, sizeof( CorrelationData_t ) );
 
-    };
+    pxSensorsMessage->bClassifierOn = pxSensorsData->bClassifierOn;
+    pxSensorsMessage->bClassifierReady = pxSensorsData->bClassifierReady;
+    memcpy( &pxSensorsMessage->xClassifier, &pxSensorsData->xClassifier, sizeof( ClassifierData_t ) );
 
-    bool *pbSensorsOn[] = {
-#if( SENSOR_DPS368_1_ENABLE > 0 )
-    		 &pxSensorsMessage->bDPS368On_1,
-#endif
+}
 
-#if( SENSOR_DPS368_2_ENABLE > 0 )
-    		 &pxSensorsMessage->bDPS368On_2,
-#endif
 
-#if( SENSOR_DPS368_3_ENABLE > 0 )
-    		 &pxSensorsMessage->bDPS368On_3,
-#endif
+/* Every entry of the message in the order of JsonSensorsStatistic_t to the encoder */
+static bool prvMessageEncode( InfineonSensorsMessage_t *pxSensorsMessage, SensorAdd_t pxSensorAdd, void *pvEncoder )
+{
+	bool bRet = true;
 
-#if( SENSOR_DPS368_4_ENABLE > 0 )
-    		 &pxSensorsMessage->bDPS368On_4,
-#endif
+	static const SensorContext_t xSensorCxtEmpty;
+    SensorContext_t xSensorCxt = xSensorCxtEmpty;
+    bool bSpectra = ( pxSensorsMessage->xDetail == MSG_DETAIL_FULL );
+    bool bFeatures = ( pxSensorsMessage->xDetail != MSG_DETAIL_STATS );
 
-#if( SENSOR_DPS368_5_ENABLE > 0 )
-    		 &pxSensorsMessage->bDPS368On_5,
-#endif
+    for( uint32_t i = 0; ( i < MSG_PARAMETER_MAX ) && bRet; i++ )
+    {
+    	/* A spectrum left out keeps its codec state, the next one is coded against the last one sent */
+    	uint8_t ucSpectrum = bSpectra ? pucSpectrumOf[i] : 0;
+
+    	xSensorCxt.bOn = pxSensorsMessage->bOn[xParameterRow[i].ucSensor];
+    	xSensorCxt.bReady = pxSensorsMessage->bReady[xParameterRow[i].ucSensor] && !pxSensorsMessage->bSuppressed[i];
+    	xSensorCxt.pcName = pcJsonSensorsStatString[i];
+    	xSensorCxt.ucId = i;
+    	xSensorCxt.ucPrecision = xParameterRow[i].ucPrecision;
+    	xSensorCxt.pxStat = &pxSensorsMessage->xStat[i];
+    	xSensorCxt.pxFft = ucSpectrum ? &pxSensorsMessage->xFft[ucSpectrum - 1] : NULL;
+    	xSensorCxt.pxSpecCodec = ( ucSpectrum && pbSpectrumCoded[ucSpectrum - 1] ) ? &xSpecCodec[ucSpectrum - 1] : NULL;
+    	xSensorCxt.pxEdge = ( bFeatures && pucEdgeOf[i] ) ? &pxSensorsMessage->xEdge[pucEdgeOf[i] - 1] : NULL;
+    	bRet = pxSensorAdd( pvEncoder, &xSensorCxt );
+    }
 
-#if( SENSOR_TLI4971_1_ENABLE > 0 )
-			 &pxSensorsMessage->bTLI4971On_1,
-#endif
+    /* Derived values have no statistic of their own, the context carries only them */
+    xSensorCxt = xSensorCxtEmpty;
+    for( uint32_t i = 0; ( i < MSG_PAIR_MAX ) && bRet; i++ )
+    {
+    	xSensorCxt.bOn = pxSensorsMessage->bPairOn[i];
+    	xSensorCxt.bReady = pxSensorsMessage->bPairReady[i];
+    	xSensorCxt.ucId = MSG_PARAMETER_MAX + i;
+    	xSensorCxt.pcName = pcJsonSensorsStatString[xSensorCxt.ucId];
+    	xSensorCxt.pxDerived = &pxSensorsMessage->xPair[i];
+    	bRet = pxSensorAdd( pvEncoder, &xSensorCxt );
+    }
 
-#if( SENSOR_TLI4971_2_ENABLE > 0 )
-			 &pxSensorsMessage->bTLI4971On_2,
-#endif
+    xSensorCxt = xSensorCxtEmpty;
+    if( bRet )
+    {
+    	xSensorCxt.bOn = pxSensorsMessage->bCorrelationOn;
+    	xSensorCxt.bReady = pxSensorsMessage->bCorrelationReady && bFeatures;
+    	xSensorCxt.ucId = JSON_STATISTIC_SENSOR_CORRELATION;
+    	xSensorCxt.pcName = pcJsonSensorsStatString[xSensorCxt.ucId];
+    	xSensorCxt.pxCorr = &pxSensorsMessage->xCorrelation;
+    	bRet = pxSensorAdd( pvEncoder, &xSensorCxt );
+    }
 
-#if( SENSOR_TLI4971_3_ENABLE > 0 )
-			 &pxSensorsMessage->bTLI4971On_3,
-#endif
+    xSensorCxt = xSensorCxtEmpty;
+    if( bRet )
+    {
+    	xSensorCxt.bOn = pxSensorsMessage->bClassifierOn;
+    	xSensorCxt.bReady = pxSensorsMessage->bClassifierReady && bFeatures;
+    	xSensorCxt.ucId = JSON_STATISTIC_SENSOR_CLASSIFIER;
+    	xSensorCxt.pcName = pcJsonSensorsStatString[xSensorCxt.ucId];
+    	xSensorCxt.pxClass = &pxSensorsMessage->xClassifier;
+    	bRet = pxSensorAdd( pvEncoder, &xSensorCxt );
+    }
 
-#if( SENSOR_TLE4997_1_ENABLE > 0 )
-			 &pxSensorsMessage->bTLE4997On_1,
-#endif
+    return bRet;
+}
 
-#if( SENSOR_TLE4964_1_ENABLE > 0 )
-			 &pxSensorsMessage->bTLE4964On_1,
-#endif
 
-#if( SENSOR_TLE4961_3K_1_ENABLE > 0 )
-			 &pxSensorsMessage->bTLE49613KOn_1,
-#endif
+static bool prvJsonSensorAdd( void *pvEncoder, SensorContext_t *pxSensorCxt )
+{
+	return JSON_bSensorAdd( (JsonContext_t *)pvEncoder, pxSensorCxt );
+}
 
-#if( SENSOR_TLE4913_1_ENABLE > 0 )
-			 &pxSensorsMessage->bTLE4913On_1,
-#endif
 
-#if( SENSOR_TLE4961_1K_1_ENABLE > 0 )
-			 &pxSensorsMessage->bTLE49611KOn_1,
-#endif
+bool JSON_bGenerateToSend( InfineonSensorsMessage_t *pxSensorsMessage, char* pucJsonBuf, uint32_t ulMaxSize, uint32_t *pulLen )
+{
+	bool bRet = false;
 
-#if( SENSOR_TLI4966_1_ENABLE > 0 )
-			 &pxSensorsMessage->bTLI4966gOn_1,
-#endif
+	JsonContext_t xJsonCxt;
 
-#if( SENSOR_IM69D130_ENABLE > 0 )
-			 &pxSensorsMessage->bIM69dOn_1,
-#endif
+    while( 1 )
+    {
+        bRet = JSON_bCreate( &xJsonCxt, pucJsonBuf, ulMaxSize );
+        if( !bRet ) break;
 
-#if( SENSOR_TLI493D_1_ENABLE > 0 )
-			 &pxSensorsMessage->bTLI493dOn_1,
-#endif
+        bRet = prvMessageEncode( pxSensorsMessage, prvJsonSensorAdd, &xJsonCxt );
+        if( !bRet ) break;
 
-    };
+        bRet = JSON_bFinish( &xJsonCxt, pulLen );
+        if( !bRet ) break;
 
+        bRet = true;
+        break;
+    }
 
-    for( int i = 0; i < SENSORS_NUMBER; ++i )
+    if( bRet )
     {
-    	*pbSensorsOn[i] = pxSensorsData->bSensorsOn.on_buf[i];
-    }
+    	if( JSON_MESSAGE_PRINT )
+    	{
+    		 configPRINTF( ( pucJsonBuf ) );
+    		 vTaskDelay( 10 );
+    	}
 
-    for( int i = 0; i < PARAMETERS_NUMBER; ++i )
+        return true;
+    }
+    else
     {
-    	pxSensorsStat[i]->fMin = pxSensorsData->Min.stat_buf[i];
-    	pxSensorsStat[i]->fMax = pxSensorsData->Max.stat_buf[i];
-    	pxSensorsStat[i]->fMean = pxSensorsData->Mean.stat_buf[i];
-    	pxSensorsStat[i]->fRMS = pxSensorsData->Rms.stat_buf[i];
-    	pxSensorsStat[i]->fStdDev = pxSensorsData->StdDev.stat_buf[i];
+        configPRINTF( ("JSON Failed") );
+        return false;
     }
 
-    memcpy( pxSensorsMessage->fIM69dMicSpectra_1.data, pxSensorsData->fMicBuffer.mic_fft_buf, sizeof( pxSensorsMessage->fIM69dMicSpectra_1.data ) );
-    memcpy( pxSensorsMessage->fTLE4997HallSpectra_1.data, pxSensorsData->fHallBuffer.adc_raw_buf, sizeof( pxSensorsMessage->fTLE4997HallSpectra_1.data ) );
-
 }
 
 
-static void prvStatDataToJSONStat( bool bSensorsOn, StatData_t *pxStatData, SensorContext_t *pxSensorCxt, JsonSensorsStatistic_t xJsonSensorStat )
+static bool prvCborSensorAdd( void *pvEncoder, SensorContext_t *pxSensorCxt )
 {
-	pxSensorCxt->pxStat->fMin = pxStatData->fMin;
-	pxSensorCxt->pxStat->fMax = pxStatData->fMax;
-	pxSensorCxt->pxStat->fRMS = pxStatData->fRMS;
-	pxSensorCxt->pxStat->fStdDev = pxStatData->fStdDev;
-	pxSensorCxt->pxStat->fMean = pxStatData->fMean;
-	pxSensorCxt->pcName = pcJsonSensorsStatString[xJsonSensorStat];
-	pxSensorCxt->bOn = bSensorsOn;
+	return CBOR_bSensorAdd( (CborEncoder *)pvEncoder, pxSensorCxt );
 }
 
 
-bool JSON_bGenerateToSend( InfineonSensorsMessage_t *pxSensorsMessage, char* pucJsonBuf, uint32_t ulMaxSize )
+bool CBOR_bGenerateToSend( InfineonSensorsMessage_t *pxSensorsMessage, uint8_t *pucBuf, uint32_t ulMaxSize, uint32_t *pulLen )
 {
 	bool bRet = false;
 
-	JsonContext_t xJsonCxt;
-
-	static const SensorContext_t xSensorCxtEmpty;
-    SensorContext_t xSensorCxt = xSensorCxtEmpty;
+	CborEncoder xEncoder, xMessage;
 
-    StatData_t xStatData;
-    xSensorCxt.pxStat = &xStatData;
+	memcpy( xSpecCodecSaved, xSpecCodec, sizeof( xSpecCodec ) );
 
     while( 1 )
     {
-        bRet = JSON_bCreate( &xJsonCxt, pucJsonBuf, ulMaxSize );
+    	cbor_encoder_init( &xEncoder, pucBuf, ulMaxSize, 0 );
+
+    	/* Sensors with an open window are skipped, the count is not known in advance */
+    	if( ( cbor_encoder_create_map( &xEncoder, &xMessage, CborIndefiniteLength ) != CborNoError ) ||
+    		( cbor_encode_uint( &xMessage, CBOR_KEY_VERSION ) != CborNoError ) ||
+			( cbor_encode_uint( &xMessage, CBOR_SCHEMA_VERSION ) != CborNoError ) )
+    	{
+    		break;
+    	}
+
+        bRet = prvMessageEncode( pxSensorsMessage, prvCborSensorAdd, &xMessage );
         if( !bRet ) break;
 
-        prvStatDataToJSONStat( pxSensorsMessage->bDPS368On_1, &pxSensorsMessage->fDPS368Temperature_1, &xSensorCxt, JSON_STATISTIC_SENSOR_DPS368_TEMP_1 );
-        bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-        if (!bRet) break;
+        bRet = ( cbor_encoder_close_container( &xEncoder, &xMessage ) == CborNoError );
+        if( !bRet ) break;
 
+        if( pulLen )
+        {
+        	*pulLen = cbor_encoder_get_buffer_size( &xEncoder, pucBuf );
+        }
+        break;
+    }
 
-        prvStatDataToJSONStat( pxSensorsMessage->bDPS368On_1, &pxSensorsMessage->fDPS368Pressure_1, &xSensorCxt, JSON_STATISTIC_SENSOR_DPS368_PRESS_1 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
+    if( !bRet )
+    {
+    	memcpy( xSpecCodec, xSpecCodecSaved, sizeof( xSpecCodec ) );
+        configPRINTF( ("CBOR Failed") );
+    }
 
-        prvStatDataToJSONStat( pxSensorsMessage->bDPS368On_2, &pxSensorsMessage->fDPS368Temperature_2, &xSensorCxt, JSON_STATISTIC_SENSOR_DPS368_TEMP_2 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
+    return bRet;
+}
 
-		prvStatDataToJSONStat( pxSensorsMessage->bDPS368On_2, &pxSensorsMessage->fDPS368Pressure_2, &xSensorCxt, JSON_STATISTIC_SENSOR_DPS368_PRESS_2 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
 
-		prvStatDataToJSONStat( pxSensorsMessage->bDPS368On_3, &pxSensorsMessage->fDPS368Temperature_3, &xSensorCxt, JSON_STATISTIC_SENSOR_DPS368_TEMP_3 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
+bool BATCH_bCreate( BatchContext_t *pxBatch, bool bCbor, uint8_t *pucBuf, uint32_t ulMaxSize )
+{
+	memset( pxBatch, 0, sizeof( BatchContext_t ) );
 
-		prvStatDataToJSONStat( pxSensorsMessage->bDPS368On_3, &pxSensorsMessage->fDPS368Pressure_3, &xSensorCxt, JSON_STATISTIC_SENSOR_DPS368_PRESS_3 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
+	if( ulMaxSize <= BATCH_TAIL_SIZE )
+	{
+		return false;
+	}
 
-		prvStatDataToJSONStat( pxSensorsMessage->bDPS368On_4, &pxSensorsMessage->fDPS368Temperature_4, &xSensorCxt, JSON_STATISTIC_SENSOR_DPS368_TEMP_4 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
+	pxBatch->bCbor = bCbor;
+	pxBatch->pucBuf = pucBuf;
+	pxBatch->ulMaxSize = ulMaxSize;
 
-		prvStatDataToJSONStat( pxSensorsMessage->bDPS368On_4, &pxSensorsMessage->fDPS368Pressure_4, &xSensorCxt, JSON_STATISTIC_SENSOR_DPS368_PRESS_4 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
+	if( !bCbor )
+	{
+		if( !JSON_bCreate( &pxBatch->xJson, (char *)pucBuf, ulMaxSize ) )
+		{
+			return false;
+		}
+		pxBatch->ulLen = pxBatch->xJson.lUsedLen;
+
+		return true;
+	}
+
+	/* Windows are added one by one, the counts are not known in advance */
+	cbor_encoder_init( &pxBatch->xEncoder, pucBuf, ulMaxSize, 0 );
+	if( ( cbor_encoder_create_map( &pxBatch->xEncoder, &pxBatch->xMessage, CborIndefiniteLength ) != CborNoError ) ||
+		( cbor_encode_uint( &pxBatch->xMessage, CBOR_KEY_VERSION ) != CborNoError ) ||
+		( cbor_encode_uint( &pxBatch->xMessage, CBOR_SCHEMA_VERSION ) != CborNoError ) ||
+		( cbor_encode_uint( &pxBatch->xMessage, CBOR_KEY_WINDOWS ) != CborNoError ) ||
+		( cbor_encoder_create_array( &pxBatch->xMessage, &pxBatch->xWindows, CborIndefiniteLength ) != CborNoError ) )
+	{
+		return false;
+	}
+	pxBatch->ulLen = cbor_encoder_get_buffer_size( &pxBatch->xWindows, pucBuf );
+
+	return true;
+}
 
-		prvStatDataToJSONStat( pxSensorsMessage->bDPS368On_5, &pxSensorsMessage->fDPS368Temperature_5, &xSensorCxt, JSON_STATISTIC_SENSOR_DPS368_TEMP_5 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
 
-		prvStatDataToJSONStat( pxSensorsMessage->bDPS368On_5, &pxSensorsMessage->fDPS368Pressure_5, &xSensorCxt, JSON_STATISTIC_SENSOR_DPS368_PRESS_5 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
+bool BATCH_bAdd( BatchContext_t *pxBatch, InfineonSensorsMessage_t *pxSensorsMessage )
+{
+	bool bRet = false;
+	uint32_t ulLen = 0;
 
-		prvStatDataToJSONStat( pxSensorsMessage->bTLI4971On_1, &pxSensorsMessage->fTLI4971Current_1, &xSensorCxt, JSON_STATISTIC_SENSOR_TLI4971_CURRENT_1 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
+	if( !pxBatch->bCbor )
+	{
+		JsonContext_t xSaved = pxBatch->xJson;
+		char pcKey[11];
 
-		prvStatDataToJSONStat( pxSensorsMessage->bTLI4971On_2, &pxSensorsMessage->fTLI4971Current_2, &xSensorCxt, JSON_STATISTIC_SENSOR_TLI4971_CURRENT_2 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
+		sprintf( pcKey, "%lu", (unsigned long)pxSensorsMessage->ulTimestamp );
 
-		prvStatDataToJSONStat( pxSensorsMessage->bTLI4971On_3, &pxSensorsMessage->fTLI4971Current_3, &xSensorCxt, JSON_STATISTIC_SENSOR_TLI4971_CURRENT_3 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
+		bRet = JSON_bSubstringCreate( &pxBatch->xJson, pcKey ) &&
+			   prvMessageEncode( pxSensorsMessage, prvJsonSensorAdd, &pxBatch->xJson ) &&
+			   JSON_bSubstringFinish( &pxBatch->xJson );
+		ulLen = pxBatch->xJson.lUsedLen;
 
-		xSensorCxt.pxFft = &pxSensorsMessage->fTLE4997HallSpectra_1;
-		prvStatDataToJSONStat( pxSensorsMessage->bTLE4997On_1, &pxSensorsMessage->fTLE4997LinearHall_1, &xSensorCxt, JSON_STATISTIC_SENSOR_TLE4997_LINEAR_HALL_1 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( bRet == true )
+		/* Without a flush callback the writer never goes past the buffer, only the cursor is rewound */
+		if( !bRet || ( ulLen + BATCH_TAIL_SIZE > pxBatch->ulMaxSize ) )
 		{
-			xSensorCxt.pxFft = NULL;
+			pxBatch->xJson = xSaved;
+			pxBatch->pucBuf[xSaved.lUsedLen] = 0;
+			return false;
 		}
-		else
+	}
+	else
+	{
+		/* An encoder out of memory only counts the missing bytes, the saved copies restore it and the spectrum codec */
+		CborEncoder xSaved = pxBatch->xWindows;
+		CborEncoder xWindow;
+
+		memcpy( xSpecCodecSaved, xSpecCodec, sizeof( xSpecCodec ) );
+
+		bRet = ( cbor_encoder_create_map( &pxBatch->xWindows, &xWindow, CborIndefiniteLength ) == CborNoError ) &&
+			   ( cbor_encode_uint( &xWindow, CBOR_KEY_TIMESTAMP ) == CborNoError ) &&
+			   ( cbor_encode_uint( &xWindow, pxSensorsMessage->ulTimestamp ) == CborNoError ) &&
+			   prvMessageEncode( pxSensorsMessage, prvCborSensorAdd, &xWindow ) &&
+			   ( cbor_encoder_close_container( &pxBatch->xWindows, &xWindow ) == CborNoError );
+		ulLen = bRet ? cbor_encoder_get_buffer_size( &pxBatch->xWindows, pxBatch->pucBuf ) : 0;
+
+		if( !bRet || ( ulLen + BATCH_TAIL_SIZE > pxBatch->ulMaxSize ) )
 		{
-			break;
+			pxBatch->xWindows = xSaved;
+			memcpy( xSpecCodec, xSpecCodecSaved, sizeof( xSpecCodec ) );
+			return false;
 		}
+	}
 
-		prvStatDataToJSONStat( pxSensorsMessage->bTLE4964On_1, &pxSensorsMessage->fTLE4964Hall_1, &xSensorCxt, JSON_STATISTIC_SENSOR_TLE4964_HALL_SWITCH_1 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
+	pxBatch->ulLen = ulLen;
+	pxBatch->ucWindows++;
 
-		prvStatDataToJSONStat( pxSensorsMessage->bTLE49613KOn_1, &pxSensorsMessage->fTLE49613kHall_1, &xSensorCxt, JSON_STATISTIC_SENSOR_TLE49613K_HALL_LATCH_1 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
+	return true;
+}
 
-		prvStatDataToJSONStat( pxSensorsMessage->bTLE4913On_1, &pxSensorsMessage->fTLE4913Hall_1, &xSensorCxt, JSON_STATISTIC_SENSOR_TLE4913_HALL_SWITCH_1 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
 
-		prvStatDataToJSONStat( pxSensorsMessage->bTLE49611KOn_1, &pxSensorsMessage->fTLE49611kHall_1, &xSensorCxt, JSON_STATISTIC_SENSOR_TLE49611K_HALL_LATCH_1 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
+bool BATCH_bFinish( BatchContext_t *pxBatch, uint32_t ulNow, uint32_t *pulLen )
+{
+	bool bRet = false;
 
-		prvStatDataToJSONStat( pxSensorsMessage->bTLI4966gOn_1, &pxSensorsMessage->fTLI4966gDoubleHall_Speed_1, &xSensorCxt, JSON_STATISTIC_SENSOR_TLI4966G_DOUBLE_HALL_SPEED_1 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
+	if( !pxBatch->bCbor )
+	{
+		char pcNow[11];
 
-		prvStatDataToJSONStat( pxSensorsMessage->bTLI4966gOn_1, &pxSensorsMessage->fTLI4966gDoubleHall_Dir_1, &xSensorCxt, JSON_STATISTIC_SENSOR_TLI4966G_DOUBLE_HALL_DIR_1 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
+		/* Unsigned, the tick count passes INT32_MAX after 24 days */
+		sprintf( pcNow, "%lu", (unsigned long)ulNow );
+		bRet = JSON_bStringAdd( &pxBatch->xJson, "now", pcNow ) &&
+			   JSON_bFinish( &pxBatch->xJson, pulLen );
 
-		xSensorCxt.pxFft = &pxSensorsMessage->fIM69dMicSpectra_1;
-		prvStatDataToJSONStat( pxSensorsMessage->bIM69dOn_1, &pxSensorsMessage->fIM69dMic_1, &xSensorCxt, JSON_STATISTIC_SENSOR_IM69D_MIC_1 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( bRet == true )
+		if( bRet && JSON_MESSAGE_PRINT )
 		{
-			xSensorCxt.pxFft = NULL;
+			configPRINTF( ( (char *)pxBatch->pucBuf ) );
+			vTaskDelay( 10 );
 		}
-		else
+	}
+	else
+	{
+		bRet = ( cbor_encoder_close_container( &pxBatch->xMessage, &pxBatch->xWindows ) == CborNoError ) &&
+			   ( cbor_encode_uint( &pxBatch->xMessage, CBOR_KEY_NOW ) == CborNoError ) &&
+			   ( cbor_encode_uint( &pxBatch->xMessage, ulNow ) == CborNoError ) &&
+			   ( cbor_encoder_close_container( &pxBatch->xEncoder, &pxBatch->xMessage ) == CborNoError );
+
+		if( bRet && pulLen )
 		{
-			break;
+			*pulLen = cbor_encoder_get_buffer_size( &pxBatch->xEncoder, pxBatch->pucBuf );
 		}
+	}
 
-		prvStatDataToJSONStat( pxSensorsMessage->bTLI493dOn_1, &pxSensorsMessage->fTLI493dMagnetic_X_1, &xSensorCxt, JSON_STATISTIC_SENSOR_TLI493D_MAGNETIC_X_1 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
-
-		prvStatDataToJSONStat( pxSensorsMessage->bTLI493dOn_1, &pxSensorsMessage->fTLI493dMagnetic_Y_1, &xSensorCxt, JSON_STATISTIC_SENSOR_TLI493D_MAGNETIC_Y_1 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
-
-		prvStatDataToJSONStat( pxSensorsMessage->bTLI493dOn_1, &pxSensorsMessage->fTLI493dMagnetic_Z_1, &xSensorCxt, JSON_STATISTIC_SENSOR_TLI493D_MAGNETIC_Z_1 );
-		bRet = JSON_bSensorAdd( &xJsonCxt, &xSensorCxt );
-		if( !bRet ) break;
+	if( !bRet )
+	{
+		configPRINTF( ("Batch Failed") );
+	}
 
-        bRet = JSON_bFinish( &xJsonCxt, NULL );
-        if( !bRet ) break;
-
-        bRet = true;
-        break;
-    }
+	pxBatch->ucWindows = 0;
 
-    if( bRet )
-    {
-    	if( JSON_MESSAGE_PRINT )
-    	{
-    		 configPRINTF( ( pucJsonBuf ) );
-    		 vTaskDelay( 10 );
-    	}
+	return bRet;
+}
 
-        return true;
-    }
-    else
-    {
-        configPRINTF( ("JSON Failed") );
-        return false;
-    }
 
+/* Comma and the value at pulLen, the buffer is kept null terminated */
+static bool prvCsvValueAdd( char *pcBuf, uint32_t ulMaxSize, uint32_t *pulLen, float fVal )
+{
+	uint32_t ulPos = *pulLen;
+	uint32_t ulLen;
+
+	/* The null at pulLen makes room for the comma, the value fits what is left or restores the null */
+	if( ulPos > 0 )
+	{
+		pcBuf[ulPos++] = ',';
+	}
+	ulLen = FTOS_ulFormat( fVal, CSV_FLOAT_PRECISION, &pcBuf[ulPos], ulMaxSize - ulPos );
+	if( ulLen == 0 )
+	{
+		pcBuf[*pulLen] = 0;
+		return false;
+	}
+	*pulLen = ulPos + ulLen;
+
+	return true;
 }
 
 
-void CSV_vGenerateToSend( InfineonSensorsMessage_t *pxSensorsMessage, uint8_t* pucBuffer )
+bool CSV_bGenerateToSend( InfineonSensorsMessage_t *pxSensorsMessage, uint8_t *pucBuf, uint32_t ulMaxSize, uint32_t *pulLen )
 {
-	int i;
-    StatData_t *pxCurrentStatData[] = {
-        &pxSensorsMessage->fDPS368Temperature_1,
-		&pxSensorsMessage->fDPS368Pressure_1,
-		&pxSensorsMessage->fDPS368Temperature_2,
-		&pxSensorsMessage->fDPS368Pressure_2,
-		&pxSensorsMessage->fDPS368Temperature_3,
-		&pxSensorsMessage->fDPS368Pressure_3,
-		&pxSensorsMessage->fDPS368Temperature_4,
-		&pxSensorsMessage->fDPS368Pressure_4,
-		&pxSensorsMessage->fDPS368Temperature_5,
-        &pxSensorsMessage->fDPS368Pressure_5,
-        &pxSensorsMessage->fTLI4971Current_1,
-        &pxSensorsMessage->fTLI4971Current_2,
-        &pxSensorsMessage->fTLI4971Current_3,
-		&pxSensorsMessage->fTLE4997LinearHall_1,
-		&pxSensorsMessage->fTLE4964Hall_1,
-		&pxSensorsMessage->fTLE49613kHall_1,
-		&pxSensorsMessage->fTLE4913Hall_1,
-		&pxSensorsMessage->fTLE49611kHall_1,
-		&pxSensorsMessage->fTLI4966gDoubleHall_Speed_1,
-		&pxSensorsMessage->fTLI4966gDoubleHall_Dir_1,
-		&pxSensorsMessage->fIM69dMic_1,
-		&pxSensorsMessage->fTLI493dMagnetic_X_1,
-		&pxSensorsMessage->fTLI493dMagnetic_Y_1,
-		&pxSensorsMessage->fTLI493dMagnetic_Z_1,
-    };
-    for( i = 0; i < BUF_LEN( pxCurrentStatData ); ++i )
+	char *pcBuf = (char *)pucBuf;
+	uint32_t ulLen = 0;
+	bool bRet = ( ulMaxSize > 0 );
+
+	if( bRet )
+	{
+		pcBuf[0] = 0;
+	}
+
+    for( uint32_t i = 0; ( i < MSG_PARAMETER_MAX ) && bRet; ++i )
     {
-        pucBuffer = STAT_pcPrintStatData( pxCurrentStatData[i], pucBuffer );
-    }
+    	StatData_t *pxStat = &pxSensorsMessage->xStat[i];
 
+    	bRet = prvCsvValueAdd( pcBuf, ulMaxSize, &ulLen, pxStat->fMin ) && prvCsvValueAdd( pcBuf, ulMaxSize, &ulLen, pxStat->fMax ) &&
+    		   prvCsvValueAdd( pcBuf, ulMaxSize, &ulLen, pxStat->fMean ) && prvCsvValueAdd( pcBuf, ulMaxSize, &ulLen, pxStat->fRMS ) &&
+			   prvCsvValueAdd( pcBuf, ulMaxSize, &ulLen, pxStat->fStdDev ) && prvCsvValueAdd( pcBuf, ulMaxSize, &ulLen, pxStat->fVariance );
+    }
 
-    char pcFloatToStringBuffer[10];
+    /* The spectra columns only at full detail */
+    for( uint32_t i = 0; ( i < MSG_SPECTRUM_MAX ) && ( pxSensorsMessage->xDetail == MSG_DETAIL_FULL ); ++i )
+    {
+    	for( uint32_t j = 0; ( j < BUF_LEN( pxSensorsMessage->xFft[i].data ) ) && bRet; ++j )
+    	{
+    		bRet = prvCsvValueAdd( pcBuf, ulMaxSize, &ulLen, pxSensorsMessage->xFft[i].data[j] );
+    	}
+    }
 
-    for( i = 0; i < BUF_LEN( pxSensorsMessage->fIM69dMicSpectra_1.data ); ++i )
+    if( !bRet )
     {
-    	ftoa( pxSensorsMessage->fIM69dMicSpectra_1.data[i], pcFloatToStringBuffer );
-        pucBuffer += sprintf( (char *)pucBuffer, "%s,", pcFloatToStringBuffer );
+        configPRINTF( ("CSV Failed") );
+        return false;
     }
 
-    for( i = 0; i < BUF_LEN( pxSensorsMessage->fTLE4997HallSpectra_1.data ); ++i )
+    if( pulLen )
     {
-    	ftoa( pxSensorsMessage->fTLE4997HallSpectra_1.data[i], pcFloatToStringBuffer );
-        pucBuffer += sprintf( (char *)pucBuffer, "%s,", pcFloatToStringBuffer );
+    	*pulLen = ulLen;
     }
 
-    /** Erase the excessive comma at the end */
-    *( pucBuffer - 1 ) = 0;
+    return true;
 }
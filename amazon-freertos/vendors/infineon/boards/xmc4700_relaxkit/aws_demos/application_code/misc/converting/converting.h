@@ -32,15 +32,53 @@
 #include "json/json_sensor.h"
 #include "sensors.h"
 #include "statistic.h"
+#include "cbor.h"
+
+
+/* Digits after the point of the CSV values */
+#define CSV_FLOAT_PRECISION		( 4 )
+
+/* Room kept in a batch for closing it, the "now" timestamp and the brackets */
+#define BATCH_TAIL_SIZE			( 24 )
+
+/* Windows collected into one payload, the encoder state is kept between the windows */
+typedef struct {
+	bool bCbor;
+	uint8_t ucWindows;
+	uint8_t *pucBuf;
+	uint32_t ulMaxSize;
+	uint32_t ulLen;						/* Payload bytes so far, without the tail */
+	JsonContext_t xJson;
+	CborEncoder xEncoder;
+	CborEncoder xMessage;
+	CborEncoder xWindows;
+
+} BatchContext_t;
 
 
 void vSensorsDataToMessage( InfineonSensorsData_t *pxSensorsData, InfineonSensorsMessage_t *pxSensorsMessage );
 
 void vStatDataToJSONStat( StatData_t *pxStatData, SensorContext_t *pxSensor, JsonSensorsStatistic_t xJsonSensorStat );
 
-bool JSON_bGenerateToSend( InfineonSensorsMessage_t *pxSensorsMessage, char *pucJsonBuf, uint32_t ulMaxSize );
+/** pulLen gets the JSON length, may be NULL */
+bool JSON_bGenerateToSend( InfineonSensorsMessage_t *pxSensorsMessage, char *pucJsonBuf, uint32_t ulMaxSize, uint32_t *pulLen );
+
+/** binary payload, see cbor_sensor.h for the schema */
+bool CBOR_bGenerateToSend( InfineonSensorsMessage_t *pxSensorsMessage, uint8_t *pucBuf, uint32_t ulMaxSize, uint32_t *pulLen );
+
+/**
+ * Batch of windows, JSON keyed by the window timestamps plus "now":
+ *   { "<tick ms>": { sensors as JSON_bGenerateToSend }, ..., "now": <tick ms> }
+ * or CBOR as in cbor_sensor.h
+ */
+bool BATCH_bCreate( BatchContext_t *pxBatch, bool bCbor, uint8_t *pucBuf, uint32_t ulMaxSize );
+/** false if the window does not fit, the batch stays as it was */
+bool BATCH_bAdd( BatchContext_t *pxBatch, InfineonSensorsMessage_t *pxSensorsMessage );
+/** close the payload, the batch is empty afterwards */
+bool BATCH_bFinish( BatchContext_t *pxBatch, uint32_t ulNow, uint32_t *pulLen );
 
-void CSV_vGenerateToSend( InfineonSensorsMessage_t *pxSensorsData, uint8_t *pucBuffer );
+/** statistic of every parameter then the spectra, comma separated, false if it doesn't fit ulMaxSize with the null */
+bool CSV_bGenerateToSend( InfineonSensorsMessage_t *pxSensorsMessage, uint8_t *pucBuf, uint32_t ulMaxSize, uint32_t *pulLen );
 
 
 #endif /* CONVERTING_H */
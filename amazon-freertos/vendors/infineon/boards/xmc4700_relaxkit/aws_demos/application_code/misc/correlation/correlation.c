@@ -0,0 +1,182 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "DAVE.h"
+
+#include "correlation.h"
+
+
+/* Shifted block of each channel */
+static float pfBlock[CORR_CHANNELS_MAX][CORR_BLOCK_LEN];
+/* Mean removed vectors of the lagged pair */
+static float pfLagA[CORR_VECTOR_LEN_MAX];
+static float pfLagB[CORR_VECTOR_LEN_MAX];
+
+
+uint32_t CORR_ulTriangleIndex( uint8_t ucChannels, uint8_t ucRow, uint8_t ucCol )
+{
+	/* Rows above take n + (n-1) + .. + (n-row+1) elements */
+	return ( (uint32_t)ucRow * ( 2u * ucChannels - ucRow + 1u ) ) / 2u + ( ucCol - ucRow );
+}
+
+
+/**
+ * Each channel is shifted by its first sample to keep the float sums small,
+ * the vectors are read block by block once, the block of every channel is
+ * multiplied with the blocks of the channels after it
+ */
+bool CORR_bMatrix( const float * const ppfVect[], uint8_t ucChannels, uint32_t ulLen, CorrelationData_t *pxCorr )
+{
+	float pfShift[CORR_CHANNELS_MAX];
+	float pfSum[CORR_CHANNELS_MAX];
+	float fProd;
+	uint32_t ulBlock, ulIdx;
+
+	if( ( ucChannels == 0 ) || ( ucChannels > CORR_CHANNELS_MAX ) || ( ulLen < 2 ) )
+	{
+		return false;
+	}
+
+	pxCorr->ucChannels = ucChannels;
+	pxCorr->ulSamples = ulLen;
+	memset( pxCorr->pfCovariance, 0, sizeof( pxCorr->pfCovariance ) );
+	memset( pxCorr->pfCorrelation, 0, sizeof( pxCorr->pfCorrelation ) );
+
+	for( uint8_t i = 0; i < ucChannels; i++ )
+	{
+		pfShift[i] = ppfVect[i][0];
+		pfSum[i] = 0.0f;
+	}
+
+	for( uint32_t ulPos = 0; ulPos < ulLen; ulPos += ulBlock )
+	{
+		ulBlock = ( ( ulLen - ulPos ) < CORR_BLOCK_LEN ) ? ( ulLen - ulPos ) : CORR_BLOCK_LEN;
+
+		for( uint8_t i = 0; i < ucChannels; i++ )
+		{
+			arm_offset_f32( (float32_t *)&ppfVect[i][ulPos], -pfShift[i], pfBlock[i], ulBlock );
+			for( uint32_t k = 0; k < ulBlock; k++ )
+			{
+				pfSum[i] += pfBlock[i][k];
+			}
+		}
+
+		ulIdx = 0;
+		for( uint8_t i = 0; i < ucChannels; i++ )
+		{
+			for( uint8_t j = i; j < ucChannels; j++ )
+			{
+				arm_dot_prod_f32( pfBlock[i], pfBlock[j], ulBlock, &fProd );
+				pxCorr->pfCovariance[ulIdx++] += fProd;
+			}
+		}
+	}
+
+	/* Cross products to sample covariance */
+	ulIdx = 0;
+	for( uint8_t i = 0; i < ucChannels; i++ )
+	{
+		for( uint8_t j = i; j < ucChannels; j++ )
+		{
+			pxCorr->pfCovariance[ulIdx] = ( pxCorr->pfCovariance[ulIdx] - pfSum[i] * pfSum[j] / (float)ulLen ) / (float)( ulLen - 1 );
+			ulIdx++;
+		}
+	}
+
+	/* Covariance to correlation, channels without variance have no correlation */
+	ulIdx = 0;
+	for( uint8_t i = 0; i < ucChannels; i++ )
+	{
+		float fVarI = pxCorr->pfCovariance[CORR_ulTriangleIndex( ucChannels, i, i )];
+
+		for( uint8_t j = i; j < ucChannels; j++ )
+		{
+			float fVarJ = pxCorr->pfCovariance[CORR_ulTriangleIndex( ucChannels, j, j )];
+
+			if( ( fVarI > 0.0f ) && ( fVarJ > 0.0f ) )
+			{
+				pxCorr->pfCorrelation[ulIdx] = pxCorr->pfCovariance[ulIdx] / sqrtf( fVarI * fVarJ );
+			}
+			ulIdx++;
+		}
+	}
+
+	return true;
+}
+
+
+bool CORR_bLagPeak( const float *pfA, const float *pfB, uint32_t ulLen, uint32_t ulMaxLag, int16_t *psLag, float *pfPeak )
+{
+	float fMeanA, fMeanB, fPowA, fPowB, fDot, fNorm;
+
+	*psLag = 0;
+	*pfPeak = 0.0f;
+
+	if( ( ulLen < 2 ) || ( ulLen > CORR_VECTOR_LEN_MAX ) )
+	{
+		return false;
+	}
+
+	if( ulMaxLag >= ulLen )
+	{
+		ulMaxLag = ulLen - 1;
+	}
+
+	arm_mean_f32( (float32_t *)pfA, ulLen, &fMeanA );
+	arm_mean_f32( (float32_t *)pfB, ulLen, &fMeanB );
+	arm_offset_f32( (float32_t *)pfA, -fMeanA, pfLagA, ulLen );
+	arm_offset_f32( (float32_t *)pfB, -fMeanB, pfLagB, ulLen );
+
+	arm_dot_prod_f32( pfLagA, pfLagA, ulLen, &fPowA );
+	arm_dot_prod_f32( pfLagB, pfLagB, ulLen, &fPowB );
+	if( ( fPowA <= 0.0f ) || ( fPowB <= 0.0f ) )
+	{
+		return false;
+	}
+	fNorm = 1.0f / sqrtf( fPowA * fPowB );
+
+	/* Biased estimate, the overlap gets shorter with the lag */
+	for( int32_t lLag = -(int32_t)ulMaxLag; lLag <= (int32_t)ulMaxLag; lLag++ )
+	{
+		if( lLag >= 0 )
+		{
+			arm_dot_prod_f32( pfLagA, &pfLagB[lLag], ulLen - lLag, &fDot );
+		}
+		else
+		{
+			arm_dot_prod_f32( &pfLagA[-lLag], pfLagB, ulLen + lLag, &fDot );
+		}
+
+		fDot *= fNorm;
+		if( fabsf( fDot ) > fabsf( *pfPeak ) )
+		{
+			*pfPeak = fDot;
+			*psLag = (int16_t)lLag;
+		}
+	}
+
+	return true;
+}
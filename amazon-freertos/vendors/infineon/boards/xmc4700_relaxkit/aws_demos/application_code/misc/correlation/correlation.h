@@ -0,0 +1,64 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#ifndef CORRELATION_H
+#define CORRELATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/* Max parameters in the matrix */
+#define CORR_CHANNELS_MAX			( 8 )
+/* Max pairs with lagged cross-correlation */
+#define CORR_LAG_PAIRS_MAX			( 4 )
+/* Max vector length for the lagged cross-correlation */
+#define CORR_VECTOR_LEN_MAX			( 256 )
+/* Samples of each channel processed at once */
+#define CORR_BLOCK_LEN				( 32 )
+
+/* Upper triangle with the diagonal, row by row: (0,0) (0,1) .. (0,n-1) (1,1) .. (n-1,n-1) */
+#define CORR_TRIANGLE_LEN( n )		( ( ( n ) * ( ( n ) + 1 ) ) / 2 )
+
+
+/* Structure containing the correlation of several parameters over one window */
+typedef struct {
+    uint8_t ucChannels; 				//! < Parameters in the matrix
+    uint8_t ucLagPairs; 				//! < Pairs with lagged cross-correlation
+    uint32_t ulSamples; 				//! < Samples used from each vector
+    float pfCovariance[CORR_TRIANGLE_LEN( CORR_CHANNELS_MAX )]; 	//! < Covariance, upper triangle with the variances
+    float pfCorrelation[CORR_TRIANGLE_LEN( CORR_CHANNELS_MAX )]; 	//! < Pearson correlation, same layout
+    int16_t psLag[CORR_LAG_PAIRS_MAX]; 				//! < Lag of the cross-correlation peak, samples
+    float pfLagPeak[CORR_LAG_PAIRS_MAX]; 			//! < Cross-correlation at the peak
+} CorrelationData_t;
+
+
+/** covariance and correlation matrix of ucChannels vectors of ulLen samples, one pass over the data */
+bool CORR_bMatrix( const float * const ppfVect[], uint8_t ucChannels, uint32_t ulLen, CorrelationData_t *pxCorr );
+/** lag in [-ulMaxLag, ulMaxLag] with the max absolute correlation of pfA[t] and pfB[t + lag] */
+bool CORR_bLagPeak( const float *pfA, const float *pfB, uint32_t ulLen, uint32_t ulMaxLag, int16_t *psLag, float *pfPeak );
+/** position of the element ( row, col ), row <= col, in the upper triangle */
+uint32_t CORR_ulTriangleIndex( uint8_t ucChannels, uint8_t ucRow, uint8_t ucCol );
+
+
+#endif /* CORRELATION_H */
@@ -0,0 +1,161 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "diff_pressure.h"
+
+
+/* Sums are recalculated from the stored points after this many window slides to drop float drift */
+#define DIFFP_TREND_RESUM_PERIOD	( DIFFP_TREND_POINTS_MAX )
+
+
+static void prvTrendResum( DiffPressureTrend_t *pxTrend )
+{
+	uint32_t ulPos = ( pxTrend->ulCount < pxTrend->ulPoints ) ? 0 : pxTrend->ulOldest;
+
+	pxTrend->fSumY = 0.0f;
+	pxTrend->fSumXY = 0.0f;
+
+	for( uint32_t i = 0; i < pxTrend->ulCount; i++ )
+	{
+		pxTrend->fSumY += pxTrend->pfY[ulPos];
+		pxTrend->fSumXY += (float)i * pxTrend->pfY[ulPos];
+
+		if( ++ulPos >= pxTrend->ulPoints )
+		{
+			ulPos = 0;
+		}
+	}
+
+	pxTrend->ulUpdates = 0;
+}
+
+
+void DIFFP_vTrendInit( DiffPressureTrend_t *pxTrend, uint32_t ulPoints )
+{
+	memset( pxTrend, 0, sizeof( DiffPressureTrend_t ) );
+
+	if( ( ulPoints < 2 ) || ( ulPoints > DIFFP_TREND_POINTS_MAX ) )
+	{
+		ulPoints = DIFFP_TREND_POINTS_MAX;
+	}
+	pxTrend->ulPoints = ulPoints;
+}
+
+
+/**
+ * O(1) update of the sums:
+ * while the window is filling the new point gets x = n,
+ * when it is full the oldest point is dropped, all x are shifted by -1
+ * ( SumXY -= SumY without the oldest point ) and the new point gets x = n - 1
+ */
+void DIFFP_vTrendAdd( DiffPressureTrend_t *pxTrend, float fValue )
+{
+	if( pxTrend->ulCount < pxTrend->ulPoints )
+	{
+		pxTrend->pfY[pxTrend->ulCount] = fValue;
+		pxTrend->fSumXY += (float)pxTrend->ulCount * fValue;
+		pxTrend->fSumY += fValue;
+		pxTrend->ulCount++;
+
+		return;
+	}
+
+	pxTrend->fSumY -= pxTrend->pfY[pxTrend->ulOldest];
+	pxTrend->fSumXY -= pxTrend->fSumY;
+
+	pxTrend->pfY[pxTrend->ulOldest] = fValue;
+	pxTrend->fSumXY += (float)( pxTrend->ulCount - 1 ) * fValue;
+	pxTrend->fSumY += fValue;
+
+	if( ++pxTrend->ulOldest >= pxTrend->ulPoints )
+	{
+		pxTrend->ulOldest = 0;
+	}
+
+	if( ++pxTrend->ulUpdates >= DIFFP_TREND_RESUM_PERIOD )
+	{
+		prvTrendResum( pxTrend );
+	}
+}
+
+
+bool DIFFP_bTrendFit( DiffPressureTrend_t *pxTrend, float *pfSlope, float *pfLast )
+{
+	float fN = (float)pxTrend->ulCount;
+
+	if( pxTrend->ulCount < 2 )
+	{
+		return false;
+	}
+
+	/* Sum x = n(n-1)/2, n * Sum x^2 - (Sum x)^2 = n^2(n^2-1)/12 */
+	float fSumX = fN * ( fN - 1.0f ) * 0.5f;
+	float fDenom = fN * fN * ( fN * fN - 1.0f ) / 12.0f;
+
+	float fSlope = ( fN * pxTrend->fSumXY - fSumX * pxTrend->fSumY ) / fDenom;
+	float fIntercept = ( pxTrend->fSumY - fSlope * fSumX ) / fN;
+
+	*pfSlope = fSlope;
+	*pfLast = fIntercept + fSlope * ( fN - 1.0f );
+
+	return true;
+}
+
+
+float DIFFP_fDiffPressure( float fUpstream, float fDownstream )
+{
+	return ( fUpstream - fDownstream ) * DIFFP_PA_IN_MBAR;
+}
+
+
+/* Q = Cd * A * sqrt( 2 * dP / rho ), rho = p / ( R * T ), the sign follows the flow direction */
+float DIFFP_fFlow( float fDiffPressure, float fPressure, float fTemperature, float fFlowK )
+{
+	float fKelvin = fTemperature + DIFFP_KELVIN_OFFSET;
+	float fDensity;
+
+	if( ( fKelvin <= 0.0f ) || ( fPressure <= 0.0f ) )
+	{
+		return 0.0f;
+	}
+
+	fDensity = ( fPressure * DIFFP_PA_IN_MBAR ) / ( DIFFP_AIR_GAS_CONSTANT * fKelvin );
+
+	float fFlow = fFlowK * sqrtf( 2.0f * fabsf( fDiffPressure ) / fDensity ) * 3600.0f;
+
+	return ( fDiffPressure < 0.0f ) ? -fFlow : fFlow;
+}
+
+
+float DIFFP_fCloggingIndex( float fSlope, float fLast, float fPointsPerHour )
+{
+	if( fabsf( fLast ) < DIFFP_TREND_MIN_PRESSURE )
+	{
+		return 0.0f;
+	}
+
+	return 100.0f * fSlope * fPointsPerHour / fabsf( fLast );
+}
@@ -0,0 +1,68 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#ifndef DIFF_PRESSURE_H
+#define DIFF_PRESSURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/* Points kept in the sliding regression window of the clogging trend */
+#define DIFFP_TREND_POINTS_MAX		( 120 )
+
+/* Specific gas constant of dry air, J/(kg*K) */
+#define DIFFP_AIR_GAS_CONSTANT		( 287.05f )
+#define DIFFP_KELVIN_OFFSET			( 273.15f )
+#define DIFFP_PA_IN_MBAR			( 100.0f )
+/* Fitted differential pressure below this value gives no trend index, Pa */
+#define DIFFP_TREND_MIN_PRESSURE	( 1.0f )
+
+
+/* Sliding linear regression y = a + b * x over the last points, x = 0..n-1 from the oldest */
+typedef struct {
+	float pfY[DIFFP_TREND_POINTS_MAX];
+	uint32_t ulPoints;			/* Window length */
+	uint32_t ulCount;			/* Points in the window */
+	uint32_t ulOldest;			/* Position of the oldest point when the window is full */
+	uint32_t ulUpdates;			/* Updates since the sums were recalculated */
+	float fSumY;
+	float fSumXY;
+
+} DiffPressureTrend_t;
+
+
+void DIFFP_vTrendInit( DiffPressureTrend_t *pxTrend, uint32_t ulPoints );
+void DIFFP_vTrendAdd( DiffPressureTrend_t *pxTrend, float fValue );
+/** slope per point and value fitted at the newest point, false if less than two points */
+bool DIFFP_bTrendFit( DiffPressureTrend_t *pxTrend, float *pfSlope, float *pfLast );
+
+/** differential pressure in Pa from two pressures in mBar */
+float DIFFP_fDiffPressure( float fUpstream, float fDownstream );
+/** volume flow in m^3/h through an orifice of fFlowK = Cd * A in m^2, pressure in mBar, temperature in C */
+float DIFFP_fFlow( float fDiffPressure, float fPressure, float fTemperature, float fFlowK );
+/** trend growth in % of the fitted differential pressure per hour */
+float DIFFP_fCloggingIndex( float fSlope, float fLast, float fPointsPerHour );
+
+
+#endif /* DIFF_PRESSURE_H */
@@ -0,0 +1,156 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <string.h>
+
+#include "dns_cache.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+
+typedef struct {
+	char cName[DNS_CACHE_NAME_MAX];		/* Empty for a free entry */
+	uint32_t ulAddr;
+	uint32_t ulTime;					/* ms of the lookup */
+
+} DnsEntry_t;
+
+
+static DnsEntry_t xDnsEntries[DNS_CACHE_ENTRIES];
+static DnsCacheStat_t xDnsStat;
+
+
+/* Entry of pcName, NULL if there is none */
+static DnsEntry_t *prvFind( const char *pcName )
+{
+	for( uint8_t i = 0; i < DNS_CACHE_ENTRIES; ++i )
+	{
+		if( ( xDnsEntries[i].cName[0] != '\0' ) && ( strcmp( xDnsEntries[i].cName, pcName ) == 0 ) )
+		{
+			return &xDnsEntries[i];
+		}
+	}
+
+	return NULL;
+}
+
+
+/* Free entry, else the least recently resolved one */
+static DnsEntry_t *prvVictim( uint32_t ulNow )
+{
+	DnsEntry_t *pxVictim = &xDnsEntries[0];
+
+	for( uint8_t i = 0; i < DNS_CACHE_ENTRIES; ++i )
+	{
+		if( xDnsEntries[i].cName[0] == '\0' )
+		{
+			return &xDnsEntries[i];
+		}
+
+		if( ( ulNow - xDnsEntries[i].ulTime ) > ( ulNow - pxVictim->ulTime ) )
+		{
+			pxVictim = &xDnsEntries[i];
+		}
+	}
+
+	return pxVictim;
+}
+
+
+uint32_t DNS_CACHE_ulResolve( const char *pcName, DnsResolve_t pxResolve, uint32_t ulNow )
+{
+	uint32_t ulAddr = 0;
+	uint32_t ulAge = 0;
+	bool bCacheable = ( strlen( pcName ) < DNS_CACHE_NAME_MAX );
+
+	if( bCacheable )
+	{
+		taskENTER_CRITICAL();
+		DnsEntry_t *pxEntry = prvFind( pcName );
+		if( pxEntry != NULL )
+		{
+			ulAddr = pxEntry->ulAddr;
+			ulAge = ulNow - pxEntry->ulTime;
+			if( ulAge < DNS_CACHE_TTL )
+			{
+				xDnsStat.ulHits++;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( ( ulAddr != 0 ) && ( ulAge < DNS_CACHE_TTL ) )
+		{
+			return ulAddr;
+		}
+	}
+
+	uint32_t ulResolved = pxResolve( pcName );
+
+	taskENTER_CRITICAL();
+	if( ulResolved != 0 )
+	{
+		xDnsStat.ulResolved++;
+		if( bCacheable )
+		{
+			DnsEntry_t *pxEntry = prvFind( pcName );
+			if( pxEntry == NULL )
+			{
+				pxEntry = prvVictim( ulNow );
+				strcpy( pxEntry->cName, pcName );
+			}
+			pxEntry->ulAddr = ulResolved;
+			pxEntry->ulTime = ulNow;
+		}
+		ulAddr = ulResolved;
+	}
+	else if( ( ulAddr != 0 ) && ( ulAge < DNS_CACHE_STALE_MAX ) )
+	{
+		/* The host most likely kept its address, better than no connection */
+		xDnsStat.ulStale++;
+	}
+	else
+	{
+		xDnsStat.ulFailed++;
+		ulAddr = 0;
+	}
+	taskEXIT_CRITICAL();
+
+	return ulAddr;
+}
+
+
+void DNS_CACHE_vFlush( void )
+{
+	taskENTER_CRITICAL();
+	memset( xDnsEntries, 0, sizeof( xDnsEntries ) );
+	taskEXIT_CRITICAL();
+}
+
+
+void DNS_CACHE_vStatGet( DnsCacheStat_t *pxStat )
+{
+	taskENTER_CRITICAL();
+	*pxStat = xDnsStat;
+	taskEXIT_CRITICAL();
+}
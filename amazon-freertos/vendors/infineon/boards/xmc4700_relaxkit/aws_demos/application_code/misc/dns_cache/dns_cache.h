@@ -0,0 +1,67 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/* Host names kept at once, the least recently resolved one makes room */
+#define DNS_CACHE_ENTRIES			( 2 )
+/* Longer names are resolved every time */
+#define DNS_CACHE_NAME_MAX			( 80 )
+
+/* ms an address is used without asking the resolver, the modules give no TTL of the record */
+#define DNS_CACHE_TTL				( 600000 )
+/* ms an expired address still stands in while the resolver fails */
+#define DNS_CACHE_STALE_MAX			( 3600000 )
+
+
+/* Lookup of the network module, 0 if the name can't be resolved */
+typedef uint32_t ( *DnsResolve_t )( const char *pcName );
+
+
+typedef struct {
+	uint32_t ulHits;			/* Answered from the cache */
+	uint32_t ulResolved;		/* Answered by the resolver */
+	uint32_t ulStale;			/* Resolver failed, answered by an expired entry */
+	uint32_t ulFailed;			/* Resolver failed without an entry to fall back to */
+
+} DnsCacheStat_t;
+
+
+/**
+ * Resolved addresses of the few hosts the device talks to, so a reconnect
+ * doesn't wait for a lookup over the modem or a freshly joined access point.
+ * The resolver is called outside of the critical sections.
+ */
+
+/** address of pcName, from the cache or from pxResolve; ulNow in ms */
+uint32_t DNS_CACHE_ulResolve( const char *pcName, DnsResolve_t pxResolve, uint32_t ulNow );
+/** forgets every address, the next lookups go to the resolver */
+void DNS_CACHE_vFlush( void );
+void DNS_CACHE_vStatGet( DnsCacheStat_t *pxStat );
+
+
+#endif /* DNS_CACHE_H */
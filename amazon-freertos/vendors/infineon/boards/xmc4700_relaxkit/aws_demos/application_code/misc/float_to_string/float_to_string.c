@@ -22,197 +22,221 @@
  */
 
 #include <string.h>
-#include <math.h>
+#include <stdbool.h>
 
 #include "float_to_string.h"
 
 
-static double PRECISION = 0.01;
+static const char pcDigitPairs[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
 
-/**
- * Double to ASCII
- */
-char * dtoa( char *s, float n )
-{
-    /* handle special cases */
-    if( __isnanf(n) )
-    {
-        strcpy( s, "nan" );
-    }
-    else if( __isinff(n) )
-    {
-        strcpy( s, "inf" );
-    }
-    else if( n == 0.0f )
-    {
-        strcpy( s, "0" );
-    }
-    else
-    {
-        int digit, m, m1;
-        char *c = s;
-        int neg = ( n < 0 );
-        if( neg )
-        {
-            n = -n;
-        }
-        /* calculate magnitude */
-        m = log10f( n );
-        int useExp = ( m >= 14 || (neg && m >= 9) || m <= -9 );
-        if( neg )
-        {
-        	*(c++) = '-';
-        }
-        /* set up for scientific notation */
-        if( useExp )
-        {
-            if( m < 0 )
-            {
-            	m -= 1.0f;
-            }
-            n = n / powf( 10.0f, m );
-            m1 = m;
-            m = 0;
-        }
-        if( m < 1.0f )
-        {
-            m = 0;
-        }
-        /* convert the number */
-        while( n > PRECISION || m >= 0 )
-        {
-            float weight = powf( 10.0f, m );
-            if( weight > 0 && !__isinff(weight) )
-            {
-                digit = floorf( n / weight );
-                n -= (digit * weight);
-                *(c++) = '0' + digit;
-            }
-            if( m == 0 && n > 0 )
-            {
-                *(c++) = '.';
-                if( n <= PRECISION )
-                {
-                    *(c++) = '0';
-                }
-            }
-            m--;
-        }
-        if( useExp )
-        {
-            /* convert the exponent */
-            int i, j;
-            *(c++) = 'e';
-            if (m1 > 0)
-            {
-                *(c++) = '+';
-            }
-            else
-            {
-                *(c++) = '-';
-                m1 = -m1;
-            }
-            m = 0;
-            while( m1 > 0 )
-            {
-                *(c++) = '0' + m1 % 10;
-                m1 /= 10;
-                m++;
-            }
-            c -= m;
-            for( i = 0, j = m-1; i<j; i++, j-- )
-            {
-                /* swap without temporary */
-                c[i] ^= c[j];
-                c[j] ^= c[i];
-                c[i] ^= c[j];
-            }
-            c += m;
-        }
-        *(c) = '\0';
-    }
-
-    return s;
-}
+static const uint32_t ulPow10[FTOS_PRECISION_MAX + 1] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
 
 
-/* reverses a string 'str' of length 'len' */
-void reverse( char *str, int len )
+/* Decimal digits backwards from pcEnd, two per division, at least ucMinDigits with leading zeros */
+static char * FTOS_prvUIntWrite( uint32_t ulVal, char *pcEnd, uint8_t ucMinDigits )
 {
-    int i = 0, j = len - 1, temp;
-    while( i < j )
-    {
-        temp = str[i];
-        str[i] = str[j];
-        str[j] = temp;
-        i++; j--;
-    }
-}
+	char *pcPtr = pcEnd;
+	uint32_t ulQuot;
 
-/* Converts a given integer x to string str[].  d is the number
- * of digits required in output. If d is more than the number
- * of digits in x, then 0s are added at the beginning.
- */
-int intToStr( int x, char str[], int d )
-{
-    int i = 0;
-    while( x )
-    {
-        str[i++] = ( x % 10 ) + '0';
-        x = x / 10;
-    }
-
-    /* If number of digits required is more, then
-     * add 0s at the beginning
-     */
-    while( i < d )
-    {
-    	str[i++] = '0';
-    }
-    reverse( str, i );
-    str[i] = '\0';
-
-    return i;
+	while( ulVal >= 100 )
+	{
+		ulQuot = ulVal / 100;
+		pcPtr -= 2;
+		memcpy( pcPtr, &pcDigitPairs[2 * ( ulVal - ulQuot * 100 )], 2 );
+		ulVal = ulQuot;
+	}
+	if( ulVal >= 10 )
+	{
+		pcPtr -= 2;
+		memcpy( pcPtr, &pcDigitPairs[2 * ulVal], 2 );
+	}
+	else
+	{
+		*( --pcPtr ) = '0' + ulVal;
+	}
+	while( pcEnd - pcPtr < ucMinDigits )
+	{
+		*( --pcPtr ) = '0';
+	}
+
+	return pcPtr;
 }
 
-/* Converts a floating point number to string. */
-char * ftoa( float n, char *resIn )
+
+/* 128-bit pulWord[0] least significant divided by 10^9, returns the remainder */
+static uint32_t FTOS_prvDivide( uint32_t *pulWord )
 {
-	char * res = resIn;
+	uint64_t ullCur;
+	uint64_t ullRem = 0;
 
-	if( n<0 )
+	for( int8_t i = 3; i >= 0; i-- )
 	{
-		res[0] = '-';
-		res++;
+		ullCur = ( ullRem << 32 ) | pulWord[i];
+		pulWord[i] = (uint32_t)( ullCur / 1000000000UL );
+		ullRem = ullCur % 1000000000UL;
 	}
 
-	n = fabs( n );
+	return (uint32_t)ullRem;
+}
 
-	/* Extract integer part */
-    int ipart = (int)n;
 
-    int afterpoint = 4;
+uint32_t FTOS_ulFormat( float fVal, uint8_t ucPrecision, char *pcBuf, uint32_t ulBufSize )
+{
+	char pcTmp[FTOS_BUF_SIZE];
+	char *pcEnd = &pcTmp[FTOS_BUF_SIZE];
+	char *pcPtr = pcEnd;
+	uint32_t ulBits, ulMant, ulInt, ulLen;
+	int32_t lExp;
+	bool bNeg;
+
+	if( ucPrecision > FTOS_PRECISION_MAX )
+	{
+		return 0;
+	}
 
-    /* Extract floating part */
-    float fpart = n - (float)ipart;
+	memcpy( &ulBits, &fVal, sizeof( ulBits ) );
+	bNeg = ( ulBits >> 31 ) != 0;
+	lExp = ( ulBits >> 23 ) & 0xFF;
+	ulMant = ulBits & 0x7FFFFF;
 
-    /* convert integer part to string */
-    int i = intToStr( ipart, res, 1 );
+	if( lExp == 0xFF )
+	{
+		if( ulMant )
+		{
+			pcPtr -= 3;
+			memcpy( pcPtr, "nan", 3 );
+			bNeg = false;
+		}
+		else
+		{
+			pcPtr -= 3;
+			memcpy( pcPtr, "inf", 3 );
+		}
+	}
+	else
+	{
+		/* fVal = ulMant * 2^lExp exactly */
+		if( lExp == 0 )
+		{
+			lExp = 1;
+		}
+		else
+		{
+			ulMant |= 0x800000;
+		}
+		lExp -= 150;
+
+		if( lExp >= 0 )
+		{
+			/* Integer value, the fraction is zero */
+			for( uint8_t i = 0; i < ucPrecision; i++ )
+			{
+				*( --pcPtr ) = '0';
+			}
+			if( ucPrecision )
+			{
+				*( --pcPtr ) = '.';
+			}
+
+			if( lExp <= 8 )
+			{
+				pcPtr = FTOS_prvUIntWrite( ulMant << lExp, pcPtr, 1 );
+			}
+			else
+			{
+				/* Up to 2^128, 9 digits per division */
+				uint32_t pulWord[4] = { 0 };
+				uint32_t ulShift = lExp % 32;
+				uint32_t ulRem;
+
+				pulWord[lExp / 32] = ulMant << ulShift;
+				if( ulShift > 8 )
+				{
+					pulWord[lExp / 32 + 1] = ulMant >> ( 32 - ulShift );
+				}
+				do
+				{
+					ulRem = FTOS_prvDivide( pulWord );
+					bool bMore = ( pulWord[0] | pulWord[1] | pulWord[2] | pulWord[3] ) != 0;
+					pcPtr = FTOS_prvUIntWrite( ulRem, pcPtr, bMore ? 9 : 1 );
+					if( !bMore )
+					{
+						break;
+					}
+				} while( 1 );
+			}
+		}
+		else
+		{
+			/* Integer part and the fraction rounded to ucPrecision digits, exact in 64 bits:
+			 * the fraction is below 2^24, times 10^6 below 2^44 */
+			uint32_t ulShift = -lExp;
+			uint64_t ullFrac = ( ulShift < 32 ) ? ( ulMant & ( ( 1UL << ulShift ) - 1 ) ) : ulMant;
+			uint64_t ullScaled = ullFrac * ulPow10[ucPrecision];
+			uint64_t ullQuot = 0;
+
+			ulInt = ( ulShift < 32 ) ? ( ulMant >> ulShift ) : 0;
+
+			/* From 2^64 on the scaled fraction is below half */
+			if( ulShift < 64 )
+			{
+				uint64_t ullRem = ullScaled & ( ( 1ULL << ulShift ) - 1 );
+				uint64_t ullHalf = 1ULL << ( ulShift - 1 );
+				uint32_t ulLastDigit;
+
+				ullQuot = ullScaled >> ulShift;
+				ulLastDigit = ( ucPrecision > 0 ) ? (uint32_t)ullQuot : ulInt;
+				if( ( ullRem > ullHalf ) || ( ( ullRem == ullHalf ) && ( ulLastDigit & 1 ) ) )
+				{
+					ullQuot++;
+				}
+				if( ullQuot >= ulPow10[ucPrecision] )
+				{
+					ullQuot -= ulPow10[ucPrecision];
+					ulInt++;
+				}
+			}
+
+			if( ucPrecision )
+			{
+				pcPtr = FTOS_prvUIntWrite( (uint32_t)ullQuot, pcPtr, ucPrecision );
+				*( --pcPtr ) = '.';
+			}
+			pcPtr = FTOS_prvUIntWrite( ulInt, pcPtr, 1 );
+		}
+	}
 
-    /* check for display option after point */
-    if (afterpoint != 0)
-    {
-    	/* add dot */
-        res[i] = '.';
+	if( bNeg )
+	{
+		*( --pcPtr ) = '-';
+	}
+
+	ulLen = pcEnd - pcPtr;
+	if( ulLen >= ulBufSize )
+	{
+		return 0;
+	}
+	memcpy( pcBuf, pcPtr, ulLen );
+	pcBuf[ulLen] = 0;
+
+	return ulLen;
+}
 
-        /* Get the value of fraction part upto given no.
-         * of points after dot. The third parameter is needed
-         * to handle cases like 233.007
-         */
-        fpart = fpart * powf( 10, afterpoint );
 
-        intToStr( (int)fpart, res + i + 1, afterpoint );
-    }
+/* Converts a floating point number to string. */
+char * ftoa( float n, char *res )
+{
+	FTOS_ulFormat( n, 4, res, FTOS_BUF_SIZE );
 
-    return resIn;
+	return res;
 }
@@ -24,7 +24,22 @@
 #ifndef FLOAT_TO_STRING_H
 #define FLOAT_TO_STRING_H
 
-/* Converts a floating point number to string */
+#include <stdint.h>
+
+
+#define FTOS_PRECISION_MAX		( 6 )
+/* Sign, 39 digits of FLT_MAX, point, 6 digits and null */
+#define FTOS_BUF_SIZE			( 48 )
+
+
+/**
+ * Fixed point decimal of the exact float value, as printf "%.<ucPrecision>f" with
+ * round half to even. "nan", "inf" and "-inf" for the special values.
+ * Returns the length without the null, 0 if ulBufSize is too small.
+ */
+uint32_t FTOS_ulFormat( float fVal, uint8_t ucPrecision, char *pcBuf, uint32_t ulBufSize );
+
+/* Converts a floating point number to string with 4 digits after the point, res should have FTOS_BUF_SIZE bytes */
 char * ftoa( float n, char *res );
 
 
@@ -22,149 +22,339 @@
  */
 
 #include <stdbool.h>
-#include <stdio.h>
+#include <math.h>
 
 #include "json.h"
 #include "string.h"
+#include "float_to_string.h"
 
 
-bool JSON_bCreate ( JsonContext_t *pxCxt, char *pcBuf, uint32_t ulBufSize )
+#define JSON_INDENT_MAX			( 16 )
+
+static const char pcJsonSpace[JSON_INDENT_MAX + 1] = "                ";
+
+
+/* Pass the written part to pxFlush and rewind the cursor */
+static bool JSON_prvFlush( JsonContext_t *pxCxt )
 {
-    memset( (uint8_t*)pxCxt, 0, sizeof( JsonContext_t ) );
-    pxCxt->pcBuf = pcBuf;
-    pxCxt->ulBufSize = ulBufSize;
-    int32_t lLen = snprintf( pxCxt->pcBuf, pxCxt->ulBufSize, "{" );
-    if( lLen <= 0 )
+    if( !pxCxt->pxFlush )
     {
     	return false;
     }
-    pxCxt->lUsedLen += lLen;
-    pxCxt->bCreated = true;
-#if (JSON_STRING_FULL > 0)
-    pxCxt->ucSubCount = 1;
-#else
-    pxCxt->ucSubCount = 0;
-#endif
+    if( pxCxt->lUsedLen == 0 )
+    {
+    	return true;
+    }
+    if( !pxCxt->pxFlush( pxCxt->pcBuf, pxCxt->lUsedLen, pxCxt->pvFlushArg ) )
+    {
+    	return false;
+    }
+    pxCxt->ulFlushedLen += pxCxt->lUsedLen;
+    pxCxt->lUsedLen = 0;
+    pxCxt->pcBuf[0] = 0;
 
     return true;
 }
 
 
-bool JSON_bSubstringCreate( JsonContext_t *pxCxt, char *pcKey )
+/* Copy at the cursor, without pxFlush nothing is written if the data does not fit */
+static bool JSON_prvWrite( JsonContext_t *pxCxt, const char *pcData, uint32_t ulLen )
+{
+    uint32_t ulPart;
+
+    if( ( !pxCxt->pxFlush ) && ( pxCxt->lUsedLen + ulLen >= pxCxt->ulBufSize ) )
+    {
+    	return false;
+    }
+
+    while( ulLen > 0 )
+    {
+    	ulPart = pxCxt->ulBufSize - 1 - pxCxt->lUsedLen;
+    	if( ulPart == 0 )
+    	{
+    		if( !JSON_prvFlush( pxCxt ) )
+    		{
+    			return false;
+    		}
+    		continue;
+    	}
+    	if( ulPart > ulLen )
+    	{
+    		ulPart = ulLen;
+    	}
+    	memcpy( &pxCxt->pcBuf[pxCxt->lUsedLen], pcData, ulPart );
+    	pxCxt->lUsedLen += ulPart;
+    	pcData += ulPart;
+    	ulLen -= ulPart;
+    }
+    pxCxt->pcBuf[pxCxt->lUsedLen] = 0;
+
+    return true;
+}
+
+
+#define JSON_prvWriteConst( pxCxt, pcStr )		JSON_prvWrite( ( pxCxt ), ( pcStr ), sizeof( pcStr ) - 1 )
+
+
+static bool JSON_prvIndentWrite( JsonContext_t *pxCxt )
+{
+    if( JSON_INDENT_MAX - 1 <= pxCxt->ucSubCount * 2 )
+    {
+    	return false;
+    }
+
+    return JSON_prvWrite( pxCxt, pcJsonSpace, pxCxt->ucSubCount * 2 );
+}
+
+
+/* Back to the context saved at the start of a field, not possible once part of the field is flushed */
+static bool JSON_prvRestore( JsonContext_t *pxCxt, const JsonContext_t *pxSaved )
+{
+    if( pxCxt->ulFlushedLen == pxSaved->ulFlushedLen )
+    {
+    	*pxCxt = *pxSaved;
+    	pxCxt->pcBuf[pxCxt->lUsedLen] = 0;
+    }
+
+    return false;
+}
+
+
+/* Separator, indent and "key": */
+static bool JSON_prvKeyWrite( JsonContext_t *pxCxt, const char *pcKey )
 {
-    char pcSpace[] = "                ";
     if( !pxCxt->bCreated )
     {
     	return false;
     }
-    if( strlen( pcSpace ) - 1 <= pxCxt->ucSubCount * 2 )
+    if( pxCxt->bFirstItemAdded && !JSON_prvWriteConst( pxCxt, "," ) )
     {
     	return false;
     }
-    pcSpace[pxCxt->ucSubCount * 2] = 0;
-#if (JSON_STRING_FULL > 0)
-    pxCxt->ucSubCount++;
-#endif
-    int32_t lLen = snprintf( &pxCxt->pcBuf[pxCxt->lUsedLen], pxCxt->ulBufSize - pxCxt->lUsedLen, "%s%s%s\"%s\"%s:%s{", pxCxt->bFirstItemAdded?",":"", JSON_STRING_END_OF_LINE,
-    		pcSpace, pcKey,JSON_STRING_SPACE, JSON_STRING_SPACE );
-    if( ( lLen <= 0 ) || ( lLen >= ( pxCxt->ulBufSize - pxCxt->lUsedLen ) ) )
+    if( !JSON_prvWriteConst( pxCxt, JSON_STRING_END_OF_LINE ) || !JSON_prvIndentWrite( pxCxt ) ||
+    	!JSON_prvWriteConst( pxCxt, "\"" ) || !JSON_prvWrite( pxCxt, pcKey, strlen( pcKey ) ) ||
+		!JSON_prvWriteConst( pxCxt, "\"" JSON_STRING_SPACE ":" JSON_STRING_SPACE ) )
     {
     	return false;
     }
-
-    pxCxt->lUsedLen += lLen;
-    pxCxt->bFirstItemAdded = false;
+    pxCxt->bFirstItemAdded = true;
 
     return true;
 }
 
 
-bool JSON_bSubstringFinish( JsonContext_t *pxCxt )
+static bool JSON_prvIntWrite( JsonContext_t *pxCxt, int32_t lVal )
 {
-    char pcSpace[] = "                ";
+    char pcDigits[11];
+    uint32_t ulVal = ( lVal < 0 ) ? ( 0UL - (uint32_t)lVal ) : (uint32_t)lVal;
+    uint32_t i = sizeof( pcDigits );
 
-    if( !pxCxt->bCreated )
+    do
     {
-    	return false;
+    	pcDigits[--i] = '0' + ( ulVal % 10 );
+    	ulVal /= 10;
+    } while( ulVal );
+
+    if( lVal < 0 )
+    {
+    	pcDigits[--i] = '-';
     }
-    if( strlen( pcSpace ) - 1 <= pxCxt->ucSubCount * 2 )
+
+    return JSON_prvWrite( pxCxt, &pcDigits[i], sizeof( pcDigits ) - i );
+}
+
+
+/* Formatted at the cursor, the buffer is flushed once if the number does not fit, null for nan and inf */
+static bool JSON_prvFloatWrite( JsonContext_t *pxCxt, float fVal )
+{
+    if( !isfinite( fVal ) )
+    {
+    	return JSON_prvWriteConst( pxCxt, "null" );
+    }
+
+    for( uint8_t ucTry = 0; ucTry < 2; ucTry++ )
+    {
+    	uint32_t ulLen = FTOS_ulFormat( fVal, pxCxt->ucPrecision, &pxCxt->pcBuf[pxCxt->lUsedLen], pxCxt->ulBufSize - pxCxt->lUsedLen );
+    	if( ulLen > 0 )
+    	{
+    		pxCxt->lUsedLen += ulLen;
+    		return true;
+    	}
+    	if( !JSON_prvFlush( pxCxt ) )
+    	{
+    		break;
+    	}
+    }
+
+    return false;
+}
+
+
+static bool JSON_prvElementBegin( JsonContext_t *pxCxt )
+{
+    if( pxCxt->bFirstElementAdded && !JSON_prvWriteConst( pxCxt, "," JSON_STRING_SPACE ) )
     {
     	return false;
-   	}
+    }
+    pxCxt->bFirstElementAdded = true;
 
-    pcSpace[pxCxt->ucSubCount * 2] = 0;
+    return true;
+}
 
-    int32_t lLen = snprintf( &pxCxt->pcBuf[pxCxt->lUsedLen], pxCxt->ulBufSize - pxCxt->lUsedLen, "%s%s}", JSON_STRING_END_OF_LINE, pcSpace );
 
-    if( ( lLen <= 0 ) || ( lLen >= ( pxCxt->ulBufSize - pxCxt->lUsedLen ) ) )
+bool JSON_bCreate ( JsonContext_t *pxCxt, char *pcBuf, uint32_t ulBufSize )
+{
+    memset( (uint8_t*)pxCxt, 0, sizeof( JsonContext_t ) );
+    if( ( !pcBuf ) || ( ulBufSize < 2 ) )
     {
     	return false;
     }
-    pxCxt->lUsedLen += lLen;
+    pxCxt->pcBuf = pcBuf;
+    pxCxt->ulBufSize = ulBufSize;
+    if( !JSON_prvWriteConst( pxCxt, "{" ) )
+    {
+    	return false;
+    }
+    pxCxt->bCreated = true;
+    pxCxt->ucPrecision = JSON_FLOAT_PRECISION;
 #if (JSON_STRING_FULL > 0)
-    pxCxt->ucSubCount--;
+    pxCxt->ucSubCount = 1;
+#else
+    pxCxt->ucSubCount = 0;
 #endif
 
     return true;
 }
 
 
-bool JSON_bStringAdd( JsonContext_t *pxCxt, char *pcKey, char *pcVal )
+void JSON_vPrecisionSet( JsonContext_t *pxCxt, uint8_t ucPrecision )
 {
-    char pcSpace[] = "                ";
+	if( pxCxt )
+	{
+		pxCxt->ucPrecision = ( ucPrecision > FTOS_PRECISION_MAX ) ? FTOS_PRECISION_MAX : ucPrecision;
+	}
+}
 
+
+bool JSON_bFlushSet( JsonContext_t *pxCxt, JsonFlush_t pxFlush, void *pvArg )
+{
     if( !pxCxt->bCreated )
     {
     	return false;
-   	}
-    if( strlen( pcSpace ) - 1 <= pxCxt->ucSubCount * 2 )
+    }
+    pxCxt->pxFlush = pxFlush;
+    pxCxt->pvFlushArg = pvArg;
+
+    return true;
+}
+
+
+bool JSON_bSubstringCreate( JsonContext_t *pxCxt, char *pcKey )
+{
+    JsonContext_t xSaved = *pxCxt;
+
+    if( !JSON_prvKeyWrite( pxCxt, pcKey ) || !JSON_prvWriteConst( pxCxt, "{" ) )
     {
-    	return false;
+    	return JSON_prvRestore( pxCxt, &xSaved );
     }
-    pcSpace[pxCxt->ucSubCount * 2] = 0;
+#if (JSON_STRING_FULL > 0)
+    pxCxt->ucSubCount++;
+#endif
+    pxCxt->bFirstItemAdded = false;
+
+    return true;
+}
+
 
-    int32_t lLen = snprintf( &pxCxt->pcBuf[pxCxt->lUsedLen], pxCxt->ulBufSize - pxCxt->lUsedLen, "%s%s%s\"%s\"%s:%s%s", pxCxt->bFirstItemAdded?",":"", JSON_STRING_END_OF_LINE,
-            pcSpace,
-            pcKey, JSON_STRING_SPACE,
-            JSON_STRING_SPACE, pcVal );
-    if( ( lLen <= 0 ) || ( lLen >= ( pxCxt->ulBufSize - pxCxt->lUsedLen ) ) )
+bool JSON_bSubstringFinish( JsonContext_t *pxCxt )
+{
+    if( !pxCxt->bCreated )
+    {
+    	return false;
+    }
+#if (JSON_STRING_FULL > 0)
+    pxCxt->ucSubCount--;
+#endif
+    if( !JSON_prvWriteConst( pxCxt, JSON_STRING_END_OF_LINE ) || !JSON_prvIndentWrite( pxCxt ) || !JSON_prvWriteConst( pxCxt, "}" ) )
     {
     	return false;
     }
-    pxCxt->lUsedLen += lLen;
     pxCxt->bFirstItemAdded = true;
 
     return true;
 }
 
 
-bool JSON_bFinish( JsonContext_t *pxCxt, uint32_t *pulLen )
+bool JSON_bStringAdd( JsonContext_t *pxCxt, char *pcKey, char *pcVal )
 {
-    if( !pxCxt->bCreated )
+    JsonContext_t xSaved = *pxCxt;
+
+    return ( JSON_prvKeyWrite( pxCxt, pcKey ) && JSON_prvWrite( pxCxt, pcVal, strlen( pcVal ) ) ) || JSON_prvRestore( pxCxt, &xSaved );
+}
+
+
+bool JSON_bIntAdd( JsonContext_t *pxCxt, char *pcKey, int32_t lVal )
+{
+    JsonContext_t xSaved = *pxCxt;
+
+    return ( JSON_prvKeyWrite( pxCxt, pcKey ) && JSON_prvIntWrite( pxCxt, lVal ) ) || JSON_prvRestore( pxCxt, &xSaved );
+}
+
+
+bool JSON_bArrayCreate( JsonContext_t *pxCxt, char *pcKey )
+{
+    JsonContext_t xSaved = *pxCxt;
+
+    if( !JSON_prvKeyWrite( pxCxt, pcKey ) || !JSON_prvWriteConst( pxCxt, "[" ) )
     {
-    	return false;
+    	return JSON_prvRestore( pxCxt, &xSaved );
     }
+    pxCxt->bFirstElementAdded = false;
+
+    return true;
+}
+
+
+bool JSON_bArrayIntAdd( JsonContext_t *pxCxt, int32_t lVal )
+{
+    JsonContext_t xSaved = *pxCxt;
 
-    bool bRet = false;
+    return ( JSON_prvElementBegin( pxCxt ) && JSON_prvIntWrite( pxCxt, lVal ) ) || JSON_prvRestore( pxCxt, &xSaved );
+}
+
+
+bool JSON_bArrayFloatAdd( JsonContext_t *pxCxt, float fVal )
+{
+    JsonContext_t xSaved = *pxCxt;
+
+    return ( JSON_prvElementBegin( pxCxt ) && JSON_prvFloatWrite( pxCxt, fVal ) ) || JSON_prvRestore( pxCxt, &xSaved );
+}
+
+
+bool JSON_bArrayFinish( JsonContext_t *pxCxt )
+{
+    return JSON_prvWriteConst( pxCxt, "]" );
+}
 
-    int32_t lLen = snprintf( &pxCxt->pcBuf[pxCxt->lUsedLen], pxCxt->ulBufSize - pxCxt->lUsedLen, "%s}%s", JSON_STRING_END_OF_LINE,JSON_STRING_END_OF_LINE );
 
-    if( ( lLen <= 0 ) || ( lLen >= ( pxCxt->ulBufSize - pxCxt->lUsedLen ) ) )
+bool JSON_bFinish( JsonContext_t *pxCxt, uint32_t *pulLen )
+{
+    if( !pxCxt->bCreated )
     {
     	return false;
     }
-    pxCxt->lUsedLen += lLen;
-
-    /* check summary length */
-    int32_t lStrLen = strlen( pxCxt->pcBuf );
-    if( lStrLen == pxCxt->lUsedLen )
+    if( !JSON_prvWriteConst( pxCxt, JSON_STRING_END_OF_LINE "}" JSON_STRING_END_OF_LINE ) )
+    {
+    	return false;
+    }
+    if( pulLen )
     {
-        bRet = true;
-        if( pulLen )
-        {
-            *pulLen = pxCxt->lUsedLen;
-        }
+        *pulLen = pxCxt->ulFlushedLen + pxCxt->lUsedLen;
+    }
+    if( pxCxt->pxFlush )
+    {
+    	return JSON_prvFlush( pxCxt );
     }
 
-    return bRet;
+    return true;
 }
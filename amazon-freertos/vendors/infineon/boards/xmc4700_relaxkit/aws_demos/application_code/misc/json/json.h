@@ -29,13 +29,24 @@
 #include <stdint.h>
 
 
+/**
+ * Called when the buffer is full and at the end of the document, the data should be
+ * consumed before return, the buffer is reused after that. false stops the writer.
+ */
+typedef bool ( *JsonFlush_t )( const char *pcData, uint32_t ulLen, void *pvArg );
+
 typedef struct {
     char *pcBuf;
     bool bFirstItemAdded;
+    bool bFirstElementAdded;
     bool bCreated;
     uint8_t ucSubCount;
+    uint8_t ucPrecision;				/* Digits after the point of float values */
     uint32_t ulBufSize;
-    int32_t lUsedLen;
+    int32_t lUsedLen;					/* Write cursor, the buffer is kept null terminated */
+    uint32_t ulFlushedLen;				/* Already passed to pxFlush */
+    JsonFlush_t pxFlush;
+    void *pvFlushArg;
 
 } JsonContext_t;
 
@@ -49,11 +60,24 @@ typedef struct {
     #define JSON_STRING_SPACE           ""
 #endif
 
+#define JSON_FLOAT_PRECISION        ( 4 )
+
 
 bool JSON_bCreate( JsonContext_t *pxCxt, char *pcBuf, uint32_t ulBufSize );
+/** float values from here on, JSON_FLOAT_PRECISION after JSON_bCreate */
+void JSON_vPrecisionSet( JsonContext_t *pxCxt, uint8_t ucPrecision );
+/** optional, without it the document should fit the buffer */
+bool JSON_bFlushSet( JsonContext_t *pxCxt, JsonFlush_t pxFlush, void *pvArg );
 bool JSON_bSubstringCreate( JsonContext_t *pxCxt, char *pcKey );
 bool JSON_bSubstringFinish( JsonContext_t *pxCxt );
+/** pcVal is copied as is, it should be valid JSON */
 bool JSON_bStringAdd( JsonContext_t *pxCxt, char *pcKey, char *pcVal );
+bool JSON_bIntAdd( JsonContext_t *pxCxt, char *pcKey, int32_t lVal );
+bool JSON_bArrayCreate( JsonContext_t *pxCxt, char *pcKey );
+bool JSON_bArrayIntAdd( JsonContext_t *pxCxt, int32_t lVal );
+bool JSON_bArrayFloatAdd( JsonContext_t *pxCxt, float fVal );
+bool JSON_bArrayFinish( JsonContext_t *pxCxt );
+/** pulLen gets the whole document length, flushed part included */
 bool JSON_bFinish( JsonContext_t *pxCxt, uint32_t *pulLen );
 
 
@@ -28,32 +28,29 @@
 
 
 static bool JSON_prvSensorFFTAdd( JsonContext_t* pxJsonCxt, SensorContext_t* pxSensorCxt );
+static bool JSON_prvSensorCorrAdd( JsonContext_t* pxJsonCxt, SensorContext_t* pxSensorCxt );
+static bool JSON_prvFloatArrayAdd( JsonContext_t *pxJsonCxt, char *pcKey, const float *pfData, uint32_t ulCount, uint8_t ucChannels, bool bSkipDiagonal );
 
 
 bool JSON_bSensorAdd( JsonContext_t *pxJsonCxt, SensorContext_t *pxSensorCxt )
 {
-    const size_t STR_BUF_MAX = 256;
-    const size_t STR_FORMAT_MAX = 64;
-
     if( !pxSensorCxt )
 	{
     	return false;
 	}
-    bool bRet = false;
 
-    char *pcStrBuf = pvPortMalloc( STR_BUF_MAX );
-    char *pcStrFormat = pvPortMalloc( STR_FORMAT_MAX );
+    /* Statistic window of the sensor is still open, nothing to send this time */
+    if( !pxSensorCxt->bReady )
+    {
+    	return true;
+    }
 
-    int32_t lLen = 0;
+    /* A sensor entry cut short by the buffer end is taken out as a whole */
+    JsonContext_t xSaved = *pxJsonCxt;
+    bool bRet = false;
 
     while( 1 )
     {
-        if( ( !pcStrBuf ) || ( !pcStrFormat ) )
-        {
-        	bRet = false;
-        	break;
-        }
-
         bRet = JSON_bSubstringCreate( pxJsonCxt, pxSensorCxt->pcName );
         if( !bRet )
         {
@@ -61,12 +58,7 @@ bool JSON_bSensorAdd( JsonContext_t *pxJsonCxt, SensorContext_t *pxSensorCxt )
         }
 
         /* Sensor state */
-        lLen = snprintf( pcStrBuf, STR_BUF_MAX, "%d",pxSensorCxt->bOn );
-        if( ( lLen <= 0 ) || ( lLen >= STR_BUF_MAX ) )
-        {
-        	break;
-        }
-        bRet = JSON_bStringAdd( pxJsonCxt, JSON_SENSOR_ON_STRING, pcStrBuf );
+        bRet = JSON_bIntAdd( pxJsonCxt, JSON_SENSOR_ON_STRING, pxSensorCxt->bOn );
         if( !bRet )
 		{
         	break;
@@ -77,30 +69,76 @@ bool JSON_bSensorAdd( JsonContext_t *pxJsonCxt, SensorContext_t *pxSensorCxt )
             /* Sensor statistic */
             if( pxSensorCxt->pxStat )
             {
-                int32_t lLen = snprintf( pcStrFormat, STR_FORMAT_MAX, "[%s,%s%s,%s%s,%s%s,%s%s,%s%s]",
-                        JSON_STATISTIC_FORMAT_FLOAT,
-                        JSON_STRING_SPACE, JSON_STATISTIC_FORMAT_FLOAT,
-                        JSON_STRING_SPACE, JSON_STATISTIC_FORMAT_FLOAT,
-                        JSON_STRING_SPACE, JSON_STATISTIC_FORMAT_FLOAT,
-                        JSON_STRING_SPACE, JSON_STATISTIC_FORMAT_FLOAT,
-                        JSON_STRING_SPACE, JSON_STATISTIC_FORMAT_FLOAT);
-                if( ( lLen <= 0 ) || ( lLen >= STR_FORMAT_MAX ) )
+                const float pfStat[] = { pxSensorCxt->pxStat->fMin, pxSensorCxt->pxStat->fMax, pxSensorCxt->pxStat->fMean,
+                		pxSensorCxt->pxStat->fRMS, pxSensorCxt->pxStat->fStdDev, pxSensorCxt->pxStat->fVariance };
+
+                JSON_vPrecisionSet( pxJsonCxt, pxSensorCxt->ucPrecision );
+                bRet = JSON_prvFloatArrayAdd( pxJsonCxt, JSON_SENSOR_STAT_STRING, pfStat, BUF_LEN( pfStat ), BUF_LEN( pfStat ), false );
+                JSON_vPrecisionSet( pxJsonCxt, JSON_FLOAT_PRECISION );
+                if( !bRet )
                 {
                 	break;
                 }
-                lLen = snprintf( pcStrBuf, STR_BUF_MAX, pcStrFormat,
-                        pxSensorCxt->pxStat->fMin, pxSensorCxt->pxStat->fMax, pxSensorCxt->pxStat->fMean, pxSensorCxt->pxStat->fRMS, pxSensorCxt->pxStat->fStdDev, pxSensorCxt->pxStat->fVariance );
-                if( ( lLen <= 0 ) || ( lLen >= STR_BUF_MAX ) )
+            }
+
+            /* Sensor edge timing: frequency, duty cycle, pulse count, dwell on, dwell off */
+            if( pxSensorCxt->pxEdge )
+            {
+                bRet = JSON_bArrayCreate( pxJsonCxt, JSON_SENSOR_EDGE_STRING ) &&
+                		JSON_bArrayFloatAdd( pxJsonCxt, pxSensorCxt->pxEdge->fFrequency ) &&
+						JSON_bArrayFloatAdd( pxJsonCxt, pxSensorCxt->pxEdge->fDutyCycle ) &&
+						JSON_bArrayIntAdd( pxJsonCxt, (int32_t)pxSensorCxt->pxEdge->ulPulseCount ) &&
+						JSON_bArrayFloatAdd( pxJsonCxt, pxSensorCxt->pxEdge->fDwellOn ) &&
+						JSON_bArrayFloatAdd( pxJsonCxt, pxSensorCxt->pxEdge->fDwellOff ) &&
+						JSON_bArrayFinish( pxJsonCxt );
+                if( !bRet )
+                {
+                	break;
+                }
+            }
+
+            /* Derived values: differential pressure, flow, clogging index */
+            if( pxSensorCxt->pxDerived )
+            {
+                const float pfDerived[] = { pxSensorCxt->pxDerived->fDiffPressure, pxSensorCxt->pxDerived->fFlow, pxSensorCxt->pxDerived->fCloggingIndex };
+
+                bRet = JSON_prvFloatArrayAdd( pxJsonCxt, JSON_SENSOR_DERIVED_STRING, pfDerived, BUF_LEN( pfDerived ), BUF_LEN( pfDerived ), false );
+                if( !bRet )
+                {
+                	break;
+                }
+            }
+
+            /* Correlation: covariance and correlation upper triangles, lag peaks */
+            if( pxSensorCxt->pxCorr )
+            {
+                bRet = JSON_prvSensorCorrAdd( pxJsonCxt, pxSensorCxt );
+                if( !bRet )
+                {
+                	break;
+                }
+            }
+
+            /* Classifier: label and class probabilities */
+            if( pxSensorCxt->pxClass )
+            {
+                bRet = JSON_bIntAdd( pxJsonCxt, JSON_SENSOR_CLASS_STRING, pxSensorCxt->pxClass->ucLabel ) &&
+                		JSON_prvFloatArrayAdd( pxJsonCxt, JSON_SENSOR_PROB_STRING, pxSensorCxt->pxClass->pfProb, pxSensorCxt->pxClass->ucClasses,
+                				pxSensorCxt->pxClass->ucClasses, false );
+                if( !bRet )
                 {
                 	break;
                 }
-                bRet = JSON_bStringAdd( pxJsonCxt, JSON_SENSOR_STAT_STRING, pcStrBuf );
             }
 
             /* Sensor FFT */
             if( pxSensorCxt->pxFft )
             {
                 bRet = JSON_prvSensorFFTAdd( pxJsonCxt, pxSensorCxt );
+                if( !bRet )
+                {
+                	break;
+                }
             }
         }
         bRet = JSON_bSubstringFinish( pxJsonCxt );
@@ -108,13 +146,10 @@ bool JSON_bSensorAdd( JsonContext_t *pxJsonCxt, SensorContext_t *pxSensorCxt )
         break;
     }
 
-    if( pcStrBuf )
-	{
-    	vPortFree( pcStrBuf );
-	}
-    if( pcStrFormat )
+    if( !bRet && ( pxJsonCxt->ulFlushedLen == xSaved.ulFlushedLen ) )
     {
-    	vPortFree( pcStrFormat );
+    	*pxJsonCxt = xSaved;
+    	pxJsonCxt->pcBuf[xSaved.lUsedLen] = 0;
     }
 
     return bRet;
@@ -123,86 +158,100 @@ bool JSON_bSensorAdd( JsonContext_t *pxJsonCxt, SensorContext_t *pxSensorCxt )
 
 static bool JSON_prvSensorFFTAdd( JsonContext_t *pxJsonCxt, SensorContext_t *pxSensorCxt )
 {
-    const uint32_t STR_BUF_MAX = 1024;
-
     if( ( !pxSensorCxt ) || ( !pxJsonCxt ) || ( !pxSensorCxt->pxFft ) )
     {
     	return false;
     }
-    if( !pxSensorCxt->pxFft )
+
+    if( !JSON_bArrayCreate( pxJsonCxt, JSON_SENSOR_FFT_STRING ) )
     {
     	return false;
     }
 
-    bool bRet = true;
+    for( uint32_t i = 0; i < JSON_STATISTIC_FFT_COUNT; ++i )
+    {
+        if( !JSON_bArrayIntAdd( pxJsonCxt, pxSensorCxt->pxFft->data[i] ) )
+        {
+        	return false;
+        }
+    }
 
-    char *pcStrBuf = pvPortMalloc( STR_BUF_MAX );
+    return JSON_bArrayFinish( pxJsonCxt );
+}
 
-    char *pcPtr = &pcStrBuf[0];
-    int32_t lLenFree = STR_BUF_MAX;
 
-//    assert( (sizeof(pxSensorCxt->pxFft->data) / sizeof(pxSensorCxt->pxFft->data[0]) > JSON_STATISTIC_FFT_COUNT) );
+/* Float array to JSON, bSkipDiagonal leaves the always 1.0 diagonal out of the correlation triangle */
+static bool JSON_prvFloatArrayAdd( JsonContext_t *pxJsonCxt, char *pcKey, const float *pfData, uint32_t ulCount, uint8_t ucChannels, bool bSkipDiagonal )
+{
+    uint8_t ucRow = 0, ucCol = 0;
 
-    while( 1 )
+    if( !JSON_bArrayCreate( pxJsonCxt, pcKey ) )
     {
-        if( !pcStrBuf )
+    	return false;
+    }
+
+    for( uint32_t i = 0; i < ulCount; ++i )
+    {
+    	/* Walk the triangle to know the diagonal elements */
+    	bool bDiagonal = ( ucRow == ucCol );
+    	if( ++ucCol >= ucChannels )
+    	{
+    		ucRow++;
+    		ucCol = ucRow;
+    	}
+    	if( bSkipDiagonal && bDiagonal )
+    	{
+    		continue;
+    	}
+
+        if( !JSON_bArrayFloatAdd( pxJsonCxt, pfData[i] ) )
         {
-        	bRet = false;
-        	break;
+        	return false;
         }
+    }
+
+    return JSON_bArrayFinish( pxJsonCxt );
+}
+
+
+static bool JSON_prvSensorCorrAdd( JsonContext_t *pxJsonCxt, SensorContext_t *pxSensorCxt )
+{
+    if( ( !pxSensorCxt ) || ( !pxJsonCxt ) || ( !pxSensorCxt->pxCorr ) )
+    {
+    	return false;
+    }
 
-        int32_t lLen = snprintf( pcPtr, lLenFree, "[" );
-        if( ( lLen <= 0 ) || ( lLen >= lLenFree ) )
+    CorrelationData_t *pxCorr = pxSensorCxt->pxCorr;
+    uint32_t ulCount = CORR_TRIANGLE_LEN( pxCorr->ucChannels );
+
+    bool bRet = false;
+
+    while( 1 )
+    {
+        bRet = JSON_prvFloatArrayAdd( pxJsonCxt, JSON_SENSOR_COV_STRING, pxCorr->pfCovariance, ulCount, pxCorr->ucChannels, false );
+        if( !bRet )
         {
         	break;
         }
-        lLenFree -= lLen;
-        pcPtr += lLen;
 
-        for( uint32_t i = 0; i < JSON_STATISTIC_FFT_COUNT; ++i )
-        {
-            if( i )
-            {
-                lLen = snprintf( pcPtr, lLenFree, ",%s", JSON_STRING_SPACE );
-                if( ( lLen <= 0 ) || ( lLen >= lLenFree ) )
-                {
-                	bRet = false;
-                	break;
-                }
-                lLenFree -= lLen;
-                pcPtr += lLen;
-            }
-            lLen = snprintf( pcPtr, lLenFree, "%d", pxSensorCxt->pxFft->data[i] );
-            if( ( lLen <= 0 ) || ( lLen >= lLenFree ) )
-            {
-            	bRet = false;
-            	break;
-            }
-            lLenFree -= lLen;
-            pcPtr += lLen;
-        }
-        if( bRet == false )
+        bRet = JSON_prvFloatArrayAdd( pxJsonCxt, JSON_SENSOR_CORR_STRING, pxCorr->pfCorrelation, ulCount, pxCorr->ucChannels, true );
+        if( !bRet )
         {
         	break;
         }
 
-        lLen = snprintf( pcPtr, lLenFree, "]" );
-        if( ( lLen <= 0 ) || ( lLen >= lLenFree ) )
+        /* Pairs of lag in samples and the peak correlation */
+        if( pxCorr->ucLagPairs > 0 )
         {
-        	bRet = false;
-        	break;
+        	bRet = JSON_bArrayCreate( pxJsonCxt, JSON_SENSOR_LAG_STRING );
+        	for( uint8_t i = 0; ( i < pxCorr->ucLagPairs ) && bRet; i++ )
+        	{
+        		bRet = JSON_bArrayIntAdd( pxJsonCxt, pxCorr->psLag[i] ) && JSON_bArrayFloatAdd( pxJsonCxt, pxCorr->pfLagPeak[i] );
+        	}
+        	bRet = bRet && JSON_bArrayFinish( pxJsonCxt );
         }
-
-        lLenFree -= lLen;
-        pcPtr += lLen;
-
-        bRet = JSON_bStringAdd( pxJsonCxt, JSON_SENSOR_FFT_STRING, pcStrBuf );
         break;
     }
-    if( pcStrBuf )
-    {
-    	vPortFree( pcStrBuf );
-    }
 
     return bRet;
 }
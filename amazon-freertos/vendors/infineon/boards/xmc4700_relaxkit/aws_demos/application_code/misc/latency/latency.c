@@ -0,0 +1,349 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "latency.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "xmc_device.h"
+
+
+#define LATENCY_BIT( x )		( ( uint16_t )( 1u << ( x ) ) )
+
+
+typedef struct {
+	uint16_t usBucket[LATENCY_BUCKETS + 1];
+	uint32_t ulCount;
+	uint32_t ulMax;						/* us, since the last roll */
+	uint32_t ulMaxPrev;					/* us, of the roll before */
+
+} LatencyHist_t;
+
+
+static const char * const pcLatencyStages[LATENCY_POINT_MAX] = {
+	"total", "spectra", "stats", "queue_in", "queue_out", "encode", "write", "ack"
+};
+
+static LatencyHist_t xLatencyHist[LATENCY_POINT_MAX];
+static LatencyStamp_t xLatencyWrites[LATENCY_WRITES];
+static uint32_t ulLatencyWrites = 0;
+
+static uint32_t ulCyclesPerUs = 144;
+/* ms below which the cycle counter is used, half of its wrap */
+static uint32_t ulCyclesSpan = 14000;
+
+
+static void prvNow( LatencyStamp_t *pxStamp )
+{
+	pxStamp->ulCycles = DWT->CYCCNT;
+	pxStamp->ulTick = ( uint32_t )( xTaskGetTickCount() * portTICK_PERIOD_MS );
+}
+
+
+/* pxB is not before pxA */
+static bool prvAfter( const LatencyStamp_t *pxA, const LatencyStamp_t *pxB )
+{
+	int32_t lMs = ( int32_t )( pxB->ulTick - pxA->ulTick );
+
+	if( lMs < 0 )
+	{
+		return false;
+	}
+
+	return ( ( uint32_t )lMs >= ulCyclesSpan ) || ( ( int32_t )( pxB->ulCycles - pxA->ulCycles ) >= 0 );
+}
+
+
+/* us from pxA to pxB, in cycles as long as the counter can't have wrapped */
+static uint32_t prvDeltaUs( const LatencyStamp_t *pxA, const LatencyStamp_t *pxB )
+{
+	uint32_t ulMs = pxB->ulTick - pxA->ulTick;
+
+	if( ulMs >= ulCyclesSpan )
+	{
+		return ( ulMs < ( UINT32_MAX / 1000 ) ) ? ulMs * 1000 : UINT32_MAX;
+	}
+
+	if( ( int32_t )( pxB->ulCycles - pxA->ulCycles ) < 0 )
+	{
+		return 0;
+	}
+
+	return ( pxB->ulCycles - pxA->ulCycles ) / ulCyclesPerUs;
+}
+
+
+static void prvRecord( LatencyHist_t *pxHist, uint32_t ulUs )
+{
+	uint8_t b = 0;
+
+	while( ( b < LATENCY_BUCKETS ) && ( ulUs >= ( ( uint32_t )LATENCY_BUCKET_MIN << b ) ) )
+	{
+		b++;
+	}
+
+	pxHist->usBucket[b]++;
+	pxHist->ulCount++;
+	if( ulUs > pxHist->ulMax )
+	{
+		pxHist->ulMax = ulUs;
+	}
+
+	/* Halving keeps the shape, the windows of the last rolls weigh the most */
+	if( pxHist->ulCount >= LATENCY_ROLL )
+	{
+		pxHist->ulCount = 0;
+		for( b = 0; b <= LATENCY_BUCKETS; ++b )
+		{
+			pxHist->usBucket[b] /= 2;
+			pxHist->ulCount += pxHist->usBucket[b];
+		}
+		pxHist->ulMaxPrev = pxHist->ulMax;
+		pxHist->ulMax = 0;
+	}
+}
+
+
+/* Upper bound of the bucket holding the ucPercent percentile, the maximum for the last bucket */
+static uint32_t prvPercentile( const LatencyHist_t *pxHist, uint8_t ucPercent, uint32_t ulMax )
+{
+	uint32_t ulSum = 0;
+
+	for( uint8_t b = 0; b < LATENCY_BUCKETS; ++b )
+	{
+		ulSum += pxHist->usBucket[b];
+		if( ( ulSum * 100 ) >= ( pxHist->ulCount * ucPercent ) )
+		{
+			uint32_t ulBound = ( uint32_t )LATENCY_BUCKET_MIN << b;
+			return ( ulBound < ulMax ) ? ulBound : ulMax;
+		}
+	}
+
+	return ulMax;
+}
+
+
+void LATENCY_vInit( void )
+{
+	/* Not cleared, the run-time counter of the task statistics extends it */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	taskENTER_CRITICAL();
+	ulCyclesPerUs = ( SystemCoreClock >= 1000000 ) ? ( SystemCoreClock / 1000000 ) : 1;
+	ulCyclesSpan = ( UINT32_MAX / ulCyclesPerUs ) / 2000;
+	memset( xLatencyHist, 0, sizeof( xLatencyHist ) );
+	ulLatencyWrites = 0;
+	taskEXIT_CRITICAL();
+}
+
+
+void LATENCY_vStamp( LatencyTrace_t *pxTrace, LatencyPoint_t xPoint )
+{
+	LatencyStamp_t xNow;
+
+	prvNow( &xNow );
+	LATENCY_vStampAt( pxTrace, xPoint, &xNow );
+}
+
+
+void LATENCY_vStampAt( LatencyTrace_t *pxTrace, LatencyPoint_t xPoint, const LatencyStamp_t *pxStamp )
+{
+	if( xPoint >= LATENCY_POINT_MAX )
+	{
+		return;
+	}
+
+	if( xPoint == LATENCY_WINDOW )
+	{
+		pxTrace->usSet = 0;
+	}
+
+	pxTrace->xStamp[xPoint] = *pxStamp;
+	pxTrace->usSet |= LATENCY_BIT( xPoint );
+}
+
+
+void LATENCY_vWrite( void )
+{
+	LatencyStamp_t xNow;
+
+	prvNow( &xNow );
+
+	taskENTER_CRITICAL();
+	xLatencyWrites[ulLatencyWrites % LATENCY_WRITES] = xNow;
+	ulLatencyWrites++;
+	taskEXIT_CRITICAL();
+}
+
+
+void LATENCY_vComplete( LatencyTrace_t *pxTrace )
+{
+	if( ( pxTrace->usSet & LATENCY_BIT( LATENCY_WINDOW ) ) == 0 )
+	{
+		return;
+	}
+
+	taskENTER_CRITICAL();
+
+	/* The write of the payload is the first one after its encode, and not after its acknowledge */
+	if( ( ( pxTrace->usSet & LATENCY_BIT( LATENCY_ENCODE ) ) != 0 ) && ( ( pxTrace->usSet & LATENCY_BIT( LATENCY_WRITE ) ) == 0 ) )
+	{
+		uint32_t ulKept = ( ulLatencyWrites < LATENCY_WRITES ) ? ulLatencyWrites : LATENCY_WRITES;
+		const LatencyStamp_t *pxFirst = NULL;
+
+		for( uint32_t i = 0; i < ulKept; ++i )
+		{
+			const LatencyStamp_t *pxWrite = &xLatencyWrites[i];
+
+			if( !prvAfter( &pxTrace->xStamp[LATENCY_ENCODE], pxWrite ) ||
+				( ( ( pxTrace->usSet & LATENCY_BIT( LATENCY_ACK ) ) != 0 ) && !prvAfter( pxWrite, &pxTrace->xStamp[LATENCY_ACK] ) ) )
+			{
+				continue;
+			}
+
+			if( ( pxFirst == NULL ) || prvAfter( pxWrite, pxFirst ) )
+			{
+				pxFirst = pxWrite;
+			}
+		}
+
+		if( pxFirst != NULL )
+		{
+			pxTrace->xStamp[LATENCY_WRITE] = *pxFirst;
+			pxTrace->usSet |= LATENCY_BIT( LATENCY_WRITE );
+		}
+	}
+
+	/* A point not stamped leaves its time to the stage of the next one */
+	uint8_t ucPrev = LATENCY_WINDOW;
+	for( uint8_t p = LATENCY_WINDOW + 1; p < LATENCY_POINT_MAX; ++p )
+	{
+		if( ( pxTrace->usSet & LATENCY_BIT( p ) ) != 0 )
+		{
+			prvRecord( &xLatencyHist[p], prvDeltaUs( &pxTrace->xStamp[ucPrev], &pxTrace->xStamp[p] ) );
+			ucPrev = p;
+		}
+	}
+	if( ucPrev != LATENCY_WINDOW )
+	{
+		prvRecord( &xLatencyHist[LATENCY_WINDOW], prvDeltaUs( &pxTrace->xStamp[LATENCY_WINDOW], &pxTrace->xStamp[ucPrev] ) );
+	}
+
+	taskEXIT_CRITICAL();
+
+	pxTrace->usSet = 0;
+}
+
+
+void LATENCY_vStatGet( LatencyPoint_t xStage, LatencyStat_t *pxStat )
+{
+	LatencyHist_t xHist;
+
+	memset( pxStat, 0, sizeof( LatencyStat_t ) );
+	if( xStage >= LATENCY_POINT_MAX )
+	{
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	xHist = xLatencyHist[xStage];
+	taskEXIT_CRITICAL();
+
+	if( xHist.ulCount == 0 )
+	{
+		return;
+	}
+
+	pxStat->ulCount = xHist.ulCount;
+	pxStat->ulMax = ( xHist.ulMax > xHist.ulMaxPrev ) ? xHist.ulMax : xHist.ulMaxPrev;
+	pxStat->ulP50 = prvPercentile( &xHist, 50, pxStat->ulMax );
+	pxStat->ulP90 = prvPercentile( &xHist, 90, pxStat->ulMax );
+	pxStat->ulP99 = prvPercentile( &xHist, 99, pxStat->ulMax );
+}
+
+
+const char *LATENCY_pcStage( LatencyPoint_t xStage )
+{
+	return ( xStage < LATENCY_POINT_MAX ) ? pcLatencyStages[xStage] : "";
+}
+
+
+void LATENCY_vPrint( void )
+{
+	LatencyStat_t xStat;
+
+	for( uint8_t s = 0; s < LATENCY_POINT_MAX; ++s )
+	{
+		LATENCY_vStatGet( ( LatencyPoint_t )s, &xStat );
+		if( xStat.ulCount > 0 )
+		{
+			configPRINTF( ("Latency %-9s n %3u p50 %8u p90 %8u p99 %8u max %8u us\r\n",
+					pcLatencyStages[s], xStat.ulCount, xStat.ulP50, xStat.ulP90, xStat.ulP99, xStat.ulMax) );
+		}
+	}
+}
+
+
+uint32_t LATENCY_ulJson( char *pcBuf, uint32_t ulSize )
+{
+	LatencyStat_t xStat;
+	uint32_t ulLen = 0;
+	int lLen;
+
+	lLen = snprintf( pcBuf, ulSize, "{\"latency_us\":{" );
+	if( ( lLen <= 0 ) || ( ( uint32_t )lLen >= ulSize ) )
+	{
+		return 0;
+	}
+	ulLen = ( uint32_t )lLen;
+
+	for( uint8_t s = 0; s < LATENCY_POINT_MAX; ++s )
+	{
+		LATENCY_vStatGet( ( LatencyPoint_t )s, &xStat );
+		if( xStat.ulCount == 0 )
+		{
+			continue;
+		}
+
+		lLen = snprintf( &pcBuf[ulLen], ulSize - ulLen, "%s\"%s\":{\"n\":%u,\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u}",
+				( pcBuf[ulLen - 1] == '{' ) ? "" : ",", pcLatencyStages[s],
+				( unsigned )xStat.ulCount, ( unsigned )xStat.ulP50, ( unsigned )xStat.ulP90, ( unsigned )xStat.ulP99, ( unsigned )xStat.ulMax );
+		if( ( lLen <= 0 ) || ( ( uint32_t )lLen >= ( ulSize - ulLen ) ) )
+		{
+			return 0;
+		}
+		ulLen += ( uint32_t )lLen;
+	}
+
+	lLen = snprintf( &pcBuf[ulLen], ulSize - ulLen, "}}" );
+	if( ( lLen <= 0 ) || ( ( uint32_t )lLen >= ( ulSize - ulLen ) ) )
+	{
+		return 0;
+	}
+
+	return ulLen + ( uint32_t )lLen;
+}
@@ -0,0 +1,103 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/* Histogram buckets, bucket b takes the times below LATENCY_BUCKET_MIN << b us, one more bucket takes the rest */
+#define LATENCY_BUCKETS				( 20 )
+#define LATENCY_BUCKET_MIN			( 64 )
+/* Traces after which the histograms are halved, older windows fade out */
+#define LATENCY_ROLL				( 256 )
+/* TLS writes kept until their payload completes, more than the publishes in flight at once */
+#define LATENCY_WRITES				( 8 )
+
+
+/* Points of a window from the sensors to the broker, in the order they are passed */
+typedef enum {
+	LATENCY_WINDOW = 0,		/* Acquisition window closed, the trace starts */
+	LATENCY_SPECTRA,		/* Microphone spectra read */
+	LATENCY_STATS,			/* Statistic and derived values calculated */
+	LATENCY_QUEUE_IN,		/* Posted to the message pool */
+	LATENCY_QUEUE_OUT,		/* Taken by the MQTT task */
+	LATENCY_ENCODE,			/* Payload encoded, of a batch once it is complete */
+	LATENCY_WRITE,			/* First TLS write after the encode */
+	LATENCY_ACK,			/* PUBACK, QoS 1 only */
+	LATENCY_POINT_MAX
+
+} LatencyPoint_t;
+
+
+typedef struct {
+	uint32_t ulCycles;		/* DWT cycle counter, wraps in about 30 s at 144 MHz */
+	uint32_t ulTick;		/* ms, for the longer gaps */
+
+} LatencyStamp_t;
+
+
+typedef struct {
+	LatencyStamp_t xStamp[LATENCY_POINT_MAX];
+	uint16_t usSet;			/* Bit of each point stamped */
+
+} LatencyTrace_t;
+
+
+typedef struct {
+	uint32_t ulCount;		/* Traces in the histogram, halved on every roll */
+	uint32_t ulP50;			/* us, upper bound of the bucket */
+	uint32_t ulP90;
+	uint32_t ulP99;
+	uint32_t ulMax;			/* us, of the last two rolls */
+
+} LatencyStat_t;
+
+
+/**
+ * Time a window spends in each stage on its way to the broker. The trace
+ * travels with the window, the histograms are kept per stage: the stage of a
+ * point is the time since the point stamped before it, the stage of
+ * LATENCY_WINDOW is the total from the window close to the last point.
+ */
+
+/** enables the cycle counter and clears the histograms */
+void LATENCY_vInit( void );
+/** stamps the point with the time now, LATENCY_WINDOW starts the trace over */
+void LATENCY_vStamp( LatencyTrace_t *pxTrace, LatencyPoint_t xPoint );
+void LATENCY_vStampAt( LatencyTrace_t *pxTrace, LatencyPoint_t xPoint, const LatencyStamp_t *pxStamp );
+/** time of a TLS write, called by the socket ports */
+void LATENCY_vWrite( void );
+/** adds the stages of the trace to the histograms, the write is taken from the TLS writes after the encode */
+void LATENCY_vComplete( LatencyTrace_t *pxTrace );
+
+void LATENCY_vStatGet( LatencyPoint_t xStage, LatencyStat_t *pxStat );
+const char *LATENCY_pcStage( LatencyPoint_t xStage );
+/** histograms to the debug UART */
+void LATENCY_vPrint( void );
+/** histograms as a JSON object, 0 if they don't fit ulSize */
+uint32_t LATENCY_ulJson( char *pcBuf, uint32_t ulSize );
+
+
+#endif /* LATENCY_H */
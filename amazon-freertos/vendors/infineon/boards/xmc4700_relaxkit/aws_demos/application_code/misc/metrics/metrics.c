@@ -0,0 +1,156 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "metrics.h"
+
+
+/* Run time of the tasks at the call before */
+static uint32_t ulPrevNumber[METRICS_TASKS_MAX];
+static uint32_t ulPrevRunTime[METRICS_TASKS_MAX];
+static uint32_t ulPrevTasks = 0;
+static uint32_t ulPrevTotal = 0;
+
+
+void METRICS_vInit( void )
+{
+	ulPrevTasks = 0;
+	ulPrevTotal = 0;
+}
+
+
+/* Custom metric names take letters, digits, ':', '_' and '-' */
+static void prvName( char *pcDst, const char *pcSrc )
+{
+	uint32_t i = 0;
+
+	for( ; ( i < ( METRICS_NAME_LEN - 1 ) ) && ( pcSrc[i] != '\0' ); i++ )
+	{
+		char c = pcSrc[i];
+		bool bAllowed = ( ( c >= 'a' ) && ( c <= 'z' ) ) || ( ( c >= 'A' ) && ( c <= 'Z' ) ) || ( ( c >= '0' ) && ( c <= '9' ) ) ||
+				( c == ':' ) || ( c == '_' ) || ( c == '-' );
+		pcDst[i] = bAllowed ? c : '_';
+	}
+	pcDst[i] = '\0';
+}
+
+
+void METRICS_vTasks( MetricsData_t *pxData, const MetricsTaskSample_t *pxSample, uint32_t ulTasks, uint32_t ulTotal )
+{
+	/* Unsigned, a wrap of the counter within the period doesn't matter */
+	uint32_t ulPeriod = ulTotal - ulPrevTotal;
+
+	if( ulTasks > METRICS_TASKS_MAX )
+	{
+		ulTasks = METRICS_TASKS_MAX;
+	}
+
+	for( uint32_t i = 0; i < ulTasks; i++ )
+	{
+		MetricsTask_t *pxTask = &pxData->xTask[i];
+		uint32_t ulRunTime = pxSample[i].ulRunTime;
+
+		/* A task created since the call before ran only in this period */
+		for( uint32_t j = 0; j < ulPrevTasks; j++ )
+		{
+			if( ulPrevNumber[j] == pxSample[i].ulNumber )
+			{
+				ulRunTime -= ulPrevRunTime[j];
+				break;
+			}
+		}
+
+		prvName( pxTask->cName, pxSample[i].pcName );
+		pxTask->ulStackFree = pxSample[i].ulStackFree;
+		pxTask->usCpu = ( ulPeriod > 0 ) ? ( uint16_t )( ( ( uint64_t )ulRunTime * 1000 ) / ulPeriod ) : 0;
+		if( pxTask->usCpu > 1000 )
+		{
+			pxTask->usCpu = 1000;
+		}
+	}
+	pxData->ucTasks = ( uint8_t )ulTasks;
+
+	for( uint32_t i = 0; i < ulTasks; i++ )
+	{
+		ulPrevNumber[i] = pxSample[i].ulNumber;
+		ulPrevRunTime[i] = pxSample[i].ulRunTime;
+	}
+	ulPrevTasks = ulTasks;
+	ulPrevTotal = ulTotal;
+}
+
+
+/* "<prefix><name>":[{"number":<value>}] after the ones before, false if it doesn't fit */
+static bool prvNumber( char *pcBuf, uint32_t ulSize, uint32_t *pulLen, const char *pcPrefix, const char *pcName, uint32_t ulValue )
+{
+	int lLen = snprintf( &pcBuf[*pulLen], ulSize - *pulLen, "%s\"%s%s\":[{\"number\":%u}]",
+			( pcBuf[*pulLen - 1] == '{' ) ? "" : ",", pcPrefix, pcName, ( unsigned )ulValue );
+
+	if( ( lLen <= 0 ) || ( ( uint32_t )lLen >= ( ulSize - *pulLen ) ) )
+	{
+		return false;
+	}
+	*pulLen += ( uint32_t )lLen;
+
+	return true;
+}
+
+
+uint32_t METRICS_ulReport( const MetricsData_t *pxData, uint32_t ulReportId, char *pcBuf, uint32_t ulSize )
+{
+	uint32_t ulLen = 0;
+	int lLen;
+
+	/* No built-in metrics, the block is required */
+	lLen = snprintf( pcBuf, ulSize, "{\"header\":{\"report_id\":%u,\"version\":\"1.0\"},\"metrics\":{},\"custom_metrics\":{", ( unsigned )ulReportId );
+	if( ( lLen <= 0 ) || ( ( uint32_t )lLen >= ulSize ) )
+	{
+		return 0;
+	}
+	ulLen = ( uint32_t )lLen;
+
+	bool bFits = prvNumber( pcBuf, ulSize, &ulLen, "", "uptime_s", pxData->ulUptime ) &&
+			prvNumber( pcBuf, ulSize, &ulLen, "", "heap_free", pxData->ulHeapFree ) &&
+			prvNumber( pcBuf, ulSize, &ulLen, "", "heap_low", pxData->ulHeapLow ) &&
+			prvNumber( pcBuf, ulSize, &ulLen, "", "pool_dropped", pxData->ulDropped ) &&
+			prvNumber( pcBuf, ulSize, &ulLen, "", "latency_p50_us", pxData->ulLatencyP50 ) &&
+			prvNumber( pcBuf, ulSize, &ulLen, "", "latency_p90_us", pxData->ulLatencyP90 ) &&
+			prvNumber( pcBuf, ulSize, &ulLen, "", "latency_p99_us", pxData->ulLatencyP99 ) &&
+			prvNumber( pcBuf, ulSize, &ulLen, "", "bus_errors", pxData->ulBusErrors ) &&
+			prvNumber( pcBuf, ulSize, &ulLen, "", "reconnects", pxData->ulReconnects );
+
+	for( uint32_t i = 0; bFits && ( i < pxData->ucTasks ); i++ )
+	{
+		bFits = prvNumber( pcBuf, ulSize, &ulLen, "cpu_", pxData->xTask[i].cName, pxData->xTask[i].usCpu ) &&
+				prvNumber( pcBuf, ulSize, &ulLen, "stack_", pxData->xTask[i].cName, pxData->xTask[i].ulStackFree );
+	}
+
+	if( !bFits || ( ( ulSize - ulLen ) < 3 ) )
+	{
+		return 0;
+	}
+	memcpy( &pcBuf[ulLen], "}}", 3 );
+
+	return ulLen + 2;
+}
@@ -0,0 +1,92 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/* Tasks reported, the ones above are left out */
+#define METRICS_TASKS_MAX			( 20 )
+/* configMAX_TASK_NAME_LEN with the terminator */
+#define METRICS_NAME_LEN			( 16 )
+/* Report with METRICS_TASKS_MAX tasks of the longest name */
+#define METRICS_REPORT_SIZE			( 3072 )
+/* Run-time counter of the task statistics, the CPU shares are taken over one report period, it wraps in about 12 h */
+#define METRICS_RUN_TIME_HZ			( 100000 )
+
+
+/* Task as given by the kernel */
+typedef struct {
+	const char *pcName;
+	uint32_t ulNumber;				/* xTaskNumber, a task created later under the same name starts over */
+	uint32_t ulRunTime;				/* Run-time counter of the task since it was created */
+	uint32_t ulStackFree;			/* Bytes, never used since it was created */
+
+} MetricsTaskSample_t;
+
+
+typedef struct {
+	char cName[METRICS_NAME_LEN];	/* Characters a custom metric name may not have are replaced by '_' */
+	uint16_t usCpu;					/* Per mille of the run time since the report before */
+	uint32_t ulStackFree;			/* Bytes */
+
+} MetricsTask_t;
+
+
+typedef struct {
+	MetricsTask_t xTask[METRICS_TASKS_MAX];
+	uint8_t ucTasks;
+	uint32_t ulUptime;				/* s */
+	uint32_t ulHeapFree;			/* Bytes */
+	uint32_t ulHeapLow;				/* Bytes, lowest since the start */
+	uint32_t ulDropped;				/* Windows lost in the message pool */
+	uint32_t ulLatencyP50;			/* us, window close to PUBACK */
+	uint32_t ulLatencyP90;
+	uint32_t ulLatencyP99;
+	uint32_t ulBusErrors;			/* Sensor reads failed */
+	uint32_t ulReconnects;
+
+} MetricsData_t;
+
+
+/**
+ * Performance counters of the firmware as Device Defender custom metrics. The
+ * report is the Defender JSON document without built-in metrics, every
+ * counter is a custom metric of type number: cpu_<task> and stack_<task> for
+ * each task, the others by their key in METRICS_ulReport. The metrics have to
+ * be defined in the account to be taken by Defender.
+ */
+
+/** forgets the run time of the report before, the next CPU shares are since the start */
+void METRICS_vInit( void );
+/** CPU share of each task since the call before, ulTotal is the run-time counter now */
+void METRICS_vTasks( MetricsData_t *pxData, const MetricsTaskSample_t *pxSample, uint32_t ulTasks, uint32_t ulTotal );
+/** Defender report for $aws/things/<thing>/defender/metrics/json, 0 if it doesn't fit ulSize */
+uint32_t METRICS_ulReport( const MetricsData_t *pxData, uint32_t ulReportId, char *pcBuf, uint32_t ulSize );
+/** tasks, heap and uptime from the kernel, metrics_xmc4.c */
+void METRICS_vSystemGet( MetricsData_t *pxData );
+
+
+#endif /* METRICS_H */
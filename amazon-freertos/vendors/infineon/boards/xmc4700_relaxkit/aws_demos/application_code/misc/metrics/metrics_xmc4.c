@@ -0,0 +1,93 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#include "metrics.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "xmc_device.h"
+
+
+#if( configGENERATE_RUN_TIME_STATS == 1 )
+static TaskStatus_t xTaskStatus[METRICS_TASKS_MAX];
+static MetricsTaskSample_t xTaskSample[METRICS_TASKS_MAX];
+
+/* DWT cycles not yet counted and the counter they extend, the kernel reads it at every context switch, well within the 30 s wrap of the cycles */
+static uint32_t ulCyclesLast = 0;
+static uint32_t ulCyclesRest = 0;
+static uint32_t ulCyclesPerCount = 1440;
+static uint32_t ulRunTime = 0;
+
+
+/* portCONFIGURE_TIMER_FOR_RUN_TIME_STATS, before the scheduler starts */
+void vConfigureTimerForRunTimeStats( void )
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	ulCyclesPerCount = ( SystemCoreClock >= METRICS_RUN_TIME_HZ ) ? ( SystemCoreClock / METRICS_RUN_TIME_HZ ) : 1;
+	ulCyclesLast = DWT->CYCCNT;
+	ulCyclesRest = 0;
+	ulRunTime = 0;
+}
+
+
+/* portGET_RUN_TIME_COUNTER_VALUE, in the context switch or with the scheduler suspended */
+unsigned long ulGetRunTimeCounterValue( void )
+{
+	uint32_t ulCycles = DWT->CYCCNT;
+
+	ulCyclesRest += ulCycles - ulCyclesLast;
+	ulCyclesLast = ulCycles;
+	ulRunTime += ulCyclesRest / ulCyclesPerCount;
+	ulCyclesRest %= ulCyclesPerCount;
+
+	return ulRunTime;
+}
+#endif
+
+
+void METRICS_vSystemGet( MetricsData_t *pxData )
+{
+#if( configGENERATE_RUN_TIME_STATS == 1 )
+	uint32_t ulTotal = 0;
+
+	/* Nothing if there are more tasks than the array takes */
+	UBaseType_t uxTasks = uxTaskGetSystemState( xTaskStatus, METRICS_TASKS_MAX, &ulTotal );
+
+	for( UBaseType_t i = 0; i < uxTasks; i++ )
+	{
+		xTaskSample[i].pcName = xTaskStatus[i].pcTaskName;
+		xTaskSample[i].ulNumber = xTaskStatus[i].xTaskNumber;
+		xTaskSample[i].ulRunTime = xTaskStatus[i].ulRunTimeCounter;
+		xTaskSample[i].ulStackFree = xTaskStatus[i].usStackHighWaterMark * sizeof( StackType_t );
+	}
+	METRICS_vTasks( pxData, xTaskSample, uxTasks, ulTotal );
+#else
+	pxData->ucTasks = 0;
+#endif
+
+	pxData->ulUptime = ( uint32_t )( xTaskGetTickCount() / configTICK_RATE_HZ );
+	pxData->ulHeapFree = xPortGetFreeHeapSize();
+	pxData->ulHeapLow = xPortGetMinimumEverFreeHeapSize();
+}
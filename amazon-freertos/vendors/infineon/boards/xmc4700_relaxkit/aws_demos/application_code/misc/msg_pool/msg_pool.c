@@ -0,0 +1,208 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <string.h>
+
+#include "msg_pool.h"
+
+#include "task.h"
+
+
+/* Take the oldest message of the lane, inside a critical section */
+static bool prvPop( MsgPool_t *pxPool, MsgPoolLane_t xLane, InfineonSensorsMessage_t **ppxMessage )
+{
+	if( pxPool->ucReady[xLane] == 0 )
+	{
+		return false;
+	}
+	*ppxMessage = pxPool->pxReady[xLane][pxPool->ucHead[xLane]];
+	pxPool->ucHead[xLane] = ( uint8_t )( ( pxPool->ucHead[xLane] + 1 ) % MSG_POOL_SIZE_MAX );
+	pxPool->ucReady[xLane]--;
+
+	return true;
+}
+
+
+bool MSG_POOL_bInit( MsgPool_t *pxPool, InfineonSensorsMessage_t *pxBuffers, uint8_t ucCount, MsgPoolDropPolicy_t xPolicy )
+{
+	memset( pxPool, 0, sizeof( MsgPool_t ) );
+
+	if( ucCount > MSG_POOL_SIZE_MAX )
+	{
+		ucCount = MSG_POOL_SIZE_MAX;
+	}
+
+	/* Every buffer fits in any lane, posting never blocks or fails */
+	pxPool->xPosted = xSemaphoreCreateBinary();
+	if( pxPool->xPosted == NULL )
+	{
+		return false;
+	}
+
+	for( uint8_t i = 0; i < ucCount; i++ )
+	{
+		pxPool->pxFree[i] = &pxBuffers[i];
+	}
+	pxPool->ucFree = ucCount;
+	pxPool->ucSize = ucCount;
+	pxPool->xPolicy = xPolicy;
+
+	return true;
+}
+
+
+void MSG_POOL_vDelete( MsgPool_t *pxPool )
+{
+	if( pxPool->xPosted != NULL )
+	{
+		vSemaphoreDelete( pxPool->xPosted );
+		pxPool->xPosted = NULL;
+	}
+	memset( pxPool->ucReady, 0, sizeof( pxPool->ucReady ) );
+	pxPool->ucFree = 0;
+}
+
+
+InfineonSensorsMessage_t *MSG_POOL_pxAcquire( MsgPool_t *pxPool )
+{
+	InfineonSensorsMessage_t *pxMessage = NULL;
+
+	/* The counters are read by the other task too, they change in the same critical section as the lanes */
+	taskENTER_CRITICAL();
+	if( pxPool->ucFree > 0 )
+	{
+		pxMessage = pxPool->pxFree[--pxPool->ucFree];
+
+		if( ( uint8_t )( pxPool->ucSize - pxPool->ucFree ) > pxPool->xStat.ucInUseMax )
+		{
+			pxPool->xStat.ucInUseMax = pxPool->ucSize - pxPool->ucFree;
+		}
+	}
+	/* Pool exhausted: the consumer lags behind, take back the oldest bulk message it hasn't picked up yet */
+	else if( ( pxPool->xPolicy == MSG_POOL_DROP_OLDEST ) && ( pxPool->xPosted != NULL ) &&
+			 prvPop( pxPool, MSG_POOL_LANE_BULK, &pxMessage ) )
+	{
+		pxPool->xStat.ulDroppedOldest++;
+	}
+	else
+	{
+		pxPool->xStat.ulDroppedNewest++;
+	}
+	taskEXIT_CRITICAL();
+
+	return pxMessage;
+}
+
+
+void MSG_POOL_vPost( MsgPool_t *pxPool, InfineonSensorsMessage_t *pxMessage, MsgPoolLane_t xLane )
+{
+	if( pxPool->xPosted == NULL )
+	{
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	pxPool->pxReady[xLane][( pxPool->ucHead[xLane] + pxPool->ucReady[xLane] ) % MSG_POOL_SIZE_MAX] = pxMessage;
+	pxPool->ucReady[xLane]++;
+	pxPool->xStat.ulPosted++;
+	if( xLane == MSG_POOL_LANE_HIGH )
+	{
+		pxPool->xStat.ulPostedHigh++;
+	}
+	taskEXIT_CRITICAL();
+
+	( void )xSemaphoreGive( pxPool->xPosted );
+}
+
+
+bool MSG_POOL_bReceive( MsgPool_t *pxPool, InfineonSensorsMessage_t **ppxMessage, MsgPoolLane_t xLowest, MsgPoolLane_t *pxLane, TickType_t xTimeout )
+{
+	TimeOut_t xTimeOut;
+
+	if( pxPool->xPosted == NULL )
+	{
+		return false;
+	}
+
+	vTaskSetTimeOutState( &xTimeOut );
+
+	/* A post after the lanes were looked at leaves the semaphore given, no message is missed */
+	while( 1 )
+	{
+		for( MsgPoolLane_t xLane = MSG_POOL_LANE_HIGH; xLane <= xLowest; xLane++ )
+		{
+			taskENTER_CRITICAL();
+			bool bPopped = prvPop( pxPool, xLane, ppxMessage );
+			taskEXIT_CRITICAL();
+
+			if( bPopped )
+			{
+				if( pxLane != NULL )
+				{
+					*pxLane = xLane;
+				}
+				return true;
+			}
+		}
+
+		if( ( xTaskCheckForTimeOut( &xTimeOut, &xTimeout ) != pdFALSE ) ||
+			( xSemaphoreTake( pxPool->xPosted, xTimeout ) != pdTRUE ) )
+		{
+			return false;
+		}
+	}
+}
+
+
+void MSG_POOL_vRelease( MsgPool_t *pxPool, InfineonSensorsMessage_t *pxMessage )
+{
+	taskENTER_CRITICAL();
+	if( pxPool->ucFree < pxPool->ucSize )
+	{
+		pxPool->pxFree[pxPool->ucFree++] = pxMessage;
+	}
+	taskEXIT_CRITICAL();
+}
+
+
+uint8_t MSG_POOL_ucQueued( MsgPool_t *pxPool )
+{
+	uint8_t ucQueued = 0;
+
+	taskENTER_CRITICAL();
+	for( MsgPoolLane_t xLane = MSG_POOL_LANE_HIGH; xLane < MSG_POOL_LANES; xLane++ )
+	{
+		ucQueued += pxPool->ucReady[xLane];
+	}
+	taskEXIT_CRITICAL();
+
+	return ucQueued;
+}
+
+
+void MSG_POOL_vStatGet( MsgPool_t *pxPool, MsgPoolStat_t *pxStat )
+{
+	taskENTER_CRITICAL();
+	*pxStat = pxPool->xStat;
+	taskEXIT_CRITICAL();
+}
@@ -0,0 +1,107 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#ifndef MSG_POOL_H
+#define MSG_POOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+#include "app_types.h"
+
+
+/* Upper bound of the buffers in one pool */
+#define MSG_POOL_SIZE_MAX			( 8 )
+
+
+/* Ready lanes, the consumer takes from the highest lane that holds a message */
+typedef enum {
+	MSG_POOL_LANE_HIGH = 0,		/* Alarm windows, never reclaimed by MSG_POOL_DROP_OLDEST */
+	MSG_POOL_LANE_BULK,			/* Routine telemetry */
+	MSG_POOL_LANES
+
+} MsgPoolLane_t;
+
+
+/* What to lose when the producer finds no free buffer */
+typedef enum {
+	MSG_POOL_DROP_OLDEST = 0,	/* Reclaim the oldest queued bulk message, the consumer gets the newest data */
+	MSG_POOL_DROP_NEWEST		/* Keep the queued messages, the new window is skipped */
+
+} MsgPoolDropPolicy_t;
+
+
+/* Backpressure accounting */
+typedef struct {
+	uint32_t ulPosted;			/* Messages handed to the consumer */
+	uint32_t ulPostedHigh;		/* Of them on the high lane */
+	uint32_t ulDroppedOldest;	/* Queued messages overwritten by newer ones */
+	uint32_t ulDroppedNewest;	/* Windows skipped for lack of a buffer */
+	uint8_t ucInUseMax;			/* High-water mark of the buffers out of the free list */
+
+} MsgPoolStat_t;
+
+
+/*
+ * Fixed set of message buffers. Free buffers sit on a LIFO free list,
+ * filled ones travel to the consumer as pointers through the FIFO of their
+ * lane, so a message is written once in place and never copied. A high
+ * lane message overtakes every queued bulk message.
+ */
+typedef struct {
+	InfineonSensorsMessage_t *pxFree[MSG_POOL_SIZE_MAX];
+	uint8_t ucFree;					/* Buffers on the free list */
+	uint8_t ucSize;					/* Buffers in the pool */
+	InfineonSensorsMessage_t *pxReady[MSG_POOL_LANES][MSG_POOL_SIZE_MAX];	/* Filled buffers per lane, oldest at ucHead */
+	uint8_t ucHead[MSG_POOL_LANES];
+	uint8_t ucReady[MSG_POOL_LANES];
+	SemaphoreHandle_t xPosted;		/* Given on every post, the consumer looks at the lanes again */
+	MsgPoolDropPolicy_t xPolicy;
+	MsgPoolStat_t xStat;
+
+} MsgPool_t;
+
+
+/** the pool takes ucCount buffers from pxBuffers, false if the semaphore can't be created */
+bool MSG_POOL_bInit( MsgPool_t *pxPool, InfineonSensorsMessage_t *pxBuffers, uint8_t ucCount, MsgPoolDropPolicy_t xPolicy );
+void MSG_POOL_vDelete( MsgPool_t *pxPool );
+
+/** producer: buffer to fill, NULL when the window has to be dropped */
+InfineonSensorsMessage_t *MSG_POOL_pxAcquire( MsgPool_t *pxPool );
+/** producer: hand the filled buffer to the consumer */
+void MSG_POOL_vPost( MsgPool_t *pxPool, InfineonSensorsMessage_t *pxMessage, MsgPoolLane_t xLane );
+
+/** consumer: the oldest filled buffer of the highest lane down to xLowest, false on timeout; pxLane may be NULL */
+bool MSG_POOL_bReceive( MsgPool_t *pxPool, InfineonSensorsMessage_t **ppxMessage, MsgPoolLane_t xLowest, MsgPoolLane_t *pxLane, TickType_t xTimeout );
+/** consumer: return the buffer to the free list once it is encoded */
+void MSG_POOL_vRelease( MsgPool_t *pxPool, InfineonSensorsMessage_t *pxMessage );
+
+/** windows posted and not yet received, both lanes */
+uint8_t MSG_POOL_ucQueued( MsgPool_t *pxPool );
+void MSG_POOL_vStatGet( MsgPool_t *pxPool, MsgPoolStat_t *pxStat );
+
+
+#endif /* MSG_POOL_H */
@@ -0,0 +1,328 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <string.h>
+
+#include "pipeline.h"
+
+#include "task.h"
+
+
+/* Sequence a is older than b, over the wrap */
+#define PIPE_OLDER( a, b )		( ( int32_t )( ( a ) - ( b ) ) < 0 )
+
+
+/* New transmission of a reserved or pending slot, the slot stays pending if the transport refuses it */
+static bool prvStart( Pipe_t *pxPipe, PipeSlot_t *pxSlot )
+{
+	uint32_t ulToken;
+	uint8_t ucInFlight = 0;
+
+	taskENTER_CRITICAL();
+	/* 0 is never a token, a completion for it can't match */
+	if( ++pxPipe->ulToken == 0 )
+	{
+		pxPipe->ulToken = 1;
+	}
+	ulToken = pxPipe->ulToken;
+	pxSlot->ulToken = ulToken;
+	pxSlot->xState = PIPE_SLOT_IN_FLIGHT;
+	pxSlot->xSent = xTaskGetTickCount();
+	pxPipe->xStat.ulSent++;
+	for( uint8_t i = 0; i < pxPipe->ucSlots; i++ )
+	{
+		if( pxPipe->xSlots[i].xState == PIPE_SLOT_IN_FLIGHT )
+		{
+			ucInFlight++;
+		}
+	}
+	if( ucInFlight > pxPipe->xStat.ucInFlightMax )
+	{
+		pxPipe->xStat.ucInFlightMax = ucInFlight;
+	}
+	taskEXIT_CRITICAL();
+
+	/* The acknowledge may come before the call returns */
+	if( pxPipe->pxTransport->pxPublish( pxPipe->pxTransport->pvContext, pxSlot, ulToken ) )
+	{
+		return true;
+	}
+
+	( void )PIPE_bComplete( pxPipe, ulToken, false );
+
+	return false;
+}
+
+
+/* Slots in one of the states, bit per state */
+static uint8_t prvCount( Pipe_t *pxPipe, uint32_t ulStates )
+{
+	uint8_t ucCount = 0;
+
+	taskENTER_CRITICAL();
+	for( uint8_t i = 0; i < pxPipe->ucSlots; i++ )
+	{
+		if( ( ulStates & ( 1UL << pxPipe->xSlots[i].xState ) ) != 0 )
+		{
+			ucCount++;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	return ucCount;
+}
+
+
+bool PIPE_bInit( Pipe_t *pxPipe, const PipeTransport_t *pxTransport, uint8_t *pucBuffers, uint32_t ulSlotSize, uint8_t ucSlots )
+{
+	memset( pxPipe, 0, sizeof( Pipe_t ) );
+
+	if( ( pxTransport == NULL ) || ( pxTransport->pxPublish == NULL ) || ( pucBuffers == NULL ) ||
+		( ulSlotSize == 0 ) || ( ucSlots == 0 ) || ( ucSlots > PIPE_SLOTS_MAX ) )
+	{
+		return false;
+	}
+
+	pxPipe->xDone = xSemaphoreCreateBinary();
+	if( pxPipe->xDone == NULL )
+	{
+		return false;
+	}
+
+	for( uint8_t i = 0; i < ucSlots; i++ )
+	{
+		pxPipe->xSlots[i].pucData = &pucBuffers[i * ulSlotSize];
+	}
+	pxPipe->ucSlots = ucSlots;
+	pxPipe->ulSlotSize = ulSlotSize;
+	pxPipe->pxTransport = pxTransport;
+
+	return true;
+}
+
+
+void PIPE_vDelete( Pipe_t *pxPipe )
+{
+	if( pxPipe->xDone != NULL )
+	{
+		vSemaphoreDelete( pxPipe->xDone );
+		pxPipe->xDone = NULL;
+	}
+	pxPipe->ucSlots = 0;
+}
+
+
+bool PIPE_bSend( Pipe_t *pxPipe, const char *pcTopic, uint16_t usTopicLength, uint8_t ucQoS, const uint8_t *pucData, uint32_t ulLen, TickType_t xTimeout )
+{
+	PipeSlot_t *pxSlot = NULL;
+	TimeOut_t xTimeOut;
+
+	if( ( pxPipe->xDone == NULL ) || ( ulLen > pxPipe->ulSlotSize ) )
+	{
+		return false;
+	}
+
+	vTaskSetTimeOutState( &xTimeOut );
+
+	/* A completion after the slots were looked at leaves the semaphore given, no free slot is missed */
+	while( 1 )
+	{
+		taskENTER_CRITICAL();
+		for( uint8_t i = 0; i < pxPipe->ucSlots; i++ )
+		{
+			if( pxPipe->xSlots[i].xState == PIPE_SLOT_FREE )
+			{
+				pxSlot = &pxPipe->xSlots[i];
+				pxSlot->xState = PIPE_SLOT_RESERVED;
+				pxSlot->ulSeq = pxPipe->ulSeq++;
+				break;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( pxSlot != NULL )
+		{
+			break;
+		}
+
+		if( ( xTaskCheckForTimeOut( &xTimeOut, &xTimeout ) != pdFALSE ) ||
+			( xSemaphoreTake( pxPipe->xDone, xTimeout ) != pdTRUE ) )
+		{
+			pxPipe->xStat.ulRejected++;
+			return false;
+		}
+	}
+
+	memcpy( pxSlot->pucData, pucData, ulLen );
+	pxSlot->ulLen = ulLen;
+	pxSlot->pcTopic = pcTopic;
+	pxSlot->usTopicLength = usTopicLength;
+	pxSlot->ucQoS = ucQoS;
+
+	/* Refused by the transport the payload waits for the resend */
+	( void )prvStart( pxPipe, pxSlot );
+
+	return true;
+}
+
+
+bool PIPE_bComplete( Pipe_t *pxPipe, uint32_t ulToken, bool bAcked )
+{
+	bool bRet = false;
+
+	taskENTER_CRITICAL();
+	for( uint8_t i = 0; i < pxPipe->ucSlots; i++ )
+	{
+		PipeSlot_t *pxSlot = &pxPipe->xSlots[i];
+
+		if( ( pxSlot->xState == PIPE_SLOT_IN_FLIGHT ) && ( pxSlot->ulToken == ulToken ) )
+		{
+			if( bAcked )
+			{
+				TickType_t xRtt = xTaskGetTickCount() - pxSlot->xSent;
+				if( xRtt > pxPipe->xStat.xRttMax )
+				{
+					pxPipe->xStat.xRttMax = xRtt;
+				}
+				pxPipe->xStat.xRttLast = xRtt;
+				pxSlot->xState = PIPE_SLOT_FREE;
+				pxPipe->xStat.ulAcked++;
+			}
+			else
+			{
+				pxSlot->xState = PIPE_SLOT_PENDING;
+				pxPipe->xStat.ulFailed++;
+			}
+			bRet = true;
+			break;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if( pxPipe->xDone != NULL )
+	{
+		( void )xSemaphoreGive( pxPipe->xDone );
+	}
+
+	return bRet;
+}
+
+
+uint8_t PIPE_ucResend( Pipe_t *pxPipe )
+{
+	/* Transmissions still in flight belong to the old connection, their late completions are ignored */
+	taskENTER_CRITICAL();
+	for( uint8_t i = 0; i < pxPipe->ucSlots; i++ )
+	{
+		if( pxPipe->xSlots[i].xState == PIPE_SLOT_IN_FLIGHT )
+		{
+			pxPipe->xSlots[i].xState = PIPE_SLOT_PENDING;
+			pxPipe->xStat.ulFailed++;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	return PIPE_ucRetry( pxPipe );
+}
+
+
+uint8_t PIPE_ucRetry( Pipe_t *pxPipe )
+{
+	uint8_t ucResent = 0;
+
+	while( 1 )
+	{
+		PipeSlot_t *pxOldest = NULL;
+
+		taskENTER_CRITICAL();
+		for( uint8_t i = 0; i < pxPipe->ucSlots; i++ )
+		{
+			PipeSlot_t *pxSlot = &pxPipe->xSlots[i];
+
+			if( ( pxSlot->xState == PIPE_SLOT_PENDING ) && ( ( pxOldest == NULL ) || PIPE_OLDER( pxSlot->ulSeq, pxOldest->ulSeq ) ) )
+			{
+				pxOldest = pxSlot;
+			}
+		}
+		if( pxOldest != NULL )
+		{
+			pxOldest->xState = PIPE_SLOT_RESERVED;
+		}
+		taskEXIT_CRITICAL();
+
+		/* A refused one stays pending with the ones after it, for the next try */
+		if( ( pxOldest == NULL ) || !prvStart( pxPipe, pxOldest ) )
+		{
+			break;
+		}
+
+		ucResent++;
+		pxPipe->xStat.ulResent++;
+	}
+
+	return ucResent;
+}
+
+
+bool PIPE_bIdle( Pipe_t *pxPipe, TickType_t xTimeout )
+{
+	TimeOut_t xTimeOut;
+
+	if( pxPipe->xDone == NULL )
+	{
+		return true;
+	}
+
+	vTaskSetTimeOutState( &xTimeOut );
+
+	while( prvCount( pxPipe, ( 1UL << PIPE_SLOT_IN_FLIGHT ) | ( 1UL << PIPE_SLOT_RESERVED ) ) > 0 )
+	{
+		if( ( xTaskCheckForTimeOut( &xTimeOut, &xTimeout ) != pdFALSE ) ||
+			( xSemaphoreTake( pxPipe->xDone, xTimeout ) != pdTRUE ) )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+uint8_t PIPE_ucUsed( Pipe_t *pxPipe )
+{
+	return prvCount( pxPipe, ( 1UL << PIPE_SLOT_RESERVED ) | ( 1UL << PIPE_SLOT_IN_FLIGHT ) | ( 1UL << PIPE_SLOT_PENDING ) );
+}
+
+
+uint8_t PIPE_ucPending( Pipe_t *pxPipe )
+{
+	return prvCount( pxPipe, 1UL << PIPE_SLOT_PENDING );
+}
+
+
+void PIPE_vStatGet( Pipe_t *pxPipe, PipeStat_t *pxStat )
+{
+	taskENTER_CRITICAL();
+	*pxStat = pxPipe->xStat;
+	taskEXIT_CRITICAL();
+}
@@ -0,0 +1,133 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+
+/* Upper limit of the in-flight window */
+#define PIPE_SLOTS_MAX				( 8 )
+
+
+typedef enum {
+	PIPE_SLOT_FREE = 0,
+	PIPE_SLOT_RESERVED,			/* Payload being copied in */
+	PIPE_SLOT_IN_FLIGHT,		/* Handed to the transport, waiting for the acknowledge */
+	PIPE_SLOT_PENDING			/* Not acknowledged, sent again after the reconnect */
+
+} PipeSlotState_t;
+
+
+typedef struct {
+	PipeSlotState_t xState;
+	uint32_t ulToken;			/* Identifies the transmission in the completion, new for every retransmission */
+	uint32_t ulSeq;				/* Order of the PIPE_bSend calls, kept over retransmissions */
+	TickType_t xSent;
+	const char *pcTopic;		/* Not copied, has to outlive the slot */
+	uint16_t usTopicLength;
+	uint8_t ucQoS;
+	uint8_t *pucData;			/* Own copy of the payload, kept until the broker has it */
+	uint32_t ulLen;
+
+} PipeSlot_t;
+
+
+/* Asynchronous publish of the slot, valid during the call only; the outcome comes later through PIPE_bComplete with ulToken */
+typedef struct {
+	bool ( *pxPublish )( void *pvContext, const PipeSlot_t *pxSlot, uint32_t ulToken );	/* false if the publish did not start */
+	void *pvContext;
+
+} PipeTransport_t;
+
+
+typedef struct {
+	uint32_t ulSent;			/* Transmissions started, retransmissions included */
+	uint32_t ulAcked;
+	uint32_t ulFailed;			/* Transmissions not acknowledged */
+	uint32_t ulResent;
+	uint32_t ulRejected;		/* PIPE_bSend calls that found no free slot in time */
+	uint8_t ucInFlightMax;
+	TickType_t xRttMax;			/* Longest time from the publish to the acknowledge */
+	TickType_t xRttLast;
+
+} PipeStat_t;
+
+
+/*
+ * Window of publishes waiting for their acknowledge. A payload is copied into
+ * a free slot and handed to the transport right away, so up to ucSlots
+ * payloads are on the way at once instead of one round trip per payload.
+ * A slot is freed by its acknowledge; a failed one waits for PIPE_ucRetry on
+ * the same connection or PIPE_ucResend after the reconnect and goes out again
+ * in the original order.
+ * One sending task, completions may come from any task.
+ */
+typedef struct {
+	PipeSlot_t xSlots[PIPE_SLOTS_MAX];
+	uint8_t ucSlots;
+	uint32_t ulSlotSize;
+	uint32_t ulToken;
+	uint32_t ulSeq;
+	const PipeTransport_t *pxTransport;
+	SemaphoreHandle_t xDone;	/* Given on every completion */
+	PipeStat_t xStat;
+
+} Pipe_t;
+
+
+/** pucBuffers holds ucSlots payloads of ulSlotSize bytes, false on a bad geometry or no semaphore */
+bool PIPE_bInit( Pipe_t *pxPipe, const PipeTransport_t *pxTransport, uint8_t *pucBuffers, uint32_t ulSlotSize, uint8_t ucSlots );
+void PIPE_vDelete( Pipe_t *pxPipe );
+
+/**
+ * Copies the payload into a slot and publishes it, waits up to xTimeout for a free slot.
+ * false if the payload is too long or no slot freed in time; a payload taken is never lost
+ * while the device runs
+ */
+bool PIPE_bSend( Pipe_t *pxPipe, const char *pcTopic, uint16_t usTopicLength, uint8_t ucQoS, const uint8_t *pucData, uint32_t ulLen, TickType_t xTimeout );
+
+/** outcome of the transmission ulToken, false for a token of a replaced transmission which is ignored */
+bool PIPE_bComplete( Pipe_t *pxPipe, uint32_t ulToken, bool bAcked );
+
+/** after a reconnect, publishes the unacknowledged slots again oldest first, returns how many */
+uint8_t PIPE_ucResend( Pipe_t *pxPipe );
+/** on the same connection, publishes the pending slots again oldest first, the ones in flight stay; returns how many */
+uint8_t PIPE_ucRetry( Pipe_t *pxPipe );
+
+/** waits until nothing is in flight, pending slots don't count; false on the timeout */
+bool PIPE_bIdle( Pipe_t *pxPipe, TickType_t xTimeout );
+
+/** slots taken, in flight or pending */
+uint8_t PIPE_ucUsed( Pipe_t *pxPipe );
+/** slots waiting for PIPE_ucRetry or PIPE_ucResend */
+uint8_t PIPE_ucPending( Pipe_t *pxPipe );
+void PIPE_vStatGet( Pipe_t *pxPipe, PipeStat_t *pxStat );
+
+
+#endif /* PIPELINE_H */
@@ -0,0 +1,141 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "report.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+
+/* Deadband columns of message_schema.h */
+typedef struct {
+	uint8_t ucSensor;
+	float fDeadband;
+	float fRelative;			/* Fraction of the last reported value */
+} ReportBand_t;
+
+/* Values the receiver has seen last */
+typedef struct {
+	bool bValid;
+	bool bOn;
+	uint16_t usSilence;			/* Windows since the parameter was reported */
+	float fMean;
+	float fStdDev;
+} ReportState_t;
+
+#define REPORT_BAND_ROW( id, name, sensor, precision, unit, deadband, relative )	{ MSG_SENSOR_##sensor, deadband, ( relative ) / 100.0f },
+
+static const ReportBand_t xReportBand[MSG_PARAMETER_MAX] = { MSG_PARAMETERS( REPORT_BAND_ROW ) };
+
+static ReportState_t xReportState[MSG_PARAMETER_MAX];
+static ReportStat_t xReportStat;
+/* Set from the MQTT task, read by the sensors task */
+static volatile bool bSnapshotForced = true;
+
+
+static bool prvOutsideBand( const ReportBand_t *pxBand, float fValue, float fReported )
+{
+	float fBand = pxBand->fRelative * fabsf( fReported );
+
+	if( fBand < pxBand->fDeadband )
+	{
+		fBand = pxBand->fDeadband;
+	}
+
+	return ( fabsf( fValue - fReported ) > fBand );
+}
+
+
+void REPORT_vReset( void )
+{
+	memset( xReportState, 0, sizeof( xReportState ) );
+	memset( &xReportStat, 0, sizeof( xReportStat ) );
+	bSnapshotForced = true;
+}
+
+
+void REPORT_vSnapshotForce( void )
+{
+	bSnapshotForced = true;
+}
+
+
+void REPORT_vFilter( InfineonSensorsMessage_t *pxMessage )
+{
+	/* Read and cleared at once, a force from the MQTT task in between is not lost */
+	taskENTER_CRITICAL();
+	bool bSnapshot = bSnapshotForced;
+	bSnapshotForced = false;
+	taskEXIT_CRITICAL();
+
+	bSnapshot = bSnapshot || ( ( xReportStat.ulWindows % REPORT_SNAPSHOT_PERIOD ) == 0 );
+	xReportStat.ulWindows++;
+	xReportStat.ulSnapshots += bSnapshot;
+
+	for( uint32_t i = 0; i < MSG_PARAMETER_MAX; i++ )
+	{
+		const ReportBand_t *pxBand = &xReportBand[i];
+		ReportState_t *pxState = &xReportState[i];
+		StatData_t *pxStat = &pxMessage->xStat[i];
+		bool bOn = pxMessage->bOn[pxBand->ucSensor];
+
+		/* Open window, nothing is sent and nothing changes for the receiver */
+		if( !pxMessage->bReady[pxBand->ucSensor] )
+		{
+			continue;
+		}
+
+		bool bReport = bSnapshot || !pxState->bValid || ( bOn != pxState->bOn ) || ( ++pxState->usSilence >= REPORT_SILENCE_MAX );
+
+		/* The values of a switched off sensor are meaningless */
+		if( !bReport && bOn )
+		{
+			bReport = prvOutsideBand( pxBand, pxStat->fMean, pxState->fMean ) ||
+					  prvOutsideBand( pxBand, pxStat->fStdDev, pxState->fStdDev );
+		}
+
+		if( bReport )
+		{
+			pxState->bValid = true;
+			pxState->bOn = bOn;
+			pxState->usSilence = 0;
+			pxState->fMean = pxStat->fMean;
+			pxState->fStdDev = pxStat->fStdDev;
+			xReportStat.ulReported++;
+		}
+		else
+		{
+			pxMessage->bSuppressed[i] = true;
+			xReportStat.ulSuppressed++;
+		}
+	}
+}
+
+
+void REPORT_vStatGet( ReportStat_t *pxStat )
+{
+	*pxStat = xReportStat;
+}
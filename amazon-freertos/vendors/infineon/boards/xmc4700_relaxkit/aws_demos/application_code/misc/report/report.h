@@ -0,0 +1,62 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "app_types.h"
+
+
+/* Leave parameters that did not change out of the payload, 0 sends every window in full */
+#define REPORT_BY_EXCEPTION_ENABLE		( 1 )
+/* Windows a parameter may stay within its deadband before it is reported anyway */
+#define REPORT_SILENCE_MAX				( 60 )
+/* Every this many windows all parameters are reported, the receiver rebuilds its picture from it */
+#define REPORT_SNAPSHOT_PERIOD			( 600 )
+
+
+typedef struct {
+	uint32_t ulWindows;			/* Windows filtered */
+	uint32_t ulSnapshots;		/* Windows sent in full */
+	uint32_t ulReported;		/* Parameters sent */
+	uint32_t ulSuppressed;		/* Parameters left out */
+
+} ReportStat_t;
+
+
+/** forget the reported values, the next window is a snapshot */
+void REPORT_vReset( void );
+/** next window is a snapshot, e.g. after a message was lost */
+void REPORT_vSnapshotForce( void );
+/**
+ * mark the parameters of the message whose mean and standard deviation stayed within
+ * the message_schema.h deadbands of the last reported values, the encoders skip them
+ */
+void REPORT_vFilter( InfineonSensorsMessage_t *pxMessage );
+void REPORT_vStatGet( ReportStat_t *pxStat );
+
+
+#endif /* REPORT_H */
@@ -0,0 +1,481 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "settings.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "iot_json_utils.h"
+
+
+/* Longest key searched for, the sensor names included */
+#define SETTINGS_KEY_MAX			( 16 )
+/* Record of the settings in the NVM, a different layout is not loaded */
+#define SETTINGS_MAGIC				( 0x53455454UL )
+/* Groups of sensors whose samples are combined */
+#define SETTINGS_LINKS_MAX			( 4 )
+
+typedef struct {
+	uint32_t ulMagic;
+	uint32_t ulSize;
+	Settings_t xSettings;
+
+} SettingsRecord_t;
+
+
+#define SETTINGS_SENSOR_NAME( sensor )		#sensor,
+
+static const char *pcSensorName[MSG_SENSOR_MAX] = { MSG_SENSORS( SETTINGS_SENSOR_NAME ) };
+
+
+static Settings_t xCurrent;
+static Settings_t xPending;
+static bool bPending = false;
+static bool bReportDue = false;
+static bool bPersistDue = false;
+
+static uint32_t ulLinks[SETTINGS_LINKS_MAX];
+static uint32_t ulLinksNumber = 0;
+
+
+/* Value of the key in the object, the quote before the key keeps it from matching the tail of a longer one */
+static bool prvFind( const char *pcDoc, size_t xLen, const char *pcKey, const char **ppcValue, size_t *pxValueLen )
+{
+	char cKey[SETTINGS_KEY_MAX + 2];
+
+	int lLen = snprintf( cKey, sizeof( cKey ), "\"%s", pcKey );
+	if( ( lLen <= 1 ) || ( ( size_t )lLen >= sizeof( cKey ) ) )
+	{
+		return false;
+	}
+
+	return IotJsonUtils_FindJsonValue( pcDoc, xLen, cKey, ( size_t )lLen, ppcValue, pxValueLen );
+}
+
+
+/* Absent key is true and leaves the value, a present one has to be in bounds */
+static bool prvUint( const char *pcObj, size_t xObjLen, const char *pcKey, uint32_t ulMin, uint32_t ulMax, uint32_t *pulValue )
+{
+	const char *pcValue;
+	size_t xLen;
+	uint32_t ulValue = 0;
+
+	if( !prvFind( pcObj, xObjLen, pcKey, &pcValue, &xLen ) )
+	{
+		return true;
+	}
+
+	if( ( xLen == 0 ) || ( xLen > 10 ) )
+	{
+		return false;
+	}
+
+	for( size_t i = 0; i < xLen; i++ )
+	{
+		if( ( pcValue[i] < '0' ) || ( pcValue[i] > '9' ) || ( ulValue > ( ( ulMax - ( uint32_t )( pcValue[i] - '0' ) ) / 10 ) ) )
+		{
+			return false;
+		}
+		ulValue = ulValue * 10 + ( uint32_t )( pcValue[i] - '0' );
+	}
+
+	if( ulValue < ulMin )
+	{
+		return false;
+	}
+
+	*pulValue = ulValue;
+
+	return true;
+}
+
+
+static bool prvBool( const char *pcObj, size_t xObjLen, const char *pcKey, bool *pbValue )
+{
+	const char *pcValue;
+	size_t xLen;
+
+	if( !prvFind( pcObj, xObjLen, pcKey, &pcValue, &xLen ) )
+	{
+		return true;
+	}
+
+	if( ( xLen == 4 ) && ( strncmp( pcValue, "true", 4 ) == 0 ) )
+	{
+		*pbValue = true;
+	}
+	else if( ( xLen == 5 ) && ( strncmp( pcValue, "false", 5 ) == 0 ) )
+	{
+		*pbValue = false;
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+/* A group the delta changes has to end up with one sample_ms and window, sensors not built in aside */
+static bool prvLinksKept( const Settings_t *pxOld, const Settings_t *pxNew )
+{
+	for( uint32_t i = 0; i < ulLinksNumber; i++ )
+	{
+		const SettingsSensor_t *pxFirst = NULL;
+		bool bChanged = false;
+		bool bSame = true;
+
+		for( uint32_t j = 0; j < MSG_SENSOR_MAX; j++ )
+		{
+			const SettingsSensor_t *pxSensor = &pxNew->xSensor[j];
+
+			if( ( ( ulLinks[i] & ( 1UL << j ) ) == 0 ) || ( pxOld->xSensor[j].ulSendMs == 0 ) )
+			{
+				continue;
+			}
+
+			bChanged |= ( pxSensor->ulSampleMs != pxOld->xSensor[j].ulSampleMs ) || ( pxSensor->ulWindow != pxOld->xSensor[j].ulWindow );
+			if( pxFirst == NULL )
+			{
+				pxFirst = pxSensor;
+			}
+			bSame &= ( pxSensor->ulSampleMs == pxFirst->ulSampleMs ) && ( pxSensor->ulWindow == pxFirst->ulWindow );
+		}
+
+		if( bChanged && !bSame )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/* A bool of the NVM record may hold any byte */
+static bool prvBoolValid( const bool *pbValue )
+{
+	uint8_t ucByte;
+
+	memcpy( &ucByte, pbValue, sizeof( ucByte ) );
+
+	return ucByte <= 1;
+}
+
+
+/* Settings within the bounds of a delta and keeping the links of pxBase, sensors not built in aside */
+static bool prvValid( const Settings_t *pxBase, const Settings_t *pxNew )
+{
+	for( uint32_t i = 0; i < MSG_SENSOR_MAX; i++ )
+	{
+		const SettingsSensor_t *pxSensor = &pxNew->xSensor[i];
+
+		if( pxBase->xSensor[i].ulSendMs == 0 )
+		{
+			continue;
+		}
+
+		/* A sensor read by DMA keeps sample_ms 0 */
+		if( !prvBoolValid( &pxSensor->bOn ) ||
+			( ( pxSensor->ulSampleMs == 0 ) && ( pxBase->xSensor[i].ulSampleMs != 0 ) ) || ( pxSensor->ulSampleMs > SETTINGS_SAMPLE_MS_MAX ) ||
+			( pxSensor->ulWindow == 0 ) || ( pxSensor->ulWindow > SETTINGS_WINDOW_MAX ) ||
+			( pxSensor->ulSendMs < SETTINGS_SEND_MS_MIN ) || ( pxSensor->ulSendMs > SETTINGS_SEND_MS_MAX ) )
+		{
+			return false;
+		}
+	}
+
+	if( !prvBoolValid( &pxNew->bSpectra ) || ( pxNew->ucAlarmPercent == 0 ) || ( pxNew->ucAlarmPercent > 100 ) )
+	{
+		return false;
+	}
+
+	return prvLinksKept( pxBase, pxNew );
+}
+
+
+bool SETTINGS_bLink( uint32_t ulRows )
+{
+	if( ulLinksNumber >= SETTINGS_LINKS_MAX )
+	{
+		return false;
+	}
+
+	ulLinks[ulLinksNumber++] = ulRows;
+
+	return true;
+}
+
+
+bool SETTINGS_bParse( Settings_t *pxSettings, const char *pcState, size_t xStateLen )
+{
+	const char *pcSensors;
+	size_t xSensorsLen;
+	Settings_t xNew = *pxSettings;
+
+	if( ( xStateLen == 0 ) || ( pcState[0] != '{' ) )
+	{
+		return false;
+	}
+
+	if( prvFind( pcState, xStateLen, "sensors", &pcSensors, &xSensorsLen ) )
+	{
+		if( pcSensors[0] != '{' )
+		{
+			return false;
+		}
+
+		for( uint32_t i = 0; i < MSG_SENSOR_MAX; i++ )
+		{
+			const char *pcObj;
+			size_t xObjLen;
+			SettingsSensor_t *pxSensor = &xNew.xSensor[i];
+
+			if( ( pxSensor->ulSendMs == 0 ) || !prvFind( pcSensors, xSensorsLen, pcSensorName[i], &pcObj, &xObjLen ) )
+			{
+				continue;
+			}
+
+			if( ( pcObj[0] != '{' ) ||
+				!prvBool( pcObj, xObjLen, "on", &pxSensor->bOn ) ||
+				!prvUint( pcObj, xObjLen, "sample_ms", 1, SETTINGS_SAMPLE_MS_MAX, &pxSensor->ulSampleMs ) ||
+				!prvUint( pcObj, xObjLen, "window", 1, SETTINGS_WINDOW_MAX, &pxSensor->ulWindow ) ||
+				!prvUint( pcObj, xObjLen, "send_ms", SETTINGS_SEND_MS_MIN, SETTINGS_SEND_MS_MAX, &pxSensor->ulSendMs ) )
+			{
+				return false;
+			}
+		}
+	}
+
+	uint32_t ulAlarm = xNew.ucAlarmPercent;
+	if( !prvBool( pcState, xStateLen, "spectra", &xNew.bSpectra ) ||
+		!prvUint( pcState, xStateLen, "alarm_percent", 1, 100, &ulAlarm ) )
+	{
+		return false;
+	}
+	xNew.ucAlarmPercent = ( uint8_t )ulAlarm;
+
+	if( !prvValid( pxSettings, &xNew ) )
+	{
+		return false;
+	}
+
+	*pxSettings = xNew;
+
+	return true;
+}
+
+
+bool SETTINGS_bDelta( const char *pcDoc, size_t xLen )
+{
+	const char *pcState;
+	size_t xStateLen;
+	Settings_t xNew;
+
+	/* The shadow of a get holds the delta next to the desired and the reported state, a shadow in sync holds none */
+	if( !prvFind( pcDoc, xLen, "delta", &pcState, &xStateLen ) )
+	{
+		if( !prvFind( pcDoc, xLen, "state", &pcState, &xStateLen ) )
+		{
+			return false;
+		}
+
+		const char *pcDesired;
+		size_t xDesiredLen;
+		if( prvFind( pcState, xStateLen, "desired", &pcDesired, &xDesiredLen ) )
+		{
+			return true;
+		}
+	}
+
+	taskENTER_CRITICAL();
+	xNew = bPending ? xPending : xCurrent;
+	taskEXIT_CRITICAL();
+
+	if( !SETTINGS_bParse( &xNew, pcState, xStateLen ) )
+	{
+		return false;
+	}
+
+	taskENTER_CRITICAL();
+	xPending = xNew;
+	bPending = true;
+	taskEXIT_CRITICAL();
+
+	return true;
+}
+
+
+bool SETTINGS_bTake( Settings_t *pxSettings )
+{
+	bool bRet;
+
+	taskENTER_CRITICAL();
+	bRet = bPending;
+	if( bPending )
+	{
+		*pxSettings = xPending;
+		bPending = false;
+	}
+	taskEXIT_CRITICAL();
+
+	return bRet;
+}
+
+
+void SETTINGS_vApplied( const Settings_t *pxSettings, bool bPersist )
+{
+	taskENTER_CRITICAL();
+	xCurrent = *pxSettings;
+	bReportDue = true;
+	bPersistDue |= bPersist;
+	taskEXIT_CRITICAL();
+}
+
+
+bool SETTINGS_bReport( Settings_t *pxSettings, bool *pbPersist )
+{
+	bool bRet;
+
+	taskENTER_CRITICAL();
+	bRet = bReportDue;
+	if( bReportDue )
+	{
+		*pxSettings = xCurrent;
+		*pbPersist = bPersistDue;
+		bReportDue = false;
+		bPersistDue = false;
+	}
+	taskEXIT_CRITICAL();
+
+	return bRet;
+}
+
+
+void SETTINGS_vReportAgain( void )
+{
+	taskENTER_CRITICAL();
+	bReportDue = true;
+	taskEXIT_CRITICAL();
+}
+
+
+void SETTINGS_vGet( Settings_t *pxSettings )
+{
+	taskENTER_CRITICAL();
+	*pxSettings = xCurrent;
+	taskEXIT_CRITICAL();
+}
+
+
+uint32_t SETTINGS_ulReported( const Settings_t *pxSettings, uint32_t ulToken, char *pcBuf, uint32_t ulSize )
+{
+	uint32_t ulLen = 0;
+	int lLen;
+
+	lLen = snprintf( pcBuf, ulSize, "{\"state\":{\"reported\":{\"sensors\":{" );
+	if( ( lLen <= 0 ) || ( ( uint32_t )lLen >= ulSize ) )
+	{
+		return 0;
+	}
+	ulLen = ( uint32_t )lLen;
+
+	for( uint32_t i = 0; i < MSG_SENSOR_MAX; i++ )
+	{
+		const SettingsSensor_t *pxSensor = &pxSettings->xSensor[i];
+		if( pxSensor->ulSendMs == 0 )
+		{
+			continue;
+		}
+
+		lLen = snprintf( &pcBuf[ulLen], ulSize - ulLen, "%s\"%s\":{\"on\":%s,\"sample_ms\":%u,\"window\":%u,\"send_ms\":%u}",
+				( pcBuf[ulLen - 1] == '{' ) ? "" : ",", pcSensorName[i], pxSensor->bOn ? "true" : "false",
+				( unsigned )pxSensor->ulSampleMs, ( unsigned )pxSensor->ulWindow, ( unsigned )pxSensor->ulSendMs );
+		if( ( lLen <= 0 ) || ( ( uint32_t )lLen >= ( ulSize - ulLen ) ) )
+		{
+			return 0;
+		}
+		ulLen += ( uint32_t )lLen;
+	}
+
+	/* The shadow service echoes the token in its answer, the update is matched by it */
+	lLen = snprintf( &pcBuf[ulLen], ulSize - ulLen, "},\"spectra\":%s,\"alarm_percent\":%u}},\"clientToken\":\"%08x\"}",
+			pxSettings->bSpectra ? "true" : "false", ( unsigned )pxSettings->ucAlarmPercent, ( unsigned )ulToken );
+	if( ( lLen <= 0 ) || ( ( uint32_t )lLen >= ( ulSize - ulLen ) ) )
+	{
+		return 0;
+	}
+
+	return ulLen + ( uint32_t )lLen;
+}
+
+
+bool SETTINGS_bLoad( Settings_t *pxSettings, const SettingsNvm_t *pxNvm )
+{
+	SettingsRecord_t xRecord;
+	Settings_t xNew = *pxSettings;
+
+	if( !pxNvm->pxRead( ( uint8_t * )&xRecord, sizeof( xRecord ) ) ||
+		( xRecord.ulMagic != SETTINGS_MAGIC ) || ( xRecord.ulSize != sizeof( Settings_t ) ) )
+	{
+		return false;
+	}
+
+	/* Sensors built in since the record was written keep their defaults */
+	for( uint32_t i = 0; i < MSG_SENSOR_MAX; i++ )
+	{
+		if( ( xNew.xSensor[i].ulSendMs != 0 ) && ( xRecord.xSettings.xSensor[i].ulSendMs != 0 ) )
+		{
+			xNew.xSensor[i] = xRecord.xSettings.xSensor[i];
+		}
+	}
+	xNew.bSpectra = xRecord.xSettings.bSpectra;
+	xNew.ucAlarmPercent = xRecord.xSettings.ucAlarmPercent;
+
+	/* A record out of the bounds of a delta is not run with, the defaults stay */
+	if( !prvValid( pxSettings, &xNew ) )
+	{
+		return false;
+	}
+
+	*pxSettings = xNew;
+
+	return true;
+}
+
+
+bool SETTINGS_bSave( const Settings_t *pxSettings, const SettingsNvm_t *pxNvm )
+{
+	SettingsRecord_t xRecord;
+
+	memset( &xRecord, 0, sizeof( xRecord ) );
+	xRecord.ulMagic = SETTINGS_MAGIC;
+	xRecord.ulSize = sizeof( Settings_t );
+	xRecord.xSettings = *pxSettings;
+
+	return pxNvm->pxWrite( ( const uint8_t * )&xRecord, sizeof( xRecord ) );
+}
@@ -0,0 +1,110 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "message_schema.h"
+
+
+/* Bounds of the values a delta may set, a delta with any value out of them is rejected as a whole */
+#define SETTINGS_SAMPLE_MS_MAX		( 60000 )
+#define SETTINGS_WINDOW_MAX			( 256 )
+#define SETTINGS_SEND_MS_MIN		( 100 )
+#define SETTINGS_SEND_MS_MAX		( 3600000 )
+/* Buffer of the reported document with every sensor built in */
+#define SETTINGS_REPORT_SIZE		( 1536 )
+
+
+/* Acquisition of one MSG_SENSORS row */
+typedef struct {
+	bool bOn;
+	uint32_t ulSampleMs;		/* Time between two reads, 0 for a sensor read by DMA */
+	uint32_t ulWindow;			/* Max samples in the window */
+	uint32_t ulSendMs;			/* Window length in time, 0 for a sensor not built in */
+
+} SettingsSensor_t;
+
+
+typedef struct {
+	SettingsSensor_t xSensor[MSG_SENSOR_MAX];
+	bool bSpectra;				/* Spectra in the routine windows, alarms go in full */
+	uint8_t ucAlarmPercent;		/* Classifier probability from which a window is an alarm */
+
+} Settings_t;
+
+
+/* Non-volatile memory of the applied settings, the record is read and written as a whole */
+typedef struct {
+	bool ( *pxRead )( uint8_t *pucData, uint32_t ulLen );
+	bool ( *pxWrite )( const uint8_t *pucData, uint32_t ulLen );
+
+} SettingsNvm_t;
+
+
+/**
+ * Runtime acquisition and reporting settings from the device shadow. The
+ * delta is applied by the sensors task, then saved and reported back by the
+ * MQTT task, so the reported state is always what the device runs with:
+ *
+ *   {"sensors":{"DPS368_1":{"on":true,"sample_ms":100,"window":50,"send_ms":5000},..},
+ *    "spectra":true,"alarm_percent":80}
+ *
+ * Keys left out keep their values, unknown keys and sensors not built in are
+ * ignored. Sensors whose samples are combined, a DPS368 pair or the
+ * correlation channels, are linked: a delta changing the sample_ms or window
+ * of one of them has to give all of them the same values.
+ */
+
+/** rows of message_schema.h as bits of ulRows are linked, set up before SETTINGS_bLoad; false if too many links */
+bool SETTINGS_bLink( uint32_t ulRows );
+
+/** parses a state object into pxSettings, which holds the base; false leaves it as it was */
+bool SETTINGS_bParse( Settings_t *pxSettings, const char *pcState, size_t xStateLen );
+/** document of the delta topic or of a get, its delta over the settings not applied yet or else the current ones */
+bool SETTINGS_bDelta( const char *pcDoc, size_t xLen );
+/** settings of a delta the sensors task has to apply, true once per delta */
+bool SETTINGS_bTake( Settings_t *pxSettings );
+/** settings the sensors task runs with from now on, bPersist once they came from a delta */
+void SETTINGS_vApplied( const Settings_t *pxSettings, bool bPersist );
+/** applied settings not reported yet, true once per SETTINGS_vApplied; *pbPersist if they are to be saved first */
+bool SETTINGS_bReport( Settings_t *pxSettings, bool *pbPersist );
+/** reports the current settings again, after a failed report or a new connection */
+void SETTINGS_vReportAgain( void );
+void SETTINGS_vGet( Settings_t *pxSettings );
+
+/** reported state document with a client token, 0 if it doesn't fit ulSize */
+uint32_t SETTINGS_ulReported( const Settings_t *pxSettings, uint32_t ulToken, char *pcBuf, uint32_t ulSize );
+
+/** settings of the last run of the same layout and within the bounds of a delta, false leaves pxSettings as it was */
+bool SETTINGS_bLoad( Settings_t *pxSettings, const SettingsNvm_t *pxNvm );
+bool SETTINGS_bSave( const Settings_t *pxSettings, const SettingsNvm_t *pxNvm );
+
+/* Emulated EEPROM of the XMC4, after the PKCS #11 objects */
+extern const SettingsNvm_t SETTINGS_xEeprom;
+
+
+#endif /* SETTINGS_H */
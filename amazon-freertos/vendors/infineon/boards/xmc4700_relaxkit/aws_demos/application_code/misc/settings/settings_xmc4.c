@@ -0,0 +1,85 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#include "settings.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "e_eeprom_xmc4.h"
+
+
+static E_EEPROM_XMC4_t xEeprom;
+
+
+/* The block is shared with the PKCS #11 port, both initialize it with the same length */
+static bool prvEepromInit( uint32_t ulLen )
+{
+	if( ( E_EEPROM_XMC4_SETTINGS_OFFSET + ulLen ) >= E_EEPROM_XMC4_DATA_LEN )
+	{
+		return false;
+	}
+
+	E_EEPROM_XMC4_STATUS_t xStatus = E_EEPROM_XMC4_Init( &xEeprom, E_EEPROM_XMC4_DATA_LEN );
+
+	return ( xStatus == E_EEPROM_XMC4_STATUS_OK ) || ( xStatus == E_EEPROM_XMC4_STATUS_ERROR_OLD_DATA );
+}
+
+
+static bool prvEepromRead( uint8_t *pucData, uint32_t ulLen )
+{
+	if( !prvEepromInit( ulLen ) || E_EEPROM_XMC4_IsFlashEmpty() )
+	{
+		return false;
+	}
+
+	E_EEPROM_XMC4_ReadArray( E_EEPROM_XMC4_SETTINGS_OFFSET, pucData, ( uint16_t )ulLen );
+
+	return true;
+}
+
+
+static bool prvEepromWrite( const uint8_t *pucData, uint32_t ulLen )
+{
+	if( !prvEepromInit( ulLen ) )
+	{
+		return false;
+	}
+
+	/* Unchanged settings cost no erase */
+	if( !E_EEPROM_XMC4_WriteArray( E_EEPROM_XMC4_SETTINGS_OFFSET, pucData, ( uint16_t )ulLen ) )
+	{
+		return true;
+	}
+
+	taskENTER_CRITICAL();
+	E_EEPROM_XMC4_STATUS_t xStatus = E_EEPROM_XMC4_UpdateFlashContents();
+	taskEXIT_CRITICAL();
+
+	return ( xStatus == E_EEPROM_XMC4_STATUS_OK );
+}
+
+
+const SettingsNvm_t SETTINGS_xEeprom = {
+	.pxRead = prvEepromRead,
+	.pxWrite = prvEepromWrite
+};
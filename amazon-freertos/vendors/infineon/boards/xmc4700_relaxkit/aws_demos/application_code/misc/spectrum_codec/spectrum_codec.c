@@ -0,0 +1,299 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "spectrum_codec.h"
+#include "dbg.h"
+
+
+/* Codes and residuals fit the two byte varint of SPEC_FRAME_SIZE_MAX */
+STATIC_ASSERT( SPEC_CODES <= 256, spec_codes_exceed_8_bits );
+STATIC_ASSERT( SPEC_BINS_MAX <= 128, spec_bins_exceed_2_byte_run );
+
+/* Smallest magnitude of each dB index above 0 */
+static uint32_t pulUpper[SPEC_CODES - 2];
+/* Magnitude of each code */
+static uint16_t pusLevel[SPEC_CODES];
+static bool bTablesReady = false;
+
+
+static void prvTablesInit( void )
+{
+	float fLevel;
+
+	pusLevel[0] = 0;
+	for( uint32_t k = 0; k < SPEC_CODES - 1; k++ )
+	{
+		fLevel = roundf( powf( 10.0f, (float)( k * SPEC_DB_STEP_CDB ) / 2000.0f ) );
+		pusLevel[k + 1] = ( fLevel > (float)UINT16_MAX ) ? UINT16_MAX : (uint16_t)fLevel;
+	}
+	/* Half a step above each index */
+	for( uint32_t k = 0; k < SPEC_CODES - 2; k++ )
+	{
+		pulUpper[k] = (uint32_t)ceilf( powf( 10.0f, ( (float)k + 0.5f ) * SPEC_DB_STEP_CDB / 2000.0f ) );
+	}
+
+	bTablesReady = true;
+}
+
+
+void SPEC_vReset( SpecCodec_t *pxCodec )
+{
+	if( pxCodec )
+	{
+		memset( pxCodec, 0, sizeof( SpecCodec_t ) );
+	}
+}
+
+
+/* The index is the count of thresholds at or below the magnitude */
+uint8_t SPEC_ucQuantise( uint16_t usMag )
+{
+	uint32_t ulLow = 0, ulHigh = SPEC_CODES - 2, ulMid;
+
+	if( usMag == 0 )
+	{
+		return 0;
+	}
+	if( !bTablesReady )
+	{
+		prvTablesInit();
+	}
+
+	while( ulLow < ulHigh )
+	{
+		ulMid = ( ulLow + ulHigh ) / 2;
+		if( pulUpper[ulMid] <= usMag )
+		{
+			ulLow = ulMid + 1;
+		}
+		else
+		{
+			ulHigh = ulMid;
+		}
+	}
+
+	return (uint8_t)( ulLow + 1 );
+}
+
+
+uint16_t SPEC_usDequantise( uint8_t ucCode )
+{
+	if( !bTablesReady )
+	{
+		prvTablesInit();
+	}
+
+	return ( ucCode < SPEC_CODES ) ? pusLevel[ucCode] : UINT16_MAX;
+}
+
+
+/* Counts always, writes while it fits */
+static uint32_t prvVarintPut( uint32_t ulVal, uint8_t *pucOut, uint32_t ulLen, uint32_t ulMaxSize )
+{
+	do
+	{
+		uint8_t ucByte = ulVal & 0x7F;
+		ulVal >>= 7;
+		if( ulVal )
+		{
+			ucByte |= 0x80;
+		}
+		if( pucOut && ( ulLen < ulMaxSize ) )
+		{
+			pucOut[ulLen] = ucByte;
+		}
+		ulLen++;
+	} while( ulVal );
+
+	return ulLen;
+}
+
+
+static bool prvVarintGet( const uint8_t *pucIn, uint32_t ulLen, uint32_t *pulPos, uint32_t *pulVal )
+{
+	uint32_t ulVal = 0;
+
+	for( uint8_t ucShift = 0; ucShift < 28; ucShift += 7 )
+	{
+		if( *pulPos >= ulLen )
+		{
+			return false;
+		}
+		ulVal |= (uint32_t)( pucIn[*pulPos] & 0x7F ) << ucShift;
+		if( !( pucIn[( *pulPos )++] & 0x80 ) )
+		{
+			*pulVal = ulVal;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/* Tokens of the residuals against pucRef, or against the bin before without it; only the length with no pucOut */
+static uint32_t prvTokensPut( const uint8_t *pucCode, const uint8_t *pucRef, uint16_t usBins, uint8_t *pucOut, uint32_t ulMaxSize )
+{
+	uint32_t ulLen = 0;
+	uint16_t usRun = 0;
+	int32_t lRes;
+
+	for( uint16_t i = 0; i < usBins; i++ )
+	{
+		lRes = (int32_t)pucCode[i] - ( pucRef ? pucRef[i] : ( i ? pucCode[i - 1] : 0 ) );
+		if( lRes == 0 )
+		{
+			usRun++;
+			continue;
+		}
+		if( usRun )
+		{
+			ulLen = prvVarintPut( ( (uint32_t)( usRun - 1 ) << 1 ) | 1, pucOut, ulLen, ulMaxSize );
+			usRun = 0;
+		}
+		/* zigzag: 0 -1 1 -2 2 .. to 0 1 2 3 4 .. */
+		ulLen = prvVarintPut( ( ( (uint32_t)lRes << 1 ) ^ (uint32_t)( lRes >> 31 ) ) << 1, pucOut, ulLen, ulMaxSize );
+	}
+	if( usRun )
+	{
+		ulLen = prvVarintPut( ( (uint32_t)( usRun - 1 ) << 1 ) | 1, pucOut, ulLen, ulMaxSize );
+	}
+
+	return ulLen;
+}
+
+
+uint32_t SPEC_ulEncode( SpecCodec_t *pxCodec, const uint16_t *pusMag, uint16_t usBins, uint8_t *pucFrame, uint32_t ulMaxSize )
+{
+	uint8_t pucCode[SPEC_BINS_MAX];
+	uint32_t ulLen;
+	bool bInter;
+
+	if( ( !pxCodec ) || ( !pusMag ) || ( !pucFrame ) || ( usBins == 0 ) || ( usBins > SPEC_BINS_MAX ) || ( ulMaxSize < 2 ) )
+	{
+		return 0;
+	}
+
+	for( uint16_t i = 0; i < usBins; i++ )
+	{
+		pucCode[i] = SPEC_ucQuantise( pusMag[i] );
+	}
+
+	/* A steady spectrum is cheaper against the window before, a changing one against its neighbour bin */
+	bInter = ( pxCodec->usBins == usBins ) && ( pxCodec->ucSinceKey + 1 < SPEC_KEY_INTERVAL );
+	if( bInter && ( prvTokensPut( pucCode, pxCodec->pucCode, usBins, NULL, 0 ) >= prvTokensPut( pucCode, NULL, usBins, NULL, 0 ) ) )
+	{
+		bInter = false;
+	}
+
+	pucFrame[0] = bInter ? SPEC_FLAG_INTER : 0;
+	pucFrame[1] = pxCodec->ucSeq + 1;
+	ulLen = prvVarintPut( usBins, pucFrame, 2, ulMaxSize );
+	ulLen += prvTokensPut( pucCode, bInter ? pxCodec->pucCode : NULL, usBins, ( ulLen < ulMaxSize ) ? &pucFrame[ulLen] : NULL,
+			( ulLen < ulMaxSize ) ? ( ulMaxSize - ulLen ) : 0 );
+	if( ulLen > ulMaxSize )
+	{
+		return 0;
+	}
+
+	memcpy( pxCodec->pucCode, pucCode, usBins );
+	pxCodec->usBins = usBins;
+	pxCodec->ucSeq++;
+	pxCodec->ucSinceKey = bInter ? ( pxCodec->ucSinceKey + 1 ) : 0;
+
+	return ulLen;
+}
+
+
+bool SPEC_bDecode( SpecCodec_t *pxCodec, const uint8_t *pucFrame, uint32_t ulLen, uint8_t *pucCode, uint16_t *pusBins )
+{
+	uint8_t pucNew[SPEC_BINS_MAX];
+	uint32_t ulPos = 2, ulBins, ulToken, ulZigzag;
+	uint16_t usBin = 0;
+	int32_t lCode;
+	bool bInter;
+
+	if( ( !pxCodec ) || ( !pucFrame ) || ( !pucCode ) || ( !pusBins ) || ( ulLen < 3 ) || ( pucFrame[0] & ~SPEC_FLAG_INTER ) )
+	{
+		return false;
+	}
+	if( !prvVarintGet( pucFrame, ulLen, &ulPos, &ulBins ) || ( ulBins == 0 ) || ( ulBins > SPEC_BINS_MAX ) )
+	{
+		return false;
+	}
+
+	bInter = pucFrame[0] & SPEC_FLAG_INTER;
+	if( bInter && ( ( pxCodec->usBins != ulBins ) || ( pucFrame[1] != (uint8_t)( pxCodec->ucSeq + 1 ) ) ) )
+	{
+		return false;
+	}
+
+	while( ulPos < ulLen )
+	{
+		uint32_t ulRepeat = 1;
+		int32_t lRes = 0;
+
+		if( !prvVarintGet( pucFrame, ulLen, &ulPos, &ulToken ) )
+		{
+			return false;
+		}
+		if( ulToken & 1 )
+		{
+			ulRepeat = ( ulToken >> 1 ) + 1;
+		}
+		else
+		{
+			ulZigzag = ulToken >> 1;
+			lRes = (int32_t)( ulZigzag >> 1 ) ^ -(int32_t)( ulZigzag & 1 );
+		}
+		if( usBin + ulRepeat > ulBins )
+		{
+			return false;
+		}
+
+		for( ; ulRepeat > 0; ulRepeat--, usBin++ )
+		{
+			lCode = lRes + ( bInter ? pxCodec->pucCode[usBin] : ( usBin ? pucNew[usBin - 1] : 0 ) );
+			if( ( lCode < 0 ) || ( lCode >= SPEC_CODES ) )
+			{
+				return false;
+			}
+			pucNew[usBin] = (uint8_t)lCode;
+		}
+	}
+	if( usBin != ulBins )
+	{
+		return false;
+	}
+
+	memcpy( pxCodec->pucCode, pucNew, ulBins );
+	memcpy( pucCode, pucNew, ulBins );
+	pxCodec->usBins = ulBins;
+	pxCodec->ucSeq = pucFrame[1];
+	*pusBins = ulBins;
+
+	return true;
+}
@@ -0,0 +1,81 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#ifndef SPECTRUM_CODEC_H
+#define SPECTRUM_CODEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/* Max bins of one spectrum */
+#define SPEC_BINS_MAX				( 128 )
+/* Quantisation step and the dB of the full uint16_t scale, 0.01 dB */
+#define SPEC_DB_STEP_CDB			( 50 )
+#define SPEC_DB_FULL_SCALE_CDB		( 9633 )
+/* Window with delta across bins only, the decoder recovers from a lost message here */
+#define SPEC_KEY_INTERVAL			( 16 )
+
+/* Code 0 is a zero magnitude, code k + 1 is k * SPEC_DB_STEP_CDB dB */
+#define SPEC_CODES					( ( SPEC_DB_FULL_SCALE_CDB + SPEC_DB_STEP_CDB - 1 ) / SPEC_DB_STEP_CDB + 2 )
+/* Header and two bytes a bin at most */
+#define SPEC_FRAME_SIZE_MAX( n )	( 5 + 2 * ( n ) )
+
+/* Frame header flags */
+#define SPEC_FLAG_INTER				( 0x01 )
+
+
+/**
+ * Frame:
+ *   flags, window sequence number, bin count varint, tokens
+ * Token, varint u:
+ *   u & 1 == 0 - residual zigzag( u >> 1 )
+ *   u & 1 == 1 - ( u >> 1 ) + 1 zero residuals
+ * Residual of bin i:
+ *   key frame   - code[i] - code[i - 1], code[-1] = 0
+ *   inter frame - code[i] - code of the bin in the window before, its sequence number is one less
+ * The encoder sends the shorter of the two, a key frame every SPEC_KEY_INTERVAL windows.
+ */
+
+/* Structure containing the codes of the last window, one per stream on both ends */
+typedef struct {
+	uint8_t pucCode[SPEC_BINS_MAX]; 	//! < Codes of the last window
+	uint16_t usBins; 					//! < Bins of the last window, 0 before the first one
+	uint8_t ucSeq; 						//! < Sequence number of the last window
+	uint8_t ucSinceKey; 				//! < Windows since the last key frame
+} SpecCodec_t;
+
+
+/** zero state, the next frame is a key frame */
+void SPEC_vReset( SpecCodec_t *pxCodec );
+/** dB code of the magnitude, round to nearest */
+uint8_t SPEC_ucQuantise( uint16_t usMag );
+/** magnitude of the code */
+uint16_t SPEC_usDequantise( uint8_t ucCode );
+/** frame of usBins magnitudes, returns its length, 0 if it does not fit */
+uint32_t SPEC_ulEncode( SpecCodec_t *pxCodec, const uint16_t *pusMag, uint16_t usBins, uint8_t *pucFrame, uint32_t ulMaxSize );
+/** codes of the frame, false for a broken frame or an inter frame without its reference window */
+bool SPEC_bDecode( SpecCodec_t *pxCodec, const uint8_t *pucFrame, uint32_t ulLen, uint8_t *pucCode, uint16_t *pusBins );
+
+
+#endif /* SPECTRUM_CODEC_H */
@@ -34,7 +34,7 @@
 #include "float_to_string.h"
 
 
-static char pcTempStr[32];
+static char pcTempStr[FTOS_BUF_SIZE];
 /** This function calculates features from vector of vec_len and returns result thru pointers */
 void STAT_vCalcAndPrint( float *pfVect, uint32_t ulVecLen, float *pfMax, float *pfMin, float *pfMean, float *pfRMS, float *pfStdDev, float *pfVariance )
 {
@@ -78,7 +78,7 @@ void STAT_vCalcAndPrint( float *pfVect, uint32_t ulVecLen, float *pfMax, float *
 }
 
 
-static char pcFloatToStringBuffer[10];
+static char pcFloatToStringBuffer[FTOS_BUF_SIZE];
 /** This function print statistic data */
 uint8_t *STAT_pcPrintStatData( StatData_t *pxStatData, uint8_t *pucBuffer )
 {
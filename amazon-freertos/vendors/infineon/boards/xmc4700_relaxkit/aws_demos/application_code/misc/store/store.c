@@ -0,0 +1,566 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "store.h"
+#include "dbg.h"
+
+
+#define STORE_SECTOR_MAGIC		( 0x524F5453UL )	/* "STOR" */
+#define STORE_DATA_MAGIC		( 0x41544144UL )	/* "DATA" */
+#define STORE_ACK_MAGIC			( 0x534B4341UL )	/* "ACKS" */
+
+
+/* Page 0 of every open sector */
+typedef struct {
+	uint32_t ulMagic;
+	uint32_t ulSeq;				/* Opening order, the head has the highest */
+	uint32_t ulErases;			/* Erase count of this sector */
+	uint32_t ulCrc;
+
+} StoreSector_t;
+
+
+/* Start of a record, the payload follows on the same and the next pages */
+typedef struct {
+	uint32_t ulMagic;
+	uint32_t ulSeq;				/* Data: sequence number of the record, checkpoint: the acknowledged one */
+	uint32_t ulTick;
+	uint16_t usLen;
+	uint16_t usReserved;
+	uint32_t ulCrc;				/* Over the header up to here and the payload */
+
+} StoreRecord_t;
+
+
+STATIC_ASSERT( ( sizeof( StoreRecord_t ) % sizeof( uint32_t ) ) == 0, store_record_unaligned );
+
+
+/* Chained CRC-32, as prvCrc32() of classifier.c for ulCrc = 0 */
+static uint32_t prvCrc32( uint32_t ulCrc, const uint8_t *pucData, uint32_t ulLen )
+{
+	ulCrc = ~ulCrc;
+
+	while( ulLen-- )
+	{
+		ulCrc ^= *pucData++;
+		for( uint8_t i = 0; i < 8; i++ )
+		{
+			ulCrc = ( ulCrc >> 1 ) ^ ( 0xEDB88320UL & ( 0u - ( ulCrc & 1u ) ) );
+		}
+	}
+
+	return ~ulCrc;
+}
+
+
+static void prvAccess( Store_t *pxStore, bool bBegin )
+{
+	if( pxStore->pxFlash->pxAccess != NULL )
+	{
+		pxStore->pxFlash->pxAccess( bBegin );
+	}
+}
+
+
+static uintptr_t prvAddr( Store_t *pxStore, uint8_t ucSector, uint32_t ulOffset )
+{
+	return pxStore->pxFlash->uxBase + ( uintptr_t )ucSector * pxStore->pxFlash->ulSectorSize + ulOffset;
+}
+
+
+static uint8_t prvNext( Store_t *pxStore, uint8_t ucSector )
+{
+	return ( uint8_t )( ( ucSector + 1 ) % pxStore->pxFlash->ucSectors );
+}
+
+
+/* Bytes a record takes, whole pages */
+static uint32_t prvSpan( uint32_t ulLen )
+{
+	return ( ( sizeof( StoreRecord_t ) + ulLen + STORE_PAGE_SIZE - 1 ) / STORE_PAGE_SIZE ) * STORE_PAGE_SIZE;
+}
+
+
+static bool prvErased( Store_t *pxStore, uint8_t ucSector, uint32_t ulOffset )
+{
+	const uint32_t *pulPage = ( const uint32_t * )prvAddr( pxStore, ucSector, ulOffset );
+
+	for( uint32_t i = 0; i < STORE_PAGE_SIZE / sizeof( uint32_t ); i++ )
+	{
+		if( pulPage[i] != STORE_ERASED )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/* Header of an open sector, NULL if the sector is blank or its opening was cut */
+static const StoreSector_t *prvSectorGet( Store_t *pxStore, uint8_t ucSector )
+{
+	const StoreSector_t *pxSector = ( const StoreSector_t * )prvAddr( pxStore, ucSector, 0 );
+
+	if( ( pxSector->ulMagic != STORE_SECTOR_MAGIC ) ||
+		( prvCrc32( 0, ( const uint8_t * )pxSector, offsetof( StoreSector_t, ulCrc ) ) != pxSector->ulCrc ) )
+	{
+		return NULL;
+	}
+
+	return pxSector;
+}
+
+
+/* Complete record at the offset, NULL for erased, torn or foreign pages */
+static const StoreRecord_t *prvRecordGet( Store_t *pxStore, uint8_t ucSector, uint32_t ulOffset )
+{
+	const StoreRecord_t *pxRecord = ( const StoreRecord_t * )prvAddr( pxStore, ucSector, ulOffset );
+	uint32_t ulCrc;
+
+	if( ( ( pxRecord->ulMagic != STORE_DATA_MAGIC ) && ( pxRecord->ulMagic != STORE_ACK_MAGIC ) ) ||
+		( ulOffset + prvSpan( pxRecord->usLen ) > pxStore->pxFlash->ulSectorSize ) )
+	{
+		return NULL;
+	}
+
+	ulCrc = prvCrc32( 0, ( const uint8_t * )pxRecord, offsetof( StoreRecord_t, ulCrc ) );
+	ulCrc = prvCrc32( ulCrc, ( const uint8_t * )( pxRecord + 1 ), pxRecord->usLen );
+
+	return ( ulCrc == pxRecord->ulCrc ) ? pxRecord : NULL;
+}
+
+
+/* Move the read position to the oldest unacknowledged data record, NULL once it reaches the write position */
+static const StoreRecord_t *prvSeek( Store_t *pxStore )
+{
+	const StoreRecord_t *pxRecord;
+
+	while( ( pxStore->ucRead != pxStore->ucHead ) || ( pxStore->ulRead < pxStore->ulWrite ) )
+	{
+		if( pxStore->ulRead >= pxStore->pxFlash->ulSectorSize )
+		{
+			pxStore->ucRead = prvNext( pxStore, pxStore->ucRead );
+			pxStore->ulRead = STORE_PAGE_SIZE;
+			continue;
+		}
+
+		pxRecord = prvRecordGet( pxStore, pxStore->ucRead, pxStore->ulRead );
+		if( pxRecord == NULL )
+		{
+			pxStore->ulRead += STORE_PAGE_SIZE;
+		}
+		else if( ( pxRecord->ulMagic == STORE_DATA_MAGIC ) && ( pxRecord->ulSeq > pxStore->ulAcked ) )
+		{
+			return pxRecord;
+		}
+		else
+		{
+			pxStore->ulRead += prvSpan( pxRecord->usLen );
+		}
+	}
+
+	return NULL;
+}
+
+
+/* Erase the sector after the head and make it the new head, its unsent records are lost */
+static bool prvSectorOpen( Store_t *pxStore )
+{
+	const StoreFlash_t *pxFlash = pxStore->pxFlash;
+	uint8_t ucSector = prvNext( pxStore, pxStore->ucHead );
+	const StoreSector_t *pxOld = prvSectorGet( pxStore, ucSector );
+	StoreSector_t *pxSector = ( StoreSector_t * )pxStore->pulPage;
+	const StoreRecord_t *pxRecord;
+
+	/* Only the read position can be in the oldest sector, seeking moves it on to the next one at the end */
+	while( ( pxStore->ucRead == ucSector ) && ( ( pxRecord = prvSeek( pxStore ) ) != NULL ) && ( pxStore->ucRead == ucSector ) )
+	{
+		pxStore->ulRead += prvSpan( pxRecord->usLen );
+		pxStore->ulPending--;
+		pxStore->xStat.ulDropped++;
+	}
+	if( pxStore->ucRead == ucSector )
+	{
+		pxStore->ucRead = prvNext( pxStore, ucSector );
+		pxStore->ulRead = STORE_PAGE_SIZE;
+	}
+
+	memset( pxStore->pulPage, 0, STORE_PAGE_SIZE );
+	pxSector->ulMagic = STORE_SECTOR_MAGIC;
+	pxSector->ulSeq = pxStore->ulHeadSeq + 1;
+	pxSector->ulCrc = 0;
+
+	/* Erased ahead of time by STORE_bPrepare, only the header is programmed here */
+	if( pxStore->bNextErased )
+	{
+		pxSector->ulErases = pxStore->ulNextErases;
+	}
+	else
+	{
+		pxSector->ulErases = ( pxOld != NULL ) ? ( pxOld->ulErases + 1 ) : 1;
+
+		pxStore->xStat.ulErases++;
+		if( !pxFlash->pxErase( prvAddr( pxStore, ucSector, 0 ) ) )
+		{
+			return false;
+		}
+	}
+	pxSector->ulCrc = prvCrc32( 0, ( const uint8_t * )pxSector, offsetof( StoreSector_t, ulCrc ) );
+	pxStore->bNextErased = false;
+
+	if( pxSector->ulErases > pxStore->xStat.ulWearMax )
+	{
+		pxStore->xStat.ulWearMax = pxSector->ulErases;
+	}
+
+	if( !pxFlash->pxProgram( prvAddr( pxStore, ucSector, 0 ), pxStore->pulPage ) )
+	{
+		return false;
+	}
+
+	pxStore->ucHead = ucSector;
+	pxStore->ulHeadSeq = pxSector->ulSeq;
+	pxStore->ulWrite = STORE_PAGE_SIZE;
+
+	return true;
+}
+
+
+/* Append at the write position, the header and its CRC go into the first page */
+static bool prvRecordWrite( Store_t *pxStore, uint32_t ulMagic, uint32_t ulSeq, uint32_t ulTick, const uint8_t *pucData, uint32_t ulLen )
+{
+	StoreRecord_t *pxRecord = ( StoreRecord_t * )pxStore->pulPage;
+	uint8_t *pucPage = ( uint8_t * )pxStore->pulPage;
+	uintptr_t uxAddr;
+	uint32_t ulCopied;
+	uint32_t ulChunk;
+
+	if( ( pxStore->ulWrite + prvSpan( ulLen ) > pxStore->pxFlash->ulSectorSize ) && !prvSectorOpen( pxStore ) )
+	{
+		return false;
+	}
+
+	memset( pxStore->pulPage, 0, STORE_PAGE_SIZE );
+	pxRecord->ulMagic = ulMagic;
+	pxRecord->ulSeq = ulSeq;
+	pxRecord->ulTick = ulTick;
+	pxRecord->usLen = ( uint16_t )ulLen;
+	pxRecord->ulCrc = prvCrc32( prvCrc32( 0, pucPage, offsetof( StoreRecord_t, ulCrc ) ), pucData, ulLen );
+
+	ulCopied = ( ulLen < STORE_PAGE_SIZE - sizeof( StoreRecord_t ) ) ? ulLen : ( STORE_PAGE_SIZE - sizeof( StoreRecord_t ) );
+	if( ulCopied > 0 )
+	{
+		memcpy( &pucPage[sizeof( StoreRecord_t )], pucData, ulCopied );
+	}
+
+	/* A programmed page can't be written again, the pages are used up even if programming fails */
+	uxAddr = prvAddr( pxStore, pxStore->ucHead, pxStore->ulWrite );
+	pxStore->ulWrite += prvSpan( ulLen );
+
+	while( 1 )
+	{
+		if( !pxStore->pxFlash->pxProgram( uxAddr, pxStore->pulPage ) )
+		{
+			return false;
+		}
+		if( ulCopied == ulLen )
+		{
+			return true;
+		}
+
+		uxAddr += STORE_PAGE_SIZE;
+		ulChunk = ( ulLen - ulCopied < STORE_PAGE_SIZE ) ? ( ulLen - ulCopied ) : STORE_PAGE_SIZE;
+		memset( pxStore->pulPage, 0, STORE_PAGE_SIZE );
+		memcpy( pucPage, &pucData[ulCopied], ulChunk );
+		ulCopied += ulChunk;
+	}
+}
+
+
+bool STORE_bInit( Store_t *pxStore, const StoreFlash_t *pxFlash )
+{
+	const StoreSector_t *pxSector;
+	const StoreRecord_t *pxRecord;
+	uint8_t ucOldest;
+	uint8_t ucSector;
+	uint32_t ulOffset;
+	uint32_t ulEnd = STORE_PAGE_SIZE;
+	uint32_t ulSeqMax = 0;
+	uint8_t ucRead;
+	uint32_t ulRead;
+
+	memset( pxStore, 0, sizeof( Store_t ) );
+	pxStore->pxFlash = pxFlash;
+
+	if( ( pxFlash->ucSectors < 2 ) || ( pxFlash->ulSectorSize < 2 * STORE_PAGE_SIZE ) || ( ( pxFlash->ulSectorSize % STORE_PAGE_SIZE ) != 0 ) )
+	{
+		return false;
+	}
+
+	prvAccess( pxStore, true );
+
+	/* The head is the sector opened last */
+	for( ucSector = 0; ucSector < pxFlash->ucSectors; ucSector++ )
+	{
+		pxSector = prvSectorGet( pxStore, ucSector );
+		if( pxSector == NULL )
+		{
+			continue;
+		}
+		if( pxSector->ulSeq > pxStore->ulHeadSeq )
+		{
+			pxStore->ucHead = ucSector;
+			pxStore->ulHeadSeq = pxSector->ulSeq;
+		}
+		if( pxSector->ulErases > pxStore->xStat.ulWearMax )
+		{
+			pxStore->xStat.ulWearMax = pxSector->ulErases;
+		}
+	}
+
+	if( pxStore->ulHeadSeq == 0 )
+	{
+		/* Blank store, the head is full so the first record opens sector 0 */
+		pxStore->ucHead = pxFlash->ucSectors - 1;
+		pxStore->ulWrite = pxFlash->ulSectorSize;
+		pxStore->ucRead = pxStore->ucHead;
+		pxStore->ulRead = pxStore->ulWrite;
+		pxStore->ulNextSeq = 1;
+		prvAccess( pxStore, false );
+
+		return true;
+	}
+
+	/* The older records are in the sectors opened one after the other before the head */
+	ucOldest = pxStore->ucHead;
+	for( uint8_t i = 1; i < pxFlash->ucSectors; i++ )
+	{
+		ucSector = ( uint8_t )( ( pxStore->ucHead + pxFlash->ucSectors - i ) % pxFlash->ucSectors );
+		pxSector = prvSectorGet( pxStore, ucSector );
+		if( ( pxSector == NULL ) || ( pxSector->ulSeq != pxStore->ulHeadSeq - i ) )
+		{
+			break;
+		}
+		ucOldest = ucSector;
+	}
+
+	/* Newest sequence number, last checkpoint and the end of the written pages of the head */
+	ucSector = ucOldest;
+	while( 1 )
+	{
+		ulEnd = STORE_PAGE_SIZE;
+		for( ulOffset = STORE_PAGE_SIZE; ulOffset < pxFlash->ulSectorSize; )
+		{
+			pxRecord = prvRecordGet( pxStore, ucSector, ulOffset );
+			if( pxRecord != NULL )
+			{
+				if( ( pxRecord->ulMagic == STORE_DATA_MAGIC ) && ( pxRecord->ulSeq > ulSeqMax ) )
+				{
+					ulSeqMax = pxRecord->ulSeq;
+				}
+				if( ( pxRecord->ulMagic == STORE_ACK_MAGIC ) && ( pxRecord->ulSeq > pxStore->ulAcked ) )
+				{
+					pxStore->ulAcked = pxRecord->ulSeq;
+				}
+				ulOffset += prvSpan( pxRecord->usLen );
+				ulEnd = ulOffset;
+			}
+			else
+			{
+				/* Torn record, its pages are lost */
+				if( !prvErased( pxStore, ucSector, ulOffset ) )
+				{
+					ulEnd = ulOffset + STORE_PAGE_SIZE;
+				}
+				ulOffset += STORE_PAGE_SIZE;
+			}
+		}
+
+		if( ucSector == pxStore->ucHead )
+		{
+			break;
+		}
+		ucSector = prvNext( pxStore, ucSector );
+	}
+
+	pxStore->ulWrite = ulEnd;
+	pxStore->ulNextSeq = ( ( ulSeqMax > pxStore->ulAcked ) ? ulSeqMax : pxStore->ulAcked ) + 1;
+
+	/* Unacknowledged records from the oldest one on */
+	pxStore->ucRead = ucOldest;
+	pxStore->ulRead = STORE_PAGE_SIZE;
+	( void )prvSeek( pxStore );
+	ucRead = pxStore->ucRead;
+	ulRead = pxStore->ulRead;
+	while( ( pxRecord = prvSeek( pxStore ) ) != NULL )
+	{
+		pxStore->ulRead += prvSpan( pxRecord->usLen );
+		pxStore->ulPending++;
+	}
+	pxStore->ucRead = ucRead;
+	pxStore->ulRead = ulRead;
+
+	prvAccess( pxStore, false );
+
+	return true;
+}
+
+
+bool STORE_bPut( Store_t *pxStore, const uint8_t *pucData, uint32_t ulLen, uint32_t ulTick )
+{
+	bool bRet;
+
+	if( ( ulLen > UINT16_MAX ) || ( prvSpan( ulLen ) > pxStore->pxFlash->ulSectorSize - STORE_PAGE_SIZE ) )
+	{
+		return false;
+	}
+
+	prvAccess( pxStore, true );
+
+	/* The number is used up even by a failed write, a half programmed record may still read back valid */
+	bRet = prvRecordWrite( pxStore, STORE_DATA_MAGIC, pxStore->ulNextSeq++, ulTick, pucData, ulLen );
+	if( bRet )
+	{
+		pxStore->ulPending++;
+		pxStore->xStat.ulStored++;
+	}
+
+	prvAccess( pxStore, false );
+
+	return bRet;
+}
+
+
+const uint8_t *STORE_pucPeek( Store_t *pxStore, uint32_t *pulLen, uint32_t *pulSeq, uint32_t *pulTick )
+{
+	const StoreRecord_t *pxRecord;
+
+	prvAccess( pxStore, true );
+	pxRecord = prvSeek( pxStore );
+	prvAccess( pxStore, false );
+
+	if( pxRecord == NULL )
+	{
+		return NULL;
+	}
+
+	*pulLen = pxRecord->usLen;
+	*pulSeq = pxRecord->ulSeq;
+	*pulTick = pxRecord->ulTick;
+
+	return ( const uint8_t * )( pxRecord + 1 );
+}
+
+
+void STORE_vAck( Store_t *pxStore, uint32_t ulSeq )
+{
+	const StoreRecord_t *pxRecord;
+
+	prvAccess( pxStore, true );
+
+	/* A record dropped in the meantime is not acknowledged */
+	pxRecord = prvSeek( pxStore );
+	if( ( pxRecord != NULL ) && ( pxRecord->ulSeq == ulSeq ) )
+	{
+		pxStore->ulRead += prvSpan( pxRecord->usLen );
+		pxStore->ulAcked = ulSeq;
+		pxStore->ulPending--;
+		pxStore->xStat.ulSent++;
+
+		/* Checkpoint also when the store runs empty, so a restart doesn't send the tail again */
+		if( ( ++pxStore->ucAcks >= STORE_ACK_INTERVAL ) || ( pxStore->ulPending == 0 ) )
+		{
+			pxStore->ucAcks = 0;
+			( void )prvRecordWrite( pxStore, STORE_ACK_MAGIC, ulSeq, 0, NULL, 0 );
+		}
+	}
+
+	prvAccess( pxStore, false );
+}
+
+
+bool STORE_bPrepare( Store_t *pxStore )
+{
+	uint8_t ucSector = prvNext( pxStore, pxStore->ucHead );
+	const StoreSector_t *pxOld;
+	uint32_t ulOffset;
+
+	if( pxStore->bNextErased )
+	{
+		return true;
+	}
+
+	prvAccess( pxStore, true );
+
+	/* The read position stops in the sector at its oldest unsent record */
+	( void )prvSeek( pxStore );
+	if( pxStore->ucRead == ucSector )
+	{
+		prvAccess( pxStore, false );
+		return false;
+	}
+
+	/* Erased before a restart, the header with its erase count went with it, the wear of the ring stands in */
+	pxOld = prvSectorGet( pxStore, ucSector );
+	for( ulOffset = 0; ( pxOld == NULL ) && ( ulOffset < pxStore->pxFlash->ulSectorSize ); ulOffset += STORE_PAGE_SIZE )
+	{
+		if( !prvErased( pxStore, ucSector, ulOffset ) )
+		{
+			break;
+		}
+	}
+	if( ( pxOld == NULL ) && ( ulOffset >= pxStore->pxFlash->ulSectorSize ) )
+	{
+		pxStore->ulNextErases = ( pxStore->xStat.ulWearMax > 0 ) ? pxStore->xStat.ulWearMax : 1;
+	}
+	else
+	{
+		pxStore->ulNextErases = ( pxOld != NULL ) ? ( pxOld->ulErases + 1 ) : 1;
+		pxStore->xStat.ulErases++;
+		if( !pxStore->pxFlash->pxErase( prvAddr( pxStore, ucSector, 0 ) ) )
+		{
+			prvAccess( pxStore, false );
+			return false;
+		}
+	}
+
+	prvAccess( pxStore, false );
+	pxStore->bNextErased = true;
+
+	return true;
+}
+
+
+uint32_t STORE_ulPending( Store_t *pxStore )
+{
+	return pxStore->ulPending;
+}
+
+
+void STORE_vStatGet( Store_t *pxStore, StoreStat_t *pxStat )
+{
+	*pxStat = pxStore->xStat;
+}
@@ -0,0 +1,116 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#ifndef STORE_H
+#define STORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/* Programming unit of the XMC4 PFLASH, records start on a page */
+#define STORE_PAGE_SIZE				( 256 )
+
+/* Erased XMC4 PFLASH reads back as zeros */
+#define STORE_ERASED				( 0x00000000UL )
+
+/* Acknowledges between two checkpoints, after a reset at most that many records are sent twice */
+#define STORE_ACK_INTERVAL			( 16 )
+
+/* Sectors 12..15 of the XMC4700, 1 MB kept out of the application region by the linker script */
+#define STORE_XMC4_BASE				( 0x0C100000UL )
+#define STORE_XMC4_SECTOR_SIZE		( 0x00040000UL )
+#define STORE_XMC4_SECTORS			( 4 )
+
+
+/* Flash the store lives in, read through the memory map at uxBase */
+typedef struct {
+	uintptr_t uxBase;						/* Address of the first sector */
+	uint32_t ulSectorSize;					/* Multiple of STORE_PAGE_SIZE */
+	uint8_t ucSectors;						/* At least 2 */
+	bool ( *pxErase )( uintptr_t uxAddr );
+	bool ( *pxProgram )( uintptr_t uxAddr, const uint32_t *pulPage );	/* One STORE_PAGE_SIZE page */
+	void ( *pxAccess )( bool bBegin );		/* Around the reads of possibly torn pages, may be NULL */
+
+} StoreFlash_t;
+
+
+typedef struct {
+	uint32_t ulStored;			/* Records written since the start */
+	uint32_t ulSent;			/* Records acknowledged */
+	uint32_t ulDropped;			/* Unsent records erased to make room for newer ones */
+	uint32_t ulErases;			/* Sector erases since the start */
+	uint32_t ulWearMax;			/* Highest erase count of a sector, over the life of the flash */
+
+} StoreStat_t;
+
+
+/*
+ * Append-only log in a ring of flash sectors. Every record has a gap-free
+ * sequence number and a CRC, a record torn by a reset is skipped on the next
+ * start. When the ring is full the oldest sector is erased, so the sectors
+ * wear evenly and the newest data is kept. Acknowledged positions are
+ * checkpointed into the log itself, nothing is ever rewritten in place.
+ * Not thread safe, one task owns the store.
+ */
+typedef struct {
+	const StoreFlash_t *pxFlash;
+	uint8_t ucHead;				/* Sector being written */
+	uint32_t ulHeadSeq;			/* Sector sequence of the head, 0 while no sector is open */
+	uint32_t ulWrite;			/* Offset of the next free page in the head sector */
+	uint8_t ucRead;				/* Sector of the oldest unacknowledged record */
+	uint32_t ulRead;			/* Offset of the oldest unacknowledged record */
+	uint32_t ulNextSeq;
+	uint32_t ulAcked;			/* Newest acknowledged sequence number */
+	uint32_t ulPending;
+	uint8_t ucAcks;				/* Acknowledges since the last checkpoint */
+	bool bNextErased;			/* The sector after the head is erased ahead of time */
+	uint32_t ulNextErases;		/* Erase count it gets when it is opened */
+	uint32_t pulPage[STORE_PAGE_SIZE / sizeof( uint32_t )];
+	StoreStat_t xStat;
+
+} Store_t;
+
+
+/** scans the flash for the records left by the last run, false on a bad geometry */
+bool STORE_bInit( Store_t *pxStore, const StoreFlash_t *pxFlash );
+
+/** appends a record, false if it can't be written */
+bool STORE_bPut( Store_t *pxStore, const uint8_t *pucData, uint32_t ulLen, uint32_t ulTick );
+
+/** oldest unacknowledged record in place in the flash, NULL if there is none; valid until the next STORE_bPut */
+const uint8_t *STORE_pucPeek( Store_t *pxStore, uint32_t *pulLen, uint32_t *pulSeq, uint32_t *pulTick );
+/** the record from the last peek is delivered */
+void STORE_vAck( Store_t *pxStore, uint32_t ulSeq );
+
+/** erases the sector after the head ahead of time if it holds no unsent record, true once it is erased;
+ *  the erase stalls the flash, call it where the stall does the least harm */
+bool STORE_bPrepare( Store_t *pxStore );
+
+uint32_t STORE_ulPending( Store_t *pxStore );
+void STORE_vStatGet( Store_t *pxStore, StoreStat_t *pxStat );
+
+/** the reserved sectors of the XMC4700 */
+extern const StoreFlash_t STORE_xXmc4Flash;
+
+
+#endif /* STORE_H */
@@ -0,0 +1,74 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#include "store.h"
+
+#include "xmc_flash.h"
+
+
+/*
+ * Same sequences as e_eeprom_xmc4.c, addresses in the uncached map.
+ * The code runs from the same PFLASH, every fetch waits while the flash is busy,
+ * interrupt handlers included: a 256 KB sector erase stops the CPU for up to
+ * t_ERP = 5.5 s of the data sheet, a page program for up to 5.5 ms. The store
+ * erases once per sector of payloads, STORE_bPrepare takes it out of the outage.
+ */
+static bool prvXmc4Erase( uintptr_t uxAddr )
+{
+	XMC_FLASH_ClearStatus();
+	XMC_FLASH_EraseSector( ( uint32_t * )uxAddr );
+
+	return ( XMC_FLASH_GetStatus() == ( uint32_t )XMC_FLASH_STATUS_ERASE_STATE );
+}
+
+
+static bool prvXmc4Program( uintptr_t uxAddr, const uint32_t *pulPage )
+{
+	XMC_FLASH_ClearStatus();
+	XMC_FLASH_ProgramPage( ( uint32_t * )uxAddr, pulPage );
+
+	return ( ( XMC_FLASH_GetStatus() & ( uint32_t )XMC_FLASH_STATUS_VERIFY_ERROR ) == 0 );
+}
+
+
+/* A page torn by a reset may hold uncorrectable ECC errors, reading it must not trap */
+static void prvXmc4Access( bool bBegin )
+{
+	if( bBegin )
+	{
+		XMC_FLASH_DisableDoubleBitErrorTrap();
+	}
+	else
+	{
+		XMC_FLASH_EnableDoubleBitErrorTrap();
+	}
+}
+
+
+const StoreFlash_t STORE_xXmc4Flash = {
+	.uxBase = STORE_XMC4_BASE,
+	.ulSectorSize = STORE_XMC4_SECTOR_SIZE,
+	.ucSectors = STORE_XMC4_SECTORS,
+	.pxErase = prvXmc4Erase,
+	.pxProgram = prvXmc4Program,
+	.pxAccess = prvXmc4Access
+};
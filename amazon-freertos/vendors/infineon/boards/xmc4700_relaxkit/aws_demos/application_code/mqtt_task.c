@@ -30,18 +30,28 @@
 #include "iot_wifi.h"
 #include "iot_mqtt_agent.h" 
 #include "types/iot_mqtt_types.h"
+#include "iot_mqtt.h"
+#include "iot_tls.h"
 
 #include "iot_demo_logging.h"
 #include "iot_network_manager_private.h"
 #include "platform/iot_threads.h"
 #include "iot_init.h"
+#if( mqtttaskSHADOW_ENABLE > 0 )
+#include "aws_iot_shadow.h"
+#endif
 
 #include "app_types.h"
 #include "json/json_sensor.h"
 #include "converting.h"
+#include "report.h"
+#if( mqtttaskCOMPRESSION_ENABLE > 0 )
+#include "compress.h"
+#endif
 #include "base64.h"
 #include "float_to_string.h"
 #include "led.h"
+#include "dbg.h"
 
 #include "i2c_mux.h"
 #include "DAVE.h"
@@ -62,9 +72,76 @@
 
 /** Buffer in which messages to the brocker will be generated */
 static uint8_t pcMQTTBuffer[ mqtttaskSEND_BUFFER_SIZE ];
+#if( mqtttaskCOMPRESSION_ENABLE > 0 )
+/* Compressed frame of pcMQTTBuffer */
+static uint8_t pcMQTTPacked[ COMP_BOUND( mqtttaskSEND_BUFFER_SIZE ) ];
+#endif
 
-/* Package for MQTT */
-static InfineonSensorsMessage_t xSensorsMessage;
+/* Packages for MQTT, written in place by the sensors task */
+static InfineonSensorsMessage_t xSensorsMessages[ mqtttaskMESSAGE_POOL_SIZE ];
+static MsgPool_t xMessagePool;
+#if MQTT_BATCH_ENABLE
+/* Windows waiting in pcMQTTBuffer */
+static BatchContext_t xBatch;
+/* Stages of the oldest window in the batch */
+static LatencyTrace_t xBatchTrace;
+/* Alarm windows are encoded next to the open batch */
+static uint8_t pcMQTTAlarmBuffer[ mqtttaskSEND_BUFFER_SIZE ];
+#else
+#define pcMQTTAlarmBuffer                               pcMQTTBuffer
+#endif
+#if( mqtttaskCAPTURE_ENABLE > 0 )
+/* Capture chunks are built in pcMQTTAlarmBuffer */
+STATIC_ASSERT( mqtttaskCAPTURE_CHUNK_SIZE <= mqtttaskSEND_BUFFER_SIZE, capture_chunk_exceeds_send_buffer );
+#endif
+#if( mqtttaskINFLIGHT_MAX > 0 )
+#if( mqtttaskCOMPRESSION_ENABLE > 0 )
+#define mqtttaskPAYLOAD_MAX                             COMP_BOUND( mqtttaskSEND_BUFFER_SIZE )
+#else
+#define mqtttaskPAYLOAD_MAX                             mqtttaskSEND_BUFFER_SIZE
+#endif
+/* Copies of the publishes waiting for their acknowledge */
+static uint8_t pcMQTTInFlight[ mqtttaskINFLIGHT_MAX ][ mqtttaskPAYLOAD_MAX ];
+static Pipe_t xPipe;
+static bool bPipeReady = false;
+/* Stages of the payload in each slot and the token of its last publish */
+static LatencyTrace_t xPipeTraces[ mqtttaskINFLIGHT_MAX ];
+static uint32_t ulPipeTokens[ mqtttaskINFLIGHT_MAX ];
+/* Trace of the payload PIPE_bSend is about to publish */
+static LatencyTrace_t *pxPipeTrace = NULL;
+/* Outcomes from the task pool of the MQTT library, the connection state is counted in the MQTT task */
+static bool bPipeAcked = false;
+static uint8_t ucPipeNacks = 0;
+#endif
+#if( mqtttaskADAPT_ENABLE > 0 )
+/* Levels of the link and what goes out at them, the signal is the RSSI of Wi-Fi or the RSRP of NB-IoT */
+static const AdaptConfig_t xAdaptConfig = {
+#if NBIOT_ENABLED
+	.sSignalFair = -105,
+	.sSignalPoor = -115,
+#else
+	.sSignalFair = -67,
+	.sSignalPoor = -80,
+#endif
+	.ulLatencyFair = 1000,
+	.ulLatencyPoor = mqtttaskMQTT_TIMEOUT * portTICK_PERIOD_MS,
+	.ulBacklogFair = 3,
+	.ulBacklogPoor = 8,
+	.ucHold = 5,
+	.xPolicy = {
+		[ADAPT_LINK_GOOD] = { 1, ( mqtttaskBATCH_WINDOWS + 3 ) / 4, MSG_DETAIL_FULL },
+		[ADAPT_LINK_FAIR] = { 1, ( mqtttaskBATCH_WINDOWS + 1 ) / 2, MSG_DETAIL_FEATURES },
+		[ADAPT_LINK_POOR] = { 4, mqtttaskBATCH_WINDOWS, MSG_DETAIL_STATS },
+	},
+};
+#endif
+#if( mqtttaskSTORE_ENABLE > 0 )
+/* Payloads of the outages, kept over a reset */
+static Store_t xStore;
+static bool bStoreReady = false;
+/* Records from this sequence number on were stored in this run, their ticks give the age */
+static uint32_t ulStoreRunSeq = 0;
+#endif
 
 static IotNetworkManagerSubscription_t subscription = IOT_NETWORK_MANAGER_SUBSCRIPTION_INITIALIZER;
 
@@ -76,8 +153,8 @@ static uint32_t ulConnectedNetwork = AWSIOT_NETWORK_TYPE_NONE;
  */
 static MQTTAgentHandle_t xMQTTHandle = NULL;
 
-/** Handle for the sensors queue */
-QueueHandle_t xMQTTMessageQueueHandle = NULL;
+/** Pool of the sensors messages */
+MsgPool_t *pxMQTTMessagePool = NULL;
 
 /** Handle for the task */
 TaskHandle_t xMQTTTaskHandle = NULL;
@@ -92,6 +169,30 @@ static IotMutex_t xNetworkMutex;
 static uint8_t ucPingErrorCount = 0;
 static uint8_t ucPublishErrorCount = 0;
 
+static eReconnectTier_t eReconnectTier = eReconnectResume;
+static uint8_t ucTierAttempts = 0;
+static const uint8_t ucTierAttemptsMax[] = { mqtttaskRECONNECT_RESUME_ATTEMPTS, mqtttaskRECONNECT_SOCKET_ATTEMPTS, mqtttaskRECONNECT_RADIO_ATTEMPTS };
+/** First reconnect attempt of the outage, for the length of the gap */
+static TickType_t xOutageStart = 0;
+
+/** Last acknowledge, PINGRESP or answered probe */
+static volatile TickType_t xLastAlive = 0;
+/** Connections reestablished since the start */
+static uint32_t ulReconnects = 0;
+#if( mqtttaskSHADOW_ENABLE > 0 )
+/** Delta callback set on the current connection */
+static bool bShadowSubscribed = false;
+/** Shadow document fetched on the current connection */
+static bool bShadowFetched = false;
+/** Tick of the last failed subscription or get, and the wait before the next try */
+static TickType_t xShadowFailed = 0;
+static TickType_t xShadowBackoff = 0;
+#endif
+#if( mqtttaskCAPTURE_ENABLE > 0 )
+/** Capture requests subscribed on the current connection */
+static bool bCaptureSubscribed = false;
+#endif
+
 
 static void prvMqttTask( void *pvParameters );
 
@@ -99,7 +200,50 @@ static BaseType_t prvCreateRobustTask ( void );
 static void prvDeleteRobustTask( void );
 static BaseType_t prvNetworkConnectionRestart( void );
 static BaseType_t prvMqttAgentRestart( void );
+static BaseType_t prvReconnect( void );
+static bool prvLinkUp( void );
 static ePingStatus_t prvPing( uint8_t *pucIPAddr, uint16_t usCount, uint32_t ulIntervalMS );
+static bool prvSend( MQTTAgentPublishParams_t *pxParams, LatencyTrace_t *pxTrace );
+#if( mqtttaskINFLIGHT_MAX > 0 )
+static bool prvPipeSend( MQTTAgentPublishParams_t *pxParams, LatencyTrace_t *pxTrace );
+static bool prvPipePublish( void *pvContext, const PipeSlot_t *pxSlot, uint32_t ulToken );
+static void prvPipeCallback( void *pvContext, IotMqttCallbackParam_t *pxParam );
+static void prvPipeRetry( void );
+
+static const PipeTransport_t xPipeTransport = { prvPipePublish, &xPipe };
+#endif
+#if( ( mqtttaskINFLIGHT_MAX > 0 ) || ( mqtttaskSHADOW_ENABLE > 0 ) )
+/* Connection of the agent for the asynchronous API, as in aws_shadow.c */
+extern IotMqttConnection_t MQTT_AGENT_Getv2Connection( MQTTAgentHandle_t xMQTTHandle );
+#endif
+static void prvPublish( MQTTAgentPublishParams_t *pxParams, const uint8_t *pucBuf, uint32_t ulLen, LatencyTrace_t *pxTrace );
+static void prvWindowProcess( MQTTAgentPublishParams_t *pxParams, InfineonSensorsMessage_t *pxSensorsMessage, MsgPoolLane_t xLane );
+#if( mqtttaskSTORE_ENABLE > 0 )
+static void prvStoreDrain( MQTTAgentPublishParams_t *pxParams );
+#endif
+#if MQTT_BATCH_ENABLE
+static void prvBatchAdd( MQTTAgentPublishParams_t *pxParams, InfineonSensorsMessage_t *pxSensorsMessage );
+#endif
+#if( mqtttaskLATENCY_REPORT_PERIOD > 0 )
+static void prvLatencyReport( MQTTAgentPublishParams_t *pxParams );
+#endif
+#if( mqtttaskMETRICS_PERIOD > 0 )
+static void prvMetricsReport( void );
+#endif
+
+#if( mqtttaskADAPT_ENABLE > 0 )
+static void prvAdaptUpdate( void );
+#endif
+#if( mqtttaskSHADOW_ENABLE > 0 )
+static void prvShadowDelta( void *pvContext, AwsIotShadowCallbackParam_t *pxParam );
+static void prvShadowFailed( const char *pcWhat );
+static void prvShadowSync( void );
+#endif
+#if( mqtttaskCAPTURE_ENABLE > 0 )
+static MQTTBool_t prvCaptureCommand( void *pvContext, const MQTTPublishData_t * const pxPublishData );
+static void prvCaptureSubscribe( void );
+static void prvCaptureSend( MQTTAgentPublishParams_t *pxParams );
+#endif
 
 /** @brief Start the MQTT agent and connects to the broker */
 static BaseType_t prvMqttAgentStartAndConnect( void );
@@ -127,11 +271,11 @@ void vMqttTaskDelete( void )
         MQTT_AGENT_Disconnect( xMQTTHandle, mqtttaskMQTT_TIMEOUT );
         MQTT_AGENT_Delete( xMQTTHandle );
         xMQTTHandle = NULL;
-        /** Delete the queue. We need to do that atomically since the sensor task could try to send to the invalidated queue */
+        /** Unpublish the pool atomically so the sensor task stops posting to it, then delete it outside the critical section */
         taskENTER_CRITICAL();
-        vQueueDelete( xMQTTMessageQueueHandle );
-        xMQTTMessageQueueHandle = NULL;
+        pxMQTTMessagePool = NULL;
         taskEXIT_CRITICAL();
+        MSG_POOL_vDelete( &xMessagePool );
     }
     /* Delete the task */
     if( xMQTTTaskHandle != NULL )
@@ -142,201 +286,1099 @@ void vMqttTaskDelete( void )
 }
 
 
-void prvMqttTask( void *pvParameters )
+void prvMqttTask( void *pvParameters )
+{
+    ( void )pvParameters;
+
+    if( I2C_MUX_cWait( I2C_MUX_TIMEOUT ) < 0 )
+    {
+    	vFullReset( APP_ERROR_I2C_MUX_NOT_RELEASED );
+    }
+
+    LED_xStatus( MQTT, START );
+    /* Create an MQTT agent and connect to the broker */
+    BaseType_t xStatus = prvMqttAgentStartAndConnect();
+    if( xStatus == pdPASS )
+    {
+    	LED_xStatus( MQTT, SUCCESS );
+    }
+    else
+    {
+    	LED_xStatus( MQTT, FAILED );
+    	vFullReset( MQTT_AGENT_INIT_ERROR );
+    }
+
+    MQTTAgentPublishParams_t xMQTTAgentPublishParams;
+
+#ifdef PATCH
+	char ucTopicString[ mqttTOPIC_BUFFER_LENGTH ] = { 0 };
+
+	strcat( ucTopicString, pcTopic );
+	strcat( ucTopicString, pcThingName );
+
+    xMQTTAgentPublishParams.pucTopic = (uint8_t*)ucTopicString;
+    xMQTTAgentPublishParams.usTopicLength = strlen( ucTopicString );
+
+    configPRINTF( ("MQTT Thing Name: %s.\r\n", pcThingName) );
+
+#else
+    xMQTTAgentPublishParams.pucTopic = (uint8_t*)pcTopic;
+    xMQTTAgentPublishParams.usTopicLength = strlen( pcTopic );
+#endif
+
+    configPRINTF( ("MQTT Topic: %s.\r\n", xMQTTAgentPublishParams.pucTopic) );
+
+    xMQTTAgentPublishParams.xQoS = eMQTTQoS1;
+
+    /* The high lane, alarm windows on their own topic */
+    static char cAlarmTopic[ 200 ];
+    MQTTAgentPublishParams_t xAlarmParams = xMQTTAgentPublishParams;
+    snprintf( cAlarmTopic, sizeof( cAlarmTopic ), "%.*s/alarm", xMQTTAgentPublishParams.usTopicLength, ( const char * )xMQTTAgentPublishParams.pucTopic );
+    xAlarmParams.pucTopic = ( const uint8_t * )cAlarmTopic;
+    xAlarmParams.usTopicLength = strlen( cAlarmTopic );
+    xAlarmParams.xQoS = mqtttaskALARM_QOS;
+#if( mqtttaskBULK_PERIOD > 0 )
+    TickType_t xBulkLast = xTaskGetTickCount() - pdMS_TO_TICKS( mqtttaskBULK_PERIOD );
+#endif
+#if( mqtttaskLATENCY_REPORT_PERIOD > 0 )
+    /* Diagnostics, the latency histograms with QoS 0 */
+    static char cDiagTopic[ 200 ];
+    MQTTAgentPublishParams_t xDiagParams = xMQTTAgentPublishParams;
+    snprintf( cDiagTopic, sizeof( cDiagTopic ), "%.*s/diag", xMQTTAgentPublishParams.usTopicLength, ( const char * )xMQTTAgentPublishParams.pucTopic );
+    xDiagParams.pucTopic = ( const uint8_t * )cDiagTopic;
+    xDiagParams.usTopicLength = strlen( cDiagTopic );
+    xDiagParams.xQoS = eMQTTQoS0;
+    TickType_t xLatencyLast = xTaskGetTickCount();
+#endif
+#if( mqtttaskMETRICS_PERIOD > 0 )
+    /* The first report after one period, the CPU shares are of the period */
+    TickType_t xMetricsLast = xTaskGetTickCount();
+#endif
+
+    if( xStatus == pdPASS )
+    {
+        /** Initialize the Sensors Data Pool */
+        if( MSG_POOL_bInit( &xMessagePool, xSensorsMessages, mqtttaskMESSAGE_POOL_SIZE, mqtttaskMESSAGE_DROP_POLICY ) )
+        {
+            pxMQTTMessagePool = &xMessagePool;
+        }
+        else
+        {
+            xStatus = pdFAIL;
+        }
+    }
+
+#if( mqtttaskSTORE_ENABLE > 0 )
+    if( xStatus == pdPASS )
+    {
+    	/* Payloads left by the last run are sent first, without the store the windows of an outage are lost */
+    	bStoreReady = STORE_bInit( &xStore, &STORE_xXmc4Flash );
+    	ulStoreRunSeq = xStore.ulNextSeq;
+    	configPRINTF( ("Store %s, %u payloads pending\r\n", bStoreReady ? "ready" : "failed", STORE_ulPending( &xStore )) );
+    }
+#endif
+
+#if( mqtttaskINFLIGHT_MAX > 0 )
+    if( xStatus == pdPASS )
+    {
+    	/* Without the window every publish waits for its acknowledge */
+    	bPipeReady = PIPE_bInit( &xPipe, &xPipeTransport, &pcMQTTInFlight[0][0], mqtttaskPAYLOAD_MAX, mqtttaskINFLIGHT_MAX );
+    	configPRINTF( ("In-flight window of %u %s\r\n", mqtttaskINFLIGHT_MAX, bPipeReady ? "ready" : "failed") );
+    }
+#endif
+
+    if( xStatus == pdPASS )
+    {
+		/** Create non-recursive mutex */
+		if( IotMutex_Create( &xNetworkMutex, false ) != true )
+		{
+			IotLogError( "Failed to create semaphore to wait for a network connection." );
+			xStatus = pdFAIL;
+		}
+    }
+
+#if( mqtttaskADAPT_ENABLE > 0 )
+    ADAPT_vInit( &xAdaptConfig );
+#endif
+    LATENCY_vInit();
+#if( mqtttaskMETRICS_PERIOD > 0 )
+    METRICS_vInit();
+#endif
+#if( mqtttaskSHADOW_ENABLE > 0 )
+    if( AwsIotShadow_Init( 0 ) != AWS_IOT_SHADOW_SUCCESS )
+    {
+    	configPRINTF( ("Shadow library init failed, the settings stay as they are\r\n") );
+    }
+#endif
+#if( mqtttaskCAPTURE_ENABLE > 0 )
+    CAPTURE_vInit();
+#endif
+
+    if( xStatus == pdPASS )
+    {
+    	eConnStatus = eConnEstablished;
+    	xStatus = prvCreateRobustTask();
+    }
+
+    if( xStatus == pdPASS )
+    {
+    	vSensorsTaskStart();
+
+        for( ;; )
+        {
+
+        	if( eConnStatus == eConnEstablished )
+        	{
+				/** Receive the sensors data from the data gathering task, alarms first, the stored payloads go out in the pauses */
+				InfineonSensorsMessage_t *pxSensorsMessage = NULL;
+				MsgPoolLane_t xLane = MSG_POOL_LANE_BULK;
+				MsgPoolLane_t xLowest = MSG_POOL_LANE_BULK;
+				TickType_t xTimeout = portMAX_DELAY;
+#if( mqtttaskBULK_PERIOD > 0 )
+				/* Only alarms until the bulk lane is due */
+				TickType_t xBulkWait = xTaskGetTickCount() - xBulkLast;
+				if( xBulkWait < pdMS_TO_TICKS( mqtttaskBULK_PERIOD ) )
+				{
+					xLowest = MSG_POOL_LANE_HIGH;
+					xTimeout = pdMS_TO_TICKS( mqtttaskBULK_PERIOD ) - xBulkWait;
+				}
+#endif
+#if( mqtttaskSHADOW_ENABLE > 0 )
+				prvShadowSync();
+				if( xTimeout > mqtttaskSHADOW_POLL_PERIOD )
+				{
+					xTimeout = mqtttaskSHADOW_POLL_PERIOD;
+				}
+#endif
+#if( mqtttaskCAPTURE_ENABLE > 0 )
+				prvCaptureSubscribe();
+				if( CAPTURE_bBusy() && ( xTimeout > mqtttaskCAPTURE_PERIOD ) )
+				{
+					xTimeout = mqtttaskCAPTURE_PERIOD;
+				}
+#endif
+#if( mqtttaskINFLIGHT_MAX > 0 )
+				/* Not acknowledged on this connection, another try on every pass */
+				prvPipeRetry();
+				if( bPipeReady && ( PIPE_ucPending( &xPipe ) > 0 ) && ( xTimeout > mqtttaskMQTT_TIMEOUT ) )
+				{
+					xTimeout = mqtttaskMQTT_TIMEOUT;
+				}
+#endif
+#if( mqtttaskSTORE_ENABLE > 0 )
+				if( ( STORE_ulPending( &xStore ) > 0 ) && ( xTimeout > mqtttaskSTORE_DRAIN_PERIOD ) )
+				{
+					xTimeout = mqtttaskSTORE_DRAIN_PERIOD;
+				}
+#endif
+				if( MSG_POOL_bReceive( &xMessagePool, &pxSensorsMessage, xLowest, &xLane, xTimeout ) )
+				{
+					LATENCY_vStamp( &pxSensorsMessage->xTrace, LATENCY_QUEUE_OUT );
+					configPRINTF( ("Queue Receive\r\n") );
+
+					MsgPoolStat_t xPoolStat;
+					MSG_POOL_vStatGet( &xMessagePool, &xPoolStat );
+					if( xPoolStat.ulDroppedOldest || xPoolStat.ulDroppedNewest )
+					{
+						configPRINTF( ("Windows posted %u, dropped oldest %u, dropped newest %u\r\n",
+								xPoolStat.ulPosted, xPoolStat.ulDroppedOldest, xPoolStat.ulDroppedNewest) );
+					}
+
+#if( mqtttaskBULK_PERIOD > 0 )
+					if( xLane == MSG_POOL_LANE_BULK )
+					{
+						xBulkLast = xTaskGetTickCount();
+					}
+#endif
+#if( mqtttaskADAPT_ENABLE > 0 )
+					prvAdaptUpdate();
+#endif
+					prvWindowProcess( ( xLane == MSG_POOL_LANE_HIGH ) ? &xAlarmParams : &xMQTTAgentPublishParams, pxSensorsMessage, xLane );
+
+					} /* if( xQueueReceive() ) */
+					else if( xTimeout == portMAX_DELAY )
+					{
+						configPRINTF( ("Stop MQTT task \r\n") );
+						break;
+					}
+					else
+					{
+#if( mqtttaskSTORE_ENABLE > 0 )
+						prvStoreDrain( &xMQTTAgentPublishParams );
+						/* The erase of the next sector stalls the CPU, here it doesn't hold up the windows of an outage */
+						if( bStoreReady && ( STORE_ulPending( &xStore ) == 0 ) && ( MSG_POOL_ucQueued( &xMessagePool ) == 0 ) )
+						{
+							( void )STORE_bPrepare( &xStore );
+						}
+#endif
+#if( mqtttaskCAPTURE_ENABLE > 0 )
+						/* The bulk transfer takes what the telemetry leaves */
+						prvCaptureSend( &xMQTTAgentPublishParams );
+#endif
+					}
+#if( mqtttaskLATENCY_REPORT_PERIOD > 0 )
+					if( ( xTaskGetTickCount() - xLatencyLast ) >= pdMS_TO_TICKS( mqtttaskLATENCY_REPORT_PERIOD ) )
+					{
+						xLatencyLast = xTaskGetTickCount();
+						prvLatencyReport( &xDiagParams );
+					}
+#endif
+#if( mqtttaskMETRICS_PERIOD > 0 )
+					if( ( xTaskGetTickCount() - xMetricsLast ) >= pdMS_TO_TICKS( mqtttaskMETRICS_PERIOD ) )
+					{
+						xMetricsLast = xTaskGetTickCount();
+						prvMetricsReport();
+					}
+#endif
+
+        	} /* if( eConnStatus == eConnEstablished ) */
+        	else
+        	{
+#if( mqtttaskSTORE_ENABLE > 0 )
+        		/* Windows of the outage go to the store instead of waiting in the pool */
+        		InfineonSensorsMessage_t *pxSensorsMessage = NULL;
+        		MsgPoolLane_t xLane;
+        		while( MSG_POOL_bReceive( &xMessagePool, &pxSensorsMessage, MSG_POOL_LANE_BULK, &xLane, 0 ) )
+        		{
+        			prvWindowProcess( ( xLane == MSG_POOL_LANE_HIGH ) ? &xAlarmParams : &xMQTTAgentPublishParams, pxSensorsMessage, xLane );
+        		}
+#endif
+
+        		/* We should not try to Ping during reconnection, thats why Mutex used */
+        		IotMutex_Lock( &xNetworkMutex );
+
+        		if( prvReconnect() == pdPASS )
+        		{
+        			xIotMqttState = IOT_MQTT_SUCCESS;
+        			eConnStatus = eConnEstablished;
+#if( mqtttaskSHADOW_ENABLE > 0 )
+        			/* The subscriptions went with the old connection */
+        			bShadowSubscribed = false;
+        			bShadowFetched = false;
+        			xShadowBackoff = 0;
+#endif
+#if( mqtttaskCAPTURE_ENABLE > 0 )
+        			bCaptureSubscribed = false;
+#endif
+        		}
+
+        		vTaskDelay( pdMS_TO_TICKS(RECONNECT_DELAY) );
+
+        		IotMutex_Unlock( &xNetworkMutex );
+
+#if( mqtttaskINFLIGHT_MAX > 0 )
+        		/* Unacknowledged publishes of the old connection go first, in their order */
+        		if( bPipeReady && ( eConnStatus == eConnEstablished ) && ( PIPE_ucUsed( &xPipe ) > 0 ) )
+        		{
+        			uint8_t ucResent = PIPE_ucResend( &xPipe );
+        			PipeStat_t xPipeStat;
+        			PIPE_vStatGet( &xPipe, &xPipeStat );
+        			configPRINTF( ("Resent %u payloads, sent %u, acked %u, failed %u, rtt max %u\r\n",
+        					ucResent, xPipeStat.ulSent, xPipeStat.ulAcked, xPipeStat.ulFailed, xPipeStat.xRttMax) );
+        		}
+#endif
+
+        	}
+        }
+
+        prvDeleteRobustTask();
+        IotMutex_Destroy( &xNetworkMutex );
+    }
+
+    /** Something went wrong, delete the task */
+    vTaskDelete( NULL );
+}
+
+/* Window from the pool into the send buffer, the buffer goes back to the pool */
+static void prvWindowProcess( MQTTAgentPublishParams_t *pxParams, InfineonSensorsMessage_t *pxSensorsMessage, MsgPoolLane_t xLane )
+{
+	AdaptPolicy_t xPolicy;
+
+	ADAPT_vPolicyGet( &xPolicy );
+#if( mqtttaskSHADOW_ENABLE > 0 )
+	/* The shadow may leave the spectra out of the routine windows on any link */
+	Settings_t xSettings;
+	SETTINGS_vGet( &xSettings );
+	if( !xSettings.bSpectra && ( xPolicy.xDetail < MSG_DETAIL_FEATURES ) )
+	{
+		xPolicy.xDetail = MSG_DETAIL_FEATURES;
+	}
+#endif
+
+#if MQTT_BATCH_ENABLE
+	if( xLane == MSG_POOL_LANE_BULK )
+	{
+		pxSensorsMessage->xDetail = xPolicy.xDetail;
+		/** Collect the window, the batch is published when it is complete */
+		prvBatchAdd( pxParams, pxSensorsMessage );
+		return;
+	}
+#endif
+	/** Fill the buffer to send, an alarm doesn't wait for the batch */
+	pxSensorsMessage->xDetail = ( xLane == MSG_POOL_LANE_HIGH ) ? MSG_DETAIL_FULL : xPolicy.xDetail;
+	uint8_t *pucBuf = ( xLane == MSG_POOL_LANE_HIGH ) ? pcMQTTAlarmBuffer : pcMQTTBuffer;
+#if MQTT_OUTPUT_FORMAT_CBOR
+	uint32_t ulLen = 0;
+	bool bRet = CBOR_bGenerateToSend( pxSensorsMessage, pucBuf, mqtttaskSEND_BUFFER_SIZE, &ulLen );
+	if( !bRet )
+	{
+		configPRINTF( ("Generate CBOR failed\r\n") );
+	}
+#elif MQTT_OUTPUT_FORMAT_JSON
+	uint32_t ulLen = 0;
+	bool bRet = JSON_bGenerateToSend( pxSensorsMessage, (char*)pucBuf, mqtttaskSEND_BUFFER_SIZE, &ulLen );
+	if( !bRet )
+	{
+		configPRINTF( ("Generate JSON failed\r\n") );
+	}
+#else
+	uint32_t ulLen = 0;
+	bool bRet = CSV_bGenerateToSend( pxSensorsMessage, pucBuf, mqtttaskSEND_BUFFER_SIZE, &ulLen );
+	if( !bRet )
+	{
+		configPRINTF( ("Generate CSV failed\r\n") );
+	}
+#endif
+	/** The payload is in the send buffer, the message buffer can take the next window */
+	LatencyTrace_t xTrace = pxSensorsMessage->xTrace;
+	MSG_POOL_vRelease( &xMessagePool, pxSensorsMessage );
+
+	/** Publish the sensors data, a payload cut short is dropped */
+	if( bRet )
+	{
+		prvPublish( pxParams, pucBuf, ulLen, &xTrace );
+	}
+}
+
+
+#if( mqtttaskSHADOW_ENABLE > 0 )
+/* Runs in the MQTT library task, the sensors task applies the settings between two reads */
+static void prvShadowDelta( void *pvContext, AwsIotShadowCallbackParam_t *pxParam )
+{
+	( void )pvContext;
+
+	if( !SETTINGS_bDelta( pxParam->u.callback.pDocument, pxParam->u.callback.documentLength ) )
+	{
+		configPRINTF( ("Shadow delta rejected\r\n") );
+	}
+}
+
+
+/* A failed subscription or get is tried again after the backoff, not on every pass of the task loop */
+static void prvShadowFailed( const char *pcWhat )
+{
+	xShadowBackoff = ( xShadowBackoff == 0 ) ? mqtttaskSHADOW_RETRY_MIN : xShadowBackoff * 2;
+	if( xShadowBackoff > mqtttaskSHADOW_RETRY_MAX )
+	{
+		xShadowBackoff = mqtttaskSHADOW_RETRY_MAX;
+	}
+	xShadowFailed = xTaskGetTickCount();
+	configPRINTF( ("Shadow %s failed, next try in %u ms\r\n", pcWhat, xShadowBackoff * portTICK_PERIOD_MS) );
+}
+
+
+/* Delta subscription of the current connection, then the report of the settings applied since the last one */
+static void prvShadowSync( void )
+{
+	static char cReported[ SETTINGS_REPORT_SIZE ];
+	IotMqttConnection_t xConnection = MQTT_AGENT_Getv2Connection( xMQTTHandle );
+	Settings_t xSettings;
+	bool bPersist = false;
+
+	if( ( !bShadowSubscribed || !bShadowFetched ) && ( xShadowBackoff > 0 ) && ( ( xTaskGetTickCount() - xShadowFailed ) < xShadowBackoff ) )
+	{
+		return;
+	}
+
+	if( !bShadowSubscribed )
+	{
+		AwsIotShadowCallbackInfo_t xDeltaCallback = AWS_IOT_SHADOW_CALLBACK_INFO_INITIALIZER;
+		xDeltaCallback.function = prvShadowDelta;
+		if( AwsIotShadow_SetDeltaCallback( xConnection, clientcredentialIOT_THING_NAME, strlen( clientcredentialIOT_THING_NAME ), 0, &xDeltaCallback ) != AWS_IOT_SHADOW_SUCCESS )
+		{
+			prvShadowFailed( "delta subscription" );
+			return;
+		}
+		bShadowSubscribed = true;
+	}
+
+	if( !bShadowFetched )
+	{
+		/* A delta published while the device was away isn't sent again, the shadow holds it */
+		AwsIotShadowDocumentInfo_t xGetInfo = AWS_IOT_SHADOW_DOCUMENT_INFO_INITIALIZER;
+		AwsIotShadowError_t xError;
+		const char *pcDoc = NULL;
+		size_t xDocLen = 0;
+		xGetInfo.pThingName = clientcredentialIOT_THING_NAME;
+		xGetInfo.thingNameLength = strlen( clientcredentialIOT_THING_NAME );
+		xGetInfo.qos = IOT_MQTT_QOS_1;
+		xGetInfo.u.get.mallocDocument = pvPortMalloc;
+		xError = AwsIotShadow_TimedGet( xConnection, &xGetInfo, 0, mqtttaskMQTT_TIMEOUT * portTICK_PERIOD_MS, &pcDoc, &xDocLen );
+		if( xError == AWS_IOT_SHADOW_SUCCESS )
+		{
+			if( !SETTINGS_bDelta( pcDoc, xDocLen ) )
+			{
+				configPRINTF( ("Shadow delta rejected\r\n") );
+			}
+			vPortFree( ( void * )pcDoc );
+		}
+		else if( xError != AWS_IOT_SHADOW_NOT_FOUND )
+		{
+			/* No shadow yet is an answer, a timeout isn't */
+			prvShadowFailed( "get" );
+			return;
+		}
+		bShadowFetched = true;
+		xShadowBackoff = 0;
+
+		/* The reported state may be of another run */
+		SETTINGS_vReportAgain();
+	}
+
+	if( !SETTINGS_bReport( &xSettings, &bPersist ) )
+	{
+		return;
+	}
+
+	if( bPersist && !SETTINGS_bSave( &xSettings, &SETTINGS_xEeprom ) )
+	{
+		configPRINTF( ("Settings not saved to the EEPROM\r\n") );
+	}
+
+	AwsIotShadowDocumentInfo_t xUpdateInfo = AWS_IOT_SHADOW_DOCUMENT_INFO_INITIALIZER;
+	uint32_t ulLen = SETTINGS_ulReported( &xSettings, ( uint32_t )xTaskGetTickCount(), cReported, sizeof( cReported ) );
+	xUpdateInfo.pThingName = clientcredentialIOT_THING_NAME;
+	xUpdateInfo.thingNameLength = strlen( clientcredentialIOT_THING_NAME );
+	xUpdateInfo.qos = IOT_MQTT_QOS_1;
+	xUpdateInfo.u.update.pUpdateDocument = cReported;
+	xUpdateInfo.u.update.updateDocumentLength = ulLen;
+	if( ( ulLen == 0 ) || ( AwsIotShadow_TimedUpdate( xConnection, &xUpdateInfo, 0, mqtttaskMQTT_TIMEOUT * portTICK_PERIOD_MS ) != AWS_IOT_SHADOW_SUCCESS ) )
+	{
+		configPRINTF( ("Shadow report failed\r\n") );
+		SETTINGS_vReportAgain();
+	}
+}
+#endif
+
+
+#if( mqtttaskCAPTURE_ENABLE > 0 )
+/* Runs in the MQTT library task, the transfer starts in a pause of the MQTT task */
+static MQTTBool_t prvCaptureCommand( void *pvContext, const MQTTPublishData_t * const pxPublishData )
+{
+	( void )pvContext;
+
+	if( !CAPTURE_bCommand( ( const char * )pxPublishData->pvData, pxPublishData->ulDataLength, ( uint32_t )xTaskGetTickCount() ) )
+	{
+		configPRINTF( ("Capture request rejected\r\n") );
+	}
+
+	/* The library frees the buffer */
+	return eMQTTFalse;
+}
+
+
+/* Subscription of the current connection, a topic of its own as the rule topics can't be subscribed to */
+static void prvCaptureSubscribe( void )
+{
+	static const char cCommandTopic[] = "infn/dev/"clientcredentialIOT_THING_NAME"/capture";
+	MQTTAgentSubscribeParams_t xSubscribeParams;
+
+	if( bCaptureSubscribed )
+	{
+		return;
+	}
+
+	xSubscribeParams.pucTopic = ( const uint8_t * )cCommandTopic;
+	xSubscribeParams.usTopicLength = ( uint16_t )strlen( cCommandTopic );
+	xSubscribeParams.xQoS = eMQTTQoS1;
+	xSubscribeParams.pvPublishCallbackContext = NULL;
+	xSubscribeParams.pxPublishCallback = prvCaptureCommand;
+	if( MQTT_AGENT_Subscribe( xMQTTHandle, &xSubscribeParams, mqtttaskMQTT_TIMEOUT ) != eMQTTAgentSuccess )
+	{
+		configPRINTF( ("Capture subscription failed\r\n") );
+		return;
+	}
+	bCaptureSubscribed = true;
+}
+
+
+/* One chunk when nothing else waits, QoS 1 and blocking; a chunk without acknowledge goes again, also after a reconnect */
+static void prvCaptureSend( MQTTAgentPublishParams_t *pxParams )
+{
+	/* Free between two windows: an alarm is encoded and sent, or queued into a pipeline slot, before the next pass */
+	uint8_t *pucChunk = pcMQTTAlarmBuffer;
+	static char cTopic[ 200 ];
+	static TickType_t xCaptureLast = 0;
+	MQTTAgentPublishParams_t xParams = *pxParams;
+	CaptureChunkHeader_t xHeader;
+	CaptureStat_t xStat;
+
+	if( CAPTURE_bStart( ( uint32_t )xTaskGetTickCount(), mqtttaskCAPTURE_CHUNK_SIZE ) )
+	{
+		configPRINTF( ("Capture of parameter %u started\r\n", CAPTURE_ucParameter()) );
+	}
+
+	if( ( xTaskGetTickCount() - xCaptureLast ) < mqtttaskCAPTURE_PERIOD )
+	{
+		return;
+	}
+#if( mqtttaskINFLIGHT_MAX > 0 )
+	if( bPipeReady && ( PIPE_ucUsed( &xPipe ) > 0 ) )
+	{
+		return;
+	}
+#endif
+#if( mqtttaskSTORE_ENABLE > 0 )
+	if( STORE_ulPending( &xStore ) > 0 )
+	{
+		return;
+	}
+#endif
+#if( mqtttaskADAPT_ENABLE > 0 )
+	AdaptStat_t xAdaptStat;
+	ADAPT_vStatGet( &xAdaptStat );
+	if( xAdaptStat.xLink == ADAPT_LINK_POOR )
+	{
+		return;
+	}
+#endif
+
+	uint32_t ulLen = CAPTURE_ulChunk( pucChunk, mqtttaskCAPTURE_CHUNK_SIZE, &xHeader );
+	if( ulLen == 0 )
+	{
+		return;
+	}
+
+	int lTopicLen = snprintf( cTopic, sizeof( cTopic ), "%.*s/raw/%u/%u", pxParams->usTopicLength, ( const char * )pxParams->pucTopic,
+			xHeader.usTransfer, xHeader.usSeq );
+	if( ( lTopicLen <= 0 ) || ( lTopicLen >= ( int )sizeof( cTopic ) ) )
+	{
+		return;
+	}
+
+	xCaptureLast = xTaskGetTickCount();
+	xParams.pucTopic = ( const uint8_t * )cTopic;
+	xParams.usTopicLength = ( uint16_t )lTopicLen;
+	xParams.xQoS = eMQTTQoS1;
+	xParams.pvData = pucChunk;
+	xParams.ulDataLength = ulLen;
+
+	if( prvSend( &xParams, NULL ) )
+	{
+		CAPTURE_vAcked( xHeader.usTransfer, xHeader.usSeq );
+
+		if( ( uint32_t )xHeader.usSeq + 1 == xHeader.usChunks )
+		{
+			CAPTURE_vStatGet( &xStat );
+			configPRINTF( ("Capture %u sent in %u chunks, requests %u, transfers %u, overwritten %u\r\n",
+					xHeader.usTransfer, xHeader.usChunks, xStat.ulRequests, xStat.ulTransfers, xStat.ulOverwritten) );
+		}
+	}
+}
+#endif
+
+
+#if( mqtttaskADAPT_ENABLE > 0 )
+/* Link level from the payloads waiting now: the pool, the in-flight window and the store */
+static void prvAdaptUpdate( void )
+{
+	uint32_t ulBacklog = MSG_POOL_ucQueued( &xMessagePool );
+	AdaptPolicy_t xPolicy;
+	AdaptStat_t xStat;
+
+#if( mqtttaskINFLIGHT_MAX > 0 )
+	ulBacklog += bPipeReady ? PIPE_ucUsed( &xPipe ) : 0;
+#endif
+#if( mqtttaskSTORE_ENABLE > 0 )
+	ulBacklog += STORE_ulPending( &xStore );
+#endif
+
+	if( ADAPT_bUpdate( ulBacklog ) )
+	{
+		ADAPT_vPolicyGet( &xPolicy );
+		ADAPT_vStatGet( &xStat );
+		configPRINTF( ("Link level %u (signal %d dBm, latency %u ms, backlog %u): interval %u, batch %u, detail %u\r\n",
+				xStat.xLink, xStat.sSignal, xStat.ulLatency, xStat.ulBacklog, xPolicy.ucInterval, xPolicy.ucBatch, xPolicy.xDetail) );
+	}
+}
+#endif
+
+
+/* Publish errors switch to reconnection after ATTEMPTS_COUNT, false if the payload didn't go out; the trace completes with it, may be NULL */
+static bool prvSend( MQTTAgentPublishParams_t *pxParams, LatencyTrace_t *pxTrace )
+{
+	MQTTAgentReturnCode_t xRet;
+	bool bRet = false;
+
+	if( ( xIotMqttState != IOT_MQTT_SUCCESS ) || ( eConnStatus != eConnEstablished ) )
+	{
+		/* Not connected */
+		return false;
+	}
+
+	IotMutex_Lock( &xNetworkMutex );
+
+	TickType_t xStart = xTaskGetTickCount();
+	xRet = MQTT_AGENT_Publish( xMQTTHandle, pxParams, mqtttaskMQTT_TIMEOUT );
+#if( mqtttaskADAPT_ENABLE > 0 )
+	/* Only QoS 1 waits for the broker */
+	if( pxParams->xQoS > 0 )
+	{
+		ADAPT_vLatency( ( xRet == eMQTTAgentSuccess ) ? ( xTaskGetTickCount() - xStart ) * portTICK_PERIOD_MS : mqtttaskMQTT_TIMEOUT * portTICK_PERIOD_MS );
+	}
+#endif
+
+	if( xRet == eMQTTAgentSuccess )
+	{
+		/* Only an acknowledge tells the connection is alive */
+		if( pxParams->xQoS > 0)
+		{
+			vMqttTaskAlive();
+		}
+		if( pxTrace != NULL )
+		{
+			if( pxParams->xQoS > 0 )
+			{
+				LATENCY_vStamp( pxTrace, LATENCY_ACK );
+			}
+			LATENCY_vComplete( pxTrace );
+		}
+		LED_xStatus( MESSAGE, SUCCESS );
+		configPRINTF( ("Message sent successfully \r\n") );
+
+		ucPublishErrorCount = 0;
+		bRet = true;
+	}
+	else
+	{
+		LED_xStatus( MESSAGE, FAILED );
+		configPRINTF( ("Message was not sent: %d \r\n", xRet) );
+
+		if( ++ucPublishErrorCount >= ATTEMPTS_COUNT )
+		{
+			xIotMqttState = IOT_MQTT_NETWORK_ERROR;
+			eConnStatus = eMqttError;
+
+			ucPublishErrorCount = 0;
+		}
+	}
+
+	IotMutex_Unlock( &xNetworkMutex );
+
+	return bRet;
+}
+
+
+#if( mqtttaskINFLIGHT_MAX > 0 )
+/* Publish errors of the pipelined path, counted as in prvSend; MQTT task only */
+static void prvPipeError( void )
+{
+	LED_xStatus( MESSAGE, FAILED );
+
+	IotMutex_Lock( &xNetworkMutex );
+	if( ( eConnStatus == eConnEstablished ) && ( ++ucPublishErrorCount >= ATTEMPTS_COUNT ) )
+	{
+		xIotMqttState = IOT_MQTT_NETWORK_ERROR;
+		eConnStatus = eMqttError;
+
+		ucPublishErrorCount = 0;
+	}
+	IotMutex_Unlock( &xNetworkMutex );
+}
+
+
+/* Outcomes posted by prvPipeCallback into the error count, then the pending slots go out again */
+static void prvPipeRetry( void )
+{
+	bool bAcked;
+	uint8_t ucNacks;
+
+	taskENTER_CRITICAL();
+	bAcked = bPipeAcked;
+	ucNacks = ucPipeNacks;
+	bPipeAcked = false;
+	ucPipeNacks = 0;
+	taskEXIT_CRITICAL();
+
+	if( bAcked )
+	{
+		IotMutex_Lock( &xNetworkMutex );
+		ucPublishErrorCount = 0;
+		IotMutex_Unlock( &xNetworkMutex );
+	}
+	while( ucNacks-- > 0 )
+	{
+		prvPipeError();
+	}
+
+	if( bPipeReady && ( eConnStatus == eConnEstablished ) && ( PIPE_ucPending( &xPipe ) > 0 ) )
+	{
+		( void )PIPE_ucRetry( &xPipe );
+	}
+}
+
+
+/* Into the in-flight window without waiting for the acknowledge, false if the window stays full */
+static bool prvPipeSend( MQTTAgentPublishParams_t *pxParams, LatencyTrace_t *pxTrace )
+{
+	bool bSent;
+
+	if( ( xIotMqttState != IOT_MQTT_SUCCESS ) || ( eConnStatus != eConnEstablished ) )
+	{
+		/* Not connected */
+		return false;
+	}
+
+	/* The topics of the windows live as long as the task, the slot keeps only the pointer; prvPipePublish takes the trace into the slot */
+	pxPipeTrace = pxTrace;
+	bSent = PIPE_bSend( &xPipe, ( const char * )pxParams->pucTopic, pxParams->usTopicLength, ( uint8_t )pxParams->xQoS,
+			pxParams->pvData, pxParams->ulDataLength, mqtttaskMQTT_TIMEOUT );
+	pxPipeTrace = NULL;
+
+	if( !bSent )
+	{
+		configPRINTF( ("In-flight window full\r\n") );
+		prvPipeError();
+		return false;
+	}
+
+	return true;
+}
+
+
+/* Transport of the window, IotMqtt_Publish completes through prvPipeCallback with the token as context */
+static bool prvPipePublish( void *pvContext, const PipeSlot_t *pxSlot, uint32_t ulToken )
+{
+	IotMqttPublishInfo_t xInfo = IOT_MQTT_PUBLISH_INFO_INITIALIZER;
+	IotMqttCallbackInfo_t xCallback = IOT_MQTT_CALLBACK_INFO_INITIALIZER;
+	IotMqttError_t xRet;
+
+	if( ( xMQTTHandle == NULL ) || ( eConnStatus != eConnEstablished ) )
+	{
+		return false;
+	}
+
+	xInfo.qos = ( pxSlot->ucQoS > 0 ) ? IOT_MQTT_QOS_1 : IOT_MQTT_QOS_0;
+	xInfo.pTopicName = pxSlot->pcTopic;
+	xInfo.topicNameLength = pxSlot->usTopicLength;
+	xInfo.pPayload = pxSlot->pucData;
+	xInfo.payloadLength = pxSlot->ulLen;
+	xInfo.retryMs = ( uint32_t )( mqtttaskMQTT_TIMEOUT * portTICK_PERIOD_MS );
+	xInfo.retryLimit = mqtttaskPUBLISH_RETRY_LIMIT;
+
+	xCallback.pCallbackContext = ( void * )( uintptr_t )ulToken;
+	xCallback.function = prvPipeCallback;
+
+	/* The first publish of a slot takes the trace of its payload, a resend keeps it */
+	uint8_t ucSlot = ( uint8_t )( pxSlot - xPipe.xSlots );
+	if( pxPipeTrace != NULL )
+	{
+		xPipeTraces[ucSlot] = *pxPipeTrace;
+		pxPipeTrace = NULL;
+	}
+	ulPipeTokens[ucSlot] = ulToken;
+
+	IotMutex_Lock( &xNetworkMutex );
+	/* The packet is serialized before the call returns, the slot may be reused after the acknowledge; QoS 0 takes no callback */
+	xRet = IotMqtt_Publish( MQTT_AGENT_Getv2Connection( xMQTTHandle ), &xInfo, 0, ( xInfo.qos == IOT_MQTT_QOS_0 ) ? NULL : &xCallback, NULL );
+	IotMutex_Unlock( &xNetworkMutex );
+
+	if( ( xInfo.qos == IOT_MQTT_QOS_0 ) && ( xRet == IOT_MQTT_SUCCESS ) )
+	{
+		/* Nothing comes back for QoS 0, done once it is out */
+		LATENCY_vComplete( &xPipeTraces[ucSlot] );
+		( void )PIPE_bComplete( ( Pipe_t * )pvContext, ulToken, true );
+		LED_xStatus( MESSAGE, SUCCESS );
+		return true;
+	}
+
+	if( xRet != IOT_MQTT_STATUS_PENDING )
+	{
+		configPRINTF( ("Message was not sent: %d \r\n", xRet) );
+		prvPipeError();
+		return false;
+	}
+
+	return true;
+}
+
+
+/* Acknowledge or give-up of a pipelined publish, runs in the task pool of the MQTT library */
+static void prvPipeCallback( void *pvContext, IotMqttCallbackParam_t *pxParam )
 {
-    ( void )pvParameters;
+	bool bAcked = ( pxParam->u.operation.result == IOT_MQTT_SUCCESS );
+	LatencyTrace_t xTrace = { .usSet = 0 };
 
-    if( I2C_MUX_cWait( I2C_MUX_TIMEOUT ) < 0 )
-    {
-    	vFullReset( APP_ERROR_I2C_MUX_NOT_RELEASED );
-    }
+	/* The slot is taken by the next payload as soon as it completes */
+	for( uint8_t i = 0; i < mqtttaskINFLIGHT_MAX; ++i )
+	{
+		if( ulPipeTokens[i] == ( uint32_t )( uintptr_t )pvContext )
+		{
+			xTrace = xPipeTraces[i];
+			break;
+		}
+	}
 
-    LED_xStatus( MQTT, START );
-    /* Create an MQTT agent and connect to the broker */
-    BaseType_t xStatus = prvMqttAgentStartAndConnect();
-    if( xStatus == pdPASS )
-    {
-    	LED_xStatus( MQTT, SUCCESS );
-    }
-    else
-    {
-    	LED_xStatus( MQTT, FAILED );
-    	vFullReset( MQTT_AGENT_INIT_ERROR );
-    }
+	/* A late outcome of a publish already resent on a new connection changes nothing */
+	if( !PIPE_bComplete( &xPipe, ( uint32_t )( uintptr_t )pvContext, bAcked ) )
+	{
+		return;
+	}
 
-    MQTTAgentPublishParams_t xMQTTAgentPublishParams;
+#if( mqtttaskADAPT_ENABLE > 0 )
+	PipeStat_t xPipeStat;
+	PIPE_vStatGet( &xPipe, &xPipeStat );
+	ADAPT_vLatency( bAcked ? xPipeStat.xRttLast * portTICK_PERIOD_MS : ( mqtttaskPUBLISH_RETRY_LIMIT + 1 ) * mqtttaskMQTT_TIMEOUT * portTICK_PERIOD_MS );
+#endif
 
-#ifdef PATCH
-	char ucTopicString[ mqttTOPIC_BUFFER_LENGTH ] = { 0 };
+	/* The MQTT task counts the outcome on its next pass, it owns the connection state */
+	taskENTER_CRITICAL();
+	if( bAcked )
+	{
+		bPipeAcked = true;
+	}
+	else if( ucPipeNacks < UINT8_MAX )
+	{
+		ucPipeNacks++;
+	}
+	taskEXIT_CRITICAL();
 
-	strcat( ucTopicString, pcTopic );
-	strcat( ucTopicString, pcThingName );
+	if( bAcked )
+	{
+		LATENCY_vStamp( &xTrace, LATENCY_ACK );
+		LATENCY_vComplete( &xTrace );
+		LED_xStatus( MESSAGE, SUCCESS );
+		vMqttTaskAlive();
+	}
+	else
+	{
+		configPRINTF( ("Message was not acknowledged: %d \r\n", pxParam->u.operation.result) );
+		LED_xStatus( MESSAGE, FAILED );
+	}
+}
+#endif
 
-    xMQTTAgentPublishParams.pucTopic = (uint8_t*)ucTopicString;
-    xMQTTAgentPublishParams.usTopicLength = strlen( ucTopicString );
 
-    configPRINTF( ("MQTT Thing Name: %s.\r\n", pcThingName) );
+/* Publish ulLen bytes of pucBuf, a payload that doesn't go out is stored; the trace of the payload completes with the acknowledge */
+static void prvPublish( MQTTAgentPublishParams_t *pxParams, const uint8_t *pucBuf, uint32_t ulLen, LatencyTrace_t *pxTrace )
+{
+	pxParams->pvData = pucBuf;
+	pxParams->ulDataLength = ulLen;
+#if( mqtttaskCOMPRESSION_ENABLE > 0 )
+	/* The frame goes out only when it saves something, otherwise the raw payload */
+	uint32_t ulPacked = COMP_ulCompress( pucBuf, ulLen, pcMQTTPacked, sizeof( pcMQTTPacked ) );
+	if( ( ulPacked > 0 ) && ( ulPacked < ulLen ) )
+	{
+		pxParams->pvData = pcMQTTPacked;
+		pxParams->ulDataLength = ulPacked;
+	}
+#endif
+	LATENCY_vStamp( pxTrace, LATENCY_ENCODE );
 
+#if( mqtttaskINFLIGHT_MAX > 0 )
+	if( bPipeReady ? prvPipeSend( pxParams, pxTrace ) : prvSend( pxParams, pxTrace ) )
 #else
-    xMQTTAgentPublishParams.pucTopic = (uint8_t*)pcTopic;
-    xMQTTAgentPublishParams.usTopicLength = strlen( pcTopic );
+	if( prvSend( pxParams, pxTrace ) )
 #endif
+	{
+		return;
+	}
 
-    configPRINTF( ("MQTT Topic: %s.\r\n", xMQTTAgentPublishParams.pucTopic) );
-
-    xMQTTAgentPublishParams.xQoS = eMQTTQoS1;
+	/* The broker may have missed changes, the next window goes in full */
+	REPORT_vSnapshotForce();
 
-    if( xStatus == pdPASS )
-    {
-        /** Initialize the Sensors Data Queue */
-        xMQTTMessageQueueHandle = xQueueCreate( mqtttaskRECEIVE_QUEUE_LENGTH, sizeof( InfineonSensorsMessage_t ) );
+#if( mqtttaskSTORE_ENABLE > 0 )
+	/* Sent as it is after the reconnect */
+	if( !bStoreReady || !STORE_bPut( &xStore, pxParams->pvData, pxParams->ulDataLength, ( uint32_t )xTaskGetTickCount() ) )
+	{
+		configPRINTF( ("Store failed, the window is lost\r\n") );
+	}
+#endif
+}
 
-        if( xMQTTMessageQueueHandle == NULL )
-        {
-            xStatus = pdFAIL;
-        }
-    }
 
-    if( xStatus == pdPASS )
-    {
-		/** Create non-recursive mutex */
-		if( IotMutex_Create( &xNetworkMutex, false ) != true )
-		{
-			IotLogError( "Failed to create semaphore to wait for a network connection." );
-			xStatus = pdFAIL;
-		}
-    }
+#if( mqtttaskSTORE_ENABLE > 0 )
+/* Publish the oldest stored payload, it stays in the store until the broker has it */
+static void prvStoreDrain( MQTTAgentPublishParams_t *pxParams )
+{
+	/* Room for a thing name of 128 characters */
+	static char cTopic[ 200 ];
+	MQTTAgentPublishParams_t xParams = *pxParams;
+	const uint8_t *pucData;
+	uint32_t ulLen;
+	uint32_t ulSeq;
+	uint32_t ulTick;
+	int lTopicLen;
+	StoreStat_t xStat;
+
+	pucData = STORE_pucPeek( &xStore, &ulLen, &ulSeq, &ulTick );
+	if( pucData == NULL )
+	{
+		return;
+	}
 
-    if( xStatus == pdPASS )
-    {
-    	eConnStatus = eConnEstablished;
-    	xStatus = prvCreateRobustTask();
-    }
+	/* The age tells the receiver when the window was taken, the tick of another run is of no use */
+	if( ulSeq >= ulStoreRunSeq )
+	{
+		lTopicLen = snprintf( cTopic, sizeof( cTopic ), "%.*s/stored/%u/%u", pxParams->usTopicLength, ( const char * )pxParams->pucTopic,
+				ulSeq, ( uint32_t )xTaskGetTickCount() - ulTick );
+	}
+	else
+	{
+		lTopicLen = snprintf( cTopic, sizeof( cTopic ), "%.*s/stored/%u", pxParams->usTopicLength, ( const char * )pxParams->pucTopic, ulSeq );
+	}
+	if( ( lTopicLen <= 0 ) || ( lTopicLen >= ( int )sizeof( cTopic ) ) )
+	{
+		return;
+	}
 
-    if( xStatus == pdPASS )
-    {
-    	vSensorsTaskStart();
+	xParams.pucTopic = ( const uint8_t * )cTopic;
+	xParams.usTopicLength = ( uint16_t )lTopicLen;
+	xParams.pvData = pucData;
+	xParams.ulDataLength = ulLen;
 
-        for( ;; )
-        {
+	if( prvSend( &xParams, NULL ) )
+	{
+		STORE_vAck( &xStore, ulSeq );
 
-        	if( eConnStatus == eConnEstablished )
-        	{
-				/** Receive the sensors data from the data gathering task*/
-				if( xQueueReceive( xMQTTMessageQueueHandle, &xSensorsMessage, portMAX_DELAY ) )
-				{
-					configPRINTF( ("Queue Receive\r\n") );
-					/** Fill the buffer to send */
-#if MQTT_OUTPUT_FORMAT_JSON
-						bool bRet = JSON_bGenerateToSend( &xSensorsMessage, (char*)pcMQTTBuffer, sizeof(pcMQTTBuffer) );
-						if( !bRet )
-						{
-							configPRINTF( ("Generate JSON failed\r\n") );
-						}
-#else
-						CSV_vGenerateToSend( &xSensorsMessage, pcMQTTBuffer );
+		if( STORE_ulPending( &xStore ) == 0 )
+		{
+			STORE_vStatGet( &xStore, &xStat );
+			configPRINTF( ("Store drained, stored %u, sent %u, dropped %u, erases %u, wear %u\r\n",
+					xStat.ulStored, xStat.ulSent, xStat.ulDropped, xStat.ulErases, xStat.ulWearMax) );
+		}
+	}
+}
 #endif
 
-						/** Publish the sensors data */
-						xMQTTAgentPublishParams.pvData = pcMQTTBuffer;
-						xMQTTAgentPublishParams.ulDataLength = strlen( (char*) pcMQTTBuffer );
-						if( xIotMqttState == IOT_MQTT_SUCCESS )
-						{
-							IotMutex_Lock( &xNetworkMutex );
-
-							xStatus = MQTT_AGENT_Publish( xMQTTHandle, &xMQTTAgentPublishParams, mqtttaskMQTT_TIMEOUT );
 
-							if( xStatus == eMQTTAgentSuccess )
-							{
-								/* If we use quality of service with response then after success sending ucPingErrorCount will be cleared */
-								if( xMQTTAgentPublishParams.xQoS > 0)
-								{
-									ucPingErrorCount = 0;
-								}
-								LED_xStatus( MESSAGE, SUCCESS );
-								configPRINTF( ("Message sent successfully \r\n") );
+#if( mqtttaskLATENCY_REPORT_PERIOD > 0 )
+/* Histograms of the stages to the debug UART and to the diagnostics topic, a lost report is not stored */
+static void prvLatencyReport( MQTTAgentPublishParams_t *pxParams )
+{
+	static char cJson[ 768 ];
+	MQTTAgentPublishParams_t xParams = *pxParams;
 
-								ucPublishErrorCount = 0;
-							}
-							else
-							{
-								LED_xStatus( MESSAGE, FAILED );
-								configPRINTF( ("Message was not sent: %d \r\n", xStatus) );
+	LATENCY_vPrint();
 
-								if( ++ucPublishErrorCount >= ATTEMPTS_COUNT )
-								{
-									xIotMqttState = IOT_MQTT_NETWORK_ERROR;
-									eConnStatus = eMqttError;
+	xParams.ulDataLength = LATENCY_ulJson( cJson, sizeof( cJson ) );
+	if( xParams.ulDataLength == 0 )
+	{
+		return;
+	}
+	xParams.pvData = cJson;
 
-									ucPublishErrorCount = 0;
-								}
-							}
+	( void )prvSend( &xParams, NULL );
+}
+#endif
 
-							IotMutex_Unlock( &xNetworkMutex );
 
-						} /* if( xIotMqttState == IOT_MQTT_SUCCESS ) */
 
-					} /* if( xQueueReceive() ) */
-					else
-					{
-						configPRINTF( ("Stop MQTT task \r\n") );
-						break;
-					}
+#if( mqtttaskMETRICS_PERIOD > 0 )
+/* Performance counters of the firmware to Device Defender, a lost report is not stored */
+static void prvMetricsReport( void )
+{
+	static const char cMetricsTopic[] = "$aws/things/"clientcredentialIOT_THING_NAME"/defender/metrics/json";
+	static char cJson[ METRICS_REPORT_SIZE ];
+	static MetricsData_t xMetrics;
+	MQTTAgentPublishParams_t xParams;
+	MsgPoolStat_t xPoolStat;
+	LatencyStat_t xLatency;
+
+	METRICS_vSystemGet( &xMetrics );
+
+	MSG_POOL_vStatGet( &xMessagePool, &xPoolStat );
+	xMetrics.ulDropped = xPoolStat.ulDroppedOldest + xPoolStat.ulDroppedNewest;
+	LATENCY_vStatGet( LATENCY_WINDOW, &xLatency );
+	xMetrics.ulLatencyP50 = xLatency.ulP50;
+	xMetrics.ulLatencyP90 = xLatency.ulP90;
+	xMetrics.ulLatencyP99 = xLatency.ulP99;
+	xMetrics.ulBusErrors = ulSensorsReadErrors();
+	xMetrics.ulReconnects = ulReconnects;
+
+	/* The service wants a new id on every report, as the Defender library the uptime is taken */
+	xParams.ulDataLength = METRICS_ulReport( &xMetrics, ( uint32_t )xTaskGetTickCount() * portTICK_PERIOD_MS, cJson, sizeof( cJson ) );
+	if( xParams.ulDataLength == 0 )
+	{
+		configPRINTF( ("Metrics report doesn't fit\r\n") );
+		return;
+	}
+	xParams.pucTopic = ( const uint8_t * )cMetricsTopic;
+	xParams.usTopicLength = ( uint16_t )strlen( cMetricsTopic );
+	xParams.xQoS = eMQTTQoS1;
+	xParams.pvData = cJson;
+
+	configPRINTF( ("Metrics of %u tasks, heap low %u, dropped %u, bus errors %u, reconnects %u\r\n",
+			xMetrics.ucTasks, xMetrics.ulHeapLow, xMetrics.ulDropped, xMetrics.ulBusErrors, xMetrics.ulReconnects) );
+	( void )prvSend( &xParams, NULL );
+}
+#endif
 
-        	} /* if( eConnStatus == eConnEstablished ) */
-        	else
-        	{
-        		/* We should not try to Ping during reconnection, thats why Mutex used */
-        		IotMutex_Lock( &xNetworkMutex );
 
-        		switch( eConnStatus )
-        		{
+#if MQTT_BATCH_ENABLE
+static void prvBatchPublish( MQTTAgentPublishParams_t *pxParams )
+{
+	uint32_t ulLen = 0;
+	uint8_t ucWindows = xBatch.ucWindows;
 
-					case eNetworkError:
-						configPRINTF( ("eNetworkError \r\n") );
-						/* In case of network error - try to reestablish network connection */
-						if( prvNetworkConnectionRestart() == pdPASS )
-						{
-							eConnStatus = eConnEstablished;
-						}
-						else
-						{
-							/* We shouldn't try reestablish MQTT connection while WiFi is not connected */
-							vFullReset( NETWORK_INIT_ERROR );
-						}
-						break;
-					case eMqttError:
-						/* In case of MQTT connection error - try to reestablish MQTT connection */
-						if( prvMqttAgentRestart() == pdPASS )
-						{
-							xIotMqttState = IOT_MQTT_SUCCESS;
-							eConnStatus = eConnEstablished;
-						}
-						else
-						{
-							eConnStatus = eNetworkError;
-						}
-						break;
-					default:
-						/* eConnStatus. */
-						configASSERT( false );
+	if( BATCH_bFinish( &xBatch, ( uint32_t )xTaskGetTickCount(), &ulLen ) )
+	{
+		configPRINTF( ("Batch of %u windows, %u bytes\r\n", ucWindows, ulLen) );
+		prvPublish( pxParams, pcMQTTBuffer, ulLen, &xBatchTrace );
+	}
+	else
+	{
+		REPORT_vSnapshotForce();
+	}
+}
 
-				} /* switch( eConnStatus ) */
 
-        		vTaskDelay( pdMS_TO_TICKS(RECONNECT_DELAY) );
+/*
+ * The window is encoded into the open batch and its buffer goes back to the pool.
+ * The batch is published once it has mqtttaskBATCH_WINDOWS windows or passes
+ * mqtttaskBATCH_BUDGET bytes; a window that does not fit publishes the batch
+ * before it and opens the next one. Alarm windows don't go into batches.
+ */
+static void prvBatchAdd( MQTTAgentPublishParams_t *pxParams, InfineonSensorsMessage_t *pxSensorsMessage )
+{
+	if( ( xBatch.ucWindows == 0 ) && !BATCH_bCreate( &xBatch, MQTT_OUTPUT_FORMAT_CBOR, pcMQTTBuffer, sizeof( pcMQTTBuffer ) ) )
+	{
+		configPRINTF( ("Batch create failed\r\n") );
+	}
+	else if( !BATCH_bAdd( &xBatch, pxSensorsMessage ) )
+	{
+		if( xBatch.ucWindows > 0 )
+		{
+			prvBatchPublish( pxParams );
+		}
 
-        		IotMutex_Unlock( &xNetworkMutex );
+		if( !BATCH_bCreate( &xBatch, MQTT_OUTPUT_FORMAT_CBOR, pcMQTTBuffer, sizeof( pcMQTTBuffer ) ) ||
+			!BATCH_bAdd( &xBatch, pxSensorsMessage ) )
+		{
+			configPRINTF( ("Window does not fit the send buffer\r\n") );
+			REPORT_vSnapshotForce();
+		}
+	}
 
-        	}
-        }
+	/* The batch is as late as its oldest window */
+	if( xBatch.ucWindows == 1 )
+	{
+		xBatchTrace = pxSensorsMessage->xTrace;
+	}
+	MSG_POOL_vRelease( &xMessagePool, pxSensorsMessage );
 
-        prvDeleteRobustTask();
-        IotMutex_Destroy( &xNetworkMutex );
-    }
+	/* The controller shortens the batch on a good link */
+	AdaptPolicy_t xPolicy;
+	ADAPT_vPolicyGet( &xPolicy );
+	uint8_t ucWindows = ( ( xPolicy.ucBatch > 0 ) && ( xPolicy.ucBatch < mqtttaskBATCH_WINDOWS ) ) ? xPolicy.ucBatch : mqtttaskBATCH_WINDOWS;
 
-    /** Something went wrong, delete the task */
-    vTaskDelete( NULL );
+	if( ( xBatch.ucWindows > 0 ) &&
+		( ( xBatch.ucWindows >= ucWindows ) || ( xBatch.ulLen >= mqtttaskBATCH_BUDGET ) ) )
+	{
+		prvBatchPublish( pxParams );
+	}
 }
+#endif
 
 /*-----------------------------------------------------------*/
 
@@ -412,6 +1454,7 @@ BaseType_t prvMqttAgentStartAndConnect( void )
             configPRINTF( ( "MQTT echo connected.\r\n" ) );
             xRet = pdPASS;
             xIotMqttState = IOT_MQTT_SUCCESS;
+            vMqttTaskAlive();
         }
     }
 
@@ -456,6 +1499,75 @@ BaseType_t prvMqttAgentRestart( void )
 }
 
 
+/*
+ * One reconnect attempt at the current tier. The cheap tiers keep the link
+ * and only renew the socket, the radio is restarted after they failed or at
+ * once when the link is down. The board resets when the radio tier failed.
+ */
+static BaseType_t prvReconnect( void )
+{
+	BaseType_t xStatus;
+	TickType_t xStart = xTaskGetTickCount();
+
+	if( ( eReconnectTier == eReconnectResume ) && ( ucTierAttempts == 0 ) )
+	{
+		xOutageStart = xStart;
+	}
+
+	if( ( eReconnectTier != eReconnectRadio ) && !prvLinkUp() )
+	{
+		eReconnectTier = eReconnectRadio;
+		ucTierAttempts = 0;
+	}
+
+	configPRINTF( ("Reconnect tier %d attempt %u\r\n", eReconnectTier, ucTierAttempts + 1) );
+
+	switch( eReconnectTier )
+	{
+		case eReconnectResume:
+			xStatus = prvMqttAgentRestart();
+			break;
+		case eReconnectSocket:
+			/* The broker may have moved or dropped the session */
+			TLS_ForgetSession();
+			DNS_CACHE_vFlush();
+			xStatus = prvMqttAgentRestart();
+			break;
+		default:
+			TLS_ForgetSession();
+			DNS_CACHE_vFlush();
+			xStatus = prvNetworkConnectionRestart();
+			break;
+	}
+
+	if( xStatus == pdPASS )
+	{
+		configPRINTF( ("Reconnected at tier %d in %u ms, gap %u ms\r\n", eReconnectTier,
+				( xTaskGetTickCount() - xStart ) * portTICK_PERIOD_MS,
+				( xTaskGetTickCount() - xOutageStart ) * portTICK_PERIOD_MS) );
+		eReconnectTier = eReconnectResume;
+		ucTierAttempts = 0;
+		ulReconnects++;
+#if NBIOT_ENABLED
+		/* URCs of the old socket */
+		( void )NBIOT_bLinkClosed();
+#endif
+	}
+	else if( ++ucTierAttempts >= ucTierAttemptsMax[eReconnectTier] )
+	{
+		if( eReconnectTier == eReconnectRadio )
+		{
+			/* We shouldn't try reestablish MQTT connection while the network is not connected */
+			vFullReset( NETWORK_INIT_ERROR );
+		}
+		eReconnectTier++;
+		ucTierAttempts = 0;
+	}
+
+	return xStatus;
+}
+
+
 BaseType_t prvNetworkConnectionRestart( void )
 {
 	int status = EXIT_SUCCESS;
@@ -542,7 +1654,8 @@ BaseType_t prvNetworkConnectionRestart( void )
 }
 
 
-ePingStatus_t prvPing( uint8_t * pucIPAddr, uint16_t usCount, uint32_t ulIntervalMS )
+/* Link to the access point or the cell as the module sees it, no traffic on the air; samples the signal for the adaption */
+static bool prvLinkUp( void )
 {
 #if WIFI_ENABLED
 	BaseType_t xRssi = WIFI_GetRssi();
@@ -550,19 +1663,15 @@ ePingStatus_t prvPing( uint8_t * pucIPAddr, uint16_t usCount, uint32_t ulInterva
 	if( WIFI_IsConnected() && xRssi < 0 )
 	{
 		configPRINTF( ("WIFI RSSI = %d dBm \r\n", xRssi) );
-		if ( WIFI_Ping( pucIPAddr, usCount, ulIntervalMS ) == eWiFiSuccess )
-		{
-			return ePingSuccess;
-		}
-		else
-		{
-			return ePingFail;
-		}
+#if( mqtttaskADAPT_ENABLE > 0 )
+		ADAPT_vSignal( ( int16_t )xRssi );
+#endif
+		return true;
 	}
 	else
 	{
 		configPRINTF( ( "WIFI is NOT connected to Access Point \r\n" ));
-		return ePingFail;
+		return false;
 	}
 
 #endif /* WIFI_ENABLED */
@@ -574,26 +1683,67 @@ ePingStatus_t prvPing( uint8_t * pucIPAddr, uint16_t usCount, uint32_t ulInterva
 	if( sRssi < 0)
 	{
 		configPRINTF( ("LTE RSSI= %d dBm \r\n", sRssi) );
-		if( NBIOT_xTcpPing( NBIOT_CONTEXT_ID, pucIPAddr ) == eStatus_Success )
-		{
-			return ePingSuccess;
-		}
-		else
+#if( mqtttaskADAPT_ENABLE > 0 )
+		/* RSRP tells the coverage of NB-IoT better than the RSSI */
+		int16_t sRsrp = 0;
+		if( NBIOT_xGetRsrp( &sRsrp ) == eStatus_Success )
 		{
-			return ePingFail;
+			ADAPT_vSignal( sRsrp );
 		}
+#endif
+		return true;
 	}
 	else
 	{
 		configPRINTF( ("LTE RSSI is not known or not detectable \r\n") );
+		return false;
+	}
+#endif /* NBIOT_ENABLED */
+}
+
+
+/* Active probe of the way to the internet, costs air time and on NB-IoT data volume */
+ePingStatus_t prvPing( uint8_t * pucIPAddr, uint16_t usCount, uint32_t ulIntervalMS )
+{
+#if WIFI_ENABLED
+	if ( WIFI_Ping( pucIPAddr, usCount, ulIntervalMS ) == eWiFiSuccess )
+	{
+		return ePingSuccess;
+	}
+	else
+	{
+		return ePingFail;
+	}
+#endif /* WIFI_ENABLED */
+
+#if NBIOT_ENABLED
+	( void )usCount;
+	( void )ulIntervalMS;
+
+	if( NBIOT_xTcpPing( NBIOT_CONTEXT_ID, pucIPAddr ) == eStatus_Success )
+	{
+		return ePingSuccess;
+	}
+	else
+	{
 		return ePingFail;
 	}
 #endif /* NBIOT_ENABLED */
 }
 
 
+void vMqttTaskAlive( void )
+{
+	xLastAlive = xTaskGetTickCount();
+}
 
 
+/*
+ * Liveness of the connection from what comes by anyway: acknowledges and
+ * PINGRESPs, the disconnect callback of the MQTT library and the URCs of
+ * the modem. The link is probed only when nothing was heard for
+ * mqtttaskLIVENESS_IDLE.
+ */
 static void vRobustTask( void *pvParameters )
 {
     uint8_t ipbuf[] = { 1, 1, 1, 1 };
@@ -610,36 +1760,60 @@ static void vRobustTask( void *pvParameters )
 
     	configPRINTF( ("eConnStatus = %d\r\n", eConnStatus) );
 
-    	if( eConnStatus != eNetworkError )
+    	if( eConnStatus == eConnEstablished )
     	{
-    		/* Ping */
-    	    xRet = prvPing( ipbuf, PING_COUNT, PING_TIMEOUT );
-    		configPRINTF( ("PING = %d\r\n", xRet) );
-
-    		if( xRet != ePingSuccess )
+    		if( xIotMqttState != IOT_MQTT_SUCCESS )
+    		{
+    			/* Socket error or missed PINGRESP */
+    			configPRINTF( ("Something wrong with MQTT connection. MQTT Agent will be reconnected \r\n") );
+    			eConnStatus = eMqttError;
+    		}
+#if NBIOT_ENABLED
+    		else if( NBIOT_bLinkClosed() )
     		{
-    			if( ++ucPingErrorCount >= ATTEMPTS_COUNT )
+    			configPRINTF( ("Connection closed by the network. MQTT Agent will be reconnected \r\n") );
+    			eConnStatus = eMqttError;
+    		}
+#endif
+    		else
+    		{
+    			if( !prvLinkUp() )
+    			{
+    				xRet = ePingFail;
+    			}
+    			else if( ( xTaskGetTickCount() - xLastAlive ) < pdMS_TO_TICKS( mqtttaskLIVENESS_IDLE ) )
+    			{
+    				xRet = ePingSuccess;
+    			}
+    			else
     			{
-    				/* Problems with network has higher priority than MQTT connection issues */
-					configPRINTF( ("Network ping error \r\n") );
-					eConnStatus = eNetworkError;
+    				/* Nothing heard for long, probe */
+    				xRet = prvPing( ipbuf, PING_COUNT, PING_TIMEOUT );
+    				configPRINTF( ("PING = %d\r\n", xRet) );
+    				if( xRet == ePingSuccess )
+    				{
+    					vMqttTaskAlive();
+    				}
+    			}
 
+    			if( xRet != ePingSuccess )
+    			{
+    				if( ++ucPingErrorCount >= ATTEMPTS_COUNT )
+    				{
+    					/* Problems with network has higher priority than MQTT connection issues */
+    					configPRINTF( ("Network ping error \r\n") );
+    					eConnStatus = eNetworkError;
+
+    					ucPingErrorCount = 0;
+    				}
+    			}
+    			else
+    			{
     				ucPingErrorCount = 0;
     			}
     		}
-			else
-			{
-				ucPingErrorCount = 0;
-
-				if( xIotMqttState != IOT_MQTT_SUCCESS )
-				{
-					/* If network is good - check MQTT connection */
-					configPRINTF( ("Something wrong with MQTT connection. MQTT Agent will be reconnected \r\n") );
-					eConnStatus = eMqttError;
-				}
-			}
 
-		} /* if( eConnStatus != eNetworkError ) */
+		} /* if( eConnStatus == eConnEstablished ) */
 
     	IotMutex_Unlock( &xNetworkMutex );
 
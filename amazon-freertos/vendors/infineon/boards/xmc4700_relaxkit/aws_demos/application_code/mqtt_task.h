@@ -34,17 +34,85 @@
 
 #include "statistic.h"
 #include "base64.h"
+#include "msg_pool.h"
+#include "store.h"
+#include "pipeline.h"
+#include "adapt.h"
+#include "dns_cache.h"
+#include "latency.h"
+#include "settings.h"
+#include "capture.h"
+#include "metrics.h"
 #include "iot_network_manager_private.h"
 
-/* Defining message format */
+/* Defining message format, CBOR takes precedence over JSON, CSV if both are 0 */
 #define MQTT_OUTPUT_FORMAT_JSON                         1
+#define MQTT_OUTPUT_FORMAT_CBOR                         0
+
+/** Windows collected into one publish, 1 publishes every window on its own */
+#if NBIOT_ENABLED
+#define mqtttaskBATCH_WINDOWS                           ( 10 )
+#else
+#define mqtttaskBATCH_WINDOWS                           ( 1 )
+#endif
+/** Batch size after which it is published without waiting for the remaining windows */
+#define mqtttaskBATCH_BUDGET                            ( 3072 )
+
+#define MQTT_BATCH_ENABLE                               ( ( mqtttaskBATCH_WINDOWS > 1 ) && ( MQTT_OUTPUT_FORMAT_CBOR || MQTT_OUTPUT_FORMAT_JSON ) )
+
+/** LZ4 payload compression with the compress.h dictionary, the receiver tells the frames from raw payloads by the first byte */
+#define mqtttaskCOMPRESSION_ENABLE                      ( 0 )
+
+/** QoS of the alarm windows, they go out on <topic>/alarm ahead of the routine windows queued before them */
+#define mqtttaskALARM_QOS                               ( eMQTTQoS1 )
+/** Shortest time in ms between two routine windows taken from the pool, 0 for no limit; over the window period the pool drops routine windows */
+#define mqtttaskBULK_PERIOD                             ( 0 )
+
+/**
+ * Payloads that could not be published go to the flash store and follow on <topic>/stored/<seq>[/<age ms>] after the reconnect.
+ * Off by default: the code runs from the same PFLASH, a sector erase stops the CPU and every interrupt for up to 5.5 s,
+ * see store_xmc4.c; the image must also fit below the store sectors, the linker script asserts it
+ */
+#define mqtttaskSTORE_ENABLE                            ( 0 )
+/** Catch-up pace, one stored payload per period while no live window is waiting */
+#define mqtttaskSTORE_DRAIN_PERIOD                      pdMS_TO_TICKS( 100 )
+
+/** QoS 1 windows on the way at once, each slot keeps a copy of its payload; 0 waits for every acknowledge before the next publish */
+#define mqtttaskINFLIGHT_MAX                            ( 4 )
+/** Retransmissions by the MQTT library of a pipelined publish without acknowledge, one per mqtttaskMQTT_TIMEOUT */
+#define mqtttaskPUBLISH_RETRY_LIMIT                     ( 2 )
+
+/** Publish interval, windows a batch and payload detail follow the signal, the acknowledge latency and the backlog, see xAdaptConfig */
+#define mqtttaskADAPT_ENABLE                            ( 1 )
+
+/** ms between the stage latency histograms on the debug UART and on <topic>/diag, 0 for none */
+#define mqtttaskLATENCY_REPORT_PERIOD                   ( 60000 )
+/** ms between the performance counters sent to Device Defender as custom metrics, the service takes one report per 5 minutes at most; 0 for none */
+#define mqtttaskMETRICS_PERIOD                          ( 3600000 )
+
+/** Acquisition settings from the device shadow, a delta is applied by the sensors task, saved to the EEPROM and reported back */
+#define mqtttaskSHADOW_ENABLE                           ( 1 )
+/** Longest wait for a window before the settings just applied are reported */
+#define mqtttaskSHADOW_POLL_PERIOD                      pdMS_TO_TICKS( 1000 )
+/** Wait after a failed delta subscription or shadow get, doubled on every failure up to the max */
+#define mqtttaskSHADOW_RETRY_MIN                        pdMS_TO_TICKS( 2000 )
+#define mqtttaskSHADOW_RETRY_MAX                        pdMS_TO_TICKS( 64000 )
+
+/** Raw samples of a parameter on request to infn/dev/<thing>/capture, chunks go on <topic>/raw/<transfer>/<seq> in the pauses of the telemetry */
+#define mqtttaskCAPTURE_ENABLE                          ( 1 )
+/** Shortest time between two chunks, none while windows, stored payloads or publishes in flight wait, nor on a poor link */
+#define mqtttaskCAPTURE_PERIOD                          pdMS_TO_TICKS( 200 )
+/** Bytes of a chunk, built in the alarm buffer; with its MQTT header it fits one TLS record, see get_optiga_certificate.c */
+#define mqtttaskCAPTURE_CHUNK_SIZE                      ( 4096 )
 
 /** Timeout for the TLS negotiation */
 #define mqtttaskMQTT_ECHO_TLS_NEGOTIATION_TIMEOUT       pdMS_TO_TICKS( 15000 )
 /** Timeout for MQTT operations */
 #define mqtttaskMQTT_TIMEOUT                            pdMS_TO_TICKS( 3000 )
-/** The number of items in the receive queue */
-#define mqtttaskRECEIVE_QUEUE_LENGTH                    ( 2 )
+/** Message buffers shared by the sensors and MQTT tasks: one being filled, one being encoded, the rest queued */
+#define mqtttaskMESSAGE_POOL_SIZE                       ( 4 )
+/** Which window is lost when the MQTT task falls behind, MSG_POOL_DROP_OLDEST or MSG_POOL_DROP_NEWEST */
+#define mqtttaskMESSAGE_DROP_POLICY                     ( MSG_POOL_DROP_OLDEST )
 /** Size of the buffer in which messages to the broker will be generated */
 #define mqtttaskSEND_BUFFER_SIZE                        ( 4096 )
 /** Stack allocated for the task */
@@ -56,17 +124,25 @@
 #define robusttaskPRIORITY                              ( tskIDLE_PRIORITY + 3 )
 /** Priority of the task */
 #define ROBUST_TASK_STACK_SIZE                   	    ( 1024 )
-/** Robust Task ping period */
+/** Period of the liveness checks, they use no air time as long as the connection is heard of */
 #if NBIOT_ENABLED
 #define ROBUST_DELAY                              	    ( 5000 )
 #else
 #define ROBUST_DELAY                              	    ( 3000 )
 #endif
+/** ms without an acknowledge or PINGRESP after which the link is probed, above the keep alive interval so a working connection isn't */
+#define mqtttaskLIVENESS_IDLE                           ( 120000 )
+
 /** ping timeout */
 #define PING_TIMEOUT                            	    ( 100 )
 /** ping retries */
 #define PING_COUNT                            	 	    ( 3 )
 
+/** Reconnect attempts at each tier before the next one, the board resets after the last tier */
+#define mqtttaskRECONNECT_RESUME_ATTEMPTS               ( 2 )
+#define mqtttaskRECONNECT_SOCKET_ATTEMPTS               ( 1 )
+#define mqtttaskRECONNECT_RADIO_ATTEMPTS                ( 1 )
+
 /** Network connection reestablishing retries period */
 #define RECONNECT_DELAY							 	    ( 10 )
 
@@ -82,6 +158,15 @@ typedef enum {
 } eConnectionState_t;
 
 
+/* Reconnect tiers, from the cheapest on */
+typedef enum {
+	eReconnectResume = 0,	/* Same link, cached broker address, TLS session resumed. */
+	eReconnectSocket,		/* Same link, fresh DNS lookup, full TLS handshake. */
+	eReconnectRadio			/* Network interface restarted. */
+
+} eReconnectTier_t;
+
+
 typedef enum {
 	ePingSuccess = 0,	/* Ping Success. */
 	ePingFail			/* Ping Fail. */
@@ -89,14 +174,16 @@ typedef enum {
 } ePingStatus_t;
 
 
-/* Queue for messages between sensors and mqtt tasks */
-extern QueueHandle_t xMQTTMessageQueueHandle;
+/* Message buffers passed by pointer between sensors and mqtt tasks, NULL until the MQTT connection is up */
+extern MsgPool_t *pxMQTTMessagePool;
 
 
 /** @brief Starts the MQTT task */
 void vMqttTaskStart( void );
 /** @brief Deletes the MQTT task */
 void vMqttTaskDelete( void );
+/** @brief Marks the connection alive, on acknowledges and PINGRESPs */
+void vMqttTaskAlive( void );
 
 /* Initialize network, manager and libraries */
 uint8_t ucNetworkInitialize( void );
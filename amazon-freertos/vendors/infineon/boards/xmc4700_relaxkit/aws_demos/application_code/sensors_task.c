@@ -29,6 +29,9 @@
 #include "mqtt_task.h"
 #include "statistic.h"
 #include "converting.h"
+#include "report.h"
+#include "settings.h"
+#include "capture.h"
 #include "app_error.h"
 
 #include "DAVE.h"
@@ -38,10 +41,12 @@
 #include "LTC4332/ltc4332.h"
 
 
-/* Package for MQTT */
-static InfineonSensorsMessage_t xSensorsMessage;
 /* Current sensor statistics and raw value buffers */
 static InfineonSensorsData_t xSensorsData;
+/* Stages of the window being processed, it goes with the message */
+static LatencyTrace_t xWindowTrace;
+/* Acquisition settings the sensors run with, from the shadow */
+static Settings_t xSettings;
 
 
 /** Handle for the Sensors Task */
@@ -59,6 +64,7 @@ typedef enum {
 
 
 static SensorsProcessStatus_t xSensorsProcess( InfineonSensorsData_t *pxSensorsData );
+static bool prvAlarm( bool bOn, bool bReady, const ClassifierData_t *pxClass );
 
 
 void vSensorsTaskStart( void )
@@ -96,6 +102,7 @@ void vSensorsTaskDelete( void )
 void prvSensorsTask( void *pvParameters )
 {
 	SensorsProcessStatus_t xProcessCompleteFlag = PROCESS_IN_PROGRESS;
+	uint32_t ulDroppedLast = 0;
 
 	/* Restore serial interfaces buses, needed to stabilize */
 	vSerialInterfaceRestore();
@@ -115,23 +122,77 @@ void prvSensorsTask( void *pvParameters )
 	vSensorsPreInit();
 	vSensorsInit();
 
+	/* Settings of the last run saved after a shadow delta, else those of sensors_config.h */
+	vSensorsSettingsGet( &xSettings );
+	xSettings.bSpectra = true;
+	xSettings.ucAlarmPercent = ( uint8_t )( sensorstaskALARM_PROBABILITY * 100.0f + 0.5f );
+	vSensorsSettingsLink();
+	if( SETTINGS_bLoad( &xSettings, &SETTINGS_xEeprom ) )
+	{
+		configPRINTF( ("Settings restored from the EEPROM\r\n") );
+	}
+	vSensorsSettingsSet( &xSettings );
+	SETTINGS_vApplied( &xSettings, false );
+
 	/* Delay is necessary to stabilize the sensors after power-on and initialization */
     vTaskDelay( 1000 );
 
     for( ;; ) 
 	{
+		/* A delta from the shadow is applied between two reads, the MQTT task saves and reports it */
+		if( SETTINGS_bTake( &xSettings ) )
+		{
+			vSensorsSettingsSet( &xSettings );
+			SETTINGS_vApplied( &xSettings, true );
+			configPRINTF( ("Settings applied from the shadow\r\n") );
+		}
+
     	/* Reading data from sensors and processing */
     	xProcessCompleteFlag = xSensorsProcess( &xSensorsData );
 
-		if( xProcessCompleteFlag && xMQTTMessageQueueHandle )
+		/* A routine window the link controller leaves out takes no buffer, nor goes through the deadband filter */
+		bool bAlarm = false;
+		if( xProcessCompleteFlag && pxMQTTMessagePool )
+		{
+			bAlarm = prvAlarm( xSensorsData.bClassifierOn, xSensorsData.bClassifierReady, &xSensorsData.xClassifier );
+			if( !ADAPT_bWindowDue( bAlarm ) )
+			{
+				xProcessCompleteFlag = PROCESS_IN_PROGRESS;
+			}
+		}
+
+		if( xProcessCompleteFlag && pxMQTTMessagePool )
 		{
-			/* Converting */
-			vSensorsDataToMessage( &xSensorsData, &xSensorsMessage );
+			/* Don't wait, in case the MQTT task is busy the pool drop policy decides which window is lost */
+			InfineonSensorsMessage_t *pxSensorsMessage = MSG_POOL_pxAcquire( pxMQTTMessagePool );
 
-			/* Don't wait, in case it is busy - skip */
-			if( xQueueSend( xMQTTMessageQueueHandle, &xSensorsMessage, ( TickType_t )1 ) != pdTRUE )
+			/* A lost window leaves the receiver with old values, resend everything */
+			MsgPoolStat_t xPoolStat;
+			MSG_POOL_vStatGet( pxMQTTMessagePool, &xPoolStat );
+			if( ( xPoolStat.ulDroppedOldest + xPoolStat.ulDroppedNewest ) != ulDroppedLast )
 			{
-				configPRINTF( ("ERROR: Send Sensors Data to Message Queue\r\n") );
+				ulDroppedLast = xPoolStat.ulDroppedOldest + xPoolStat.ulDroppedNewest;
+				REPORT_vSnapshotForce();
+			}
+
+			if( pxSensorsMessage != NULL )
+			{
+				/* Converting in place */
+				vSensorsDataToMessage( &xSensorsData, pxSensorsMessage );
+				pxSensorsMessage->ulTimestamp = ( uint32_t )xTaskGetTickCount();
+				pxSensorsMessage->bAlarm = bAlarm;
+				pxSensorsMessage->xTrace = xWindowTrace;
+#if( REPORT_BY_EXCEPTION_ENABLE > 0 )
+				/* Leave out the parameters that stayed within their deadbands */
+				REPORT_vFilter( pxSensorsMessage );
+#endif
+				LATENCY_vStamp( &pxSensorsMessage->xTrace, LATENCY_QUEUE_IN );
+				/* Alarms overtake the routine windows queued for the MQTT task */
+				MSG_POOL_vPost( pxMQTTMessagePool, pxSensorsMessage, pxSensorsMessage->bAlarm ? MSG_POOL_LANE_HIGH : MSG_POOL_LANE_BULK );
+			}
+			else
+			{
+				configPRINTF( ("ERROR: No free message buffer, window dropped\r\n") );
 			}
 
 			xProcessCompleteFlag = PROCESS_IN_PROGRESS;
@@ -148,64 +209,79 @@ static SensorsProcessStatus_t xSensorsProcess( InfineonSensorsData_t *pxSensorsD
 	SensorsProcessStatus_t xRet = PROCESS_IN_PROGRESS;
 	int32_t lReadError = 0;
 
-	static uint32_t ulTick = 0;
-	static TickType_t prevStamp = 0;
+	TickType_t xNow = xTaskGetTickCount();
 
-	/* Reading data from sensors directly per tick */
-	if( ulTick < SENSORS_VECTOR_LEN )
+	/* Reading data from sensors directly, each sensor at its own sample period */
+	vSensorsRead( pxSensorsData, ( uint32_t )xNow );
+
+	/* Raw samples of the parameter asked for, they stay in RAM until a request comes */
+	uint32_t ulSampleTick;
+	float fSample;
+	if( bSensorsSampleNew( CAPTURE_ucParameter(), pxSensorsData, &ulSampleTick, &fSample ) )
 	{
-		vSensorsRead( pxSensorsData, ulTick );
-		ulTick++;
+		CAPTURE_vAdd( ulSampleTick, fSample );
 	}
 
-	/* Perform post-processing after the vector is filled and the period time has passed */
-    if( ( xTaskGetTickCount() - prevStamp ) > SEND_PERIOD_MS )
+	/* Perform post-processing for the sensors whose send period has passed */
+    if( bSensorsWindowClose( ( uint32_t )xNow ) )
     {
-    	if( prevStamp != 0 )
-    	{
-    		/* Read data from the buffer non-tick sensors - microphone */
-    		vNonTickSensorsRead( pxSensorsData );
+		LATENCY_vStamp( &xWindowTrace, LATENCY_WINDOW );
 
-    		/* Check for the number of errors in read loop */
-    		lReadError = lSensorsReadErrorCheck( ulTick );
+		/* Read data from the buffer non-tick sensors - microphone */
+		vNonTickSensorsRead( pxSensorsData );
+		LATENCY_vStamp( &xWindowTrace, LATENCY_SPECTRA );
 
-    		/* Console output headline */
-			if( SHOW_SENSOR_OUTPUT )
-			{
+		/* Check for the number of errors in read loop */
+		lReadError = lSensorsReadErrorCheck();
 
-				configPRINTF( ("\e[1;1H\e[2J") );
-				configPRINTF( ("--------------------------------------------------\r\n") );
-				configPRINTF( ("timestamp %5d\r\n", xTaskGetTickCount()) );
-				configPRINTF( ("--------------------------------------------------\r\n") );
+		/* Console output headline */
+		if( SHOW_SENSOR_OUTPUT )
+		{
 
-				/* delay for logging */
-				vTaskDelay( 15 );
-				configPRINTF( ("length = %d, sensors = %d, vector len = %d\r\n", 6, ( PARAMETERS_NUMBER ), ulTick) );
-			}
+			configPRINTF( ("\e[1;1H\e[2J") );
+			configPRINTF( ("--------------------------------------------------\r\n") );
+			configPRINTF( ("timestamp %5d\r\n", xTaskGetTickCount()) );
+			configPRINTF( ("--------------------------------------------------\r\n") );
 
-			/* Calculating and console printing statistics */
-			vSensorsStatCalculation( pxSensorsData, ulTick );
+			/* delay for logging */
+			vTaskDelay( 15 );
+		}
 
-			/* Console output new empty line */
-			if( SHOW_SENSOR_OUTPUT )
-			{
-				configPRINTF( ("\r\n") );
-			}
+		/* Calculating and console printing statistics */
+		vSensorsStatCalculation( pxSensorsData );
 
-			if( lReadError == 0 )
-			{
-				/* Checking availability of sensors before sending data */
-				vSensorsAvailability( pxSensorsData );
-				xRet = PROCESS_COMPLETED;
-			}
+		/* Calculating values derived from several sensors */
+		vSensorsDerivedCalculation( pxSensorsData );
+		LATENCY_vStamp( &xWindowTrace, LATENCY_STATS );
 
-    	}
+		/* Console output new empty line */
+		if( SHOW_SENSOR_OUTPUT )
+		{
+			configPRINTF( ("\r\n") );
+		}
 
-    	/* Reset and start the time counter */
-        ulTick = 0;
-        prevStamp = xTaskGetTickCount();
+		if( lReadError == 0 )
+		{
+			/* Checking availability of sensors before sending data */
+			vSensorsAvailability( pxSensorsData );
+			xRet = PROCESS_COMPLETED;
+		}
 
+		/* Open new windows for the sensors just processed */
+		vSensorsWindowRestart( ( uint32_t )xNow );
     }
 
     return xRet;
 }
+
+
+/* Window the classifier confidently puts out of the normal class, it shouldn't wait for a batch */
+static bool prvAlarm( bool bOn, bool bReady, const ClassifierData_t *pxClass )
+{
+	if( !bOn || !bReady || ( pxClass->ucLabel >= pxClass->ucClasses ) )
+	{
+		return false;
+	}
+
+	return ( pxClass->ucLabel != sensorstaskNORMAL_CLASS ) && ( pxClass->pfProb[pxClass->ucLabel] * 100.0f >= ( float )xSettings.ucAlarmPercent );
+}
@@ -35,14 +35,16 @@
 #include "semphr.h"
 
 
-/* Time between sending messages */
-#define SEND_PERIOD_MS 					( 1000 )
-
 /** Stack allocated for the task */
 #define sensorstaskSTACK_SIZE           ( 4096 )
 /** Priority of the task */
 #define sensorstaskPRIORITY             ( tskIDLE_PRIORITY + 2 )
 
+/** Classifier label of the normal operation, any other label is an alarm */
+#define sensorstaskNORMAL_CLASS         ( 0 )
+/** Probability of the label from which the window is an alarm, the shadow alarm_percent overrides it */
+#define sensorstaskALARM_PROBABILITY    ( 0.8f )
+
 
 /** @brief Starts the Sensors task */
 void vSensorsTaskStart( void );
@@ -0,0 +1,189 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#include <stdbool.h>
+#include <string.h>
+
+#include "adapt_test.h"
+#include "adapt.h"
+
+#include "iot_demo_logging.h"
+
+
+#define ADAPT_TEST_HOLD			( 3 )
+
+
+static const AdaptConfig_t xTestConfig = {
+	.sSignalFair = -70,
+	.sSignalPoor = -80,
+	.ulLatencyFair = 1000,
+	.ulLatencyPoor = 3000,
+	.ulBacklogFair = 3,
+	.ulBacklogPoor = 8,
+	.ucHold = ADAPT_TEST_HOLD,
+	.xPolicy = {
+		[ADAPT_LINK_GOOD] = { 1, 1, MSG_DETAIL_FULL },
+		[ADAPT_LINK_FAIR] = { 2, 2, MSG_DETAIL_FEATURES },
+		[ADAPT_LINK_POOR] = { 4, 4, MSG_DETAIL_STATS },
+	},
+};
+
+
+static AdaptLink_t prvLink( void )
+{
+	AdaptStat_t xStat;
+
+	ADAPT_vStatGet( &xStat );
+
+	return xStat.xLink;
+}
+
+
+/* Routine windows due out of ucWindows */
+static uint8_t prvDue( uint8_t ucWindows )
+{
+	uint8_t ucDue = 0;
+
+	for( uint8_t i = 0; i < ucWindows; i++ )
+	{
+		ucDue += ADAPT_bWindowDue( false );
+	}
+
+	return ucDue;
+}
+
+
+/* Without a configuration everything goes out in full */
+static bool prvDefaultTest( void )
+{
+	AdaptPolicy_t xPolicy;
+
+	ADAPT_vInit( NULL );
+	ADAPT_vSignal( -120 );
+	ADAPT_vPolicyGet( &xPolicy );
+
+	return !ADAPT_bUpdate( 100 ) && ( xPolicy.ucInterval == 1 ) && ( xPolicy.xDetail == MSG_DETAIL_FULL ) && ( prvDue( 5 ) == 5 );
+}
+
+
+/* Down at once on the worst input, up one level after ADAPT_TEST_HOLD better updates in a row */
+static bool prvLevelTest( void )
+{
+	ADAPT_vInit( &xTestConfig );
+
+	/* Nothing known, only the backlog counts */
+	if( ADAPT_bUpdate( 0 ) || ( prvLink() != ADAPT_LINK_GOOD ) )
+	{
+		return false;
+	}
+
+	/* The first sample is taken as it is */
+	ADAPT_vSignal( -75 );
+	if( !ADAPT_bUpdate( 0 ) || ( prvLink() != ADAPT_LINK_FAIR ) )
+	{
+		return false;
+	}
+
+	/* A backlog spike goes straight to poor */
+	if( !ADAPT_bUpdate( 8 ) || ( prvLink() != ADAPT_LINK_POOR ) )
+	{
+		return false;
+	}
+
+	/* Back to fair after the hold, an update at the same level in between starts the count again */
+	if( ADAPT_bUpdate( 0 ) || ADAPT_bUpdate( 8 ) || ADAPT_bUpdate( 0 ) || ADAPT_bUpdate( 0 ) || !ADAPT_bUpdate( 0 ) ||
+		( prvLink() != ADAPT_LINK_FAIR ) )
+	{
+		return false;
+	}
+
+	/* Unknown signal samples don't move the average, strong ones move it a quarter of the way */
+	ADAPT_vSignal( 0 );
+	ADAPT_vSignal( -51 );
+	for( uint8_t i = 0; i < ADAPT_TEST_HOLD - 1; i++ )
+	{
+		if( ADAPT_bUpdate( 0 ) )
+		{
+			return false;
+		}
+	}
+	if( !ADAPT_bUpdate( 0 ) || ( prvLink() != ADAPT_LINK_GOOD ) )
+	{
+		return false;
+	}
+
+	/* A slow broker alone makes the link poor */
+	ADAPT_vLatency( 4000 );
+	if( !ADAPT_bUpdate( 0 ) || ( prvLink() != ADAPT_LINK_POOR ) )
+	{
+		return false;
+	}
+
+	AdaptStat_t xStat;
+	ADAPT_vStatGet( &xStat );
+
+	return ( xStat.sSignal == -69 ) && ( xStat.ulLatency == 4000 ) && ( xStat.ulChanges == 5 );
+}
+
+
+/* One of ucInterval routine windows goes out, alarms always and they start the count again */
+static bool prvIntervalTest( void )
+{
+	AdaptPolicy_t xPolicy;
+	AdaptStat_t xStat;
+
+	ADAPT_vInit( &xTestConfig );
+	ADAPT_vLatency( 4000 );
+	( void )ADAPT_bUpdate( 0 );
+	ADAPT_vPolicyGet( &xPolicy );
+	if( ( xPolicy.ucInterval != 4 ) || ( xPolicy.ucBatch != 4 ) || ( xPolicy.xDetail != MSG_DETAIL_STATS ) )
+	{
+		return false;
+	}
+
+	if( prvDue( 8 ) != 2 )
+	{
+		return false;
+	}
+
+	if( ( prvDue( 2 ) != 0 ) || !ADAPT_bWindowDue( true ) || ( prvDue( 3 ) != 0 ) || ( prvDue( 1 ) != 1 ) )
+	{
+		return false;
+	}
+
+	ADAPT_vStatGet( &xStat );
+
+	return xStat.ulSkipped == 11;
+}
+
+
+bool ADAPT_bTest( void )
+{
+	bool bRet = prvDefaultTest() && prvLevelTest() && prvIntervalTest();
+
+	/* The MQTT task configures the controller it uses */
+	ADAPT_vInit( NULL );
+
+	configPRINTF( ("Adapt test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
@@ -0,0 +1,180 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "batch_test.h"
+#include "cbor_sensor.h"
+#include "converting.h"
+
+#include "FreeRTOS.h"
+#include "iot_demo_logging.h"
+
+
+#define BATCH_TEST_NOW			( 4000000000UL )
+
+/* Room for a few windows only, the last one has to be refused */
+static uint8_t ucBatchBuffer[640];
+static InfineonSensorsMessage_t xBatchMessage;
+static BatchContext_t xTestBatch;
+
+
+static void prvMessageFill( void )
+{
+	memset( &xBatchMessage, 0, sizeof( xBatchMessage ) );
+
+	xBatchMessage.bOn[MSG_SENSOR_DPS368_1] = true;
+	xBatchMessage.bReady[MSG_SENSOR_DPS368_1] = true;
+	xBatchMessage.xStat[MSG_PARAMETER_DPS368_TEMP_1].fMean = 21.5f;
+	xBatchMessage.xStat[MSG_PARAMETER_DPS368_PRESS_1].fMean = 1013.25f;
+}
+
+
+/* Add windows one second apart until the buffer is full, returns the windows in the batch */
+static uint8_t prvBatchFill( void )
+{
+	uint32_t ulLen;
+
+	for( uint32_t i = 1; i < 255; i++ )
+	{
+		xBatchMessage.ulTimestamp = i * 1000;
+		ulLen = xTestBatch.ulLen;
+
+		if( !BATCH_bAdd( &xTestBatch, &xBatchMessage ) )
+		{
+			/* Refused window leaves nothing behind */
+			return ( xTestBatch.ulLen == ulLen ) ? xTestBatch.ucWindows : 0;
+		}
+	}
+
+	return 0;
+}
+
+
+static bool prvJsonTest( void )
+{
+	uint32_t ulLen = 0;
+	uint8_t ucWindows;
+	char *pcBatch = (char *)ucBatchBuffer;
+
+	if( !BATCH_bCreate( &xTestBatch, false, ucBatchBuffer, sizeof( ucBatchBuffer ) ) )
+	{
+		return false;
+	}
+
+	ucWindows = prvBatchFill();
+	if( ( ucWindows < 2 ) || ( strlen( pcBatch ) != xTestBatch.ulLen ) )
+	{
+		return false;
+	}
+
+	if( !BATCH_bFinish( &xTestBatch, BATCH_TEST_NOW, &ulLen ) || ( ulLen != strlen( pcBatch ) ) || ( ulLen >= sizeof( ucBatchBuffer ) ) )
+	{
+		return false;
+	}
+
+	return ( strncmp( pcBatch, "{\"1000\":{", 9 ) == 0 ) &&
+		   ( strcmp( &pcBatch[ulLen - 17], "\"now\":4000000000}" ) == 0 );
+}
+
+
+static bool prvCborTest( void )
+{
+	uint32_t ulLen = 0;
+	uint8_t ucWindows;
+	uint64_t ullKey, ullVal;
+	uint8_t ucCount = 0;
+	CborParser xParser;
+	CborValue xMsg, xMap, xWindows, xWindow;
+
+	if( !BATCH_bCreate( &xTestBatch, true, ucBatchBuffer, sizeof( ucBatchBuffer ) ) )
+	{
+		return false;
+	}
+
+	ucWindows = prvBatchFill();
+	if( ( ucWindows < 2 ) || !BATCH_bFinish( &xTestBatch, BATCH_TEST_NOW, &ulLen ) )
+	{
+		return false;
+	}
+
+	if( ( cbor_parser_init( ucBatchBuffer, ulLen, 0, &xParser, &xMsg ) != CborNoError ) ||
+		( cbor_value_validate_basic( &xMsg ) != CborNoError ) || ( cbor_value_enter_container( &xMsg, &xMap ) != CborNoError ) )
+	{
+		return false;
+	}
+
+	/* version, windows, now */
+	cbor_value_get_uint64( &xMap, &ullKey );
+	cbor_value_advance_fixed( &xMap );
+	cbor_value_get_uint64( &xMap, &ullVal );
+	cbor_value_advance_fixed( &xMap );
+	if( ( ullKey != CBOR_KEY_VERSION ) || ( ullVal != CBOR_SCHEMA_VERSION ) )
+	{
+		return false;
+	}
+
+	cbor_value_get_uint64( &xMap, &ullKey );
+	cbor_value_advance_fixed( &xMap );
+	if( ( ullKey != CBOR_KEY_WINDOWS ) || ( cbor_value_enter_container( &xMap, &xWindows ) != CborNoError ) )
+	{
+		return false;
+	}
+	while( !cbor_value_at_end( &xWindows ) )
+	{
+		if( cbor_value_enter_container( &xWindows, &xWindow ) != CborNoError )
+		{
+			return false;
+		}
+		cbor_value_get_uint64( &xWindow, &ullKey );
+		cbor_value_advance_fixed( &xWindow );
+		cbor_value_get_uint64( &xWindow, &ullVal );
+		if( ( ullKey != CBOR_KEY_TIMESTAMP ) || ( ullVal != ++ucCount * 1000ULL ) )
+		{
+			return false;
+		}
+		cbor_value_advance( &xWindows );
+	}
+	cbor_value_leave_container( &xMap, &xWindows );
+
+	cbor_value_get_uint64( &xMap, &ullKey );
+	cbor_value_advance_fixed( &xMap );
+	cbor_value_get_uint64( &xMap, &ullVal );
+
+	return ( ucCount == ucWindows ) && ( ullKey == CBOR_KEY_NOW ) && ( ullVal == BATCH_TEST_NOW );
+}
+
+
+bool BATCH_bTest( void )
+{
+	bool bRet;
+
+	prvMessageFill();
+
+	bRet = prvJsonTest() && prvCborTest();
+
+	configPRINTF( ("Batch test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
@@ -0,0 +1,267 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#include <stdbool.h>
+#include <string.h>
+
+#include "capture_test.h"
+#include "capture.h"
+#include "settings.h"
+
+#include "iot_demo_logging.h"
+
+
+/* Header and eight samples */
+#define CAPTURE_TEST_CHUNK		( sizeof( CaptureChunkHeader_t ) + 8 * sizeof( CaptureSample_t ) )
+
+static uint8_t ucChunk[CAPTURE_TEST_CHUNK];
+
+
+/* Sample periods the ring span follows, the microphone is read by DMA */
+static void prvSettings( void )
+{
+	Settings_t xSettings;
+
+	memset( &xSettings, 0, sizeof( xSettings ) );
+	xSettings.xSensor[MSG_SENSOR_DPS368_1] = ( SettingsSensor_t ){ true, 100, 50, 5000 };
+	xSettings.xSensor[MSG_SENSOR_TLI4971_1] = ( SettingsSensor_t ){ true, 1, 256, 1000 };
+	xSettings.xSensor[MSG_SENSOR_TLI493D_1] = ( SettingsSensor_t ){ true, 10, 100, 1000 };
+	xSettings.xSensor[MSG_SENSOR_IM69D130] = ( SettingsSensor_t ){ true, 0, 256, 1000 };
+	SETTINGS_vApplied( &xSettings, false );
+}
+
+
+/* Samples every 100 ms, the value is the tick */
+static void prvFill( uint32_t ulFrom, uint32_t ulTo )
+{
+	for( uint32_t ulTick = ulFrom; ulTick <= ulTo; ulTick += 100 )
+	{
+		CAPTURE_vAdd( ulTick, ( float )ulTick );
+	}
+}
+
+
+/* Chunks of the transfer in order, each checked against the samples from ulFirst on */
+static bool prvReceive( uint32_t ulFirst, uint32_t ulSamples, uint8_t ucParameter )
+{
+	CaptureChunkHeader_t xHeader;
+	CaptureSample_t xSample;
+	uint32_t ulReceived = 0;
+	uint16_t usChunks = ( uint16_t )( ( ulSamples + 7 ) / 8 );
+	uint32_t ulSpanMs = ( ulSamples > 1 ) ? ( ulSamples - 1 ) * 100 : 0;
+
+	if( usChunks == 0 )
+	{
+		usChunks = 1;
+	}
+
+	for( uint16_t usSeq = 0; usSeq < usChunks; usSeq++ )
+	{
+		uint32_t ulLen = CAPTURE_ulChunk( ucChunk, sizeof( ucChunk ), &xHeader );
+		uint32_t ulIn = ( ( ulSamples - ulReceived ) > 8 ) ? 8 : ( ulSamples - ulReceived );
+
+		if( ( ulLen != sizeof( CaptureChunkHeader_t ) + ulIn * sizeof( CaptureSample_t ) ) || ( xHeader.usSeq != usSeq ) ||
+			( xHeader.usChunks != usChunks ) || ( xHeader.usSamples != ulIn ) || ( xHeader.ucParameter != ucParameter ) ||
+			( xHeader.ucVersion != CAPTURE_VERSION ) || ( xHeader.ulSpanMs != ulSpanMs ) ||
+			( memcmp( ucChunk, &xHeader, sizeof( xHeader ) ) != 0 ) )
+		{
+			return false;
+		}
+
+		for( uint32_t i = 0; i < ulIn; i++ )
+		{
+			memcpy( &xSample, &ucChunk[sizeof( CaptureChunkHeader_t ) + i * sizeof( CaptureSample_t )], sizeof( xSample ) );
+			if( ( xSample.ulTick != ulFirst + ( ulReceived + i ) * 100 ) || ( xSample.fValue != ( float )xSample.ulTick ) )
+			{
+				return false;
+			}
+		}
+		ulReceived += ulIn;
+
+		CAPTURE_vAcked( xHeader.usTransfer, xHeader.usSeq );
+	}
+
+	return !CAPTURE_bBusy() && ( CAPTURE_ulChunk( ucChunk, sizeof( ucChunk ), &xHeader ) == 0 );
+}
+
+
+/* A new parameter waits for its seconds, then only the samples of the last seconds go */
+static bool prvWindowTest( void )
+{
+	CAPTURE_vInit();
+
+	if( !CAPTURE_bRequest( MSG_PARAMETER_DPS368_TEMP_1, 2, 1000 ) || ( CAPTURE_ucParameter() != MSG_PARAMETER_DPS368_TEMP_1 ) )
+	{
+		return false;
+	}
+
+	prvFill( 1000, 3000 );
+	if( CAPTURE_bStart( 2999, sizeof( ucChunk ) ) || !CAPTURE_bStart( 3000, sizeof( ucChunk ) ) || CAPTURE_bStart( 3000, sizeof( ucChunk ) ) )
+	{
+		return false;
+	}
+
+	/* The ring is frozen until the last chunk */
+	prvFill( 3100, 3500 );
+	if( !prvReceive( 1000, 21, MSG_PARAMETER_DPS368_TEMP_1 ) )
+	{
+		return false;
+	}
+
+	/* The same parameter again goes at once, the ring kept its samples */
+	if( !CAPTURE_bRequest( MSG_PARAMETER_DPS368_TEMP_1, 1, 3000 ) || !CAPTURE_bStart( 3000, sizeof( ucChunk ) ) )
+	{
+		return false;
+	}
+
+	return prvReceive( 2000, 11, MSG_PARAMETER_DPS368_TEMP_1 );
+}
+
+
+/* A chunk without acknowledge comes again, an acknowledge of another chunk or transfer is ignored */
+static bool prvResumeTest( void )
+{
+	CaptureChunkHeader_t xFirst;
+	CaptureChunkHeader_t xHeader;
+
+	CAPTURE_vInit();
+	( void )CAPTURE_bRequest( MSG_PARAMETER_TLI4971_CURRENT_1, 1, 0 );
+	prvFill( 0, 1000 );
+	if( !CAPTURE_bStart( 1000, sizeof( ucChunk ) ) )
+	{
+		return false;
+	}
+
+	/* No other request while a transfer is on */
+	if( CAPTURE_bRequest( MSG_PARAMETER_DPS368_TEMP_1, 1, 1000 ) )
+	{
+		return false;
+	}
+
+	( void )CAPTURE_ulChunk( ucChunk, sizeof( ucChunk ), &xFirst );
+	CAPTURE_vAcked( xFirst.usTransfer, 1 );
+	CAPTURE_vAcked( xFirst.usTransfer + 1, 0 );
+	( void )CAPTURE_ulChunk( ucChunk, sizeof( ucChunk ), &xHeader );
+	if( ( xHeader.usSeq != 0 ) || ( xHeader.usTransfer != xFirst.usTransfer ) )
+	{
+		return false;
+	}
+
+	/* A buffer below the chunk takes nothing */
+	if( CAPTURE_ulChunk( ucChunk, sizeof( ucChunk ) - 1, &xHeader ) != 0 )
+	{
+		return false;
+	}
+
+	return prvReceive( 0, 11, MSG_PARAMETER_TLI4971_CURRENT_1 );
+}
+
+
+/* A transfer without samples is one empty chunk, the samples beyond the ring are counted */
+static bool prvEdgeTest( void )
+{
+	CaptureStat_t xStat;
+
+	CAPTURE_vInit();
+	( void )CAPTURE_bRequest( MSG_PARAMETER_TLI493D_MAGNETIC_X_1, 1, 0 );
+	if( !CAPTURE_bStart( 1000, sizeof( ucChunk ) ) || !prvReceive( 0, 0, MSG_PARAMETER_TLI493D_MAGNETIC_X_1 ) )
+	{
+		return false;
+	}
+
+	for( uint32_t i = 0; i < CAPTURE_RING_SAMPLES + 10; i++ )
+	{
+		CAPTURE_vAdd( i, 0.0f );
+	}
+	CAPTURE_vStatGet( &xStat );
+
+	return ( xStat.ulOverwritten == 10 ) && ( xStat.ulRequests == 1 ) && ( xStat.ulTransfers == 1 ) && ( xStat.ulChunks == 1 );
+}
+
+
+/* Seconds beyond the ring at the sample period are cut, a parameter without single reads is rejected */
+static bool prvSpanTest( void )
+{
+	CaptureChunkHeader_t xHeader;
+
+	CAPTURE_vInit();
+	if( CAPTURE_bRequest( MSG_PARAMETER_IM69D_MIC_1, 1, 0 ) || CAPTURE_bRequest( MSG_PARAMETER_TLI4971_CURRENT_2, 1, 0 ) ||
+		!CAPTURE_bRequest( MSG_PARAMETER_TLI4971_CURRENT_1, 10, 0 ) )
+	{
+		return false;
+	}
+
+	/* The ring holds 2048 samples of 1 ms, two whole seconds */
+	prvFill( 0, 2000 );
+	if( CAPTURE_bStart( 1999, sizeof( ucChunk ) ) || !CAPTURE_bStart( 2000, sizeof( ucChunk ) ) ||
+		( CAPTURE_ulChunk( ucChunk, sizeof( ucChunk ), &xHeader ) == 0 ) || ( xHeader.usSeconds != 2 ) )
+	{
+		return false;
+	}
+
+	return prvReceive( 0, 21, MSG_PARAMETER_TLI4971_CURRENT_1 );
+}
+
+
+/* Parameter by its payload key, whole seconds within the limit */
+static bool prvCommandTest( void )
+{
+	static const char cGood[] = "{\"parameter\":\"DPS368Pressure_1\",\"seconds\":5}";
+	static const char *const pcBad[] = {
+		"{\"parameter\":\"DPS368Pressure\",\"seconds\":5}",
+		"{\"parameter\":\"DPS368Pressure_1\",\"seconds\":0}",
+		"{\"parameter\":\"DPS368Pressure_1\",\"seconds\":601}",
+		"{\"parameter\":\"DPS368Pressure_1\",\"seconds\":\"5\"}",
+		"{\"parameter\":\"DPS368Pressure_1\",\"xseconds\":5}",
+		"{\"parameter\":3,\"seconds\":5}",
+	};
+
+	CAPTURE_vInit();
+	for( uint32_t i = 0; i < sizeof( pcBad ) / sizeof( pcBad[0] ); i++ )
+	{
+		if( CAPTURE_bCommand( pcBad[i], strlen( pcBad[i] ), 0 ) )
+		{
+			return false;
+		}
+	}
+
+	return CAPTURE_bCommand( cGood, strlen( cGood ), 0 ) && ( CAPTURE_ucParameter() == MSG_PARAMETER_DPS368_PRESS_1 ) &&
+			!CAPTURE_bStart( 4999, sizeof( ucChunk ) ) && CAPTURE_bStart( 5000, sizeof( ucChunk ) );
+}
+
+
+bool CAPTURE_bTest( void )
+{
+	prvSettings();
+
+	bool bRet = prvWindowTest() && prvResumeTest() && prvEdgeTest() && prvSpanTest() && prvCommandTest();
+
+	/* Nothing selected for the sensors task, nothing to report for the MQTT task */
+	Settings_t xSettings;
+	bool bPersist;
+	CAPTURE_vInit();
+	( void )SETTINGS_bReport( &xSettings, &bPersist );
+
+	configPRINTF( ("Capture test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
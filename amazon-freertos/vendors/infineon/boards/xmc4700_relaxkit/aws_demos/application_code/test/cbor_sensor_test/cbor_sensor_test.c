@@ -0,0 +1,256 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "cbor_sensor_test.h"
+#include "cbor_sensor.h"
+#include "json/json_sensor.h"
+#include "converting.h"
+
+#include "FreeRTOS.h"
+#include "iot_demo_logging.h"
+
+
+static uint8_t ucBufferCBOR[2048];
+static char cBufferJSON[4096];
+static InfineonSensorsMessage_t xSensorsMessage;
+
+
+typedef struct {
+	float fVal;
+	uint16_t usHalf;
+} CborHalfVector_t;
+
+static const CborHalfVector_t xHalfVectors[] = {
+	{ 0.0f,				0x0000 },
+	{ -0.0f,			0x8000 },
+	{ 1.0f,				0x3C00 },
+	{ -2.0f,			0xC000 },
+	{ 65504.0f,			0x7BFF },	/* largest half */
+	{ 65520.0f,			0x7C00 },	/* rounds up to inf */
+	{ 6.103515625e-05f,	0x0400 },	/* smallest normal */
+	{ 5.9604645e-08f,	0x0001 },	/* smallest subnormal */
+	{ 2.9802322e-08f,	0x0000 },	/* half of it, ties to even */
+	{ 1.0009765625f,	0x3C01 },
+	{ 1.00048828125f,	0x3C00 },	/* tie, even stays */
+	{ 1.00146484375f,	0x3C02 },	/* tie, odd goes up */
+	{ 0.1f,				0x2E66 },
+	{ INFINITY,			0x7C00 },
+};
+
+
+static bool prvHalfTest( void )
+{
+	for( uint32_t i = 0; i < BUF_LEN( xHalfVectors ); i++ )
+	{
+		if( CBOR_usFloatToHalf( xHalfVectors[i].fVal ) != xHalfVectors[i].usHalf )
+		{
+			configPRINTF( ("CBOR half vector %u: 0x%04x\r\n", i, CBOR_usFloatToHalf( xHalfVectors[i].fVal )) );
+			return false;
+		}
+	}
+
+	/* Every finite half survives the way back */
+	for( uint32_t i = 0; i < 0x10000; i++ )
+	{
+		if( ( ( i & 0x7C00 ) != 0x7C00 ) && ( CBOR_usFloatToHalf( CBOR_fHalfToFloat( i ) ) != i ) )
+		{
+			return false;
+		}
+	}
+
+	return isnan( CBOR_fHalfToFloat( CBOR_usFloatToHalf( NAN ) ) );
+}
+
+
+static bool prvFloatGet( CborValue *pxVal, float *pfVal )
+{
+	if( cbor_value_is_half_float( pxVal ) )
+	{
+		uint16_t usHalf;
+		cbor_value_get_half_float( pxVal, &usHalf );
+		*pfVal = CBOR_fHalfToFloat( usHalf );
+	}
+	else if( cbor_value_is_float( pxVal ) )
+	{
+		cbor_value_get_float( pxVal, pfVal );
+	}
+	else
+	{
+		return false;
+	}
+
+	return cbor_value_advance_fixed( pxVal ) == CborNoError;
+}
+
+
+static bool prvUintGet( CborValue *pxVal, uint64_t *pullVal )
+{
+	if( !cbor_value_is_unsigned_integer( pxVal ) )
+	{
+		return false;
+	}
+	cbor_value_get_uint64( pxVal, pullVal );
+
+	return cbor_value_advance_fixed( pxVal ) == CborNoError;
+}
+
+
+/* Encode one sensor and read it back with the tinycbor parser */
+static bool prvSensorTest( void )
+{
+	static const SensorContext_t xSensorCxtEmpty;
+	SensorContext_t xSensorCxt = xSensorCxtEmpty;
+	StatData_t xStat = { 1.0f, 2.5f, 0.1f, 1234.5678f, -3.0f, 65504.0f };
+	const float pfStat[] = { xStat.fMin, xStat.fMax, xStat.fMean, xStat.fRMS, xStat.fStdDev, xStat.fVariance };
+	FFTData_t xFft;
+	CborEncoder xEnc, xMap;
+	CborParser xParser;
+	CborValue xMsg, xSensor, xField, xItem;
+	uint64_t ullVal;
+	float fVal;
+	bool bOn = false;
+
+	for( uint32_t i = 0; i < BUF_LEN( xFft.data ); i++ )
+	{
+		xFft.data[i] = i * 1001;
+	}
+
+	xSensorCxt.bOn = 1;
+	xSensorCxt.bReady = 1;
+	xSensorCxt.pxStat = &xStat;
+	xSensorCxt.pxFft = &xFft;
+	xSensorCxt.ucId = JSON_STATISTIC_SENSOR_IM69D_MIC_1;
+
+	cbor_encoder_init( &xEnc, ucBufferCBOR, sizeof( ucBufferCBOR ), 0 );
+	if( ( cbor_encoder_create_map( &xEnc, &xMap, 1 ) != CborNoError ) || !CBOR_bSensorAdd( &xMap, &xSensorCxt ) ||
+			( cbor_encoder_close_container( &xEnc, &xMap ) != CborNoError ) )
+	{
+		return false;
+	}
+
+	if( ( cbor_parser_init( ucBufferCBOR, cbor_encoder_get_buffer_size( &xEnc, ucBufferCBOR ), 0, &xParser, &xMsg ) != CborNoError ) ||
+			( cbor_value_validate_basic( &xMsg ) != CborNoError ) || ( cbor_value_enter_container( &xMsg, &xSensor ) != CborNoError ) )
+	{
+		return false;
+	}
+	if( !prvUintGet( &xSensor, &ullVal ) || ( ullVal != CBOR_KEY_SENSOR_BASE + JSON_STATISTIC_SENSOR_IM69D_MIC_1 ) ||
+			( cbor_value_enter_container( &xSensor, &xField ) != CborNoError ) )
+	{
+		return false;
+	}
+
+	/* on, stat, fft */
+	if( !prvUintGet( &xField, &ullVal ) || ( ullVal != CBOR_KEY_ON ) || ( cbor_value_get_boolean( &xField, &bOn ) != CborNoError ) || !bOn )
+	{
+		return false;
+	}
+	cbor_value_advance_fixed( &xField );
+
+	if( !prvUintGet( &xField, &ullVal ) || ( ullVal != CBOR_KEY_STAT ) || ( cbor_value_enter_container( &xField, &xItem ) != CborNoError ) )
+	{
+		return false;
+	}
+	for( uint32_t i = 0; i < BUF_LEN( pfStat ); i++ )
+	{
+		/* Shortest form keeps every value exact */
+		if( !prvFloatGet( &xItem, &fVal ) || ( fVal != pfStat[i] ) )
+		{
+			return false;
+		}
+	}
+	if( !cbor_value_at_end( &xItem ) || ( cbor_value_leave_container( &xField, &xItem ) != CborNoError ) )
+	{
+		return false;
+	}
+
+	if( !prvUintGet( &xField, &ullVal ) || ( ullVal != CBOR_KEY_FFT ) || ( cbor_value_enter_container( &xField, &xItem ) != CborNoError ) )
+	{
+		return false;
+	}
+	for( uint32_t i = 0; i < BUF_LEN( xFft.data ); i++ )
+	{
+		if( !prvUintGet( &xItem, &ullVal ) || ( ullVal != xFft.data[i] ) )
+		{
+			return false;
+		}
+	}
+
+	return cbor_value_at_end( &xItem );
+}
+
+
+/* Whole message: version first, both formats generated from the same state */
+static bool prvMessageTest( void )
+{
+	CborParser xParser;
+	CborValue xMsg, xField;
+	uint32_t ulLen = 0, ulJsonLen = 0;
+	uint64_t ullVal;
+
+	/* Typical window: environment statistic and the microphone spectrum */
+	xSensorsMessage.bOn[MSG_SENSOR_DPS368_1] = xSensorsMessage.bReady[MSG_SENSOR_DPS368_1] = true;
+	xSensorsMessage.bOn[MSG_SENSOR_IM69D130] = xSensorsMessage.bReady[MSG_SENSOR_IM69D130] = true;
+	xSensorsMessage.xStat[MSG_PARAMETER_DPS368_TEMP_1] = (StatData_t){ 23.1f, 23.9f, 23.52f, 23.52f, 0.21f, 0.0441f };
+	xSensorsMessage.xStat[MSG_PARAMETER_DPS368_PRESS_1] = (StatData_t){ 101289.5f, 101322.2f, 101301.7f, 101301.7f, 8.3f, 68.89f };
+	xSensorsMessage.xStat[MSG_PARAMETER_IM69D_MIC_1] = (StatData_t){ -0.82f, 0.79f, 0.0013f, 0.31f, 0.31f, 0.0961f };
+	for( uint32_t i = 0; i < BUF_LEN( xSensorsMessage.xFft[MSG_SPECTRUM_IM69D_MIC_1].data ); i++ )
+	{
+		xSensorsMessage.xFft[MSG_SPECTRUM_IM69D_MIC_1].data[i] = ( i * 7919 ) % 2000;
+	}
+
+	if( !CBOR_bGenerateToSend( &xSensorsMessage, ucBufferCBOR, sizeof( ucBufferCBOR ), &ulLen ) ||
+			!JSON_bGenerateToSend( &xSensorsMessage, cBufferJSON, sizeof( cBufferJSON ), &ulJsonLen ) )
+	{
+		return false;
+	}
+
+	if( ( cbor_parser_init( ucBufferCBOR, ulLen, 0, &xParser, &xMsg ) != CborNoError ) ||
+			( cbor_value_validate_basic( &xMsg ) != CborNoError ) || !cbor_value_is_map( &xMsg ) ||
+			( cbor_value_enter_container( &xMsg, &xField ) != CborNoError ) )
+	{
+		return false;
+	}
+	if( !prvUintGet( &xField, &ullVal ) || ( ullVal != CBOR_KEY_VERSION ) || !prvUintGet( &xField, &ullVal ) ||
+			( ullVal != CBOR_SCHEMA_VERSION ) )
+	{
+		return false;
+	}
+
+	configPRINTF( ("CBOR %u bytes, JSON %u bytes\r\n", ulLen, ulJsonLen) );
+
+	return ulLen < ulJsonLen;
+}
+
+
+bool CBOR_bTest( void )
+{
+	bool bRet = prvHalfTest() && prvSensorTest() && prvMessageTest();
+
+	configPRINTF( ("CBOR test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
@@ -0,0 +1,375 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "classifier_test.h"
+#include "classifier.h"
+
+#include "FreeRTOS.h"
+#include "iot_demo_logging.h"
+
+
+#define CLASSIFIER_TEST_VECTORS		( 5 )
+#define CLASSIFIER_TEST_MODELS		( 2000 )	/* Random models against the reference */
+#define CLASSIFIER_TEST_RUNS		( 20 )		/* Feature vectors per random model */
+
+
+/**
+ * 4 inputs, 4x3 ReLU layer, 3x2 output layer. The expected logits are calculated
+ * with an independent integer reference of the arm_fully_connected_s8 arithmetic,
+ * the results have to match bit by bit.
+ */
+static const uint8_t ucClassifierTestModel[] __attribute__( ( aligned( 4 ) ) ) = {
+	0x43, 0x4C, 0x53, 0x31, 0x01, 0x00, 0x02, 0x02, 0x04, 0x00, 0x00, 0x00,
+	0x9C, 0x00, 0x00, 0x00, 0xB5, 0xFF, 0x8E, 0x04, 0x00, 0x00, 0x80, 0x3D,
+	0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x3E, 0xF6, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x40,
+	0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+	0x04, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xFF, 0xFF, 0xFF,
+	0x9A, 0x79, 0x82, 0x5A, 0xFF, 0xFF, 0xFF, 0xFF, 0x80, 0xFF, 0xFF, 0xFF,
+	0x7F, 0x00, 0x00, 0x00, 0x64, 0x00, 0x00, 0x00, 0x30, 0xF8, 0xFF, 0xFF,
+	0x5E, 0x01, 0x00, 0x00, 0x0C, 0xF9, 0x03, 0x64, 0x80, 0x37, 0x09, 0xFD,
+	0x2C, 0x2C, 0xD4, 0x01, 0x03, 0x00, 0x02, 0x00, 0x80, 0x00, 0x00, 0x00,
+	0x03, 0x00, 0x00, 0x00, 0xCD, 0xCC, 0xCC, 0x4C, 0xFA, 0xFF, 0xFF, 0xFF,
+	0x80, 0xFF, 0xFF, 0xFF, 0x7F, 0x00, 0x00, 0x00, 0xCE, 0xFF, 0xFF, 0xFF,
+	0x4B, 0x00, 0x00, 0x00, 0x05, 0xF7, 0x11, 0xEC, 0x1F, 0x02, 0x00, 0x00,
+};
+
+static const float pfTestFeatures[CLASSIFIER_TEST_VECTORS][4] = {
+	{ 1.0f, 2.5f, -3.0f, 10.0f },
+	{ 3.0f, 8.0f, 1.0f, 2.0f },
+	{ 0.5f, -4.0f, 6.0f, 0.25f },
+	{ 2.0f, 1.0f, -2.0f, 1.5f },
+	{ -7.25f, 0.0f, 12.0f, -1.0f },
+};
+
+static const int8_t pcTestLogits[CLASSIFIER_TEST_VECTORS][2] = {
+	{ 32, -42 },
+	{ 47, -7 },
+	{ 8, -17 },
+	{ 14, -22 },
+	{ 3, 4 },
+};
+
+/* Copy to corrupt one byte */
+static uint8_t ucModelCopy[sizeof( ucClassifierTestModel )] __attribute__( ( aligned( 4 ) ) );
+
+/* Largest random model: every layer CLASSIFIER_LAYER_OUTPUTS_MAX x CLASSIFIER_INPUTS_MAX */
+static uint32_t pulRandomModel[( sizeof( ClassifierHeader_t ) + CLASSIFIER_INPUTS_MAX * sizeof( ClassifierInput_t ) +
+		CLASSIFIER_LAYERS_MAX * ( sizeof( ClassifierLayer_t ) + CLASSIFIER_LAYER_OUTPUTS_MAX * ( sizeof( int32_t ) + CLASSIFIER_INPUTS_MAX ) ) ) / 4];
+static uint32_t ulRandom = 4700;
+
+
+static uint32_t prvRandom( void )
+{
+	ulRandom ^= ulRandom << 13;
+	ulRandom ^= ulRandom >> 17;
+	ulRandom ^= ulRandom << 5;
+
+	return ulRandom;
+}
+
+
+/* Uniform in lMin..lMax */
+static int32_t prvRange( int32_t lMin, int32_t lMax )
+{
+	return lMin + (int32_t)( prvRandom() % (uint32_t)( lMax - lMin + 1 ) );
+}
+
+
+/* Table driven CRC-32, the loader computes it bit by bit */
+static uint32_t prvRefCrc32( const uint8_t *pucData, uint32_t ulLen )
+{
+	static uint32_t pulTable[256];
+	uint32_t ulCrc = 0xFFFFFFFFUL;
+
+	if( pulTable[1] == 0 )
+	{
+		for( uint32_t n = 0; n < 256; n++ )
+		{
+			uint32_t c = n;
+			for( uint8_t k = 0; k < 8; k++ )
+			{
+				c = ( c & 1u ) ? ( 0xEDB88320UL ^ ( c >> 1 ) ) : ( c >> 1 );
+			}
+			pulTable[n] = c;
+		}
+	}
+
+	while( ulLen-- )
+	{
+		ulCrc = pulTable[( ulCrc ^ *pucData++ ) & 0xFF] ^ ( ulCrc >> 8 );
+	}
+
+	return ~ulCrc;
+}
+
+
+/**
+ * Reference requantization written from its definition instead of the CMSIS-NN helpers:
+ * round( acc * 2^left * multiplier / 2^31 ) half up, then / 2^right rounded half away from zero.
+ */
+static int32_t prvRefRequantize( int32_t lAcc, int32_t lMultiplier, int32_t lShift )
+{
+	int64_t llScaled = (int64_t)lAcc * ( (int64_t)1 << ( ( lShift > 0 ) ? lShift : 0 ) );
+	int64_t llHigh = ( 2 * llScaled * lMultiplier + ( (int64_t)1 << 31 ) ) >> 32;
+	int32_t lRight = ( lShift > 0 ) ? 0 : -lShift;
+
+	if( lRight == 0 )
+	{
+		return (int32_t)llHigh;
+	}
+	if( llHigh >= 0 )
+	{
+		return (int32_t)( ( llHigh + ( (int64_t)1 << ( lRight - 1 ) ) ) >> lRight );
+	}
+
+	return (int32_t)-( ( -llHigh + ( (int64_t)1 << ( lRight - 1 ) ) ) >> lRight );
+}
+
+
+/* Reference model, reads the blob through the structures of classifier.h only */
+static void prvRefRun( const uint8_t *pucBlob, const float *pfFeatures, int8_t *pcLogits )
+{
+	const ClassifierHeader_t *pxHeader = (const ClassifierHeader_t *)pucBlob;
+	const ClassifierInput_t *pxInput = (const ClassifierInput_t *)&pucBlob[sizeof( ClassifierHeader_t )];
+	uint32_t ulPos = sizeof( ClassifierHeader_t ) + pxHeader->usInputs * sizeof( ClassifierInput_t );
+	int32_t plIn[CLASSIFIER_INPUTS_MAX];
+	int32_t plOut[CLASSIFIER_LAYER_OUTPUTS_MAX];
+
+	for( uint16_t i = 0; i < pxHeader->usInputs; i++ )
+	{
+		long lQ = lroundf( pfFeatures[i] / pxInput[i].fScale ) + pxInput[i].lZeroPoint;
+		plIn[i] = ( lQ < -128 ) ? -128 : ( ( lQ > 127 ) ? 127 : (int32_t)lQ );
+	}
+
+	for( uint8_t l = 0; l < pxHeader->ucLayers; l++ )
+	{
+		const ClassifierLayer_t *pxLayer = (const ClassifierLayer_t *)&pucBlob[ulPos];
+		const int32_t *plBias = (const int32_t *)&pucBlob[ulPos + sizeof( ClassifierLayer_t )];
+		const int8_t *pcWeights = (const int8_t *)&plBias[pxLayer->usOutputs];
+
+		for( uint16_t o = 0; o < pxLayer->usOutputs; o++ )
+		{
+			int64_t llAcc = plBias[o];
+			for( uint16_t i = 0; i < pxLayer->usInputs; i++ )
+			{
+				llAcc += (int64_t)pcWeights[o * pxLayer->usInputs + i] * ( plIn[i] + pxLayer->lInputOffset );
+			}
+			int32_t lOut = prvRefRequantize( (int32_t)llAcc, pxLayer->lMultiplier, pxLayer->lShift ) + pxLayer->lOutputOffset;
+			plOut[o] = ( lOut < pxLayer->lActMin ) ? pxLayer->lActMin : ( ( lOut > pxLayer->lActMax ) ? pxLayer->lActMax : lOut );
+		}
+		memcpy( plIn, plOut, pxLayer->usOutputs * sizeof( int32_t ) );
+
+		ulPos += sizeof( ClassifierLayer_t ) + pxLayer->usOutputs * sizeof( int32_t ) + ( ( pxLayer->usOutputs * pxLayer->usInputs + 3u ) & ~3u );
+	}
+
+	for( uint8_t c = 0; c < pxHeader->ucClasses; c++ )
+	{
+		pcLogits[c] = (int8_t)plIn[c];
+	}
+}
+
+
+/**
+ * Random model within the loader limits. The accumulator stays below 2^23, so the left
+ * shift up to 6 cannot overflow the 32-bit product of arm_nn_requantize.
+ */
+static uint32_t prvRandomModel( uint8_t *pucBlob )
+{
+	ClassifierHeader_t *pxHeader = (ClassifierHeader_t *)pucBlob;
+	uint16_t usInputs = (uint16_t)prvRange( 1, CLASSIFIER_INPUTS_MAX );
+	uint32_t ulPos;
+
+	memset( pxHeader, 0, sizeof( ClassifierHeader_t ) );
+	pxHeader->ulMagic = CLASSIFIER_MAGIC;
+	pxHeader->usVersion = CLASSIFIER_VERSION;
+	pxHeader->ucLayers = (uint8_t)prvRange( 1, CLASSIFIER_LAYERS_MAX );
+	pxHeader->ucClasses = (uint8_t)prvRange( 2, CLASSIFIER_CLASSES_MAX );
+	pxHeader->usInputs = usInputs;
+	pxHeader->fOutputScale = 0.0625f;
+	ulPos = sizeof( ClassifierHeader_t );
+
+	for( uint16_t i = 0; i < usInputs; i++ )
+	{
+		ClassifierInput_t *pxInput = (ClassifierInput_t *)&pucBlob[ulPos];
+		pxInput->fScale = (float)prvRange( 1, 4000 ) / 1000.0f;
+		pxInput->lZeroPoint = prvRange( -20, 20 );
+		ulPos += sizeof( ClassifierInput_t );
+	}
+
+	for( uint8_t l = 0; l < pxHeader->ucLayers; l++ )
+	{
+		ClassifierLayer_t *pxLayer = (ClassifierLayer_t *)&pucBlob[ulPos];
+		int32_t *plBias = (int32_t *)&pucBlob[ulPos + sizeof( ClassifierLayer_t )];
+		int8_t *pcWeights;
+		uint32_t ulWeights;
+
+		pxLayer->usInputs = usInputs;
+		pxLayer->usOutputs = ( l == pxHeader->ucLayers - 1 ) ? pxHeader->ucClasses : (uint16_t)prvRange( 1, CLASSIFIER_LAYER_OUTPUTS_MAX );
+		pxLayer->lInputOffset = prvRange( -127, 128 );
+		pxLayer->lOutputOffset = prvRange( -128, 127 );
+		pxLayer->lMultiplier = (int32_t)( 0x40000000UL + ( prvRandom() & 0x3FFFFFFFUL ) );
+		pxLayer->lShift = prvRange( -24, 6 );
+		pxLayer->lActMin = prvRange( -128, 0 );
+		pxLayer->lActMax = prvRange( 0, 127 );
+		for( uint16_t o = 0; o < pxLayer->usOutputs; o++ )
+		{
+			plBias[o] = prvRange( -( 1 << 20 ), 1 << 20 );
+		}
+		pcWeights = (int8_t *)&plBias[pxLayer->usOutputs];
+		ulWeights = (uint32_t)pxLayer->usOutputs * pxLayer->usInputs;
+		for( uint32_t w = 0; w < ( ( ulWeights + 3u ) & ~3u ); w++ )
+		{
+			pcWeights[w] = ( w < ulWeights ) ? (int8_t)prvRange( -128, 127 ) : 0;
+		}
+
+		ulPos += sizeof( ClassifierLayer_t ) + pxLayer->usOutputs * sizeof( int32_t ) + ( ( ulWeights + 3u ) & ~3u );
+		usInputs = pxLayer->usOutputs;
+	}
+
+	pxHeader->ulSize = ulPos;
+	pxHeader->ulCrc = prvRefCrc32( &pucBlob[sizeof( ClassifierHeader_t )], ulPos - sizeof( ClassifierHeader_t ) );
+
+	return ulPos;
+}
+
+
+/* Random models and features, the logits have to match the reference bit by bit */
+static bool prvReferenceTest( void )
+{
+	uint8_t *pucBlob = (uint8_t *)pulRandomModel;
+	const ClassifierHeader_t *pxHeader = (const ClassifierHeader_t *)pucBlob;
+	const ClassifierInput_t *pxInput = (const ClassifierInput_t *)&pucBlob[sizeof( ClassifierHeader_t )];
+	float pfFeatures[CLASSIFIER_INPUTS_MAX];
+	int8_t pcLogits[CLASSIFIER_CLASSES_MAX];
+	int8_t pcRefLogits[CLASSIFIER_CLASSES_MAX];
+	uint32_t ulValues = 0;
+
+	for( uint32_t m = 0; m < CLASSIFIER_TEST_MODELS; m++ )
+	{
+		if( CLASSIFIER_lLoad( pucBlob, prvRandomModel( pucBlob ) ) != 0 )
+		{
+			configPRINTF( ("CLASSIFIER: random model %u not loaded\r\n", m) );
+			return false;
+		}
+
+		for( uint32_t r = 0; r < CLASSIFIER_TEST_RUNS; r++ )
+		{
+			/* Mostly in range, some clamped at both ends */
+			for( uint16_t i = 0; i < pxHeader->usInputs; i++ )
+			{
+				pfFeatures[i] = (float)prvRange( -160000, 160000 ) / 1000.0f * pxInput[i].fScale;
+			}
+
+			prvRefRun( pucBlob, pfFeatures, pcRefLogits );
+			if( ( CLASSIFIER_lRunQ( pfFeatures, pxHeader->usInputs, pcLogits ) != 0 ) ||
+				( memcmp( pcLogits, pcRefLogits, pxHeader->ucClasses ) != 0 ) )
+			{
+				configPRINTF( ("CLASSIFIER: random model %u run %u differs from the reference\r\n", m, r) );
+				return false;
+			}
+			ulValues += pxHeader->ucClasses;
+		}
+	}
+
+	configPRINTF( ("CLASSIFIER: %u models, %u logits bit exact\r\n", CLASSIFIER_TEST_MODELS, ulValues) );
+
+	return true;
+}
+
+
+bool CLASSIFIER_bTest( void )
+{
+	bool bRet = false;
+	int8_t pcLogits[CLASSIFIER_CLASSES_MAX];
+	ClassifierData_t xResult;
+	uint8_t i;
+
+	while( 1 )
+	{
+		if( CLASSIFIER_lLoad( ucClassifierTestModel, sizeof( ucClassifierTestModel ) ) != 0 )
+		{
+			configPRINTF( ("CLASSIFIER: test model not loaded\r\n") );
+			break;
+		}
+
+		for( i = 0; i < CLASSIFIER_TEST_VECTORS; i++ )
+		{
+			if( ( CLASSIFIER_lRunQ( pfTestFeatures[i], 4, pcLogits ) != 0 ) || ( memcmp( pcLogits, pcTestLogits[i], 2 ) != 0 ) )
+			{
+				configPRINTF( ("CLASSIFIER: vector %u: %d %d, expected %d %d\r\n", i, pcLogits[0], pcLogits[1], pcTestLogits[i][0], pcTestLogits[i][1]) );
+				break;
+			}
+		}
+		if( i < CLASSIFIER_TEST_VECTORS )
+		{
+			break;
+		}
+
+		/* ( 32 - 3 ) / 16 vs ( -42 - 3 ) / 16 */
+		if( ( CLASSIFIER_lRun( pfTestFeatures[0], 4, &xResult ) != 0 ) || ( xResult.ucLabel != 0 ) ||
+			( xResult.pfProb[0] < 0.99f ) || ( xResult.pfProb[0] + xResult.pfProb[1] > 1.0001f ) )
+		{
+			configPRINTF( ("CLASSIFIER: softmax\r\n") );
+			break;
+		}
+
+		/* Wrong number of features */
+		if( CLASSIFIER_lRunQ( pfTestFeatures[0], 3, pcLogits ) == 0 )
+		{
+			configPRINTF( ("CLASSIFIER: feature count not checked\r\n") );
+			break;
+		}
+
+		/* Damaged blob is rejected */
+		memcpy( ucModelCopy, ucClassifierTestModel, sizeof( ucModelCopy ) );
+		ucModelCopy[sizeof( ucModelCopy ) - 5] ^= 0x01;
+		if( CLASSIFIER_lLoad( ucModelCopy, sizeof( ucModelCopy ) ) == 0 )
+		{
+			configPRINTF( ("CLASSIFIER: CRC not checked\r\n") );
+			break;
+		}
+
+		if( CLASSIFIER_lLoadDefault() != 0 )
+		{
+			configPRINTF( ("CLASSIFIER: default model not loaded\r\n") );
+			break;
+		}
+
+		if( !prvReferenceTest() )
+		{
+			break;
+		}
+
+		bRet = true;
+		break;
+	}
+
+	configPRINTF( ("CLASSIFIER test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
@@ -0,0 +1,274 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "compress_test.h"
+#include "compress.h"
+#include "converting.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "iot_demo_logging.h"
+
+
+/* A minute of the device, one window a second */
+#define COMP_TEST_SESSION			( 60 )
+/* Windows of a batch payload */
+#define COMP_TEST_BATCH				( 5 )
+#define COMP_TEST_PAYLOAD_SIZE		( 4096 )
+#define COMP_TEST_RECORD_SIZE		( COMP_TEST_SESSION * COMP_TEST_PAYLOAD_SIZE )
+/* Passes over a recording for the throughput */
+#define COMP_TEST_REPEAT			( 50 )
+
+/* Payloads of one encoder back to back, as the device would publish them */
+typedef struct {
+	const char *pcName;
+	uint32_t ulCount;
+	uint32_t pulLen[COMP_TEST_SESSION];
+	uint8_t ucData[COMP_TEST_RECORD_SIZE];
+} CompRecord_t;
+
+
+static uint8_t ucPayload[0x10000];
+static uint8_t ucFrame[COMP_BOUND( sizeof( ucPayload ) )];
+static uint8_t ucBack[sizeof( ucPayload )];
+static InfineonSensorsMessage_t xCompMessage;
+static CompRecord_t xRecord;
+static BatchContext_t xBatch;
+static uint32_t ulSeed = 2021;
+
+
+static uint32_t prvRandom( void )
+{
+	ulSeed = ulSeed * 1664525UL + 1013904223UL;
+	return ulSeed >> 8;
+}
+
+
+/* Noise of +-fRange */
+static float prvNoise( float fRange )
+{
+	return fRange * ( ( float )( prvRandom() % 2001 ) / 1000.0f - 1.0f );
+}
+
+
+/* Every sensor on, statistics drifting around their mean, the microphone with a decaying spectrum */
+static void prvMessageFill( uint32_t ulSecond )
+{
+	memset( &xCompMessage, 0, sizeof( xCompMessage ) );
+
+	for( uint32_t i = 0; i < MSG_SENSOR_MAX; i++ )
+	{
+		xCompMessage.bOn[i] = true;
+		xCompMessage.bReady[i] = true;
+	}
+	for( uint32_t i = 0; i < MSG_PARAMETER_MAX; i++ )
+	{
+		float fMean = 20.0f + 3.7f * i + 0.002f * ulSecond + prvNoise( 0.05f );
+		float fStdDev = 0.12f + prvNoise( 0.01f );
+
+		xCompMessage.xStat[i].fMean = fMean;
+		xCompMessage.xStat[i].fMin = fMean - 2.0f * fStdDev + prvNoise( 0.02f );
+		xCompMessage.xStat[i].fMax = fMean + 2.0f * fStdDev + prvNoise( 0.02f );
+		xCompMessage.xStat[i].fRMS = fMean + 0.01f;
+		xCompMessage.xStat[i].fStdDev = fStdDev;
+		xCompMessage.xStat[i].fVariance = fStdDev * fStdDev;
+	}
+	for( uint32_t i = 0; i < BUF_LEN( xCompMessage.xFft[MSG_SPECTRUM_IM69D_MIC_1].data ); i++ )
+	{
+		xCompMessage.xFft[MSG_SPECTRUM_IM69D_MIC_1].data[i] = 3000 / ( 1 + i / 4 ) + prvRandom() % 29;
+	}
+	xCompMessage.ulTimestamp = 1000 * ( ulSecond + 1 );
+}
+
+
+/* Payloads of a session through one of the encoders, 3 JSON, CBOR and CSV, 0 JSON batches */
+static bool prvRecord( const char *pcName, uint8_t ucEncoder )
+{
+	uint32_t ulPos = 0, ulLen = 0;
+	bool bOk = true;
+
+	ulSeed = 2021;
+	xRecord.pcName = pcName;
+	xRecord.ulCount = 0;
+
+	for( uint32_t ulSecond = 0; bOk && ( ulSecond < COMP_TEST_SESSION ); ulSecond++ )
+	{
+		uint8_t *pucOut = &xRecord.ucData[ulPos];
+
+		prvMessageFill( ulSecond );
+		switch( ucEncoder )
+		{
+			case 0:
+				if( ulSecond % COMP_TEST_BATCH == 0 )
+				{
+					bOk = BATCH_bCreate( &xBatch, false, pucOut, COMP_TEST_PAYLOAD_SIZE * COMP_TEST_BATCH );
+				}
+				bOk = bOk && BATCH_bAdd( &xBatch, &xCompMessage );
+				if( ulSecond % COMP_TEST_BATCH != COMP_TEST_BATCH - 1 )
+				{
+					continue;
+				}
+				bOk = bOk && BATCH_bFinish( &xBatch, xCompMessage.ulTimestamp, &ulLen );
+				break;
+			case 1:
+				bOk = JSON_bGenerateToSend( &xCompMessage, ( char * )pucOut, COMP_TEST_PAYLOAD_SIZE, &ulLen );
+				break;
+			case 2:
+				bOk = CBOR_bGenerateToSend( &xCompMessage, pucOut, COMP_TEST_PAYLOAD_SIZE, &ulLen );
+				break;
+			default:
+				bOk = CSV_bGenerateToSend( &xCompMessage, pucOut, COMP_TEST_PAYLOAD_SIZE, &ulLen );
+				break;
+		}
+		xRecord.pulLen[xRecord.ulCount++] = ulLen;
+		ulPos += ulLen;
+	}
+
+	return bOk;
+}
+
+
+/* Round trip of every payload of the recording, with the ratio and the speed both ways */
+static bool prvRecordTest( void )
+{
+	uint32_t ulIn = 0, ulOut = 0, ulPos, ulFrame = 0;
+	TickType_t xCompTicks, xDecompTicks, xStart;
+
+	ulPos = 0;
+	for( uint32_t i = 0; i < xRecord.ulCount; i++ )
+	{
+		const uint8_t *pucIn = &xRecord.ucData[ulPos];
+
+		ulFrame = COMP_ulCompress( pucIn, xRecord.pulLen[i], ucFrame, sizeof( ucFrame ) );
+		if( ( ulFrame == 0 ) || ( ulFrame >= xRecord.pulLen[i] ) ||
+			( COMP_lDecompress( ucFrame, ulFrame, ucBack, sizeof( ucBack ) ) != ( int32_t )xRecord.pulLen[i] ) ||
+			memcmp( pucIn, ucBack, xRecord.pulLen[i] ) )
+		{
+			configPRINTF( ("%s payload %u of %u bytes failed\r\n", xRecord.pcName, i, xRecord.pulLen[i]) );
+			return false;
+		}
+		ulIn += xRecord.pulLen[i];
+		ulOut += ulFrame;
+		ulPos += xRecord.pulLen[i];
+	}
+
+	xStart = xTaskGetTickCount();
+	for( uint32_t r = 0; r < COMP_TEST_REPEAT; r++ )
+	{
+		ulPos = 0;
+		for( uint32_t i = 0; i < xRecord.ulCount; i++ )
+		{
+			COMP_ulCompress( &xRecord.ucData[ulPos], xRecord.pulLen[i], ucFrame, sizeof( ucFrame ) );
+			ulPos += xRecord.pulLen[i];
+		}
+	}
+	xCompTicks = xTaskGetTickCount() - xStart;
+
+	/* The last frame of the recording over and over */
+	xStart = xTaskGetTickCount();
+	for( uint32_t r = 0; r < COMP_TEST_REPEAT * xRecord.ulCount; r++ )
+	{
+		COMP_lDecompress( ucFrame, ulFrame, ucBack, sizeof( ucBack ) );
+	}
+	xDecompTicks = xTaskGetTickCount() - xStart;
+
+	configPRINTF( ("%s %u payloads, %u -> %u bytes each, %u%%, compress %u bytes/ms, decompress %u bytes/ms\r\n",
+			xRecord.pcName, xRecord.ulCount, ulIn / xRecord.ulCount, ulOut / xRecord.ulCount, ( 100 * ulOut ) / ulIn,
+			( COMP_TEST_REPEAT * ulIn ) / ( xCompTicks ? xCompTicks : 1 ),
+			( COMP_TEST_REPEAT * xRecord.ulCount * xRecord.pulLen[xRecord.ulCount - 1] ) / ( xDecompTicks ? xDecompTicks : 1 )) );
+
+	return true;
+}
+
+
+static bool prvEdgeTest( void )
+{
+	uint32_t ulFrame, ulDict;
+
+	/* Empty and shorter than a match */
+	ulFrame = COMP_ulCompress( ucPayload, 0, ucFrame, sizeof( ucFrame ) );
+	if( ( ulFrame != COMP_HEADER_SIZE + 1 ) || ( COMP_lDecompress( ucFrame, ulFrame, ucBack, sizeof( ucBack ) ) != 0 ) )
+	{
+		return false;
+	}
+	ulFrame = COMP_ulCompress( ( const uint8_t * )"{\"on\":1}", 8, ucFrame, sizeof( ucFrame ) );
+	if( ( COMP_lDecompress( ucFrame, ulFrame, ucBack, sizeof( ucBack ) ) != 8 ) || memcmp( ucBack, "{\"on\":1}", 8 ) )
+	{
+		return false;
+	}
+
+	/* Incompressible data stays within the bound, too small output is refused */
+	for( uint32_t i = 0; i < 1000; i++ )
+	{
+		ucPayload[i] = ( uint8_t )( ( i * 2654435761U ) >> 24 );
+	}
+	ulFrame = COMP_ulCompress( ucPayload, 1000, ucFrame, sizeof( ucFrame ) );
+	if( ( ulFrame == 0 ) || ( ulFrame > COMP_BOUND( 1000 ) ) || ( COMP_ulCompress( ucPayload, 1000, ucFrame, 500 ) != 0 ) )
+	{
+		return false;
+	}
+
+	/* Longest input, the positions across the dictionary and the input are 16 bit */
+	COMP_pucDict( &ulDict );
+	for( uint32_t i = 0; i < sizeof( ucPayload ); i++ )
+	{
+		ucPayload[i] = ( uint8_t )( ( i * 2654435761U ) >> 24 );
+	}
+	ulFrame = COMP_ulCompress( ucPayload, 0xFFFF - ulDict, ucFrame, sizeof( ucFrame ) );
+	if( ( ulFrame == 0 ) || ( COMP_lDecompress( ucFrame, ulFrame, ucBack, sizeof( ucBack ) ) != ( int32_t )( 0xFFFF - ulDict ) ) ||
+		memcmp( ucPayload, ucBack, 0xFFFF - ulDict ) || ( COMP_ulCompress( ucPayload, 0x10000 - ulDict, ucFrame, sizeof( ucFrame ) ) != 0 ) )
+	{
+		return false;
+	}
+
+	/* Truncated and foreign frames */
+	ulFrame = COMP_ulCompress( ucPayload, 1000, ucFrame, sizeof( ucFrame ) );
+	if( ( COMP_lDecompress( ucFrame, ulFrame - 1, ucBack, sizeof( ucBack ) ) >= 0 ) ||
+		( COMP_lDecompress( ucFrame, ulFrame, ucBack, 999 ) >= 0 ) ||
+		( COMP_lDecompress( ( const uint8_t * )"{\"on\":1}", 8, ucBack, sizeof( ucBack ) ) >= 0 ) )
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+bool COMP_bTest( void )
+{
+	static const char *pcName[] = { "JSON batch", "JSON", "CBOR", "CSV" };
+	bool bRet = true;
+
+	for( uint8_t i = 0; bRet && ( i < BUF_LEN( pcName ) ); i++ )
+	{
+		bRet = prvRecord( pcName[i], i ) && prvRecordTest();
+	}
+	bRet = bRet && prvEdgeTest();
+
+	configPRINTF( ("Compression test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
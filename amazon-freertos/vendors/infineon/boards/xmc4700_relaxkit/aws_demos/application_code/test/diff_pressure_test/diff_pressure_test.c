@@ -0,0 +1,133 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <stdbool.h>
+#include <math.h>
+
+#include "diff_pressure_test.h"
+#include "diff_pressure.h"
+
+#include "FreeRTOS.h"
+#include "iot_demo_logging.h"
+
+
+#define DIFFP_TEST_POINTS		( 50 )
+#define DIFFP_TEST_SAMPLES		( 400 )
+
+
+static DiffPressureTrend_t xTrend;
+static float pfSamples[DIFFP_TEST_SAMPLES];
+
+
+/* Least squares over the last points, calculated directly */
+static void prvReferenceFit( uint32_t ulLast, uint32_t ulPoints, float *pfSlope, float *pfLast )
+{
+	float fSumX = 0.0f, fSumY = 0.0f, fSumXX = 0.0f, fSumXY = 0.0f;
+	uint32_t ulFirst = ulLast + 1 - ulPoints;
+
+	for( uint32_t i = 0; i < ulPoints; i++ )
+	{
+		fSumX += (float)i;
+		fSumY += pfSamples[ulFirst + i];
+		fSumXX += (float)( i * i );
+		fSumXY += (float)i * pfSamples[ulFirst + i];
+	}
+
+	*pfSlope = ( ulPoints * fSumXY - fSumX * fSumY ) / ( ulPoints * fSumXX - fSumX * fSumX );
+	*pfLast = ( fSumY - *pfSlope * fSumX ) / ulPoints + *pfSlope * ( ulPoints - 1 );
+}
+
+
+bool DIFFP_bTest( void )
+{
+	bool bRet = false;
+	float fSlope, fLast, fRefSlope, fRefLast;
+	uint32_t ulSeed = 1;
+
+	while( 1 )
+	{
+		/* Sliding regression against the direct fit, ramp with noise */
+		DIFFP_vTrendInit( &xTrend, DIFFP_TEST_POINTS );
+
+		if( DIFFP_bTrendFit( &xTrend, &fSlope, &fLast ) )
+		{
+			configPRINTF( ("DIFFP: fit of an empty window\r\n") );
+			break;
+		}
+
+		uint32_t i;
+		for( i = 0; i < DIFFP_TEST_SAMPLES; i++ )
+		{
+			ulSeed = ulSeed * 1103515245u + 12345u;
+			pfSamples[i] = 100.0f + 0.25f * i + (float)( ( ulSeed >> 16 ) % 100 ) * 0.02f;
+			DIFFP_vTrendAdd( &xTrend, pfSamples[i] );
+
+			if( i < 1 )
+			{
+				continue;
+			}
+
+			prvReferenceFit( i, ( i + 1 < DIFFP_TEST_POINTS ) ? ( i + 1 ) : DIFFP_TEST_POINTS, &fRefSlope, &fRefLast );
+			if( ( !DIFFP_bTrendFit( &xTrend, &fSlope, &fLast ) ) ||
+				( fabsf( fSlope - fRefSlope ) > 1e-3f ) || ( fabsf( fLast - fRefLast ) > 1e-2f ) )
+			{
+				configPRINTF( ("DIFFP: trend %u: %.5f %.4f, expected %.5f %.4f\r\n", i, fSlope, fLast, fRefSlope, fRefLast) );
+				break;
+			}
+		}
+		if( i < DIFFP_TEST_SAMPLES )
+		{
+			break;
+		}
+
+		/* 1 mBar = 100 Pa */
+		if( fabsf( DIFFP_fDiffPressure( 1001.0f, 1000.0f ) - 100.0f ) > 1e-2f )
+		{
+			configPRINTF( ("DIFFP: differential pressure\r\n") );
+			break;
+		}
+
+		/* 100 Pa at 1000 mBar, 20 C: rho = 1.1885 kg/m^3, v = 12.97 m/s, 0.01 m^2 -> 467.0 m^3/h */
+		float fFlow = DIFFP_fFlow( 100.0f, 1000.0f, 20.0f, 0.01f );
+		if( ( fabsf( fFlow - 467.0f ) > 1.0f ) || ( fabsf( DIFFP_fFlow( -100.0f, 1000.0f, 20.0f, 0.01f ) + fFlow ) > 1e-3f ) )
+		{
+			configPRINTF( ("DIFFP: flow %.3f\r\n", fFlow) );
+			break;
+		}
+
+		/* 1 Pa per point at 100 Pa, 60 points per hour -> 60 %/h */
+		if( ( fabsf( DIFFP_fCloggingIndex( 1.0f, 100.0f, 60.0f ) - 60.0f ) > 1e-3f ) ||
+			( DIFFP_fCloggingIndex( 1.0f, 0.5f, 60.0f ) != 0.0f ) )
+		{
+			configPRINTF( ("DIFFP: clogging index\r\n") );
+			break;
+		}
+
+		bRet = true;
+		break;
+	}
+
+	configPRINTF( ("DIFFP test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
@@ -0,0 +1,157 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#include <stdbool.h>
+#include <string.h>
+
+#include "dns_cache_test.h"
+#include "dns_cache.h"
+
+#include "iot_demo_logging.h"
+
+
+static uint32_t ulTestLookups = 0;
+static bool bTestResolverUp = true;
+
+
+/* Every name resolves to its length while the resolver is up */
+static uint32_t prvTestResolve( const char *pcName )
+{
+	ulTestLookups++;
+
+	return bTestResolverUp ? strlen( pcName ) : 0;
+}
+
+
+static uint32_t prvResolve( const char *pcName, uint32_t ulNow )
+{
+	return DNS_CACHE_ulResolve( pcName, prvTestResolve, ulNow );
+}
+
+
+/* The resolver is asked again once the TTL passed */
+static bool prvTtlTest( void )
+{
+	DNS_CACHE_vFlush();
+	bTestResolverUp = true;
+	ulTestLookups = 0;
+
+	if( ( prvResolve( "broker", 1000 ) != 6 ) || ( prvResolve( "broker", 1000 + DNS_CACHE_TTL - 1 ) != 6 ) || ( ulTestLookups != 1 ) )
+	{
+		return false;
+	}
+
+	if( ( prvResolve( "broker", 1000 + DNS_CACHE_TTL ) != 6 ) || ( ulTestLookups != 2 ) )
+	{
+		return false;
+	}
+
+	/* After a flush the next lookup goes to the resolver */
+	DNS_CACHE_vFlush();
+
+	return ( prvResolve( "broker", 1000 + DNS_CACHE_TTL ) == 6 ) && ( ulTestLookups == 3 );
+}
+
+
+/* An expired address stands in while the resolver fails, up to DNS_CACHE_STALE_MAX */
+static bool prvStaleTest( void )
+{
+	DnsCacheStat_t xBefore, xAfter;
+
+	DNS_CACHE_vFlush();
+	bTestResolverUp = true;
+	( void )prvResolve( "broker", 0 );
+	DNS_CACHE_vStatGet( &xBefore );
+
+	bTestResolverUp = false;
+	if( prvResolve( "broker", DNS_CACHE_TTL ) != 6 )
+	{
+		return false;
+	}
+
+	if( ( prvResolve( "broker", DNS_CACHE_STALE_MAX ) != 0 ) || ( prvResolve( "unknown", 0 ) != 0 ) )
+	{
+		return false;
+	}
+
+	/* The entry is still there, a working resolver refreshes it */
+	bTestResolverUp = true;
+	ulTestLookups = 0;
+	if( ( prvResolve( "broker", DNS_CACHE_STALE_MAX ) != 6 ) || ( prvResolve( "broker", DNS_CACHE_STALE_MAX + 1 ) != 6 ) || ( ulTestLookups != 1 ) )
+	{
+		return false;
+	}
+
+	DNS_CACHE_vStatGet( &xAfter );
+
+	return ( xAfter.ulStale - xBefore.ulStale == 1 ) && ( xAfter.ulFailed - xBefore.ulFailed == 2 ) &&
+			( xAfter.ulHits - xBefore.ulHits == 1 ) && ( xAfter.ulResolved - xBefore.ulResolved == 1 );
+}
+
+
+/* The least recently resolved name makes room, also over the wrap of the clock */
+static bool prvEvictTest( void )
+{
+	char cLong[DNS_CACHE_NAME_MAX + 1];
+
+	DNS_CACHE_vFlush();
+	bTestResolverUp = true;
+	ulTestLookups = 0;
+
+	( void )prvResolve( "a", UINT32_MAX - 10 );
+	( void )prvResolve( "bb", UINT32_MAX - 5 );
+	( void )prvResolve( "a", 0 );
+	( void )prvResolve( "ccc", 5 );
+	if( ulTestLookups != 3 )
+	{
+		return false;
+	}
+
+	if( ( prvResolve( "bb", 10 ) != 2 ) || ( prvResolve( "ccc", 10 ) != 3 ) || ( ulTestLookups != 3 ) )
+	{
+		return false;
+	}
+
+	if( ( prvResolve( "a", 10 ) != 1 ) || ( ulTestLookups != 4 ) )
+	{
+		return false;
+	}
+
+	/* Names too long for an entry go to the resolver every time */
+	memset( cLong, 'x', DNS_CACHE_NAME_MAX );
+	cLong[DNS_CACHE_NAME_MAX] = '\0';
+
+	return ( prvResolve( cLong, 10 ) == DNS_CACHE_NAME_MAX ) && ( prvResolve( cLong, 10 ) == DNS_CACHE_NAME_MAX ) && ( ulTestLookups == 6 );
+}
+
+
+bool DNS_CACHE_bTest( void )
+{
+	bool bRet = prvTtlTest() && prvStaleTest() && prvEvictTest();
+
+	/* The broker address is looked up afresh on the next connect */
+	DNS_CACHE_vFlush();
+
+	configPRINTF( ("DNS cache test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
@@ -0,0 +1,154 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "float_to_string_test.h"
+#include "float_to_string.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "iot_demo_logging.h"
+
+
+/* Bit patterns between two sweep values, odd so that every exponent and mantissa bit is hit, 1 for all 2^32 */
+#ifndef FTOS_TEST_STRIDE
+	#define FTOS_TEST_STRIDE		( 4099 )
+#endif
+#define FTOS_TEST_BENCH				( 1000000 )
+
+
+static char pcFtos[FTOS_BUF_SIZE];
+static char pcPrintf[FTOS_BUF_SIZE];
+
+
+/* Compares with snprintf, the reference is the exact float value rounded half to even */
+static bool prvCompare( float fVal, uint8_t ucPrecision )
+{
+	uint32_t ulLen = FTOS_ulFormat( fVal, ucPrecision, pcFtos, sizeof( pcFtos ) );
+
+	snprintf( pcPrintf, sizeof( pcPrintf ), "%.*f", ucPrecision, (double)fVal );
+	if( ( ulLen != strlen( pcPrintf ) ) || ( strcmp( pcFtos, pcPrintf ) != 0 ) )
+	{
+		configPRINTF( ("FTOS: %s, expected %s\r\n", pcFtos, pcPrintf) );
+		return false;
+	}
+
+	return true;
+}
+
+
+bool FTOS_bTest( void )
+{
+	static const float pfEdge[] = { 0.0f, -0.0f, 0.5f, 1.5f, 2.5f, -2.5f, 0.125f, 0.375f, 0.00005f, 0.00015f, 0.99995f,
+			999999.5f, 16777216.0f, 4294967296.0f, 1e-10f, 1.4e-45f, 3.4028235e38f, -3.4028235e38f, INFINITY, -INFINITY };
+	bool bRet = false;
+	uint32_t ulBits, ulSweep, ulStart, ulFtosTicks, ulPrintfTicks;
+	float fVal;
+	uint32_t i;
+
+	while( 1 )
+	{
+		for( i = 0; i < ( sizeof( pfEdge ) / sizeof( pfEdge[0] ) ); i++ )
+		{
+			uint8_t p = 0;
+			while( ( p <= FTOS_PRECISION_MAX ) && prvCompare( pfEdge[i], p ) )
+			{
+				p++;
+			}
+			if( p <= FTOS_PRECISION_MAX )
+			{
+				break;
+			}
+		}
+		if( i < ( sizeof( pfEdge ) / sizeof( pfEdge[0] ) ) )
+		{
+			break;
+		}
+
+		/* Every FTOS_TEST_STRIDE-th bit pattern at every precision, until the pattern wraps */
+		ulBits = 0;
+		ulSweep = 0;
+		do
+		{
+			memcpy( &fVal, &ulBits, sizeof( fVal ) );
+			if( !isnan( fVal ) )
+			{
+				uint8_t p = 0;
+				while( ( p <= FTOS_PRECISION_MAX ) && prvCompare( fVal, p ) )
+				{
+					p++;
+				}
+				if( p <= FTOS_PRECISION_MAX )
+				{
+					break;
+				}
+				ulSweep++;
+			}
+			ulBits += FTOS_TEST_STRIDE;
+		} while( ulBits >= FTOS_TEST_STRIDE );
+		if( ( ulBits >= FTOS_TEST_STRIDE ) || ( ulSweep == 0 ) )
+		{
+			break;
+		}
+		configPRINTF( ("FTOS: %u values x %u precisions identical to snprintf\r\n", ulSweep, FTOS_PRECISION_MAX + 1) );
+
+		if( ( FTOS_ulFormat( NAN, 4, pcFtos, sizeof( pcFtos ) ) != 3 ) || ( strcmp( pcFtos, "nan" ) != 0 ) )
+		{
+			break;
+		}
+		/* "-1.2500" does not fit 7 bytes with the null */
+		if( FTOS_ulFormat( -1.25f, 4, pcFtos, 7 ) != 0 )
+		{
+			break;
+		}
+
+		/* Values of the sensor statistic range */
+		ulStart = xTaskGetTickCount();
+		for( i = 0; i < FTOS_TEST_BENCH; i++ )
+		{
+			FTOS_ulFormat( ( (float)i - FTOS_TEST_BENCH / 2 ) * 0.37f, 4, pcFtos, sizeof( pcFtos ) );
+		}
+		ulFtosTicks = xTaskGetTickCount() - ulStart;
+
+		ulStart = xTaskGetTickCount();
+		for( i = 0; i < FTOS_TEST_BENCH; i++ )
+		{
+			snprintf( pcPrintf, sizeof( pcPrintf ), "%.4f", (double)( ( (float)i - FTOS_TEST_BENCH / 2 ) * 0.37f ) );
+		}
+		ulPrintfTicks = xTaskGetTickCount() - ulStart;
+
+		configPRINTF( ("FTOS: %u conversions %u ms, snprintf %u ms, %.1fx\r\n", FTOS_TEST_BENCH, ulFtosTicks * portTICK_PERIOD_MS,
+				ulPrintfTicks * portTICK_PERIOD_MS, (double)ulPrintfTicks / (double)( ulFtosTicks ? ulFtosTicks : 1 )) );
+
+		bRet = true;
+		break;
+	}
+
+	configPRINTF( ("FTOS test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
@@ -0,0 +1,568 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+/**
+ * Encoders under arbitrary messages and buffer sizes. FUZZ_prvOneInput maps any bytes to a
+ * message, so the same properties run from the pseudo random inputs of FUZZ_bTest and, with
+ * FUZZ_LIBFUZZER defined, from libFuzzer, AFL or the driver of test/host/fuzz_main.c.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "fuzz_test.h"
+#include "converting.h"
+#include "float_to_string.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "iot_demo_logging.h"
+
+
+#define FUZZ_BUF_SIZE				( mqtttaskSEND_BUFFER_SIZE )
+#define FUZZ_CANARY_SIZE			( 16 )
+#define FUZZ_CANARY					( 0xA5 )
+#define FUZZ_JSON_DEPTH_MAX			( 8 )
+#ifndef FUZZ_TEST_RUNS
+#define FUZZ_TEST_RUNS				( 2000 )
+#endif
+#define FUZZ_TEST_INPUT_SIZE		( 2048 )
+#ifndef FUZZ_BENCH_RUNS
+#define FUZZ_BENCH_RUNS				( 20000 )
+#endif
+
+
+/* Input bytes, zeros once they run out */
+typedef struct {
+	const uint8_t *pucData;
+	uint32_t ulSize;
+	uint32_t ulPos;
+} FuzzInput_t;
+
+
+static uint8_t pucFuzzBuf[FUZZ_BUF_SIZE + FUZZ_CANARY_SIZE];
+static uint8_t pucFuzzRef[FUZZ_BUF_SIZE];
+static uint8_t pucFuzzInput[FUZZ_TEST_INPUT_SIZE];
+static InfineonSensorsMessage_t xFuzzMessage;
+static BatchContext_t xFuzzBatch;
+
+/* Values the formatting gets wrong first */
+static const float pfFuzzSpecial[] = { 0.0f, -0.0f, 0.5f, -0.00005f, 0.00015f, 9.99995f, 16777217.0f, 4294967296.0f,
+		1e-45f, 1.17549435e-38f, 3.40282347e+38f, -3.40282347e+38f, INFINITY, -INFINITY, NAN };
+
+
+static uint8_t prvByte( FuzzInput_t *pxIn )
+{
+	return ( pxIn->ulPos < pxIn->ulSize ) ? pxIn->pucData[pxIn->ulPos++] : 0;
+}
+
+
+/* Separate statements, the order of two calls in one expression is unspecified */
+static uint16_t prvHalf( FuzzInput_t *pxIn )
+{
+	uint16_t usVal = prvByte( pxIn );
+
+	return usVal | ( uint16_t )( prvByte( pxIn ) << 8 );
+}
+
+
+static uint32_t prvWord( FuzzInput_t *pxIn )
+{
+	uint32_t ulVal = prvHalf( pxIn );
+
+	return ulVal | ( ( uint32_t )prvHalf( pxIn ) << 16 );
+}
+
+
+/* Mostly sensor-like values, the rest special or any bit pattern */
+static float prvFloat( FuzzInput_t *pxIn )
+{
+	uint8_t ucKind = prvByte( pxIn );
+	uint32_t ulBits = prvWord( pxIn );
+	float fVal;
+
+	if( ucKind < 192 )
+	{
+		return ( int32_t )ulBits / ( float )( 1UL << ( ucKind % 24 ) );
+	}
+	if( ucKind < 224 )
+	{
+		return pfFuzzSpecial[ulBits % BUF_LEN( pfFuzzSpecial )];
+	}
+	memcpy( &fVal, &ulBits, sizeof( fVal ) );
+
+	return fVal;
+}
+
+
+static void prvStatFill( FuzzInput_t *pxIn, StatData_t *pxStat )
+{
+	pxStat->fMin = prvFloat( pxIn );
+	pxStat->fMax = prvFloat( pxIn );
+	pxStat->fMean = prvFloat( pxIn );
+	pxStat->fRMS = prvFloat( pxIn );
+	pxStat->fStdDev = prvFloat( pxIn );
+	pxStat->fVariance = prvFloat( pxIn );
+}
+
+
+/* Any contents within the array bounds of the message */
+static void prvMessageFill( FuzzInput_t *pxIn, InfineonSensorsMessage_t *pxMsg )
+{
+	memset( pxMsg, 0, sizeof( InfineonSensorsMessage_t ) );
+
+	for( uint32_t i = 0; i < MSG_SENSOR_MAX; i++ )
+	{
+		uint8_t ucFlags = prvByte( pxIn );
+		pxMsg->bOn[i] = ( ucFlags & 0x01 ) != 0;
+		pxMsg->bReady[i] = ( ucFlags & 0x02 ) != 0;
+	}
+	for( uint32_t i = 0; i < MSG_PARAMETER_MAX; i++ )
+	{
+		pxMsg->bSuppressed[i] = ( prvByte( pxIn ) & 0x0F ) == 0;
+		prvStatFill( pxIn, &pxMsg->xStat[i] );
+	}
+	for( uint32_t i = 0; i < MSG_SPECTRUM_MAX; i++ )
+	{
+		for( uint32_t j = 0; j < BUF_LEN( pxMsg->xFft[i].data ); j++ )
+		{
+			pxMsg->xFft[i].data[j] = prvHalf( pxIn );
+		}
+	}
+	for( uint32_t i = 0; i < MSG_EDGE_MAX; i++ )
+	{
+		pxMsg->xEdge[i].fFrequency = prvFloat( pxIn );
+		pxMsg->xEdge[i].fDutyCycle = prvFloat( pxIn );
+		pxMsg->xEdge[i].ulPulseCount = prvWord( pxIn );
+		pxMsg->xEdge[i].fDwellOn = prvFloat( pxIn );
+		pxMsg->xEdge[i].fDwellOff = prvFloat( pxIn );
+	}
+	for( uint32_t i = 0; i < MSG_PAIR_MAX; i++ )
+	{
+		uint8_t ucFlags = prvByte( pxIn );
+		pxMsg->bPairOn[i] = ( ucFlags & 0x01 ) != 0;
+		pxMsg->bPairReady[i] = ( ucFlags & 0x02 ) != 0;
+		pxMsg->xPair[i].fDiffPressure = prvFloat( pxIn );
+		pxMsg->xPair[i].fFlow = prvFloat( pxIn );
+		pxMsg->xPair[i].fCloggingIndex = prvFloat( pxIn );
+	}
+
+	CorrelationData_t *pxCorr = &pxMsg->xCorrelation;
+	uint8_t ucFlags = prvByte( pxIn );
+	pxMsg->bCorrelationOn = ( ucFlags & 0x01 ) != 0;
+	pxMsg->bCorrelationReady = ( ucFlags & 0x02 ) != 0;
+	pxCorr->ucChannels = prvByte( pxIn ) % ( CORR_CHANNELS_MAX + 1 );
+	pxCorr->ucLagPairs = prvByte( pxIn ) % ( CORR_LAG_PAIRS_MAX + 1 );
+	for( uint32_t i = 0; i < CORR_TRIANGLE_LEN( pxCorr->ucChannels ); i++ )
+	{
+		pxCorr->pfCovariance[i] = prvFloat( pxIn );
+		pxCorr->pfCorrelation[i] = prvFloat( pxIn );
+	}
+	for( uint32_t i = 0; i < pxCorr->ucLagPairs; i++ )
+	{
+		pxCorr->psLag[i] = ( int16_t )prvHalf( pxIn );
+		pxCorr->pfLagPeak[i] = prvFloat( pxIn );
+	}
+
+	ClassifierData_t *pxClass = &pxMsg->xClassifier;
+	ucFlags = prvByte( pxIn );
+	pxMsg->bClassifierOn = ( ucFlags & 0x01 ) != 0;
+	pxMsg->bClassifierReady = ( ucFlags & 0x02 ) != 0;
+	pxClass->ucClasses = prvByte( pxIn ) % ( CLASSIFIER_CLASSES_MAX + 1 );
+	pxClass->ucLabel = prvByte( pxIn );
+	for( uint32_t i = 0; i < pxClass->ucClasses; i++ )
+	{
+		pxClass->pfProb[i] = prvFloat( pxIn );
+	}
+
+	pxMsg->ulTimestamp = prvWord( pxIn );
+}
+
+
+/* Buffer size up to FUZZ_BUF_SIZE */
+static uint32_t prvSize( FuzzInput_t *pxIn )
+{
+	return prvHalf( pxIn ) % ( FUZZ_BUF_SIZE + 1 );
+}
+
+
+static bool prvCanaryCheck( uint32_t ulSize )
+{
+	for( uint32_t i = ulSize; i < sizeof( pucFuzzBuf ); i++ )
+	{
+		if( pucFuzzBuf[i] != FUZZ_CANARY )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/* -?digits(.digits)?, what JSON_prvFloatWrite and JSON_prvIntWrite produce */
+static const char *prvJsonNumber( const char *pcPtr )
+{
+	const char *pcStart;
+
+	if( *pcPtr == '-' )
+	{
+		pcPtr++;
+	}
+	for( pcStart = pcPtr; ( *pcPtr >= '0' ) && ( *pcPtr <= '9' ); pcPtr++ );
+	if( pcPtr == pcStart )
+	{
+		return NULL;
+	}
+	if( *pcPtr == '.' )
+	{
+		for( pcStart = ++pcPtr; ( *pcPtr >= '0' ) && ( *pcPtr <= '9' ); pcPtr++ );
+		if( pcPtr == pcStart )
+		{
+			return NULL;
+		}
+	}
+
+	return pcPtr;
+}
+
+
+/* Strict JSON of the shape the writer makes: objects, arrays, plain keys, numbers and null */
+static const char *prvJsonValue( const char *pcPtr, uint8_t ucDepth )
+{
+	bool bObject = ( *pcPtr == '{' );
+
+	if( ( *pcPtr == 'n' ) && !strncmp( pcPtr, "null", 4 ) )
+	{
+		return pcPtr + 4;
+	}
+	if( !bObject && ( *pcPtr != '[' ) )
+	{
+		return prvJsonNumber( pcPtr );
+	}
+	if( ucDepth >= FUZZ_JSON_DEPTH_MAX )
+	{
+		return NULL;
+	}
+
+	pcPtr++;
+	if( *pcPtr == ( bObject ? '}' : ']' ) )
+	{
+		return pcPtr + 1;
+	}
+	while( 1 )
+	{
+		if( bObject )
+		{
+			if( *pcPtr++ != '"' )
+			{
+				return NULL;
+			}
+			while( *pcPtr && ( *pcPtr != '"' ) && ( *pcPtr != '\\' ) )
+			{
+				pcPtr++;
+			}
+			if( ( *pcPtr++ != '"' ) || ( *pcPtr++ != ':' ) )
+			{
+				return NULL;
+			}
+		}
+		pcPtr = prvJsonValue( pcPtr, ucDepth + 1 );
+		if( !pcPtr )
+		{
+			return NULL;
+		}
+		if( *pcPtr == ( bObject ? '}' : ']' ) )
+		{
+			return pcPtr + 1;
+		}
+		if( *pcPtr++ != ',' )
+		{
+			return NULL;
+		}
+	}
+}
+
+
+static bool prvJsonValid( const char *pcJson, uint32_t ulLen )
+{
+	const char *pcEnd = ( *pcJson == '{' ) ? prvJsonValue( pcJson, 0 ) : NULL;
+
+	return ( pcEnd == &pcJson[ulLen] ) && ( *pcEnd == 0 );
+}
+
+
+static bool prvCborValid( const uint8_t *pucCbor, uint32_t ulLen )
+{
+	CborParser xParser;
+	CborValue xValue;
+
+	return ( cbor_parser_init( pucCbor, ulLen, 0, &xParser, &xValue ) == CborNoError ) && cbor_value_is_map( &xValue ) &&
+		   ( cbor_value_validate_basic( &xValue ) == CborNoError );
+}
+
+
+/**
+ * Text encoders are deterministic: with the reference of the full buffer, a smaller buffer
+ * either holds the same text and its null or the encoder refuses
+ */
+static bool prvTextCheck( uint32_t ulSize, bool bJson )
+{
+	uint32_t ulRefLen = 0, ulLen = 0;
+	bool bRef, bRet;
+
+	bRef = bJson ? JSON_bGenerateToSend( &xFuzzMessage, ( char * )pucFuzzRef, sizeof( pucFuzzRef ), &ulRefLen ) :
+				   CSV_bGenerateToSend( &xFuzzMessage, pucFuzzRef, sizeof( pucFuzzRef ), &ulRefLen );
+	if( bRef && ( ( ulRefLen >= sizeof( pucFuzzRef ) ) || ( strlen( ( char * )pucFuzzRef ) != ulRefLen ) ||
+				  ( bJson && !prvJsonValid( ( char * )pucFuzzRef, ulRefLen ) ) ) )
+	{
+		return false;
+	}
+
+	memset( pucFuzzBuf, FUZZ_CANARY, sizeof( pucFuzzBuf ) );
+	bRet = bJson ? JSON_bGenerateToSend( &xFuzzMessage, ( char * )pucFuzzBuf, ulSize, &ulLen ) :
+				   CSV_bGenerateToSend( &xFuzzMessage, pucFuzzBuf, ulSize, &ulLen );
+	if( !prvCanaryCheck( ulSize ) || ( bRet != ( bRef && ( ulSize > ulRefLen ) ) ) )
+	{
+		return false;
+	}
+
+	return !bRet || ( ( ulLen == ulRefLen ) && !memcmp( pucFuzzBuf, pucFuzzRef, ulLen + 1 ) );
+}
+
+
+/* The spectrum codec keeps state between windows, only the frame properties are checked */
+static bool prvCborCheck( uint32_t ulSize )
+{
+	uint32_t ulLen = 0;
+	bool bRet;
+
+	memset( pucFuzzBuf, FUZZ_CANARY, sizeof( pucFuzzBuf ) );
+	bRet = CBOR_bGenerateToSend( &xFuzzMessage, pucFuzzBuf, ulSize, &ulLen );
+
+	return prvCanaryCheck( ulSize ) && ( !bRet || ( ( ulLen <= ulSize ) && prvCborValid( pucFuzzBuf, ulLen ) ) );
+}
+
+
+/* A window that doesn't fit is rolled back, the batch still closes into a valid payload */
+static bool prvBatchCheck( FuzzInput_t *pxIn, uint32_t ulSize, uint8_t ucFlags )
+{
+	bool bCbor = ( ucFlags & 0x01 ) != 0;
+	uint32_t ulLen = 0;
+
+	memset( pucFuzzBuf, FUZZ_CANARY, sizeof( pucFuzzBuf ) );
+	if( !BATCH_bCreate( &xFuzzBatch, bCbor, pucFuzzBuf, ulSize ) )
+	{
+		return prvCanaryCheck( ulSize ) && ( ulSize <= BATCH_TAIL_SIZE );
+	}
+	for( uint8_t i = 0; i < ( ucFlags >> 1 ) % 4; i++ )
+	{
+		xFuzzMessage.ulTimestamp += prvByte( pxIn );
+		BATCH_bAdd( &xFuzzBatch, &xFuzzMessage );
+	}
+	if( !BATCH_bFinish( &xFuzzBatch, prvWord( pxIn ), &ulLen ) || !prvCanaryCheck( ulSize ) || ( ulLen > ulSize ) )
+	{
+		return false;
+	}
+
+	return bCbor ? prvCborValid( pucFuzzBuf, ulLen ) : prvJsonValid( ( char * )pucFuzzBuf, ulLen );
+}
+
+
+/* Exact decimal rounding: the text reads back within half a unit of the last digit */
+static bool prvFloatCheck( FuzzInput_t *pxIn )
+{
+	char pcBuf[FTOS_BUF_SIZE];
+	float fVal = prvFloat( pxIn );
+	uint8_t ucPrecision = prvByte( pxIn ) % ( FTOS_PRECISION_MAX + 1 );
+	uint32_t ulLen = FTOS_ulFormat( fVal, ucPrecision, pcBuf, sizeof( pcBuf ) );
+
+	if( ( ulLen == 0 ) || ( strlen( pcBuf ) != ulLen ) )
+	{
+		return false;
+	}
+	/* One byte less has no room for the null */
+	if( ( FTOS_ulFormat( fVal, ucPrecision, pcBuf, ulLen ) != 0 ) || ( FTOS_ulFormat( fVal, ucPrecision, pcBuf, ulLen + 1 ) != ulLen ) )
+	{
+		return false;
+	}
+	if( !isfinite( fVal ) )
+	{
+		return !strcmp( pcBuf, isnan( fVal ) ? "nan" : ( ( fVal > 0 ) ? "inf" : "-inf" ) );
+	}
+
+	const char *pcEnd = prvJsonNumber( pcBuf );
+	const char *pcPoint = strchr( pcBuf, '.' );
+	double dBack = strtod( pcBuf, NULL );
+	double dHalf = 0.5;
+
+	for( uint8_t i = 0; i < ucPrecision; i++ )
+	{
+		dHalf /= 10.0;
+	}
+
+	return ( pcEnd == &pcBuf[ulLen] ) && ( ucPrecision ? ( pcPoint && ( ( uint32_t )( pcEnd - pcPoint - 1 ) == ucPrecision ) ) : !pcPoint ) &&
+		   ( fabs( dBack - fVal ) <= dHalf + fabs( dBack ) * 1e-15 );
+}
+
+
+static bool FUZZ_prvOneInput( const uint8_t *pucData, uint32_t ulSize )
+{
+	FuzzInput_t xIn = { pucData, ulSize, 0 };
+
+	/* Buffer sizes first, a short input still reaches every size */
+	uint32_t ulJsonSize = prvSize( &xIn );
+	uint32_t ulCsvSize = prvSize( &xIn );
+	uint32_t ulCborSize = prvSize( &xIn );
+	uint32_t ulBatchSize = prvSize( &xIn );
+	uint8_t ucBatchFlags = prvByte( &xIn );
+
+	prvMessageFill( &xIn, &xFuzzMessage );
+
+	for( uint32_t i = 0; i < 8; i++ )
+	{
+		if( !prvFloatCheck( &xIn ) )
+		{
+			configPRINTF( ("Fuzz float failed\r\n") );
+			return false;
+		}
+	}
+	if( !prvTextCheck( ulJsonSize, true ) )
+	{
+		configPRINTF( ("Fuzz JSON failed\r\n") );
+		return false;
+	}
+	if( !prvTextCheck( ulCsvSize, false ) )
+	{
+		configPRINTF( ("Fuzz CSV failed\r\n") );
+		return false;
+	}
+	if( !prvCborCheck( ulCborSize ) )
+	{
+		configPRINTF( ("Fuzz CBOR failed\r\n") );
+		return false;
+	}
+	if( !prvBatchCheck( &xIn, ulBatchSize, ucBatchFlags ) )
+	{
+		configPRINTF( ("Fuzz batch failed\r\n") );
+		return false;
+	}
+
+	return true;
+}
+
+
+#ifdef FUZZ_LIBFUZZER
+int LLVMFuzzerTestOneInput( const uint8_t *pucData, size_t xSize )
+{
+	if( !FUZZ_prvOneInput( pucData, xSize ) )
+	{
+		abort();
+	}
+
+	return 0;
+}
+#endif
+
+
+/* Messages a second and payload size of the typical window, every sensor on */
+static void prvBenchmark( void )
+{
+	static const char *pcFormat[] = { "JSON", "CBOR", "CSV" };
+
+	memset( &xFuzzMessage, 0, sizeof( xFuzzMessage ) );
+	for( uint32_t i = 0; i < MSG_SENSOR_MAX; i++ )
+	{
+		xFuzzMessage.bOn[i] = xFuzzMessage.bReady[i] = true;
+	}
+	for( uint32_t i = 0; i < MSG_PARAMETER_MAX; i++ )
+	{
+		xFuzzMessage.xStat[i] = ( StatData_t ){ 21.37f + i, 24.81f + i, 23.05f + i, 23.06f + i, 0.83f, 0.6889f };
+	}
+	for( uint32_t i = 0; i < BUF_LEN( xFuzzMessage.xFft[0].data ); i++ )
+	{
+		xFuzzMessage.xFft[MSG_SPECTRUM_IM69D_MIC_1].data[i] = 3000 / ( 1 + i / 4 ) + ( i * 37 ) % 29;
+	}
+
+	for( uint32_t ulFormat = 0; ulFormat < BUF_LEN( pcFormat ); ulFormat++ )
+	{
+		uint32_t ulLen = 0;
+		TickType_t xStart = xTaskGetTickCount();
+
+		for( uint32_t i = 0; i < FUZZ_BENCH_RUNS; i++ )
+		{
+			if( ulFormat == 0 )
+			{
+				JSON_bGenerateToSend( &xFuzzMessage, ( char * )pucFuzzBuf, FUZZ_BUF_SIZE, &ulLen );
+			}
+			else if( ulFormat == 1 )
+			{
+				CBOR_bGenerateToSend( &xFuzzMessage, pucFuzzBuf, FUZZ_BUF_SIZE, &ulLen );
+			}
+			else
+			{
+				CSV_bGenerateToSend( &xFuzzMessage, pucFuzzBuf, FUZZ_BUF_SIZE, &ulLen );
+			}
+		}
+
+		TickType_t xTicks = xTaskGetTickCount() - xStart;
+
+		configPRINTF( ("%s %u bytes/message, %u messages/s\r\n", pcFormat[ulFormat], ulLen,
+				( FUZZ_BENCH_RUNS * configTICK_RATE_HZ ) / ( xTicks ? xTicks : 1 )) );
+	}
+}
+
+
+bool FUZZ_bTest( void )
+{
+	bool bRet = true;
+	uint32_t ulSeed = 0x2545F491;
+
+	for( uint32_t ulRun = 0; ( ulRun < FUZZ_TEST_RUNS ) && bRet; ulRun++ )
+	{
+		/* xorshift32, the same inputs on every run */
+		for( uint32_t i = 0; i < sizeof( pucFuzzInput ); i++ )
+		{
+			ulSeed ^= ulSeed << 13;
+			ulSeed ^= ulSeed >> 17;
+			ulSeed ^= ulSeed << 5;
+			pucFuzzInput[i] = ( uint8_t )ulSeed;
+		}
+		bRet = FUZZ_prvOneInput( pucFuzzInput, 1 + ulSeed % sizeof( pucFuzzInput ) );
+		if( !bRet )
+		{
+			configPRINTF( ("Fuzz input %u\r\n", ulRun) );
+		}
+	}
+
+	if( bRet )
+	{
+		prvBenchmark();
+	}
+
+	configPRINTF( ("Fuzz test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
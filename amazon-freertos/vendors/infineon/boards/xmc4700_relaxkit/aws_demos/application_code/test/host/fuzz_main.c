@@ -0,0 +1,110 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+/**
+ * Standalone driver of LLVMFuzzerTestOneInput for compilers without libFuzzer. Without
+ * arguments it feeds FUZZ_MAIN_RUNS pseudo random inputs, otherwise every argument is an
+ * input file: a corpus entry, a crash to replay or the @@ of afl-fuzz.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#ifndef FUZZ_MAIN_RUNS
+#define FUZZ_MAIN_RUNS				( 20000 )
+#endif
+#define FUZZ_MAIN_INPUT_MAX			( 4096 )
+
+
+int LLVMFuzzerTestOneInput( const uint8_t *pucData, size_t xSize );
+
+
+static int prvFileRun( const char *pcPath )
+{
+	FILE *pxFile = fopen( pcPath, "rb" );
+	uint8_t *pucData;
+	long lSize;
+
+	if( pxFile == NULL )
+	{
+		fprintf( stderr, "%s: cannot open\n", pcPath );
+		return EXIT_FAILURE;
+	}
+	fseek( pxFile, 0, SEEK_END );
+	lSize = ftell( pxFile );
+	fseek( pxFile, 0, SEEK_SET );
+
+	/* One byte more, malloc( 0 ) may return NULL */
+	pucData = malloc( lSize + 1 );
+	if( ( pucData == NULL ) || ( fread( pucData, 1, lSize, pxFile ) != ( size_t )lSize ) )
+	{
+		fprintf( stderr, "%s: cannot read\n", pcPath );
+		fclose( pxFile );
+		free( pucData );
+		return EXIT_FAILURE;
+	}
+	fclose( pxFile );
+
+	LLVMFuzzerTestOneInput( pucData, lSize );
+	free( pucData );
+
+	return EXIT_SUCCESS;
+}
+
+
+int main( int argc, char *argv[] )
+{
+	static uint8_t pucInput[FUZZ_MAIN_INPUT_MAX];
+	uint32_t ulSeed = 0x9E3779B9;
+
+	if( argc > 1 )
+	{
+		for( int i = 1; i < argc; i++ )
+		{
+			if( prvFileRun( argv[i] ) != EXIT_SUCCESS )
+			{
+				return EXIT_FAILURE;
+			}
+		}
+		return EXIT_SUCCESS;
+	}
+
+	for( uint32_t ulRun = 0; ulRun < FUZZ_MAIN_RUNS; ulRun++ )
+	{
+		/* xorshift32, the same inputs on every run */
+		for( uint32_t i = 0; i < sizeof( pucInput ); i++ )
+		{
+			ulSeed ^= ulSeed << 13;
+			ulSeed ^= ulSeed >> 17;
+			ulSeed ^= ulSeed << 5;
+			pucInput[i] = ( uint8_t )ulSeed;
+		}
+		LLVMFuzzerTestOneInput( pucInput, ulSeed % ( sizeof( pucInput ) + 1 ) );
+	}
+	printf( "%u inputs passed\n", FUZZ_MAIN_RUNS );
+
+	return EXIT_SUCCESS;
+}
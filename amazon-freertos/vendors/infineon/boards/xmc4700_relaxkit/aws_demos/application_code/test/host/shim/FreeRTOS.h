@@ -0,0 +1,101 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+/**
+ * Host stand-in for the parts of the FreeRTOS API the application modules use,
+ * so they build and run as a normal Linux process under test/host. Tasks are
+ * pthreads, the tick is CLOCK_MONOTONIC in ms, critical sections are one
+ * recursive mutex.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef void ( *TaskFunction_t )( void * );
+
+typedef void * TaskHandle_t;
+typedef void * SemaphoreHandle_t;
+typedef void * QueueHandle_t;
+
+typedef struct {
+	TickType_t xTimeOnEntering;
+} TimeOut_t;
+
+
+#define pdFALSE						( ( BaseType_t ) 0 )
+#define pdTRUE						( ( BaseType_t ) 1 )
+#define pdFAIL						( pdFALSE )
+#define pdPASS						( pdTRUE )
+
+#define configTICK_RATE_HZ			( 1000 )
+#define configMINIMAL_STACK_SIZE	( 128 )
+#define configMAX_PRIORITIES		( 7 )
+#define tskIDLE_PRIORITY			( 0 )
+#define portMAX_DELAY				( ( TickType_t ) 0xFFFFFFFFUL )
+#define portTICK_PERIOD_MS			( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define pdMS_TO_TICKS( xTimeInMs )	( ( TickType_t ) ( ( ( TickType_t ) ( xTimeInMs ) * ( TickType_t ) configTICK_RATE_HZ ) / ( TickType_t ) 1000 ) )
+
+#define configPRINTF( X )			vLoggingPrintf X
+#define configASSERT( x )			if( ( x ) == 0 ) { vLoggingPrintf( "ASSERT %s:%d\r\n", __FILE__, __LINE__ ); abort(); }
+
+#define taskENTER_CRITICAL()		vPortEnterCritical()
+#define taskEXIT_CRITICAL()			vPortExitCritical()
+
+
+void vLoggingPrintf( const char *pcFormat, ... );
+
+void *pvPortMalloc( size_t xSize );
+void vPortFree( void *pv );
+void vPortEnterCritical( void );
+void vPortExitCritical( void );
+
+TickType_t xTaskGetTickCount( void );
+void vTaskDelay( const TickType_t xTicksToDelay );
+void vTaskSetTimeOutState( TimeOut_t * const pxTimeOut );
+BaseType_t xTaskCheckForTimeOut( TimeOut_t * const pxTimeOut, TickType_t * const pxTicksToWait );
+BaseType_t xTaskCreate( TaskFunction_t pxTaskCode, const char * const pcName, const uint16_t usStackDepth,
+						void * const pvParameters, UBaseType_t uxPriority, TaskHandle_t * const pxCreatedTask );
+void vTaskDelete( TaskHandle_t xTaskToDelete );
+
+SemaphoreHandle_t xSemaphoreCreateBinary( void );
+void vSemaphoreDelete( SemaphoreHandle_t xSemaphore );
+BaseType_t xSemaphoreGive( SemaphoreHandle_t xSemaphore );
+BaseType_t xSemaphoreTake( SemaphoreHandle_t xSemaphore, TickType_t xBlockTime );
+
+QueueHandle_t xQueueCreate( UBaseType_t uxQueueLength, UBaseType_t uxItemSize );
+void vQueueDelete( QueueHandle_t xQueue );
+BaseType_t xQueueSend( QueueHandle_t xQueue, const void * const pvItemToQueue, TickType_t xTicksToWait );
+BaseType_t xQueueReceive( QueueHandle_t xQueue, void * const pvBuffer, TickType_t xTicksToWait );
+BaseType_t xQueueReset( QueueHandle_t xQueue );
+
+
+#endif /* INC_FREERTOS_H */
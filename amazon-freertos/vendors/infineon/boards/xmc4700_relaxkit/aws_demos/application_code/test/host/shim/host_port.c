@@ -0,0 +1,406 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "FreeRTOS.h"
+
+
+typedef struct {
+	pthread_mutex_t xMutex;
+	pthread_cond_t xCond;
+	BaseType_t xCount;
+} HostSemaphore_t;
+
+typedef struct {
+	pthread_mutex_t xMutex;
+	pthread_cond_t xCond;
+	UBaseType_t uxLength;
+	UBaseType_t uxItemSize;
+	UBaseType_t uxWaiting;
+	UBaseType_t uxRead;
+	uint8_t *pucItems;
+} HostQueue_t;
+
+typedef struct {
+	TaskFunction_t pxTaskCode;
+	void *pvParameters;
+} HostTask_t;
+
+
+static pthread_mutex_t xCriticalMutex;
+static pthread_once_t xCriticalOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t xLoggingMutex = PTHREAD_MUTEX_INITIALIZER;
+static struct timespec xStart;
+static pthread_once_t xStartOnce = PTHREAD_ONCE_INIT;
+
+
+static void prvCriticalInit( void )
+{
+	pthread_mutexattr_t xAttr;
+
+	pthread_mutexattr_init( &xAttr );
+	pthread_mutexattr_settype( &xAttr, PTHREAD_MUTEX_RECURSIVE );
+	pthread_mutex_init( &xCriticalMutex, &xAttr );
+	pthread_mutexattr_destroy( &xAttr );
+}
+
+
+static void prvStartInit( void )
+{
+	clock_gettime( CLOCK_MONOTONIC, &xStart );
+}
+
+
+/* Absolute CLOCK_REALTIME deadline for the timed waits */
+static void prvDeadline( struct timespec *pxDeadline, TickType_t xTicks )
+{
+	clock_gettime( CLOCK_REALTIME, pxDeadline );
+	pxDeadline->tv_sec += xTicks / configTICK_RATE_HZ;
+	pxDeadline->tv_nsec += ( long )( xTicks % configTICK_RATE_HZ ) * ( 1000000000L / configTICK_RATE_HZ );
+	if( pxDeadline->tv_nsec >= 1000000000L )
+	{
+		pxDeadline->tv_sec++;
+		pxDeadline->tv_nsec -= 1000000000L;
+	}
+}
+
+
+/* Waits on the condition, forever for portMAX_DELAY, false on the timeout */
+static bool prvWait( pthread_cond_t *pxCond, pthread_mutex_t *pxMutex, const struct timespec *pxDeadline, TickType_t xTicks )
+{
+	if( xTicks == portMAX_DELAY )
+	{
+		return pthread_cond_wait( pxCond, pxMutex ) == 0;
+	}
+
+	return pthread_cond_timedwait( pxCond, pxMutex, pxDeadline ) == 0;
+}
+
+
+void vLoggingPrintf( const char *pcFormat, ... )
+{
+	va_list xArgs;
+
+	pthread_mutex_lock( &xLoggingMutex );
+	va_start( xArgs, pcFormat );
+	vprintf( pcFormat, xArgs );
+	va_end( xArgs );
+	fflush( stdout );
+	pthread_mutex_unlock( &xLoggingMutex );
+}
+
+
+void *pvPortMalloc( size_t xSize )
+{
+	return malloc( xSize );
+}
+
+
+void vPortFree( void *pv )
+{
+	free( pv );
+}
+
+
+void vPortEnterCritical( void )
+{
+	pthread_once( &xCriticalOnce, prvCriticalInit );
+	pthread_mutex_lock( &xCriticalMutex );
+}
+
+
+void vPortExitCritical( void )
+{
+	pthread_mutex_unlock( &xCriticalMutex );
+}
+
+
+TickType_t xTaskGetTickCount( void )
+{
+	struct timespec xNow;
+
+	pthread_once( &xStartOnce, prvStartInit );
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+	return ( TickType_t )( ( xNow.tv_sec - xStart.tv_sec ) * configTICK_RATE_HZ +
+			( xNow.tv_nsec - xStart.tv_nsec ) / ( 1000000000L / configTICK_RATE_HZ ) );
+}
+
+
+void vTaskDelay( const TickType_t xTicksToDelay )
+{
+	struct timespec xDelay = {
+		.tv_sec = xTicksToDelay / configTICK_RATE_HZ,
+		.tv_nsec = ( long )( xTicksToDelay % configTICK_RATE_HZ ) * ( 1000000000L / configTICK_RATE_HZ )
+	};
+
+	nanosleep( &xDelay, NULL );
+}
+
+
+void vTaskSetTimeOutState( TimeOut_t * const pxTimeOut )
+{
+	pxTimeOut->xTimeOnEntering = xTaskGetTickCount();
+}
+
+
+BaseType_t xTaskCheckForTimeOut( TimeOut_t * const pxTimeOut, TickType_t * const pxTicksToWait )
+{
+	TickType_t xNow = xTaskGetTickCount();
+	TickType_t xElapsed = xNow - pxTimeOut->xTimeOnEntering;
+
+	if( *pxTicksToWait == portMAX_DELAY )
+	{
+		return pdFALSE;
+	}
+	if( xElapsed >= *pxTicksToWait )
+	{
+		*pxTicksToWait = 0;
+		return pdTRUE;
+	}
+
+	*pxTicksToWait -= xElapsed;
+	pxTimeOut->xTimeOnEntering = xNow;
+
+	return pdFALSE;
+}
+
+
+static void *prvTaskEntry( void *pvArg )
+{
+	HostTask_t xTask = *( HostTask_t * )pvArg;
+
+	free( pvArg );
+	xTask.pxTaskCode( xTask.pvParameters );
+
+	return NULL;
+}
+
+
+/* Detached thread, the task ends with vTaskDelete( NULL ) or by returning */
+BaseType_t xTaskCreate( TaskFunction_t pxTaskCode, const char * const pcName, const uint16_t usStackDepth,
+						void * const pvParameters, UBaseType_t uxPriority, TaskHandle_t * const pxCreatedTask )
+{
+	HostTask_t *pxTask = malloc( sizeof( HostTask_t ) );
+	pthread_t xThread;
+
+	( void )pcName;
+	( void )usStackDepth;
+	( void )uxPriority;
+
+	if( pxTask == NULL )
+	{
+		return pdFAIL;
+	}
+	pxTask->pxTaskCode = pxTaskCode;
+	pxTask->pvParameters = pvParameters;
+
+	if( pthread_create( &xThread, NULL, prvTaskEntry, pxTask ) != 0 )
+	{
+		free( pxTask );
+		return pdFAIL;
+	}
+	pthread_detach( xThread );
+
+	if( pxCreatedTask != NULL )
+	{
+		*pxCreatedTask = ( TaskHandle_t )xThread;
+	}
+
+	return pdPASS;
+}
+
+
+/* Only a task deleting itself */
+void vTaskDelete( TaskHandle_t xTaskToDelete )
+{
+	configASSERT( xTaskToDelete == NULL );
+
+	pthread_exit( NULL );
+}
+
+
+SemaphoreHandle_t xSemaphoreCreateBinary( void )
+{
+	HostSemaphore_t *pxSem = calloc( 1, sizeof( HostSemaphore_t ) );
+
+	if( pxSem != NULL )
+	{
+		pthread_mutex_init( &pxSem->xMutex, NULL );
+		pthread_cond_init( &pxSem->xCond, NULL );
+	}
+
+	return pxSem;
+}
+
+
+void vSemaphoreDelete( SemaphoreHandle_t xSemaphore )
+{
+	HostSemaphore_t *pxSem = xSemaphore;
+
+	pthread_cond_destroy( &pxSem->xCond );
+	pthread_mutex_destroy( &pxSem->xMutex );
+	free( pxSem );
+}
+
+
+BaseType_t xSemaphoreGive( SemaphoreHandle_t xSemaphore )
+{
+	HostSemaphore_t *pxSem = xSemaphore;
+	BaseType_t xRet = pdFALSE;
+
+	pthread_mutex_lock( &pxSem->xMutex );
+	if( pxSem->xCount == 0 )
+	{
+		pxSem->xCount = 1;
+		pthread_cond_signal( &pxSem->xCond );
+		xRet = pdTRUE;
+	}
+	pthread_mutex_unlock( &pxSem->xMutex );
+
+	return xRet;
+}
+
+
+BaseType_t xSemaphoreTake( SemaphoreHandle_t xSemaphore, TickType_t xBlockTime )
+{
+	HostSemaphore_t *pxSem = xSemaphore;
+	struct timespec xDeadline;
+	BaseType_t xRet;
+
+	prvDeadline( &xDeadline, xBlockTime );
+	pthread_mutex_lock( &pxSem->xMutex );
+	while( ( pxSem->xCount == 0 ) && ( xBlockTime != 0 ) && prvWait( &pxSem->xCond, &pxSem->xMutex, &xDeadline, xBlockTime ) )
+	{
+	}
+	xRet = pxSem->xCount;
+	pxSem->xCount = 0;
+	pthread_mutex_unlock( &pxSem->xMutex );
+
+	return xRet;
+}
+
+
+QueueHandle_t xQueueCreate( UBaseType_t uxQueueLength, UBaseType_t uxItemSize )
+{
+	HostQueue_t *pxQueue = calloc( 1, sizeof( HostQueue_t ) );
+
+	if( pxQueue == NULL )
+	{
+		return NULL;
+	}
+	pxQueue->pucItems = calloc( uxQueueLength, uxItemSize );
+	if( pxQueue->pucItems == NULL )
+	{
+		free( pxQueue );
+		return NULL;
+	}
+	pxQueue->uxLength = uxQueueLength;
+	pxQueue->uxItemSize = uxItemSize;
+	pthread_mutex_init( &pxQueue->xMutex, NULL );
+	pthread_cond_init( &pxQueue->xCond, NULL );
+
+	return pxQueue;
+}
+
+
+void vQueueDelete( QueueHandle_t xQueue )
+{
+	HostQueue_t *pxQueue = xQueue;
+
+	pthread_cond_destroy( &pxQueue->xCond );
+	pthread_mutex_destroy( &pxQueue->xMutex );
+	free( pxQueue->pucItems );
+	free( pxQueue );
+}
+
+
+BaseType_t xQueueSend( QueueHandle_t xQueue, const void * const pvItemToQueue, TickType_t xTicksToWait )
+{
+	HostQueue_t *pxQueue = xQueue;
+	struct timespec xDeadline;
+	BaseType_t xRet = pdFALSE;
+
+	prvDeadline( &xDeadline, xTicksToWait );
+	pthread_mutex_lock( &pxQueue->xMutex );
+	while( ( pxQueue->uxWaiting == pxQueue->uxLength ) && ( xTicksToWait != 0 ) &&
+			prvWait( &pxQueue->xCond, &pxQueue->xMutex, &xDeadline, xTicksToWait ) )
+	{
+	}
+	if( pxQueue->uxWaiting < pxQueue->uxLength )
+	{
+		memcpy( &pxQueue->pucItems[( ( pxQueue->uxRead + pxQueue->uxWaiting ) % pxQueue->uxLength ) * pxQueue->uxItemSize],
+				pvItemToQueue, pxQueue->uxItemSize );
+		pxQueue->uxWaiting++;
+		pthread_cond_broadcast( &pxQueue->xCond );
+		xRet = pdTRUE;
+	}
+	pthread_mutex_unlock( &pxQueue->xMutex );
+
+	return xRet;
+}
+
+
+BaseType_t xQueueReceive( QueueHandle_t xQueue, void * const pvBuffer, TickType_t xTicksToWait )
+{
+	HostQueue_t *pxQueue = xQueue;
+	struct timespec xDeadline;
+	BaseType_t xRet = pdFALSE;
+
+	prvDeadline( &xDeadline, xTicksToWait );
+	pthread_mutex_lock( &pxQueue->xMutex );
+	while( ( pxQueue->uxWaiting == 0 ) && ( xTicksToWait != 0 ) &&
+			prvWait( &pxQueue->xCond, &pxQueue->xMutex, &xDeadline, xTicksToWait ) )
+	{
+	}
+	if( pxQueue->uxWaiting > 0 )
+	{
+		memcpy( pvBuffer, &pxQueue->pucItems[pxQueue->uxRead * pxQueue->uxItemSize], pxQueue->uxItemSize );
+		pxQueue->uxRead = ( pxQueue->uxRead + 1 ) % pxQueue->uxLength;
+		pxQueue->uxWaiting--;
+		pthread_cond_broadcast( &pxQueue->xCond );
+		xRet = pdTRUE;
+	}
+	pthread_mutex_unlock( &pxQueue->xMutex );
+
+	return xRet;
+}
+
+
+BaseType_t xQueueReset( QueueHandle_t xQueue )
+{
+	HostQueue_t *pxQueue = xQueue;
+
+	pthread_mutex_lock( &pxQueue->xMutex );
+	pxQueue->uxWaiting = 0;
+	pxQueue->uxRead = 0;
+	pthread_cond_broadcast( &pxQueue->xCond );
+	pthread_mutex_unlock( &pxQueue->xMutex );
+
+	return pdPASS;
+}
@@ -21,6 +21,8 @@
  *
  */
 
+#include <string.h>
+
 #include "json/json_sensor.h"
 #include "converting.h"
 #include "mqtt_task.h"
@@ -29,6 +31,12 @@
 static char cBufferJSON[4096];
 static InfineonSensorsMessage_t xSensorsMessage;
 
+/* Small writer buffer for the partial flush test */
+#define JSON_FLUSH_TEST_BUF_SIZE		( 48 )
+static char cBufferFlushJSON[JSON_FLUSH_TEST_BUF_SIZE];
+static char cBufferFlushedJSON[4096];
+static uint32_t ulFlushedLen;
+
 
 bool JSON_bSensorsShortTest( void )
 {
@@ -41,6 +49,8 @@ bool JSON_bSensorsShortTest( void )
     SensorContext_t xSensorCxt = { 0 };
     xSensorCxt.pxStat = &xStat;
     xSensorCxt.bOn = 1;
+    xSensorCxt.ucPrecision = JSON_FLOAT_PRECISION;
+    xSensorCxt.bReady = 1;
 
     while( 1 )
     {
@@ -117,7 +127,7 @@ bool JSON_bSensorsFullTest( void )
 {
 	bool bRet;
 
-	bRet = JSON_bGenerateToSend( &xSensorsMessage, (char*)cBufferJSON, sizeof(cBufferJSON) );
+	bRet = JSON_bGenerateToSend( &xSensorsMessage, (char*)cBufferJSON, sizeof(cBufferJSON), NULL );
 
     if( bRet )
     {
@@ -130,3 +140,103 @@ bool JSON_bSensorsFullTest( void )
         return false;
     }
 }
+
+
+static bool prvFlushTestCallback( const char *pcData, uint32_t ulLen, void *pvArg )
+{
+	( void )pvArg;
+
+	if( ulFlushedLen + ulLen >= sizeof( cBufferFlushedJSON ) )
+	{
+		return false;
+	}
+	memcpy( &cBufferFlushedJSON[ulFlushedLen], pcData, ulLen );
+	ulFlushedLen += ulLen;
+	cBufferFlushedJSON[ulFlushedLen] = 0;
+
+	return true;
+}
+
+
+static bool prvFlushTestGenerate( char *pcBuf, uint32_t ulBufSize, bool bFlush, uint32_t *pulLen )
+{
+	static const SensorContext_t xSensorCxtEmpty;
+	SensorContext_t xSensorCxt = xSensorCxtEmpty;
+	JsonContext_t xJsonCxt;
+	StatData_t xStat = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f };
+	FFTData_t xFft;
+
+	for( int i = 0; i < ( sizeof(xFft.data) / sizeof(xFft.data[0]) ); i++ )
+	{
+		xFft.data[i] = i * 101;
+	}
+
+	if( !JSON_bCreate( &xJsonCxt, pcBuf, ulBufSize ) )
+	{
+		return false;
+	}
+	if( bFlush && !JSON_bFlushSet( &xJsonCxt, prvFlushTestCallback, NULL ) )
+	{
+		return false;
+	}
+
+	xSensorCxt.bOn = 1;
+	xSensorCxt.bReady = 1;
+	xSensorCxt.pxStat = &xStat;
+	xSensorCxt.ucPrecision = JSON_FLOAT_PRECISION;
+	xSensorCxt.pcName = pcJsonSensorsStatString[JSON_STATISTIC_SENSOR_DPS368_TEMP_1];
+	if( !JSON_bSensorAdd( &xJsonCxt, &xSensorCxt ) )
+	{
+		return false;
+	}
+
+	xSensorCxt.pxFft = &xFft;
+	xSensorCxt.pcName = pcJsonSensorsStatString[JSON_STATISTIC_SENSOR_IM69D_MIC_1];
+	if( !JSON_bSensorAdd( &xJsonCxt, &xSensorCxt ) )
+	{
+		return false;
+	}
+
+	return JSON_bFinish( &xJsonCxt, pulLen );
+}
+
+
+/* The same document through a buffer smaller than it and a flush callback */
+bool JSON_bSensorsFlushTest( void )
+{
+	bool bRet = false;
+	uint32_t ulLen = 0;
+	uint32_t ulFlushLen = 0;
+
+	while( 1 )
+	{
+		if( !prvFlushTestGenerate( cBufferJSON, sizeof( cBufferJSON ), false, &ulLen ) || ( ulLen != strlen( cBufferJSON ) ) )
+		{
+			break;
+		}
+
+		/* Does not fit without the callback, the sensor entry cut short is taken out again */
+		if( prvFlushTestGenerate( cBufferFlushJSON, sizeof( cBufferFlushJSON ), false, NULL ) ||
+			( strcmp( cBufferFlushJSON, "{" ) != 0 ) )
+		{
+			break;
+		}
+
+		ulFlushedLen = 0;
+		if( !prvFlushTestGenerate( cBufferFlushJSON, sizeof( cBufferFlushJSON ), true, &ulFlushLen ) )
+		{
+			break;
+		}
+		if( ( ulFlushLen != ulLen ) || ( ulFlushedLen != ulLen ) || ( memcmp( cBufferFlushedJSON, cBufferJSON, ulLen ) != 0 ) )
+		{
+			break;
+		}
+
+		bRet = true;
+		break;
+	}
+
+	configPRINTF( ("JSON Flush test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
@@ -26,6 +26,7 @@
 
 bool JSON_bSensorsShortTest( void );
 bool JSON_bSensorsFullTest( void );
+bool JSON_bSensorsFlushTest( void );
 
 
 #endif /* JSON_SENSOR_TEST_H */
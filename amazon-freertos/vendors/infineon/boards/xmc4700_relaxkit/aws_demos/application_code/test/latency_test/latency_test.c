@@ -0,0 +1,202 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#include <stdbool.h>
+#include <string.h>
+
+#include "latency_test.h"
+#include "latency.h"
+
+#include "iot_demo_logging.h"
+#include "xmc_device.h"
+
+
+/* Stamp ulUs after the start of the trace, within one tick so the cycles are used */
+static void prvStampUs( LatencyTrace_t *pxTrace, LatencyPoint_t xPoint, uint32_t ulUs )
+{
+	LatencyStamp_t xStamp = { ( ulUs * ( SystemCoreClock / 1000000 ) ), 1000 };
+
+	LATENCY_vStampAt( pxTrace, xPoint, &xStamp );
+}
+
+
+/* Each stage takes the time since the point before it, points not stamped fold into the next stage */
+static bool prvStageTest( void )
+{
+	LatencyTrace_t xTrace;
+	LatencyStat_t xStat;
+
+	LATENCY_vInit();
+
+	prvStampUs( &xTrace, LATENCY_WINDOW, 0 );
+	prvStampUs( &xTrace, LATENCY_STATS, 1000 );
+	prvStampUs( &xTrace, LATENCY_QUEUE_OUT, 3000 );
+	prvStampUs( &xTrace, LATENCY_ENCODE, 3100 );
+	prvStampUs( &xTrace, LATENCY_WRITE, 3200 );
+	prvStampUs( &xTrace, LATENCY_ACK, 5000 );
+	LATENCY_vComplete( &xTrace );
+
+	LATENCY_vStatGet( LATENCY_SPECTRA, &xStat );
+	if( xStat.ulCount != 0 )
+	{
+		return false;
+	}
+
+	LATENCY_vStatGet( LATENCY_STATS, &xStat );
+	if( ( xStat.ulCount != 1 ) || ( xStat.ulP50 != 1000 ) || ( xStat.ulMax != 1000 ) )
+	{
+		return false;
+	}
+
+	LATENCY_vStatGet( LATENCY_QUEUE_OUT, &xStat );
+	if( ( xStat.ulCount != 1 ) || ( xStat.ulP99 != 2000 ) )
+	{
+		return false;
+	}
+
+	LATENCY_vStatGet( LATENCY_ACK, &xStat );
+	if( ( xStat.ulCount != 1 ) || ( xStat.ulMax != 1800 ) )
+	{
+		return false;
+	}
+
+	LATENCY_vStatGet( LATENCY_WINDOW, &xStat );
+	if( ( xStat.ulCount != 1 ) || ( xStat.ulMax != 5000 ) )
+	{
+		return false;
+	}
+
+	/* A completed trace is not counted twice */
+	LATENCY_vComplete( &xTrace );
+	LATENCY_vStatGet( LATENCY_WINDOW, &xStat );
+
+	return ( xStat.ulCount == 1 );
+}
+
+
+/* Percentiles from the buckets, the histograms are halved after LATENCY_ROLL traces */
+static bool prvRollTest( void )
+{
+	LatencyTrace_t xTrace;
+	LatencyStat_t xStat;
+
+	LATENCY_vInit();
+
+	for( uint32_t i = 0; i < ( LATENCY_ROLL - 1 ); ++i )
+	{
+		prvStampUs( &xTrace, LATENCY_WINDOW, 0 );
+		prvStampUs( &xTrace, LATENCY_ENCODE, ( i < 9 ) ? 10000 : 100 );
+		LATENCY_vComplete( &xTrace );
+	}
+
+	LATENCY_vStatGet( LATENCY_ENCODE, &xStat );
+	if( ( xStat.ulCount != ( LATENCY_ROLL - 1 ) ) || ( xStat.ulP50 != 2 * LATENCY_BUCKET_MIN ) ||
+		( xStat.ulP90 != 2 * LATENCY_BUCKET_MIN ) || ( xStat.ulP99 != 10000 ) || ( xStat.ulMax != 10000 ) )
+	{
+		return false;
+	}
+
+	prvStampUs( &xTrace, LATENCY_WINDOW, 0 );
+	prvStampUs( &xTrace, LATENCY_ENCODE, 100 );
+	LATENCY_vComplete( &xTrace );
+
+	/* The maximum of the roll before is kept */
+	LATENCY_vStatGet( LATENCY_ENCODE, &xStat );
+
+	return ( xStat.ulCount < LATENCY_ROLL ) && ( xStat.ulCount >= ( LATENCY_ROLL / 2 - 1 ) ) && ( xStat.ulMax == 10000 );
+}
+
+
+/* Gaps the cycle counter can't span are taken from the tick */
+static bool prvLongTest( void )
+{
+	LatencyTrace_t xTrace;
+	LatencyStat_t xStat;
+	LatencyStamp_t xStart = { 0, 1000 };
+	LatencyStamp_t xEnd = { 0, 1000 + 40000 };
+
+	LATENCY_vInit();
+
+	LATENCY_vStampAt( &xTrace, LATENCY_WINDOW, &xStart );
+	LATENCY_vStampAt( &xTrace, LATENCY_QUEUE_IN, &xEnd );
+	LATENCY_vComplete( &xTrace );
+
+	LATENCY_vStatGet( LATENCY_QUEUE_IN, &xStat );
+
+	return ( xStat.ulCount == 1 ) && ( xStat.ulP50 == 40000000 ) && ( xStat.ulMax == 40000000 );
+}
+
+
+/* The write of a payload comes from the socket ports, none is made up without one */
+static bool prvWriteTest( void )
+{
+	LatencyTrace_t xTrace;
+	LatencyStat_t xStat;
+
+	LATENCY_vInit();
+
+	LATENCY_vStamp( &xTrace, LATENCY_WINDOW );
+	LATENCY_vStamp( &xTrace, LATENCY_ENCODE );
+	LATENCY_vStamp( &xTrace, LATENCY_ACK );
+	LATENCY_vComplete( &xTrace );
+
+	LATENCY_vStatGet( LATENCY_WRITE, &xStat );
+	if( xStat.ulCount != 0 )
+	{
+		return false;
+	}
+
+	LATENCY_vStamp( &xTrace, LATENCY_WINDOW );
+	LATENCY_vStamp( &xTrace, LATENCY_ENCODE );
+	LATENCY_vWrite();
+	LATENCY_vStamp( &xTrace, LATENCY_ACK );
+	LATENCY_vComplete( &xTrace );
+
+	LATENCY_vStatGet( LATENCY_WRITE, &xStat );
+
+	return ( xStat.ulCount == 1 );
+}
+
+
+static bool prvJsonTest( void )
+{
+	char cJson[512];
+	char cShort[16];
+
+	uint32_t ulLen = LATENCY_ulJson( cJson, sizeof( cJson ) );
+
+	return ( ulLen > 0 ) && ( ulLen == strlen( cJson ) ) && ( strncmp( cJson, "{\"latency_us\":{\"total\":{\"n\":2,", 30 ) == 0 ) &&
+		( cJson[ulLen - 1] == '}' ) && ( LATENCY_ulJson( cShort, sizeof( cShort ) ) == 0 );
+}
+
+
+bool LATENCY_bTest( void )
+{
+	bool bRet = prvStageTest() && prvRollTest() && prvLongTest() && prvWriteTest() && prvJsonTest();
+
+	/* The histograms start empty for the windows */
+	LATENCY_vInit();
+
+	configPRINTF( ("Latency test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
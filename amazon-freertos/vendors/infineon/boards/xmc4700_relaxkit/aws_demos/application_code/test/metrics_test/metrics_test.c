@@ -0,0 +1,126 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#include <stdbool.h>
+#include <string.h>
+
+#include "metrics_test.h"
+#include "metrics.h"
+
+#include "iot_demo_logging.h"
+
+
+static MetricsData_t xData;
+static char cReport[METRICS_REPORT_SIZE];
+
+
+/* CPU shares of the period since the call before, a task created since then has all its run time in the period */
+static bool prvTasksTest( void )
+{
+	MetricsTaskSample_t xFirst[] = { { "IDLE", 1, 600, 400 }, { "Tmr Svc", 2, 400, 1024 } };
+	MetricsTaskSample_t xSecond[] = { { "IDLE", 1, 1400, 380 }, { "Tmr Svc", 2, 500, 1000 }, { "Tmr Svc", 5, 100, 2048 } };
+
+	METRICS_vInit();
+	METRICS_vTasks( &xData, xFirst, 2, 1000 );
+	if( ( xData.ucTasks != 2 ) || ( xData.xTask[0].usCpu != 600 ) || ( xData.xTask[1].usCpu != 400 ) ||
+		( strcmp( xData.xTask[1].cName, "Tmr_Svc" ) != 0 ) || ( xData.xTask[1].ulStackFree != 1024 ) )
+	{
+		return false;
+	}
+
+	METRICS_vTasks( &xData, xSecond, 3, 2000 );
+	if( ( xData.ucTasks != 3 ) || ( xData.xTask[0].usCpu != 800 ) || ( xData.xTask[1].usCpu != 100 ) ||
+		( xData.xTask[2].usCpu != 100 ) || ( xData.xTask[0].ulStackFree != 380 ) )
+	{
+		return false;
+	}
+
+	/* No time passed, nothing to share */
+	METRICS_vTasks( &xData, xSecond, 3, 2000 );
+
+	return ( xData.xTask[0].usCpu == 0 ) && ( xData.xTask[2].usCpu == 0 );
+}
+
+
+/* Defender document with every counter a custom metric of type number */
+static bool prvReportTest( void )
+{
+	static const char cExpected[] = "{\"header\":{\"report_id\":77,\"version\":\"1.0\"},\"metrics\":{},\"custom_metrics\":{"
+			"\"uptime_s\":[{\"number\":3600}],\"heap_free\":[{\"number\":20000}],\"heap_low\":[{\"number\":15000}],"
+			"\"pool_dropped\":[{\"number\":2}],\"latency_p50_us\":[{\"number\":4096}],\"latency_p90_us\":[{\"number\":8192}],"
+			"\"latency_p99_us\":[{\"number\":65536}],\"bus_errors\":[{\"number\":5}],\"reconnects\":[{\"number\":1}],"
+			"\"cpu_IDLE\":[{\"number\":750}],\"stack_IDLE\":[{\"number\":400}]}}";
+	uint32_t ulLen;
+
+	memset( &xData, 0, sizeof( xData ) );
+	xData.ucTasks = 1;
+	strcpy( xData.xTask[0].cName, "IDLE" );
+	xData.xTask[0].usCpu = 750;
+	xData.xTask[0].ulStackFree = 400;
+	xData.ulUptime = 3600;
+	xData.ulHeapFree = 20000;
+	xData.ulHeapLow = 15000;
+	xData.ulDropped = 2;
+	xData.ulLatencyP50 = 4096;
+	xData.ulLatencyP90 = 8192;
+	xData.ulLatencyP99 = 65536;
+	xData.ulBusErrors = 5;
+	xData.ulReconnects = 1;
+
+	ulLen = METRICS_ulReport( &xData, 77, cReport, sizeof( cReport ) );
+	if( ( ulLen != strlen( cExpected ) ) || ( strcmp( cReport, cExpected ) != 0 ) )
+	{
+		return false;
+	}
+
+	/* A buffer short of a byte takes nothing */
+	return ( METRICS_ulReport( &xData, 77, cReport, ulLen ) == 0 ) && ( METRICS_ulReport( &xData, 77, cReport, ulLen + 1 ) == ulLen );
+}
+
+
+/* The largest report fits the size it is given */
+static bool prvSizeTest( void )
+{
+	memset( &xData, 0xff, sizeof( xData ) );
+	xData.ucTasks = METRICS_TASKS_MAX;
+	for( uint32_t i = 0; i < METRICS_TASKS_MAX; i++ )
+	{
+		memset( xData.xTask[i].cName, 'x', METRICS_NAME_LEN - 1 );
+		xData.xTask[i].cName[METRICS_NAME_LEN - 1] = '\0';
+		xData.xTask[i].usCpu = 1000;
+	}
+
+	return METRICS_ulReport( &xData, 0xffffffff, cReport, sizeof( cReport ) ) > 0;
+}
+
+
+bool METRICS_bTest( void )
+{
+	bool bRet = prvTasksTest() && prvReportTest() && prvSizeTest();
+
+	/* The first report of the MQTT task is since the start */
+	METRICS_vInit();
+
+	configPRINTF( ("Metrics test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
@@ -0,0 +1,260 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "msg_pool_test.h"
+#include "msg_pool.h"
+
+#include "iot_demo_logging.h"
+
+
+#define MSG_POOL_TEST_SIZE		( 3 )
+
+
+static InfineonSensorsMessage_t xTestMessages[MSG_POOL_TEST_SIZE];
+static MsgPool_t xTestPool;
+
+
+/* Fill the whole pool, the window number goes into the message to track it through the queue */
+static bool prvFill( InfineonSensorsMessage_t **ppxMessages )
+{
+	for( uint8_t i = 0; i < MSG_POOL_TEST_SIZE; i++ )
+	{
+		ppxMessages[i] = MSG_POOL_pxAcquire( &xTestPool );
+		if( ppxMessages[i] == NULL )
+		{
+			return false;
+		}
+		ppxMessages[i]->xClassifier.ucClasses = i;
+		MSG_POOL_vPost( &xTestPool, ppxMessages[i], MSG_POOL_LANE_BULK );
+	}
+
+	/* All buffers distinct */
+	return ( ppxMessages[0] != ppxMessages[1] ) && ( ppxMessages[1] != ppxMessages[2] ) && ( ppxMessages[0] != ppxMessages[2] );
+}
+
+
+static bool prvDropOldestTest( void )
+{
+	InfineonSensorsMessage_t *pxMessages[MSG_POOL_TEST_SIZE];
+	InfineonSensorsMessage_t *pxMessage = NULL;
+	MsgPoolStat_t xStat;
+	bool bRet = false;
+
+	if( !MSG_POOL_bInit( &xTestPool, xTestMessages, MSG_POOL_TEST_SIZE, MSG_POOL_DROP_OLDEST ) )
+	{
+		return false;
+	}
+
+	while( 1 )
+	{
+		if( !prvFill( pxMessages ) )
+		{
+			break;
+		}
+
+		/* No free buffer, the oldest queued window is reclaimed */
+		pxMessage = MSG_POOL_pxAcquire( &xTestPool );
+		if( pxMessage != pxMessages[0] )
+		{
+			break;
+		}
+		pxMessage->xClassifier.ucClasses = MSG_POOL_TEST_SIZE;
+		MSG_POOL_vPost( &xTestPool, pxMessage, MSG_POOL_LANE_BULK );
+
+		/* The consumer sees windows 1, 2, 3 in order */
+		for( uint8_t i = 1; i <= MSG_POOL_TEST_SIZE; i++ )
+		{
+			if( !MSG_POOL_bReceive( &xTestPool, &pxMessage, MSG_POOL_LANE_BULK, NULL, 0 ) || ( pxMessage->xClassifier.ucClasses != i ) )
+			{
+				pxMessage = NULL;
+				break;
+			}
+			MSG_POOL_vRelease( &xTestPool, pxMessage );
+		}
+		if( pxMessage == NULL )
+		{
+			break;
+		}
+
+		/* Empty queue doesn't block */
+		if( MSG_POOL_bReceive( &xTestPool, &pxMessage, MSG_POOL_LANE_BULK, NULL, 0 ) )
+		{
+			break;
+		}
+
+		MSG_POOL_vStatGet( &xTestPool, &xStat );
+		if( ( xStat.ulPosted != MSG_POOL_TEST_SIZE + 1 ) || ( xStat.ulDroppedOldest != 1 ) ||
+			( xStat.ulDroppedNewest != 0 ) || ( xStat.ucInUseMax != MSG_POOL_TEST_SIZE ) )
+		{
+			break;
+		}
+
+		/* Released buffers are reused */
+		bRet = ( MSG_POOL_pxAcquire( &xTestPool ) != NULL );
+		break;
+	}
+
+	MSG_POOL_vDelete( &xTestPool );
+
+	return bRet;
+}
+
+
+static bool prvDropNewestTest( void )
+{
+	InfineonSensorsMessage_t *pxMessages[MSG_POOL_TEST_SIZE];
+	InfineonSensorsMessage_t *pxMessage = NULL;
+	MsgPoolStat_t xStat;
+	bool bRet = false;
+
+	if( !MSG_POOL_bInit( &xTestPool, xTestMessages, MSG_POOL_TEST_SIZE, MSG_POOL_DROP_NEWEST ) )
+	{
+		return false;
+	}
+
+	while( 1 )
+	{
+		if( !prvFill( pxMessages ) )
+		{
+			break;
+		}
+
+		/* No free buffer, the new window is skipped and the queue is kept */
+		if( MSG_POOL_pxAcquire( &xTestPool ) != NULL )
+		{
+			break;
+		}
+
+		for( uint8_t i = 0; i < MSG_POOL_TEST_SIZE; i++ )
+		{
+			if( !MSG_POOL_bReceive( &xTestPool, &pxMessage, MSG_POOL_LANE_BULK, NULL, 0 ) || ( pxMessage != pxMessages[i] ) )
+			{
+				pxMessage = NULL;
+				break;
+			}
+			MSG_POOL_vRelease( &xTestPool, pxMessage );
+		}
+		if( pxMessage == NULL )
+		{
+			break;
+		}
+
+		MSG_POOL_vStatGet( &xTestPool, &xStat );
+		bRet = ( xStat.ulPosted == MSG_POOL_TEST_SIZE ) && ( xStat.ulDroppedOldest == 0 ) && ( xStat.ulDroppedNewest == 1 );
+		break;
+	}
+
+	MSG_POOL_vDelete( &xTestPool );
+
+	return bRet;
+}
+
+
+/* An alarm overtakes the queued routine windows and is never reclaimed */
+static bool prvLaneTest( void )
+{
+	InfineonSensorsMessage_t *pxMessages[MSG_POOL_TEST_SIZE] = { NULL };
+	InfineonSensorsMessage_t *pxMessage = NULL;
+	MsgPoolLane_t xLane = MSG_POOL_LANE_BULK;
+	MsgPoolStat_t xStat;
+	bool bRet = false;
+
+	if( !MSG_POOL_bInit( &xTestPool, xTestMessages, MSG_POOL_TEST_SIZE, MSG_POOL_DROP_OLDEST ) )
+	{
+		return false;
+	}
+
+	while( 1 )
+	{
+		/* Two routine windows, then an alarm */
+		for( uint8_t i = 0; i < MSG_POOL_TEST_SIZE; i++ )
+		{
+			pxMessages[i] = MSG_POOL_pxAcquire( &xTestPool );
+			if( pxMessages[i] == NULL )
+			{
+				break;
+			}
+			MSG_POOL_vPost( &xTestPool, pxMessages[i], ( i == MSG_POOL_TEST_SIZE - 1 ) ? MSG_POOL_LANE_HIGH : MSG_POOL_LANE_BULK );
+		}
+		if( pxMessages[MSG_POOL_TEST_SIZE - 1] == NULL )
+		{
+			break;
+		}
+
+		/* The pool is full, the oldest routine window is reclaimed, not the alarm */
+		pxMessage = MSG_POOL_pxAcquire( &xTestPool );
+		if( pxMessage != pxMessages[0] )
+		{
+			break;
+		}
+		MSG_POOL_vPost( &xTestPool, pxMessage, MSG_POOL_LANE_BULK );
+		if( MSG_POOL_ucQueued( &xTestPool ) != MSG_POOL_TEST_SIZE )
+		{
+			break;
+		}
+
+		/* Alarm first, even when only the high lane is asked for */
+		if( !MSG_POOL_bReceive( &xTestPool, &pxMessage, MSG_POOL_LANE_HIGH, &xLane, 0 ) ||
+			( pxMessage != pxMessages[MSG_POOL_TEST_SIZE - 1] ) || ( xLane != MSG_POOL_LANE_HIGH ) )
+		{
+			break;
+		}
+		MSG_POOL_vRelease( &xTestPool, pxMessage );
+
+		/* Routine windows wait while the bulk lane is held back */
+		if( MSG_POOL_bReceive( &xTestPool, &pxMessage, MSG_POOL_LANE_HIGH, &xLane, 2 ) )
+		{
+			break;
+		}
+
+		/* Then in their order */
+		if( !MSG_POOL_bReceive( &xTestPool, &pxMessage, MSG_POOL_LANE_BULK, &xLane, 0 ) ||
+			( pxMessage != pxMessages[1] ) || ( xLane != MSG_POOL_LANE_BULK ) ||
+			!MSG_POOL_bReceive( &xTestPool, &pxMessage, MSG_POOL_LANE_BULK, &xLane, 0 ) ||
+			( pxMessage != pxMessages[0] ) )
+		{
+			break;
+		}
+
+		MSG_POOL_vStatGet( &xTestPool, &xStat );
+		bRet = ( xStat.ulPosted == MSG_POOL_TEST_SIZE + 1 ) && ( xStat.ulPostedHigh == 1 ) && ( xStat.ulDroppedOldest == 1 );
+		break;
+	}
+
+	MSG_POOL_vDelete( &xTestPool );
+
+	return bRet;
+}
+
+
+bool MSG_POOL_bTest( void )
+{
+	bool bRet = prvDropOldestTest() && prvDropNewestTest() && prvLaneTest();
+
+	configPRINTF( ("Message pool test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
@@ -0,0 +1,544 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+/**
+ * Pipeline against a stand-in broker over a loopback TCP connection. The transport
+ * writes every publish to the socket, the broker task answers it PIPE_TEST_LATENCY
+ * after it was sent and a reader task hands the answers to PIPE_bComplete, as the
+ * MQTT library does from its own task. Host build only, see test/host.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "pipeline_test.h"
+#include "pipeline.h"
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+
+#include "iot_demo_logging.h"
+
+
+#define PIPE_TEST_SLOT_SIZE			( 64 )
+#define PIPE_TEST_COUNT				( 12 )
+/* Round trip of the stand-in broker */
+#define PIPE_TEST_LATENCY			pdMS_TO_TICKS( 20 )
+#define PIPE_TEST_TIMEOUT			pdMS_TO_TICKS( 2000 )
+
+
+/* Publish on the way to the broker */
+typedef struct {
+	uint32_t ulToken;
+	uint32_t ulIndex;			/* From the payload */
+	TickType_t xSent;
+
+} PipeTestPacket_t;
+
+/* Answer of the broker */
+typedef struct {
+	uint32_t ulToken;
+	uint32_t ulAcked;
+
+} PipeTestAck_t;
+
+
+static uint8_t pucTestBuffers[PIPE_SLOTS_MAX * PIPE_TEST_SLOT_SIZE];
+static Pipe_t xTestPipe;
+
+/* Listening socket of the broker and the client end of the connection */
+static int lTestListen = -1;
+static int lTestSocket = -1;
+/* Given by the broker task and the reader task when they end */
+static SemaphoreHandle_t xTestBrokerExit = NULL;
+static SemaphoreHandle_t xTestReaderExit = NULL;
+/* Down the broker fails every publish, a refusing transport doesn't start any */
+static volatile bool bTestBrokerDown = false;
+static volatile bool bTestRefuse = false;
+/* Held the broker reads nothing, dropping it reads the publishes but never answers, as on a dead connection */
+static volatile bool bTestHold = false;
+static volatile bool bTestDrop = false;
+static volatile uint32_t ulTestDropped;
+/* Payload indexes in the order the broker acknowledged them */
+static uint32_t pulTestReceived[2 * PIPE_TEST_COUNT];
+static volatile uint8_t ucTestReceived;
+
+
+static bool prvTestPublish( void *pvContext, const PipeSlot_t *pxSlot, uint32_t ulToken )
+{
+	PipeTestPacket_t xPacket;
+
+	( void )pvContext;
+
+	if( bTestRefuse || ( lTestSocket < 0 ) || ( pxSlot->ulLen < sizeof( uint32_t ) ) )
+	{
+		return false;
+	}
+
+	xPacket.ulToken = ulToken;
+	memcpy( &xPacket.ulIndex, pxSlot->pucData, sizeof( uint32_t ) );
+	xPacket.xSent = xTaskGetTickCount();
+
+	return send( lTestSocket, &xPacket, sizeof( xPacket ), MSG_NOSIGNAL ) == ( ssize_t )sizeof( xPacket );
+}
+
+static const PipeTransport_t xTestTransport = { prvTestPublish, NULL };
+
+
+/* One connection after the other, every publish answered PIPE_TEST_LATENCY after it was sent */
+static void prvTestBrokerTask( void *pvParameters )
+{
+	PipeTestPacket_t xPacket;
+	PipeTestAck_t xAck;
+	int lNoDelay = 1;
+	int lConn;
+
+	( void )pvParameters;
+
+	while( ( lConn = accept( lTestListen, NULL, NULL ) ) >= 0 )
+	{
+		setsockopt( lConn, IPPROTO_TCP, TCP_NODELAY, &lNoDelay, sizeof( lNoDelay ) );
+		while( 1 )
+		{
+			while( bTestHold )
+			{
+				vTaskDelay( 1 );
+			}
+			if( recv( lConn, &xPacket, sizeof( xPacket ), MSG_WAITALL ) != ( ssize_t )sizeof( xPacket ) )
+			{
+				break;
+			}
+			if( bTestDrop )
+			{
+				ulTestDropped++;
+				continue;
+			}
+
+			TickType_t xElapsed = xTaskGetTickCount() - xPacket.xSent;
+			if( xElapsed < PIPE_TEST_LATENCY )
+			{
+				vTaskDelay( PIPE_TEST_LATENCY - xElapsed );
+			}
+
+			if( !bTestBrokerDown && ( ucTestReceived < ( sizeof( pulTestReceived ) / sizeof( pulTestReceived[0] ) ) ) )
+			{
+				pulTestReceived[ucTestReceived++] = xPacket.ulIndex;
+			}
+			xAck.ulToken = xPacket.ulToken;
+			xAck.ulAcked = !bTestBrokerDown;
+			( void )send( lConn, &xAck, sizeof( xAck ), MSG_NOSIGNAL );
+		}
+		close( lConn );
+	}
+
+	xSemaphoreGive( xTestBrokerExit );
+	vTaskDelete( NULL );
+}
+
+
+/* Completions of the connection until it closes */
+static void prvTestReaderTask( void *pvParameters )
+{
+	PipeTestAck_t xAck;
+	int lSocket = ( int )( intptr_t )pvParameters;
+
+	while( recv( lSocket, &xAck, sizeof( xAck ), MSG_WAITALL ) == ( ssize_t )sizeof( xAck ) )
+	{
+		( void )PIPE_bComplete( &xTestPipe, xAck.ulToken, xAck.ulAcked != 0 );
+	}
+
+	xSemaphoreGive( xTestReaderExit );
+	vTaskDelete( NULL );
+}
+
+
+static bool prvConnect( void )
+{
+	struct sockaddr_in xAddr;
+	socklen_t xAddrLen = sizeof( xAddr );
+	int lNoDelay = 1;
+	int lSocket;
+
+	if( getsockname( lTestListen, ( struct sockaddr * )&xAddr, &xAddrLen ) != 0 )
+	{
+		return false;
+	}
+	lSocket = socket( AF_INET, SOCK_STREAM, 0 );
+	if( lSocket < 0 )
+	{
+		return false;
+	}
+	/* Every publish and answer goes out at once, no coalescing with the next one */
+	setsockopt( lSocket, IPPROTO_TCP, TCP_NODELAY, &lNoDelay, sizeof( lNoDelay ) );
+	if( ( connect( lSocket, ( struct sockaddr * )&xAddr, sizeof( xAddr ) ) != 0 ) ||
+		( xTaskCreate( prvTestReaderTask, "PipeReader", configMINIMAL_STACK_SIZE * 2, ( void * )( intptr_t )lSocket, tskIDLE_PRIORITY + 1, NULL ) != pdPASS ) )
+	{
+		close( lSocket );
+		return false;
+	}
+	lTestSocket = lSocket;
+
+	return true;
+}
+
+
+/* Transmissions still on the way are lost like on a dropped connection */
+static void prvDisconnect( void )
+{
+	int lSocket = lTestSocket;
+
+	if( lSocket >= 0 )
+	{
+		lTestSocket = -1;
+		shutdown( lSocket, SHUT_RDWR );
+		( void )xSemaphoreTake( xTestReaderExit, portMAX_DELAY );
+		close( lSocket );
+	}
+}
+
+
+static bool prvBegin( uint8_t ucSlots )
+{
+	bTestBrokerDown = false;
+	bTestRefuse = false;
+	bTestHold = false;
+	bTestDrop = false;
+	ucTestReceived = 0;
+
+	return PIPE_bInit( &xTestPipe, &xTestTransport, pucTestBuffers, PIPE_TEST_SLOT_SIZE, ucSlots ) && prvConnect();
+}
+
+
+static void prvEnd( void )
+{
+	bTestHold = false;
+	prvDisconnect();
+	PIPE_vDelete( &xTestPipe );
+}
+
+
+static bool prvSend( uint32_t ulIndex, TickType_t xTimeout )
+{
+	uint8_t pucPayload[PIPE_TEST_SLOT_SIZE];
+	static const char pcTopic[] = "test/pipe";
+
+	memset( pucPayload, ( int )ulIndex, sizeof( pucPayload ) );
+	memcpy( pucPayload, &ulIndex, sizeof( uint32_t ) );
+
+	return PIPE_bSend( &xTestPipe, pcTopic, sizeof( pcTopic ) - 1, 1, pucPayload, sizeof( pucPayload ), xTimeout );
+}
+
+
+/* The broker has the indexes ulFirst.. in order from position ucFrom on */
+static bool prvReceived( uint8_t ucFrom, uint32_t ulFirst, uint32_t ulCount )
+{
+	if( ucTestReceived != ucFrom + ulCount )
+	{
+		return false;
+	}
+
+	for( uint32_t i = 0; i < ulCount; i++ )
+	{
+		if( pulTestReceived[ucFrom + i] != ulFirst + i )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/* PIPE_TEST_COUNT publishes through a window of ucSlots, pxTicks gets the time until the last acknowledge */
+static bool prvRun( uint8_t ucSlots, TickType_t *pxTicks )
+{
+	PipeStat_t xStat;
+	bool bRet = false;
+
+	if( !prvBegin( ucSlots ) )
+	{
+		prvEnd();
+		return false;
+	}
+
+	while( 1 )
+	{
+		TickType_t xStart = xTaskGetTickCount();
+		uint32_t i;
+
+		for( i = 0; i < PIPE_TEST_COUNT; i++ )
+		{
+			if( !prvSend( i, PIPE_TEST_TIMEOUT ) )
+			{
+				break;
+			}
+		}
+		if( ( i < PIPE_TEST_COUNT ) || !PIPE_bIdle( &xTestPipe, PIPE_TEST_TIMEOUT ) )
+		{
+			break;
+		}
+		*pxTicks = xTaskGetTickCount() - xStart;
+
+		PIPE_vStatGet( &xTestPipe, &xStat );
+		if( ( xStat.ulSent != PIPE_TEST_COUNT ) || ( xStat.ulAcked != PIPE_TEST_COUNT ) || ( xStat.ulFailed != 0 ) ||
+			( xStat.ucInFlightMax != ucSlots ) || ( xStat.xRttMax < PIPE_TEST_LATENCY ) )
+		{
+			break;
+		}
+
+		/* In order and every slot back */
+		bRet = prvReceived( 0, 0, PIPE_TEST_COUNT ) && ( PIPE_ucUsed( &xTestPipe ) == 0 );
+		break;
+	}
+
+	prvEnd();
+
+	return bRet;
+}
+
+
+/* A window of 4 takes about a quarter of the round trips of one publish at a time */
+static bool prvWindowTest( void )
+{
+	TickType_t pxTicks[PIPE_SLOTS_MAX + 1] = { 0 };
+
+	for( uint8_t ucSlots = 1; ucSlots <= PIPE_SLOTS_MAX; ucSlots *= 2 )
+	{
+		if( !prvRun( ucSlots, &pxTicks[ucSlots] ) )
+		{
+			configPRINTF( ("Pipeline window %u failed\r\n", ucSlots) );
+			return false;
+		}
+		configPRINTF( ("Pipeline %u publishes, %u ms round trip, window %u: %u ms, %u publishes/s\r\n",
+				PIPE_TEST_COUNT, PIPE_TEST_LATENCY * portTICK_PERIOD_MS, ucSlots, pxTicks[ucSlots] * portTICK_PERIOD_MS,
+				( PIPE_TEST_COUNT * configTICK_RATE_HZ ) / ( pxTicks[ucSlots] ? pxTicks[ucSlots] : 1 )) );
+	}
+
+	return ( pxTicks[1] >= PIPE_TEST_COUNT * PIPE_TEST_LATENCY ) && ( 2 * pxTicks[4] < pxTicks[1] );
+}
+
+
+/* Failed publishes wait in their slots and go again in order after the reconnect */
+static bool prvReconnectTest( void )
+{
+	PipeStat_t xStat;
+	bool bRet = false;
+
+	while( prvBegin( 4 ) )
+	{
+		bTestBrokerDown = true;
+		for( uint32_t i = 0; i < 4; i++ )
+		{
+			if( !prvSend( i, 0 ) )
+			{
+				break;
+			}
+		}
+		if( !PIPE_bIdle( &xTestPipe, PIPE_TEST_TIMEOUT ) || ( PIPE_ucUsed( &xTestPipe ) != 4 ) || ( ucTestReceived != 0 ) )
+		{
+			break;
+		}
+
+		/* A late acknowledge of a failed transmission doesn't free the slot, only the resend does */
+		if( PIPE_bComplete( &xTestPipe, xTestPipe.ulToken, true ) || ( PIPE_ucUsed( &xTestPipe ) != 4 ) )
+		{
+			break;
+		}
+
+		/* Pending slots are not free */
+		if( prvSend( 4, PIPE_TEST_LATENCY ) )
+		{
+			break;
+		}
+
+		/* A new connection, a transport refusing the publish keeps the payload too */
+		prvDisconnect();
+		bTestBrokerDown = false;
+		if( !prvConnect() )
+		{
+			break;
+		}
+		bTestRefuse = true;
+		if( ( PIPE_ucResend( &xTestPipe ) != 0 ) || ( PIPE_ucUsed( &xTestPipe ) != 4 ) )
+		{
+			break;
+		}
+
+		bTestRefuse = false;
+		if( ( PIPE_ucResend( &xTestPipe ) != 4 ) || !PIPE_bIdle( &xTestPipe, PIPE_TEST_TIMEOUT ) ||
+			!prvReceived( 0, 0, 4 ) || ( PIPE_ucUsed( &xTestPipe ) != 0 ) )
+		{
+			break;
+		}
+
+		/* The window works on after the reconnect */
+		if( !prvSend( 4, 0 ) || !PIPE_bIdle( &xTestPipe, PIPE_TEST_TIMEOUT ) || !prvReceived( 0, 0, 5 ) )
+		{
+			break;
+		}
+
+		PIPE_vStatGet( &xTestPipe, &xStat );
+		bRet = ( xStat.ulAcked == 5 ) && ( xStat.ulResent == 4 ) && ( xStat.ulFailed == 5 ) && ( xStat.ulRejected == 1 );
+		break;
+	}
+
+	prvEnd();
+
+	return bRet;
+}
+
+
+/* The outcome of a transmission replaced by the resend is ignored */
+static bool prvStaleTest( void )
+{
+	bool bRet = false;
+	TickType_t xStart;
+
+	while( prvBegin( 2 ) )
+	{
+		/* Sent but never answered, the connection is dead */
+		bTestDrop = true;
+		ulTestDropped = 0;
+		if( !prvSend( 0, 0 ) )
+		{
+			break;
+		}
+		uint32_t ulStale = xTestPipe.ulToken;
+
+		xStart = xTaskGetTickCount();
+		while( ( ulTestDropped == 0 ) && ( xTaskGetTickCount() - xStart < PIPE_TEST_TIMEOUT ) )
+		{
+			vTaskDelay( 1 );
+		}
+		prvDisconnect();
+		bTestDrop = false;
+
+		if( ( ulTestDropped != 1 ) || !prvConnect() || ( PIPE_ucResend( &xTestPipe ) != 1 ) || PIPE_bComplete( &xTestPipe, ulStale, true ) ||
+			( PIPE_ucUsed( &xTestPipe ) != 1 ) )
+		{
+			break;
+		}
+
+		bRet = PIPE_bIdle( &xTestPipe, PIPE_TEST_TIMEOUT ) && prvReceived( 0, 0, 1 ) && ( PIPE_ucUsed( &xTestPipe ) == 0 );
+		break;
+	}
+
+	prvEnd();
+
+	return bRet;
+}
+
+
+/* Pending slots go out again on the same connection, the one in flight is left alone */
+static bool prvRetryTest( void )
+{
+	PipeStat_t xStat;
+	bool bRet = false;
+
+	while( prvBegin( 4 ) )
+	{
+		bTestBrokerDown = true;
+		if( !prvSend( 0, 0 ) || !prvSend( 1, 0 ) || !PIPE_bIdle( &xTestPipe, PIPE_TEST_TIMEOUT ) || ( PIPE_ucPending( &xTestPipe ) != 2 ) )
+		{
+			break;
+		}
+
+		/* The broker reads the new publish before the retransmissions, the stream keeps the order */
+		bTestBrokerDown = false;
+		bTestHold = true;
+		if( !prvSend( 2, 0 ) || ( PIPE_ucRetry( &xTestPipe ) != 2 ) || ( PIPE_ucPending( &xTestPipe ) != 0 ) )
+		{
+			break;
+		}
+		bTestHold = false;
+
+		if( !PIPE_bIdle( &xTestPipe, PIPE_TEST_TIMEOUT ) || ( PIPE_ucUsed( &xTestPipe ) != 0 ) || ( ucTestReceived != 3 ) ||
+			( pulTestReceived[0] != 2 ) || ( pulTestReceived[1] != 0 ) || ( pulTestReceived[2] != 1 ) )
+		{
+			break;
+		}
+
+		PIPE_vStatGet( &xTestPipe, &xStat );
+		bRet = ( xStat.ulAcked == 3 ) && ( xStat.ulResent == 2 ) && ( xStat.ulFailed == 2 );
+		break;
+	}
+
+	prvEnd();
+
+	return bRet;
+}
+
+
+bool PIPE_bTest( void )
+{
+	struct sockaddr_in xAddr = { 0 };
+	bool bRet = false;
+
+	xAddr.sin_family = AF_INET;
+	xAddr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	xAddr.sin_port = 0;
+
+	xTestBrokerExit = xSemaphoreCreateBinary();
+	xTestReaderExit = xSemaphoreCreateBinary();
+	lTestListen = socket( AF_INET, SOCK_STREAM, 0 );
+
+	while( ( xTestBrokerExit != NULL ) && ( xTestReaderExit != NULL ) && ( lTestListen >= 0 ) )
+	{
+		if( ( bind( lTestListen, ( struct sockaddr * )&xAddr, sizeof( xAddr ) ) != 0 ) || ( listen( lTestListen, 1 ) != 0 ) ||
+			( xTaskCreate( prvTestBrokerTask, "PipeBroker", configMINIMAL_STACK_SIZE * 2, NULL, tskIDLE_PRIORITY + 1, NULL ) != pdPASS ) )
+		{
+			break;
+		}
+
+		bRet = prvWindowTest() && prvReconnectTest() && prvStaleTest() && prvRetryTest();
+
+		/* Wakes the broker out of accept() */
+		shutdown( lTestListen, SHUT_RDWR );
+		( void )xSemaphoreTake( xTestBrokerExit, portMAX_DELAY );
+		break;
+	}
+
+	if( lTestListen >= 0 )
+	{
+		close( lTestListen );
+		lTestListen = -1;
+	}
+	if( xTestBrokerExit != NULL )
+	{
+		vSemaphoreDelete( xTestBrokerExit );
+	}
+	if( xTestReaderExit != NULL )
+	{
+		vSemaphoreDelete( xTestReaderExit );
+	}
+
+	configPRINTF( ("Pipeline test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
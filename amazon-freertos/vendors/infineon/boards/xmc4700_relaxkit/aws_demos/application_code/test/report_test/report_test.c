@@ -0,0 +1,120 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "report_test.h"
+#include "report.h"
+
+#include "iot_demo_logging.h"
+
+
+static InfineonSensorsMessage_t xTestMessage;
+
+
+/* One window of DPS368_1 and TLI4971_1, returns the suppression of the temperature and the current */
+static void prvWindow( float fTemperature, float fCurrent, bool *pbTemperature, bool *pbCurrent )
+{
+	memset( xTestMessage.bSuppressed, 0, sizeof( xTestMessage.bSuppressed ) );
+
+	xTestMessage.xStat[MSG_PARAMETER_DPS368_TEMP_1].fMean = fTemperature;
+	xTestMessage.xStat[MSG_PARAMETER_TLI4971_CURRENT_1].fMean = fCurrent;
+
+	REPORT_vFilter( &xTestMessage );
+
+	*pbTemperature = xTestMessage.bSuppressed[MSG_PARAMETER_DPS368_TEMP_1];
+	*pbCurrent = xTestMessage.bSuppressed[MSG_PARAMETER_TLI4971_CURRENT_1];
+}
+
+
+bool REPORT_bTest( void )
+{
+	bool bRet = false;
+	bool bTemperature, bCurrent;
+	ReportStat_t xStat;
+
+	memset( &xTestMessage, 0, sizeof( xTestMessage ) );
+	xTestMessage.bOn[MSG_SENSOR_DPS368_1] = true;
+	xTestMessage.bReady[MSG_SENSOR_DPS368_1] = true;
+	xTestMessage.bOn[MSG_SENSOR_TLI4971_1] = true;
+	xTestMessage.bReady[MSG_SENSOR_TLI4971_1] = true;
+
+	REPORT_vReset();
+
+	while( 1 )
+	{
+		/* First window is a snapshot */
+		prvWindow( 20.0f, 10.0f, &bTemperature, &bCurrent );
+		if( bTemperature || bCurrent ) break;
+
+		/* 0.1 degC absolute, 2% of 10 A relative */
+		prvWindow( 20.05f, 10.15f, &bTemperature, &bCurrent );
+		if( !bTemperature || !bCurrent ) break;
+
+		/* Compared with the reported value, slow drift is not lost */
+		prvWindow( 20.15f, 9.75f, &bTemperature, &bCurrent );
+		if( bTemperature || bCurrent ) break;
+
+		/* Silence limit, the window that reaches it is reported */
+		for( uint32_t i = 1; i < REPORT_SILENCE_MAX; i++ )
+		{
+			prvWindow( 20.15f, 9.75f, &bTemperature, &bCurrent );
+			if( !bTemperature || !bCurrent ) break;
+		}
+		if( !bTemperature || !bCurrent ) break;
+		prvWindow( 20.15f, 9.75f, &bTemperature, &bCurrent );
+		if( bTemperature || bCurrent ) break;
+
+		/* Sensor switched off is a change */
+		xTestMessage.bOn[MSG_SENSOR_TLI4971_1] = false;
+		prvWindow( 20.15f, 9.75f, &bTemperature, &bCurrent );
+		if( !bTemperature || bCurrent ) break;
+		xTestMessage.bOn[MSG_SENSOR_TLI4971_1] = true;
+		prvWindow( 20.15f, 9.75f, &bTemperature, &bCurrent );
+		if( !bTemperature || bCurrent ) break;
+
+		/* Open window keeps the state and is not marked */
+		xTestMessage.bReady[MSG_SENSOR_DPS368_1] = false;
+		prvWindow( 25.0f, 9.75f, &bTemperature, &bCurrent );
+		if( bTemperature || !bCurrent ) break;
+		xTestMessage.bReady[MSG_SENSOR_DPS368_1] = true;
+
+		/* Forced snapshot */
+		REPORT_vSnapshotForce();
+		prvWindow( 20.15f, 9.75f, &bTemperature, &bCurrent );
+		if( bTemperature || bCurrent ) break;
+
+		REPORT_vStatGet( &xStat );
+		if( ( xStat.ulWindows != REPORT_SILENCE_MAX + 7 ) || ( xStat.ulSnapshots != 2 ) ) break;
+
+		bRet = true;
+		break;
+	}
+
+	REPORT_vReset();
+
+	configPRINTF( ("Report by exception test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
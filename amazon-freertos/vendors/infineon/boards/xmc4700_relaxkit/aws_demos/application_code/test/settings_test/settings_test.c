@@ -0,0 +1,274 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#include <stdbool.h>
+#include <string.h>
+
+#include "settings_test.h"
+#include "settings.h"
+
+#include "iot_demo_logging.h"
+
+
+/* NVM of the test in RAM */
+static uint8_t ucNvm[sizeof( Settings_t ) + 16];
+static bool bNvmWritten = false;
+
+static bool prvRamRead( uint8_t *pucData, uint32_t ulLen )
+{
+	if( !bNvmWritten || ( ulLen > sizeof( ucNvm ) ) )
+	{
+		return false;
+	}
+	memcpy( pucData, ucNvm, ulLen );
+
+	return true;
+}
+
+static bool prvRamWrite( const uint8_t *pucData, uint32_t ulLen )
+{
+	if( ulLen > sizeof( ucNvm ) )
+	{
+		return false;
+	}
+	memcpy( ucNvm, pucData, ulLen );
+	bNvmWritten = true;
+
+	return true;
+}
+
+static const SettingsNvm_t xRamNvm = { prvRamRead, prvRamWrite };
+
+
+/* Two sensors built in, a DPS368 and the microphone */
+static void prvBase( Settings_t *pxSettings )
+{
+	memset( pxSettings, 0, sizeof( Settings_t ) );
+	pxSettings->xSensor[MSG_SENSOR_DPS368_1] = ( SettingsSensor_t ){ true, 100, 50, 5000 };
+	pxSettings->xSensor[MSG_SENSOR_IM69D130] = ( SettingsSensor_t ){ true, 0, 256, 5000 };
+	pxSettings->bSpectra = true;
+	pxSettings->ucAlarmPercent = 80;
+}
+
+
+/* Keys present change their values, the others and the sensors not built in keep theirs */
+static bool prvDeltaTest( void )
+{
+	static const char cDelta[] = "{\"version\":7,\"timestamp\":1,\"state\":{\"sensors\":{\"DPS368_1\":{\"on\":false,\"send_ms\":2000},"
+			"\"TLI4971_1\":{\"on\":true}},\"spectra\":false,\"alarm_percent\":70},\"metadata\":{\"spectra\":{\"timestamp\":1}}}";
+	Settings_t xSettings;
+
+	prvBase( &xSettings );
+	SETTINGS_vApplied( &xSettings, false );
+
+	if( !SETTINGS_bDelta( cDelta, strlen( cDelta ) ) || !SETTINGS_bTake( &xSettings ) || SETTINGS_bTake( &xSettings ) )
+	{
+		return false;
+	}
+
+	return !xSettings.xSensor[MSG_SENSOR_DPS368_1].bOn && ( xSettings.xSensor[MSG_SENSOR_DPS368_1].ulSendMs == 2000 ) &&
+		( xSettings.xSensor[MSG_SENSOR_DPS368_1].ulSampleMs == 100 ) && ( xSettings.xSensor[MSG_SENSOR_DPS368_1].ulWindow == 50 ) &&
+		!xSettings.xSensor[MSG_SENSOR_TLI4971_1].bOn && ( xSettings.xSensor[MSG_SENSOR_TLI4971_1].ulSendMs == 0 ) &&
+		xSettings.xSensor[MSG_SENSOR_IM69D130].bOn && !xSettings.bSpectra && ( xSettings.ucAlarmPercent == 70 );
+}
+
+
+/* One value out of bounds or of the wrong type rejects the whole delta */
+static bool prvRejectTest( void )
+{
+	static const char *pcBad[] = {
+		"{\"state\":{\"sensors\":{\"DPS368_1\":{\"on\":false,\"send_ms\":50}}}}",
+		"{\"state\":{\"sensors\":{\"DPS368_1\":{\"window\":257}}}}",
+		"{\"state\":{\"sensors\":{\"DPS368_1\":{\"sample_ms\":-1}}}}",
+		"{\"state\":{\"sensors\":{\"DPS368_1\":{\"on\":\"yes\"}}}}",
+		"{\"state\":{\"alarm_percent\":101,\"spectra\":false}}",
+		"{\"state\":{\"alarm_percent\":99999999999}}",
+		"{\"state\":{\"sensors\":[1,2]}}",
+		"{\"version\":3}",
+	};
+	Settings_t xSettings;
+
+	prvBase( &xSettings );
+	SETTINGS_vApplied( &xSettings, false );
+
+	for( uint32_t i = 0; i < sizeof( pcBad ) / sizeof( pcBad[0] ); i++ )
+	{
+		if( SETTINGS_bDelta( pcBad[i], strlen( pcBad[i] ) ) )
+		{
+			return false;
+		}
+	}
+
+	return !SETTINGS_bTake( &xSettings );
+}
+
+
+/* A key is matched as a whole, "button" is not "on"; a get of a shadow in sync changes nothing */
+static bool prvKeyTest( void )
+{
+	static const char cDelta[] = "{\"state\":{\"sensors\":{\"DPS368_1\":{\"button\":false,\"sample_ms\":200}}}}";
+	static const char cInSync[] = "{\"state\":{\"desired\":{\"spectra\":false},\"reported\":{\"spectra\":false}},\"version\":9}";
+	static const char cGet[] = "{\"state\":{\"desired\":{\"spectra\":false},\"reported\":{\"spectra\":true},"
+			"\"delta\":{\"spectra\":false}},\"version\":9}";
+	Settings_t xSettings;
+
+	prvBase( &xSettings );
+	SETTINGS_vApplied( &xSettings, false );
+
+	if( !SETTINGS_bDelta( cDelta, strlen( cDelta ) ) || !SETTINGS_bTake( &xSettings ) ||
+		!xSettings.xSensor[MSG_SENSOR_DPS368_1].bOn || ( xSettings.xSensor[MSG_SENSOR_DPS368_1].ulSampleMs != 200 ) )
+	{
+		return false;
+	}
+
+	if( !SETTINGS_bDelta( cInSync, strlen( cInSync ) ) || SETTINGS_bTake( &xSettings ) )
+	{
+		return false;
+	}
+
+	return SETTINGS_bDelta( cGet, strlen( cGet ) ) && SETTINGS_bTake( &xSettings ) && !xSettings.bSpectra &&
+		( xSettings.xSensor[MSG_SENSOR_DPS368_1].ulSampleMs == 100 );
+}
+
+
+/* Applied settings are reported once, saved only when they came from a delta */
+static bool prvReportTest( void )
+{
+	static const char cExpected[] = "{\"state\":{\"reported\":{\"sensors\":{"
+			"\"DPS368_1\":{\"on\":true,\"sample_ms\":100,\"window\":50,\"send_ms\":5000},"
+			"\"IM69D130\":{\"on\":true,\"sample_ms\":0,\"window\":256,\"send_ms\":5000}},"
+			"\"spectra\":true,\"alarm_percent\":80}},\"clientToken\":\"0000002a\"}";
+	char cReported[SETTINGS_REPORT_SIZE];
+	char cShort[64];
+	Settings_t xSettings;
+	Settings_t xReported;
+	bool bPersist = true;
+
+	prvBase( &xSettings );
+	SETTINGS_vApplied( &xSettings, false );
+	if( !SETTINGS_bReport( &xReported, &bPersist ) || bPersist || SETTINGS_bReport( &xReported, &bPersist ) )
+	{
+		return false;
+	}
+
+	SETTINGS_vApplied( &xSettings, true );
+	if( !SETTINGS_bReport( &xReported, &bPersist ) || !bPersist )
+	{
+		return false;
+	}
+
+	uint32_t ulLen = SETTINGS_ulReported( &xReported, 42, cReported, sizeof( cReported ) );
+
+	return ( ulLen == strlen( cExpected ) ) && ( strcmp( cReported, cExpected ) == 0 ) &&
+		( SETTINGS_ulReported( &xReported, 42, cShort, sizeof( cShort ) ) == 0 );
+}
+
+
+/* The record holds the settings over a reset, sensors not built in now keep their defaults */
+static bool prvNvmTest( void )
+{
+	Settings_t xSettings;
+	Settings_t xLoaded;
+
+	bNvmWritten = false;
+	prvBase( &xLoaded );
+	if( SETTINGS_bLoad( &xLoaded, &xRamNvm ) )
+	{
+		return false;
+	}
+
+	prvBase( &xSettings );
+	xSettings.xSensor[MSG_SENSOR_DPS368_1] = ( SettingsSensor_t ){ false, 250, 20, 10000 };
+	xSettings.xSensor[MSG_SENSOR_TLI493D_1] = ( SettingsSensor_t ){ true, 10, 100, 1000 };
+	xSettings.ucAlarmPercent = 95;
+	if( !SETTINGS_bSave( &xSettings, &xRamNvm ) || !SETTINGS_bLoad( &xLoaded, &xRamNvm ) )
+	{
+		return false;
+	}
+
+	if( ( memcmp( &xLoaded.xSensor[MSG_SENSOR_DPS368_1], &xSettings.xSensor[MSG_SENSOR_DPS368_1], sizeof( SettingsSensor_t ) ) != 0 ) ||
+		( xLoaded.xSensor[MSG_SENSOR_TLI493D_1].ulSendMs != 0 ) || ( xLoaded.ucAlarmPercent != 95 ) )
+	{
+		return false;
+	}
+
+	/* A record out of the bounds of a delta is not loaded, the defaults stay */
+	xSettings.xSensor[MSG_SENSOR_DPS368_1].ulWindow = SETTINGS_WINDOW_MAX + 1;
+	prvBase( &xLoaded );
+	if( !SETTINGS_bSave( &xSettings, &xRamNvm ) || SETTINGS_bLoad( &xLoaded, &xRamNvm ) ||
+		( xLoaded.xSensor[MSG_SENSOR_DPS368_1].ulWindow != 50 ) )
+	{
+		return false;
+	}
+
+	/* Another layout is not loaded */
+	ucNvm[0] ^= 0xFF;
+	prvBase( &xLoaded );
+
+	return !SETTINGS_bLoad( &xLoaded, &xRamNvm ) && xLoaded.xSensor[MSG_SENSOR_DPS368_1].bOn;
+}
+
+
+/* Linked sensors take a new sample_ms or window together, sensors not built in don't count */
+static bool prvLinkTest( void )
+{
+	static const char cOne[] = "{\"state\":{\"sensors\":{\"DPS368_1\":{\"sample_ms\":200}}}}";
+	static const char cBoth[] = "{\"state\":{\"sensors\":{\"DPS368_1\":{\"sample_ms\":200,\"window\":20},"
+			"\"DPS368_2\":{\"sample_ms\":200,\"window\":20}}}}";
+	static const char cSend[] = "{\"state\":{\"sensors\":{\"DPS368_2\":{\"send_ms\":1000}}}}";
+	Settings_t xSettings;
+
+	prvBase( &xSettings );
+	xSettings.xSensor[MSG_SENSOR_DPS368_2] = xSettings.xSensor[MSG_SENSOR_DPS368_1];
+	SETTINGS_vApplied( &xSettings, false );
+
+	if( !SETTINGS_bLink( ( 1UL << MSG_SENSOR_DPS368_1 ) | ( 1UL << MSG_SENSOR_DPS368_2 ) | ( 1UL << MSG_SENSOR_DPS368_3 ) ) ||
+		SETTINGS_bDelta( cOne, strlen( cOne ) ) || SETTINGS_bTake( &xSettings ) )
+	{
+		return false;
+	}
+
+	if( !SETTINGS_bDelta( cBoth, strlen( cBoth ) ) || !SETTINGS_bTake( &xSettings ) ||
+		( xSettings.xSensor[MSG_SENSOR_DPS368_2].ulSampleMs != 200 ) || ( xSettings.xSensor[MSG_SENSOR_DPS368_2].ulWindow != 20 ) )
+	{
+		return false;
+	}
+
+	return SETTINGS_bDelta( cSend, strlen( cSend ) ) && SETTINGS_bTake( &xSettings ) &&
+		( xSettings.xSensor[MSG_SENSOR_DPS368_2].ulSendMs == 1000 );
+}
+
+
+bool SETTINGS_bTest( void )
+{
+	bool bRet = prvDeltaTest() && prvRejectTest() && prvKeyTest() && prvReportTest() && prvNvmTest() && prvLinkTest();
+
+	/* Nothing left for the sensors and MQTT tasks */
+	Settings_t xSettings;
+	bool bPersist;
+	( void )SETTINGS_bTake( &xSettings );
+	( void )SETTINGS_bReport( &xSettings, &bPersist );
+
+	configPRINTF( ("Settings test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
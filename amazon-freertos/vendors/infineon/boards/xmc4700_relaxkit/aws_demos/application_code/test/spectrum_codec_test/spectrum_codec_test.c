@@ -0,0 +1,284 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "spectrum_codec_test.h"
+#include "spectrum_codec.h"
+
+#include "FreeRTOS.h"
+#include "iot_demo_logging.h"
+
+
+#define SPEC_TEST_BINS				( 128 )
+#define SPEC_TEST_WINDOWS			( 48 )
+/* Window not delivered to the decoder */
+#define SPEC_TEST_LOST_WINDOW		( 20 )
+/* Windows of random spectra, bin counts and drops */
+#define SPEC_TEST_RANDOM_WINDOWS	( 200000 )
+
+static uint16_t pusMag[SPEC_TEST_BINS];
+static uint8_t pucFrame[SPEC_FRAME_SIZE_MAX( SPEC_TEST_BINS )];
+static uint8_t pucCode[SPEC_BINS_MAX];
+static SpecCodec_t xEncoder;
+static SpecCodec_t xDecoder;
+static uint32_t ulSeed = 12345;
+
+
+static uint32_t prvRandom( void )
+{
+	ulSeed = ulSeed * 1664525UL + 1013904223UL;
+	return ulSeed >> 8;
+}
+
+
+/* Falling floor, two tones and a few counts of noise, the tones move now and then */
+static void prvSpectrumMake( uint32_t ulWindow )
+{
+	uint32_t ulTone = 20 + ( ulWindow / 12 ) * 3;
+
+	for( uint32_t i = 0; i < SPEC_TEST_BINS; i++ )
+	{
+		uint32_t ulMag = 4000 / ( i + 4 ) + ( prvRandom() % 7 );
+		if( ( i == ulTone ) || ( i == 2 * ulTone ) )
+		{
+			ulMag += 20000 + ( prvRandom() % 500 );
+		}
+		pusMag[i] = ulMag;
+	}
+}
+
+
+/* Characters of the same bins as a JSON integer array */
+static uint32_t prvJsonLen( void )
+{
+	uint32_t ulLen = 2;
+
+	for( uint32_t i = 0; i < SPEC_TEST_BINS; i++ )
+	{
+		uint32_t ulVal = pusMag[i];
+		ulLen += ( i > 0 );
+		do
+		{
+			ulLen++;
+			ulVal /= 10;
+		} while( ulVal );
+	}
+
+	return ulLen;
+}
+
+
+/* Every magnitude within half a step of its level, plus the rounding of the level to an integer */
+static bool prvErrorBoundTest( void )
+{
+	const float fHalfStep = SPEC_DB_STEP_CDB / 200.0f;
+	float fErr, fMaxErr = 0.0f, fMaxErr100 = 0.0f, fMaxRel = 0.0f;
+	uint16_t usLevel;
+
+	if( ( SPEC_ucQuantise( 0 ) != 0 ) || ( SPEC_usDequantise( 0 ) != 0 ) )
+	{
+		return false;
+	}
+
+	for( uint32_t ulMag = 1; ulMag <= UINT16_MAX; ulMag++ )
+	{
+		usLevel = SPEC_usDequantise( SPEC_ucQuantise( ulMag ) );
+		fErr = fabsf( 20.0f * log10f( (float)usLevel / (float)ulMag ) );
+		if( fErr > fHalfStep + 20.0f * log10f( 1.0f + 0.5f / ulMag ) + 1e-3f )
+		{
+			configPRINTF( ("SPEC: %u decoded %u, %.3f dB\r\n", ulMag, usLevel, fErr) );
+			return false;
+		}
+		fMaxErr = fmaxf( fMaxErr, fErr );
+		fMaxRel = fmaxf( fMaxRel, fabsf( (float)usLevel - ulMag ) / ulMag );
+		if( ulMag >= 100 )
+		{
+			fMaxErr100 = fmaxf( fMaxErr100, fErr );
+		}
+	}
+
+	configPRINTF( ("SPEC: %u codes, step %.2f dB, max error %.3f dB, %.3f dB from 100 counts, relative %.4f\r\n",
+			SPEC_CODES, 2.0f * fHalfStep, fMaxErr, fMaxErr100, fMaxRel) );
+
+	return true;
+}
+
+
+/* Decoded codes equal the encoder side quantisation, a lost window breaks the inter frames up to the next key frame */
+static bool prvRoundTripTest( void )
+{
+	uint32_t ulLen, ulFrames = 0, ulJson = 0, ulKey = 0, ulSkipped = 0;
+	uint16_t usBins;
+	bool bLost = false;
+
+	SPEC_vReset( &xEncoder );
+	SPEC_vReset( &xDecoder );
+
+	for( uint32_t ulWindow = 0; ulWindow < SPEC_TEST_WINDOWS; ulWindow++ )
+	{
+		prvSpectrumMake( ulWindow );
+		ulJson += prvJsonLen();
+
+		ulLen = SPEC_ulEncode( &xEncoder, pusMag, SPEC_TEST_BINS, pucFrame, sizeof( pucFrame ) );
+		if( ulLen == 0 )
+		{
+			return false;
+		}
+		ulFrames += ulLen;
+		ulKey += !( pucFrame[0] & SPEC_FLAG_INTER );
+
+		if( ulWindow == SPEC_TEST_LOST_WINDOW )
+		{
+			bLost = true;
+			continue;
+		}
+		if( bLost && ( pucFrame[0] & SPEC_FLAG_INTER ) )
+		{
+			if( SPEC_bDecode( &xDecoder, pucFrame, ulLen, pucCode, &usBins ) )
+			{
+				return false;
+			}
+			ulSkipped++;
+			continue;
+		}
+		bLost = false;
+
+		if( !SPEC_bDecode( &xDecoder, pucFrame, ulLen, pucCode, &usBins ) || ( usBins != SPEC_TEST_BINS ) )
+		{
+			return false;
+		}
+		for( uint32_t i = 0; i < SPEC_TEST_BINS; i++ )
+		{
+			if( pucCode[i] != SPEC_ucQuantise( pusMag[i] ) )
+			{
+				return false;
+			}
+		}
+	}
+
+	/* Broken frames and a buffer too small */
+	if( SPEC_bDecode( &xDecoder, pucFrame, ulLen - 1, pucCode, &usBins ) ||
+			( SPEC_ulEncode( &xEncoder, pusMag, SPEC_TEST_BINS, pucFrame, 8 ) != 0 ) )
+	{
+		return false;
+	}
+
+	configPRINTF( ("SPEC: %u bytes a window, JSON %u, raw %u, %u key frames, %u frames skipped after the loss\r\n",
+			ulFrames / SPEC_TEST_WINDOWS, ulJson / SPEC_TEST_WINDOWS, (uint32_t)( SPEC_TEST_BINS * sizeof( uint16_t ) ), ulKey, ulSkipped) );
+
+	return ( ulKey >= SPEC_TEST_WINDOWS / SPEC_KEY_INTERVAL ) && ( ulSkipped > 0 ) && ( ulSkipped < SPEC_KEY_INTERVAL );
+}
+
+
+/* Any magnitudes and bin count within SPEC_FRAME_SIZE_MAX, decoded exactly whenever the reference window arrived */
+static bool prvRandomTest( void )
+{
+	uint32_t ulLen, ulMaxLen = 0, ulDecoded = 0;
+	uint16_t usBins = SPEC_TEST_BINS, usDecBins;
+	bool bLost = false;
+
+	SPEC_vReset( &xEncoder );
+	SPEC_vReset( &xDecoder );
+
+	for( uint32_t ulWindow = 0; ulWindow < SPEC_TEST_RANDOM_WINDOWS; ulWindow++ )
+	{
+		uint32_t ulKind = prvRandom() % 4;
+
+		if( prvRandom() % 64 == 0 )
+		{
+			usBins = 1 + prvRandom() % SPEC_BINS_MAX;
+		}
+		for( uint32_t i = 0; i < usBins; i++ )
+		{
+			/* Full scale noise, small counts, a steady spectrum with a bin or two moving */
+			if( ulKind == 0 )
+			{
+				pusMag[i] = prvRandom();
+			}
+			else if( ulKind == 1 )
+			{
+				pusMag[i] = prvRandom() % 16;
+			}
+			else if( prvRandom() % 32 == 0 )
+			{
+				pusMag[i] = prvRandom() % 3000;
+			}
+		}
+
+		ulLen = SPEC_ulEncode( &xEncoder, pusMag, usBins, pucFrame, sizeof( pucFrame ) );
+		if( ( ulLen == 0 ) || ( ulLen > SPEC_FRAME_SIZE_MAX( usBins ) ) )
+		{
+			configPRINTF( ("SPEC: window %u of %u bins, frame of %u bytes\r\n", ulWindow, usBins, ulLen) );
+			return false;
+		}
+		ulMaxLen = ( ulLen > ulMaxLen ) ? ulLen : ulMaxLen;
+
+		if( prvRandom() % 50 == 0 )
+		{
+			bLost = true;
+			continue;
+		}
+		if( bLost && ( pucFrame[0] & SPEC_FLAG_INTER ) )
+		{
+			if( SPEC_bDecode( &xDecoder, pucFrame, ulLen, pucCode, &usDecBins ) )
+			{
+				return false;
+			}
+			continue;
+		}
+		bLost = false;
+
+		if( !SPEC_bDecode( &xDecoder, pucFrame, ulLen, pucCode, &usDecBins ) || ( usDecBins != usBins ) )
+		{
+			configPRINTF( ("SPEC: window %u not decoded\r\n", ulWindow) );
+			return false;
+		}
+		for( uint32_t i = 0; i < usBins; i++ )
+		{
+			if( pucCode[i] != SPEC_ucQuantise( pusMag[i] ) )
+			{
+				configPRINTF( ("SPEC: window %u bin %u code %u, expected %u\r\n", ulWindow, i, pucCode[i], SPEC_ucQuantise( pusMag[i] )) );
+				return false;
+			}
+		}
+		ulDecoded++;
+	}
+
+	configPRINTF( ("SPEC: %u random windows, %u decoded, largest frame %u bytes of %u\r\n",
+			SPEC_TEST_RANDOM_WINDOWS, ulDecoded, ulMaxLen, SPEC_FRAME_SIZE_MAX( SPEC_BINS_MAX )) );
+
+	return true;
+}
+
+
+bool SPEC_bTest( void )
+{
+	bool bRet = prvErrorBoundTest() && prvRoundTripTest() && prvRandomTest();
+
+	configPRINTF( ("Spectrum codec test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
@@ -0,0 +1,428 @@
+/* 
+ * Copyright (C) 2021 Infineon Technologies AG.
+ *
+ * Licensed under the EVAL_XMC47_PREDMAIN_AA Evaluation Software License
+ * Agreement V1.0 (the "License"); you may not use this file except in
+ * compliance with the License.
+ *
+ * For receiving a copy of the License, please refer to:
+ *
+ * https://github.com/Infineon/pred-main-xmc4700-kit/LICENSE.txt
+ *
+ * Licensee acknowledges that the Licensed Items are provided by Licensor free
+ * of charge. Accordingly, without prejudice to Section 9 of the License, the
+ * Licensed Items provided by Licensor under this Agreement are provided "AS IS"
+ * without any warranty or liability of any kind and Licensor hereby expressly
+ * disclaims any warranties or representations, whether express, implied,
+ * statutory or otherwise, including but not limited to warranties of
+ * workmanship, merchantability, fitness for a particular purpose, defects in
+ * the Licensed Items, or non-infringement of third parties' intellectual
+ * property rights.
+ *
+ */
+#include <stdbool.h>
+#include <string.h>
+
+#include "store_test.h"
+#include "store.h"
+
+#include "iot_demo_logging.h"
+
+
+#define STORE_TEST_SECTORS			( 4 )
+#define STORE_TEST_SECTOR_SIZE		( 4096 )
+#define STORE_TEST_PAGES			( STORE_TEST_SECTOR_SIZE / STORE_PAGE_SIZE - 1 )	/* Record pages of a sector */
+
+
+/* RAM standing in for the flash, erased to zeros like the XMC4 PFLASH */
+static uint32_t pulTestFlash[STORE_TEST_SECTORS * STORE_TEST_SECTOR_SIZE / sizeof( uint32_t )];
+/* Programs until the power cut, the next one writes half a page, negative for none */
+static int32_t lTestProgramsLeft = -1;
+static bool bTestCut = false;
+
+static Store_t xTestStore;
+static uint8_t pucTestRecord[1024];
+static uint32_t ulTestLenMax;
+
+
+static bool prvTestErase( uintptr_t uxAddr )
+{
+	if( bTestCut )
+	{
+		return false;
+	}
+
+	memset( ( void * )uxAddr, 0, STORE_TEST_SECTOR_SIZE );
+
+	return true;
+}
+
+
+static bool prvTestProgram( uintptr_t uxAddr, const uint32_t *pulPage )
+{
+	uint32_t *pulFlash = ( uint32_t * )uxAddr;
+
+	if( bTestCut )
+	{
+		return false;
+	}
+
+	/* Like the real flash a page is programmed once after the erase */
+	for( uint32_t i = 0; i < STORE_PAGE_SIZE / sizeof( uint32_t ); i++ )
+	{
+		if( pulFlash[i] != STORE_ERASED )
+		{
+			return false;
+		}
+	}
+
+	/* The cut leaves the first half erased, a torn header is never valid */
+	if( lTestProgramsLeft == 0 )
+	{
+		memcpy( &pulFlash[STORE_PAGE_SIZE / 8], &pulPage[STORE_PAGE_SIZE / 8], STORE_PAGE_SIZE / 2 );
+		bTestCut = true;
+		return false;
+	}
+	if( lTestProgramsLeft > 0 )
+	{
+		lTestProgramsLeft--;
+	}
+
+	memcpy( pulFlash, pulPage, STORE_PAGE_SIZE );
+
+	return true;
+}
+
+
+static const StoreFlash_t xTestFlash = {
+	.uxBase = ( uintptr_t )pulTestFlash,
+	.ulSectorSize = STORE_TEST_SECTOR_SIZE,
+	.ucSectors = STORE_TEST_SECTORS,
+	.pxErase = prvTestErase,
+	.pxProgram = prvTestProgram,
+	.pxAccess = NULL
+};
+
+
+/* Restart with the flash as it was left, the power is back */
+static bool prvReset( void )
+{
+	lTestProgramsLeft = -1;
+	bTestCut = false;
+
+	return STORE_bInit( &xTestStore, &xTestFlash );
+}
+
+
+static bool prvBlank( uint32_t ulLenMax )
+{
+	memset( pulTestFlash, 0, sizeof( pulTestFlash ) );
+	ulTestLenMax = ulLenMax;
+
+	return prvReset();
+}
+
+
+/* Length and contents follow from the sequence number */
+static uint32_t prvLen( uint32_t ulSeq )
+{
+	return ( ulSeq * 97 ) % ulTestLenMax + 1;
+}
+
+
+static uint8_t prvByte( uint32_t ulSeq, uint32_t i )
+{
+	return ( uint8_t )( ulSeq * 31 + i * 7 );
+}
+
+
+static bool prvPut( uint32_t ulSeq )
+{
+	for( uint32_t i = 0; i < prvLen( ulSeq ); i++ )
+	{
+		pucTestRecord[i] = prvByte( ulSeq, i );
+	}
+
+	return STORE_bPut( &xTestStore, pucTestRecord, prvLen( ulSeq ), ulSeq * 10 );
+}
+
+
+/* Records ulFirst.. in order and intact, then an empty store */
+static bool prvDrain( uint32_t ulFirst, uint32_t ulCount )
+{
+	const uint8_t *pucData;
+	uint32_t ulLen;
+	uint32_t ulSeq;
+	uint32_t ulTick;
+
+	if( STORE_ulPending( &xTestStore ) != ulCount )
+	{
+		return false;
+	}
+
+	for( uint32_t ulExpected = ulFirst; ulExpected < ulFirst + ulCount; ulExpected++ )
+	{
+		pucData = STORE_pucPeek( &xTestStore, &ulLen, &ulSeq, &ulTick );
+		if( ( pucData == NULL ) || ( ulSeq != ulExpected ) || ( ulLen != prvLen( ulSeq ) ) || ( ulTick != ulSeq * 10 ) )
+		{
+			return false;
+		}
+		for( uint32_t i = 0; i < ulLen; i++ )
+		{
+			if( pucData[i] != prvByte( ulSeq, i ) )
+			{
+				return false;
+			}
+		}
+
+		/* Peeking again gives the same record until it is acknowledged */
+		if( STORE_pucPeek( &xTestStore, &ulLen, &ulSeq, &ulTick ) != pucData )
+		{
+			return false;
+		}
+		STORE_vAck( &xTestStore, ulSeq );
+	}
+
+	return ( STORE_pucPeek( &xTestStore, &ulLen, &ulSeq, &ulTick ) == NULL ) && ( STORE_ulPending( &xTestStore ) == 0 );
+}
+
+
+/* Records of one to three pages come back in order, an empty store stays empty after a restart */
+static bool prvOrderTest( void )
+{
+	StoreStat_t xStat;
+
+	if( !prvBlank( 600 ) || ( STORE_ulPending( &xTestStore ) != 0 ) )
+	{
+		return false;
+	}
+
+	for( uint32_t ulSeq = 1; ulSeq <= 10; ulSeq++ )
+	{
+		if( !prvPut( ulSeq ) )
+		{
+			return false;
+		}
+	}
+
+	if( !prvDrain( 1, 10 ) || !prvReset() || !prvDrain( 11, 0 ) || !prvPut( 11 ) || !prvReset() || !prvDrain( 11, 1 ) )
+	{
+		return false;
+	}
+
+	STORE_vStatGet( &xTestStore, &xStat );
+
+	/* Oversized record */
+	return ( xStat.ulSent == 1 ) && ( xStat.ulDropped == 0 ) &&
+		!STORE_bPut( &xTestStore, pucTestRecord, STORE_TEST_SECTOR_SIZE, 0 );
+}
+
+
+/* Acknowledges survive a restart at the checkpoints */
+static bool prvRestartTest( void )
+{
+	const uint8_t *pucData;
+	uint32_t ulLen;
+	uint32_t ulSeq;
+	uint32_t ulTick;
+
+	if( !prvBlank( 100 ) )
+	{
+		return false;
+	}
+
+	for( ulSeq = 1; ulSeq <= STORE_ACK_INTERVAL + 4; ulSeq++ )
+	{
+		if( !prvPut( ulSeq ) )
+		{
+			return false;
+		}
+	}
+
+	/* Two acknowledges before the first checkpoint are lost */
+	for( uint32_t i = 0; i < 2; i++ )
+	{
+		pucData = STORE_pucPeek( &xTestStore, &ulLen, &ulSeq, &ulTick );
+		if( pucData == NULL )
+		{
+			return false;
+		}
+		STORE_vAck( &xTestStore, ulSeq );
+	}
+	if( !prvReset() || ( STORE_ulPending( &xTestStore ) != STORE_ACK_INTERVAL + 4 ) )
+	{
+		return false;
+	}
+
+	/* The checkpoint after STORE_ACK_INTERVAL acknowledges is kept */
+	for( uint32_t i = 0; i < STORE_ACK_INTERVAL + 1; i++ )
+	{
+		pucData = STORE_pucPeek( &xTestStore, &ulLen, &ulSeq, &ulTick );
+		if( pucData == NULL )
+		{
+			return false;
+		}
+		STORE_vAck( &xTestStore, ulSeq );
+	}
+
+	return prvReset() && prvDrain( STORE_ACK_INTERVAL + 1, 4 );
+}
+
+
+/* A long outage wraps the ring, the newest records are kept without a gap */
+static bool prvWrapTest( void )
+{
+	const uint8_t *pucData;
+	uint32_t ulLen;
+	uint32_t ulSeq;
+	uint32_t ulTick;
+	StoreStat_t xStat;
+	const uint32_t ulCount = 20 * STORE_TEST_SECTORS * STORE_TEST_PAGES;
+
+	if( !prvBlank( 600 ) )
+	{
+		return false;
+	}
+
+	for( ulSeq = 1; ulSeq <= ulCount; ulSeq++ )
+	{
+		if( !prvPut( ulSeq ) )
+		{
+			return false;
+		}
+	}
+
+	STORE_vStatGet( &xTestStore, &xStat );
+	if( ( xStat.ulStored != ulCount ) || ( xStat.ulDropped == 0 ) || ( xStat.ulDropped + STORE_ulPending( &xTestStore ) != ulCount ) ||
+		( xStat.ulWearMax < 5 ) || ( xStat.ulWearMax > xStat.ulErases / STORE_TEST_SECTORS + 1 ) )
+	{
+		return false;
+	}
+
+	/* At least the sectors but the one erased last are full */
+	if( STORE_ulPending( &xTestStore ) < ( STORE_TEST_SECTORS - 1 ) * STORE_TEST_PAGES / 3 )
+	{
+		return false;
+	}
+
+	/* Same after a restart, then everything up to the last record */
+	pucData = STORE_pucPeek( &xTestStore, &ulLen, &ulSeq, &ulTick );
+	if( ( pucData == NULL ) || !prvReset() )
+	{
+		return false;
+	}
+
+	return ( ulSeq == xStat.ulDropped + 1 ) && prvDrain( ulSeq, ulCount - ulSeq + 1 );
+}
+
+
+/* Records and sector headers torn by a reset are skipped, nothing written before or after is lost */
+static bool prvPowerCutTest( void )
+{
+	uint32_t ulSeq;
+
+	/* One page records */
+	if( !prvBlank( STORE_PAGE_SIZE - 32 ) )
+	{
+		return false;
+	}
+
+	for( ulSeq = 1; ulSeq <= 3; ulSeq++ )
+	{
+		if( !prvPut( ulSeq ) )
+		{
+			return false;
+		}
+	}
+
+	/* Cut while programming the record */
+	lTestProgramsLeft = 0;
+	if( prvPut( 4 ) || !prvReset() || ( STORE_ulPending( &xTestStore ) != 3 ) )
+	{
+		return false;
+	}
+
+	/* Fill the rest of the first sector, the torn record took a page */
+	for( ulSeq = 4; ulSeq <= STORE_TEST_PAGES - 1; ulSeq++ )
+	{
+		if( !prvPut( ulSeq ) )
+		{
+			return false;
+		}
+	}
+
+	/* Cut while programming the header of the next sector */
+	lTestProgramsLeft = 0;
+	if( prvPut( ulSeq ) || !prvReset() )
+	{
+		return false;
+	}
+
+	return prvPut( ulSeq ) && prvReset() && prvDrain( 1, ulSeq );
+}
+
+
+/* The sector after the head is erased ahead of time once it holds no unsent record, only once across a restart */
+static bool prvPrepareTest( void )
+{
+	StoreStat_t xStat;
+	uint32_t ulSeq;
+	uint32_t ulErases;
+
+	/* One page records, the ring is full */
+	if( !prvBlank( STORE_PAGE_SIZE - 32 ) )
+	{
+		return false;
+	}
+	for( ulSeq = 1; ulSeq <= STORE_TEST_SECTORS * STORE_TEST_PAGES; ulSeq++ )
+	{
+		if( !prvPut( ulSeq ) )
+		{
+			return false;
+		}
+	}
+
+	/* The oldest records are not sent yet */
+	if( STORE_bPrepare( &xTestStore ) || !prvDrain( 1, ulSeq - 1 ) )
+	{
+		return false;
+	}
+
+	STORE_vStatGet( &xTestStore, &xStat );
+	ulErases = xStat.ulErases;
+	if( !STORE_bPrepare( &xTestStore ) )
+	{
+		return false;
+	}
+	STORE_vStatGet( &xTestStore, &xStat );
+	if( xStat.ulErases != ulErases + 1 )
+	{
+		return false;
+	}
+
+	/* Found erased after the restart, the head moves on into it without an erase */
+	if( !prvReset() || !STORE_bPrepare( &xTestStore ) )
+	{
+		return false;
+	}
+	for( uint32_t i = 0; i < STORE_TEST_PAGES; i++ )
+	{
+		if( !prvPut( ulSeq + i ) )
+		{
+			return false;
+		}
+	}
+	STORE_vStatGet( &xTestStore, &xStat );
+
+	return ( xStat.ulErases == 0 ) && ( xStat.ulWearMax >= 1 ) && prvReset() && prvDrain( ulSeq, STORE_TEST_PAGES );
+}
+
+
+bool STORE_bTest( void )
+{
+	bool bRet = prvOrderTest() && prvRestartTest() && prvWrapTest() && prvPowerCutTest() && prvPrepareTest();
+
+	configPRINTF( ("Store test %s\r\n", bRet ? "passed" : "failed") );
+
+	return bRet;
+}
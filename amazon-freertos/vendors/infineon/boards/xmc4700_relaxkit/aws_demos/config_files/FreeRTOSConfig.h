@@ -119,14 +119,12 @@
 /* Event group related definitions. */
 #define configUSE_EVENT_GROUPS                     1
 
-/* Run time stats gathering definitions. */
-/* FIX ME: Uncomment if you plan to use Tracealyzer.
+/* Run time stats gathering definitions, the counter is in metrics_xmc4.c. */
 unsigned long ulGetRunTimeCounterValue( void );
 void vConfigureTimerForRunTimeStats( void );
 #define configGENERATE_RUN_TIME_STATS    1
 #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    vConfigureTimerForRunTimeStats()
 #define portGET_RUN_TIME_COUNTER_VALUE()            ulGetRunTimeCounterValue()
-*/
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES                   0
@@ -319,4 +317,7 @@ extern uint32_t ulRand();
 /* Enable following configuration to use FreeRTOS POSIX ERRNO */
 #define configUSE_POSIX_ERRNO                 ( 1 )
 
+/* Resume the TLS session of the last connect to the broker, see iot_tls.h */
+#define tlsSESSION_RESUMPTION                 ( 1 )
+
 #endif /* FREERTOS_CONFIG_H */
@@ -53,4 +53,17 @@
  */
 #define AWS_IOT_SECURE_SOCKETS_METRICS_ENABLED    ( 1 )
 
+/**
+ * @brief Addresses of the broker kept over reconnects, see dns_cache.h.
+ */
+uint32_t DNS_CACHE_ulResolve( const char * pcName, uint32_t ( * pxResolve )( const char * pcName ), uint32_t ulNow );
+#define socketsconfigGET_HOST_BY_NAME_HOOK( pcHostName, xLookUp ) \
+    DNS_CACHE_ulResolve( ( pcHostName ), ( xLookUp ), xTaskGetTickCount() * portTICK_PERIOD_MS )
+
+/**
+ * @brief Time of the TLS writes for the per-stage latency, see latency.h.
+ */
+void LATENCY_vWrite( void );
+#define socketsconfigTLS_SEND_HOOK()    LATENCY_vWrite()
+
 #endif /* _AWS_SECURE_SOCKETS_CONFIG_H_ */
@@ -27,6 +27,10 @@
 /* How long the MQTT library will wait for PINGRESPs or PUBACKs. */
 #define IOT_MQTT_RESPONSE_WAIT_MS               ( 5000 )
 
+/* PINGRESPs tell the MQTT task the connection is alive, see vMqttTaskAlive(). */
+void vMqttTaskAlive( void );
+#define IotMqtt_PingrespHook()                  vMqttTaskAlive()
+
 /* MQTT demo configuration. */
 #define IOT_DEMO_MQTT_PUBLISH_BURST_COUNT       ( 10 )
 #define IOT_DEMO_MQTT_PUBLISH_BURST_SIZE        ( 2 )
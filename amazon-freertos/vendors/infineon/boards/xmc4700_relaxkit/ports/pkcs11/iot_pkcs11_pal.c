@@ -82,6 +82,9 @@ typedef struct
     CK_ULONG ulCodeVerificationLength;
 } P11KeyConfig_t;
 
+/* The shadow settings follow the objects in the same block */
+typedef char P11KeyConfigFits_t[ ( sizeof( P11KeyConfig_t ) <= E_EEPROM_XMC4_SETTINGS_OFFSET ) ? 1 : -1 ];
+
 /**
  * @brief Certificates/key storage in flash.
  */
@@ -377,7 +380,7 @@ CK_DECLARE_FUNCTION( CK_RV, C_Initialize )( CK_VOID_PTR pvInitArgs )
     /* Ensure that the FreeRTOS heap is used. */
     //CRYPTO_ConfigureHeap();
 
-    E_EEPROM_XMC4_Init( &e_eeprom, sizeof( P11KeyConfig_t ) );
+    E_EEPROM_XMC4_Init( &e_eeprom, E_EEPROM_XMC4_DATA_LEN );
 
     if( E_EEPROM_XMC4_IsFlashEmpty() == false )
     {
@@ -342,7 +342,7 @@ int32_t SOCKETS_Connect( Socket_t xSocket,
 }
 /*-----------------------------------------------------------*/
 
-uint32_t SOCKETS_GetHostByName( const char * pcHostName )
+static uint32_t prvGetHostByName( const char * pcHostName )
 {
     char ip[16] = {0};
 
@@ -370,6 +370,13 @@ uint32_t SOCKETS_GetHostByName( const char * pcHostName )
 }
 /*-----------------------------------------------------------*/
 
+uint32_t SOCKETS_GetHostByName( const char * pcHostName )
+{
+    /* The board may answer from a cache, see iot_secure_sockets_config_defaults.h. */
+    return socketsconfigGET_HOST_BY_NAME_HOOK( pcHostName, prvGetHostByName );
+}
+/*-----------------------------------------------------------*/
+
 int32_t SOCKETS_Recv( Socket_t xSocket,
                       void * pvBuffer,
                       size_t xBufferLength,
@@ -425,6 +432,10 @@ int32_t SOCKETS_Send( Socket_t xSocket,
             {
                 /* Send through TLS pipe, if negotiated. */
                 lStatus = TLS_Send( pxContext->pvTLSContext, pvBuffer, xDataLength );
+                if( lStatus > 0 )
+                {
+                    socketsconfigTLS_SEND_HOOK();
+                }
             }
             else
             {
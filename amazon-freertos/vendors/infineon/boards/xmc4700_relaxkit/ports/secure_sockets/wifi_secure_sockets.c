@@ -894,6 +894,10 @@ int32_t SOCKETS_Send( Socket_t xSocket,
                         /* TLS_Send failed. */
                         lSentBytes = SOCKETS_TLS_SEND_ERROR;
                     }
+                    else
+                    {
+                        socketsconfigTLS_SEND_HOOK();
+                    }
                 }
                 else
                 {
@@ -1208,7 +1212,7 @@ int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
 }
 /*-----------------------------------------------------------*/
 
-uint32_t SOCKETS_GetHostByName( const char * pcHostName )
+static uint32_t prvGetHostByName( const char * pcHostName )
 {
     uint32_t ulIPAddres = 0;
 
@@ -1230,6 +1234,13 @@ uint32_t SOCKETS_GetHostByName( const char * pcHostName )
 }
 /*-----------------------------------------------------------*/
 
+uint32_t SOCKETS_GetHostByName( const char * pcHostName )
+{
+    /* The board may answer from a cache, see iot_secure_sockets_config_defaults.h. */
+    return socketsconfigGET_HOST_BY_NAME_HOOK( pcHostName, prvGetHostByName );
+}
+/*-----------------------------------------------------------*/
+
 BaseType_t SOCKETS_Init( void )
 {
     uint32_t ulIndex;